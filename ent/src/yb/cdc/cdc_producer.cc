@@ -76,7 +76,8 @@ Status CDCProducer::GetChanges(const GetChangesRequestPB& req,
   }
 
   ReplicateMsgs messages;
-  RETURN_NOT_OK(tablet_peer_->consensus()->ReadReplicatedMessages(from_op_id, &messages));
+  RETURN_NOT_OK(tablet_peer_->consensus()->ReadReplicatedMessages(
+      from_op_id, &messages, req.subscriber_uuid()));
 
   TxnStatusMap txn_map = VERIFY_RESULT(BuildTxnStatusMap(messages, now));
   const auto& ordered_msgs = VERIFY_RESULT(SortWrites(messages, txn_map));
@@ -70,12 +70,17 @@ Result<bool> ClusterLoadBalancer::HandleLeaderLoadIfNonAffinitized(TabletId* mov
       }
 
       const set<TabletId>& leaders = state_->per_ts_meta_[non_affinitized_uuid].leaders;
-      const set<TabletId>& peers = state_->per_ts_meta_[affinitized_uuid].running_tablets;
+      const auto& affinitized_ts_meta = state_->per_ts_meta_[affinitized_uuid];
+      const set<TabletId>& peers = affinitized_ts_meta.running_tablets;
       set<TabletId> intersection;
       const auto& itr = std::inserter(intersection, intersection.begin());
       std::set_intersection(leaders.begin(), leaders.end(), peers.begin(), peers.end(), itr);
-      if (!intersection.empty()) {
-        *moving_tablet_id = *intersection.begin();
+      // Witness replicas could not become leaders.
+      for (const auto& tablet_id : intersection) {
+        if (affinitized_ts_meta.witnesses.count(tablet_id)) {
+          continue;
+        }
+        *moving_tablet_id = tablet_id;
         *from_ts = non_affinitized_uuid;
         *to_ts = affinitized_uuid;
         return true;
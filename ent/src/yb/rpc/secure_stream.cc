@@ -71,7 +71,7 @@ class SecureOutboundData : public OutboundData {
     return false;
   }
 
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override {
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override {
     output->push_back(std::move(buffer_));
   }
 
@@ -419,10 +419,10 @@ size_t SecureStream::Send(OutboundDataPtr data) {
     pending_data_.push_back(std::move(data));
     return std::numeric_limits<size_t>::max();
   case SecureState::kEnabled: {
-      boost::container::small_vector<RefCntBuffer, 10> queue;
+      boost::container::small_vector<RefCntSlice, 10> queue;
       data->Serialize(&queue);
       for (const auto& buf : queue) {
-        Slice slice(buf.data(), buf.size());
+        Slice slice = buf.as_slice();
         for (;;) {
           auto len = SSL_write(ssl_.get(), slice.data(), slice.size());
           if (len == slice.size()) {
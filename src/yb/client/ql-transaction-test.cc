@@ -1133,6 +1133,57 @@ TEST_F(QLTransactionTest, StatusEvolution) {
   }
 }
 
+// Transaction that consists of a single batch of writes to one tablet does not write intents.
+TEST_F(QLTransactionTest, SingleShardWrite) {
+  auto txn = CreateTransaction();
+  auto session = CreateSession(txn);
+  txn->SetNextFlushFinal();
+  ASSERT_OK(WriteRow(session, 1, 2));
+  ASSERT_EQ(CountIntents(), 0);
+  ASSERT_OK(txn->CommitFuture().get());
+
+  VERIFY_ROW(CreateSession(), 1, 2);
+  CheckNoRunningTransactions();
+}
+
+// Statuses of several transactions are returned in the same order as they were requested.
+TEST_F(QLTransactionTest, BatchedStatusRequest) {
+  auto txn = CreateTransaction();
+  ASSERT_OK(WriteRow(CreateSession(txn), 0, 0));
+  auto metadata = txn->TEST_GetMetadata().get();
+  ASSERT_OK(txn->CommitFuture().get());
+
+  auto unknown_id = GenerateTransactionId();
+  tserver::GetTransactionStatusRequestPB req;
+  req.set_tablet_id(metadata.status_tablet);
+  req.set_transaction_id(unknown_id.data, unknown_id.size());
+  req.add_batch_transaction_id(metadata.transaction_id.data, metadata.transaction_id.size());
+  req.add_batch_transaction_id(unknown_id.data, unknown_id.size());
+
+  rpc::Rpcs rpcs;
+  auto resp = ASSERT_RESULT(rpc::WrapRpcFuture<tserver::GetTransactionStatusResponsePB>(
+      GetTransactionStatus, &rpcs)(
+          TransactionRpcDeadline(), nullptr /* tablet */, client_.get(), &req).get());
+  // Status of the first transaction is reported in the same way as without batching.
+  ASSERT_EQ(TransactionStatus::ABORTED, resp.status());
+  ASSERT_FALSE(resp.has_status_hybrid_time());
+  ASSERT_EQ(2, resp.batch_status().size());
+  ASSERT_EQ(2, resp.batch_status_hybrid_time().size());
+  ASSERT_EQ(TransactionStatus::COMMITTED, resp.batch_status(0));
+  ASSERT_EQ(TransactionStatus::ABORTED, resp.batch_status(1));
+  ASSERT_EQ(HybridTime::kMax.ToUint64(), resp.batch_status_hybrid_time(1));
+
+  // Request from a client that does not batch gets no batch fields in response.
+  req.clear_batch_transaction_id();
+  req.set_transaction_id(metadata.transaction_id.data, metadata.transaction_id.size());
+  resp = ASSERT_RESULT(rpc::WrapRpcFuture<tserver::GetTransactionStatusResponsePB>(
+      GetTransactionStatus, &rpcs)(
+          TransactionRpcDeadline(), nullptr /* tablet */, client_.get(), &req).get());
+  ASSERT_EQ(TransactionStatus::COMMITTED, resp.status());
+  ASSERT_TRUE(resp.has_status_hybrid_time());
+  ASSERT_EQ(0, resp.batch_status().size());
+}
+
 // Writing multiple keys concurrently, each key is increasing by 1 at each step.
 // At the same time concurrently execute several transactions that read all those keys.
 // Suppose two transactions have read values t1_i and t2_i respectively.
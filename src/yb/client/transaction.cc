@@ -42,6 +42,9 @@ using namespace std::placeholders;
 
 DEFINE_uint64(transaction_heartbeat_usec, 500000, "Interval of transaction heartbeat in usec.");
 DEFINE_bool(transaction_disable_heartbeat_in_tests, false, "Disable heartbeat during test.");
+DEFINE_bool(enable_single_shard_transaction_fast_path, true,
+            "Write final batch of a transaction directly to the regular DB, when it is the only "
+            "batch of this transaction and consists of a single write operation.");
 DEFINE_bool(transaction_disable_proactive_cleanup_in_tests, false,
             "Disable cleanup of intents in abort path.");
 DECLARE_uint64(max_clock_skew_usec);
@@ -181,6 +184,15 @@ class YBTransaction::Impl final {
     bool has_tablets_without_metadata = false;
     {
       std::unique_lock<std::mutex> lock(mutex_);
+      if (TrySingleShardWrite(ops)) {
+        // Metadata is left empty, so operations are sent as non transactional ones. Tablet
+        // resolves their conflicts with running transactions and writes them to the regular DB.
+        VLOG_WITH_PREFIX(2) << "Prepare, single shard write of " << ops.size() << " ops";
+        return true;
+      }
+      LOG_IF_WITH_PREFIX(DFATAL, single_shard_write_)
+          << "Operations after the final batch of single shard transaction";
+
       if (!ready_) {
         if (waiter) {
           waiters_.push_back(std::move(waiter));
@@ -260,6 +272,16 @@ class YBTransaction::Impl final {
         << "Flushed: " << yb::ToString(ops) << ", used_read_time: " << used_read_time
         << ", status: " << status;
 
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (single_shard_write_) {
+        if (!status.ok()) {
+          single_shard_status_ = status;
+        }
+        return;
+      }
+    }
+
     if (status.ok()) {
       std::lock_guard<std::mutex> lock(mutex_);
       if (used_read_time && metadata_.isolation == IsolationLevel::SNAPSHOT_ISOLATION) {
@@ -306,6 +328,14 @@ class YBTransaction::Impl final {
         return;
       }
       state_.store(TransactionState::kCommitted, std::memory_order_release);
+      if (single_shard_write_) {
+        // All writes were already applied by the only tablet, so there is nothing to commit.
+        auto status = single_shard_status_;
+        lock.unlock();
+        VLOG_WITH_PREFIX(1) << "Commit of single shard write: " << status;
+        callback(status);
+        return;
+      }
       commit_callback_ = std::move(callback);
       if (!ready_) {
         waiters_.emplace_back(std::bind(&Impl::DoCommit, this, _1, transaction));
@@ -331,6 +361,12 @@ class YBTransaction::Impl final {
         return;
       }
       state_.store(TransactionState::kAborted, std::memory_order_release);
+      if (single_shard_write_) {
+        // Status tablet never knew about this transaction. Abort is expected only when the
+        // single shard write failed, either the flush or the operation itself, in which case
+        // nothing was written.
+        return;
+      }
       if (!ready_) {
         waiters_.emplace_back(std::bind(&Impl::DoAbort, this, _1, transaction));
         lock.unlock();
@@ -347,7 +383,12 @@ class YBTransaction::Impl final {
 
   bool HasOperations() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return !tablets_.empty();
+    return !tablets_.empty() || single_shard_write_;
+  }
+
+  void SetNextFlushFinal() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    next_flush_final_ = true;
   }
 
   std::shared_future<TransactionMetadata> TEST_GetMetadata() {
@@ -475,6 +516,29 @@ class YBTransaction::Impl final {
     return Status::OK();
   }
 
+  // Returns true if ops are the whole transaction and consist of a single write, so it could be
+  // done without intents, as a non transactional write. A batch of several operations is not
+  // handled this way even if they belong to the same tablet, because the tablet would still write
+  // the others when one of them fails.
+  bool TrySingleShardWrite(const std::unordered_set<internal::InFlightOpPtr>& ops) {
+    if (!next_flush_final_ || child_ || !tablets_.empty() || single_shard_write_ ||
+        !FLAGS_enable_single_shard_transaction_fast_path) {
+      return false;
+    }
+    // Writes could depend on values read at the already picked read time, while single shard
+    // write resolves conflicts at the current time.
+    if (read_point_.GetReadTime()) {
+      next_flush_final_ = false;
+      return false;
+    }
+    next_flush_final_ = false;
+    if (ops.size() != 1 || (**ops.begin()).yb_op->read_only()) {
+      return false;
+    }
+    single_shard_write_ = true;
+    return true;
+  }
+
   void DoCommit(const Status& status, const YBTransactionPtr& transaction) {
     VLOG_WITH_PREFIX(1) << Format("Commit, tablets: $0, status: $1", tablets_, status);
 
@@ -809,6 +873,11 @@ class YBTransaction::Impl final {
   const bool child_;
   bool child_had_read_time_ = false;
   bool ready_ = false;
+  // Set by SetNextFlushFinal, until the next flush is prepared.
+  bool next_flush_final_ = false;
+  // The only batch of this transaction was sent as a single shard write, see TrySingleShardWrite.
+  bool single_shard_write_ = false;
+  Status single_shard_status_;
   CommitCallback commit_callback_;
   Status error_;
   rpc::Rpcs::Handle heartbeat_handle_;
@@ -881,6 +950,10 @@ void YBTransaction::InitWithReadPoint(
   return impl_->InitWithReadPoint(isolation, std::move(read_point));
 }
 
+void YBTransaction::SetNextFlushFinal() {
+  impl_->SetNextFlushFinal();
+}
+
 bool YBTransaction::Prepare(const std::unordered_set<internal::InFlightOpPtr>& ops,
                             ForceConsistentRead force_consistent_read,
                             Waiter waiter,
@@ -84,6 +84,13 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
                TransactionMetadata* metadata,
                bool* may_have_metadata);
 
+  // Notifies transaction that the next flush contains all its remaining operations, and it will be
+  // committed right after this flush. If this flush is also the first one, and it consists of a
+  // single write operation, it is applied directly to the regular DB of its tablet, without
+  // writing intents and contacting the status tablet. Transaction should not be used for
+  // anything except Commit or Abort (if flush failed) after such flush.
+  void SetNextFlushFinal();
+
   // Notifies transaction that specified ops were flushed with some status.
   void Flushed(
       const internal::InFlightOps& ops, const ReadHybridTime& used_read_time, const Status& status);
@@ -550,6 +550,14 @@ YBPgsqlReadOp *YBPgsqlReadOp::NewSelect(const shared_ptr<YBTable>& table) {
   return op;
 }
 
+std::unique_ptr<YBPgsqlReadOp> YBPgsqlReadOp::DeepCopy() const {
+  std::unique_ptr<YBPgsqlReadOp> op(new YBPgsqlReadOp(table_));
+  *op->read_request_ = *read_request_;
+  op->yb_consistency_level_ = yb_consistency_level_;
+  op->read_time_ = read_time_;
+  return op;
+}
+
 std::string YBPgsqlReadOp::ToString() const {
   return "PGSQL_READ " + read_request_->DebugString();
 }
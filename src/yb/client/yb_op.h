@@ -453,6 +453,9 @@ class YBPgsqlReadOp : public YBPgsqlOp {
 
   static YBPgsqlReadOp *NewSelect(const std::shared_ptr<YBTable>& table);
 
+  // Creates a new read op for the same table with a copy of this op's request.
+  std::unique_ptr<YBPgsqlReadOp> DeepCopy() const;
+
   // Note: to avoid memory copy, this PgsqlReadRequestPB is moved into tserver ReadRequestPB
   // when the request is sent to tserver. It is restored after response is received from tserver
   // (see ReadRpc's constructor).
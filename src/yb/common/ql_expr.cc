@@ -707,6 +707,16 @@ boost::optional<const QLValuePB&> QLTableRow::GetValue(ColumnIdRep col_id) const
   return col_iter->second.value;
 }
 
+void QLTableRow::ClearExcept(ColumnIdRep col_id) {
+  for (auto it = col_map_.begin(); it != col_map_.end();) {
+    if (it->first == col_id) {
+      ++it;
+    } else {
+      it = col_map_.erase(it);
+    }
+  }
+}
+
 void QLTableRow::ClearValue(ColumnIdRep col_id) {
   col_map_[col_id].value.Clear();
 }
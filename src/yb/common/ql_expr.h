@@ -86,6 +86,9 @@ class QLTableRow {
   // Clear the row.
   void Clear() { col_map_.clear(); }
 
+  // Clear all columns except col_id, whose value is kept so that its buffer could be reused.
+  void ClearExcept(ColumnIdRep col_id);
+
   // Compare column value between two rows.
   bool MatchColumn(ColumnIdRep col_id, const QLTableRow& source) const;
   bool MatchColumn(const ColumnId& col, const QLTableRow& source) const {
@@ -0,0 +1,56 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/common/ql_rowwise_iterator_interface.h"
+
+#include "yb/common/ql_expr.h"
+
+namespace yb {
+namespace common {
+
+Result<size_t> YQLRowwiseIteratorIf::NextRowBatch(
+    const Schema& projection, size_t max_rows, std::vector<QLTableRow::SharedPtr>* table_rows) {
+  const auto tuple_id_column = static_cast<ColumnIdRep>(PgSystemAttrNum::kYBTupleId);
+  // Cleared once the iterator reports that it does not provide tuple ids, so the error status is
+  // not built for every row.
+  bool has_tuple_id = true;
+  size_t num_rows = 0;
+  while (num_rows < max_rows && VERIFY_RESULT(HasNext())) {
+    if (table_rows->size() == num_rows) {
+      table_rows->push_back(std::make_shared<QLTableRow>());
+    } else if (has_tuple_id) {
+      (*table_rows)[num_rows]->ClearExcept(tuple_id_column);
+    } else {
+      (*table_rows)[num_rows]->Clear();
+    }
+    QLTableRow* table_row = (*table_rows)[num_rows].get();
+    if (has_tuple_id) {
+      auto tuple_id = GetTupleId();
+      if (tuple_id.ok()) {
+        table_row->AllocColumn(tuple_id_column).value.mutable_binary_value()->assign(
+            tuple_id->cdata(), tuple_id->size());
+      } else if (tuple_id.status().IsNotSupported()) {
+        has_tuple_id = false;
+        table_row->Clear();
+      } else {
+        return tuple_id.status();
+      }
+    }
+    RETURN_NOT_OK(DoNextRow(projection, table_row));
+    num_rows++;
+  }
+  return num_rows;
+}
+
+}  // namespace common
+}  // namespace yb
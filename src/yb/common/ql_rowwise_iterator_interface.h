@@ -15,6 +15,7 @@
 #define YB_COMMON_QL_ROWWISE_ITERATOR_INTERFACE_H
 
 #include <memory>
+#include <vector>
 
 #include "yb/util/result.h"
 #include "yb/util/status.h"
@@ -26,8 +27,8 @@ class HybridTime;
 class PgsqlReadRequestPB;
 class PgsqlResponsePB;
 class QLReadRequestPB;
-class QLResponsePB;
 class QLTableRow;
+class QLResponsePB;
 class Schema;
 
 namespace common {
@@ -92,6 +93,15 @@ class YQLRowwiseIteratorIf {
     return DoNextRow(schema(), table_row);
   }
 
+  // Read up to max_rows next rows using the specified projection. Rows already allocated in the
+  // vector are cleared and reused, so callers scanning many pages should keep the same vector.
+  // Since the iterator is no longer positioned at a row once the batch is returned, iterators that
+  // provide tuple ids save the tuple id of each row under PgSystemAttrNum::kYBTupleId.
+  // Returns the number of rows read, which is less than max_rows only when there are no more rows.
+  virtual Result<size_t> NextRowBatch(const Schema& projection,
+                                      size_t max_rows,
+                                      std::vector<std::shared_ptr<QLTableRow>>* table_rows);
+
  private:
   virtual CHECKED_STATUS DoNextRow(const Schema& projection, QLTableRow* table_row) = 0;
 };
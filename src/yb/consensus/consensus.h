@@ -32,6 +32,7 @@
 #ifndef YB_CONSENSUS_CONSENSUS_H_
 #define YB_CONSENSUS_CONSENSUS_H_
 
+#include <functional>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -261,6 +262,16 @@ class Consensus {
       ConsensusResponsePB* response,
       CoarseTimePoint deadline) = 0;
 
+  // Requests pipelined by the leader could be received before the ones preceding them. Returns
+  // true if handling of such a request was postponed, in which case 'resume' is invoked, possibly
+  // on another thread, when its preceding ops are received or after it waited for too long.
+  // Otherwise the request should be handled right away.
+  virtual bool ParkUpdate(const ConsensusRequestPB& request,
+                          CoarseTimePoint deadline,
+                          std::function<void()> resume) {
+    return false;
+  }
+
   // Messages sent from CANDIDATEs to voting peers to request their vote
   // in leader election.
   virtual CHECKED_STATUS RequestVote(const VoteRequestPB* request,
@@ -342,7 +353,10 @@ class Consensus {
   // This includes heartbeats too.
   virtual MonoTime TimeSinceLastMessageFromLeader() = 0;
 
-  virtual CHECKED_STATUS ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs) = 0;
+  // Reads replicated messages following 'from'. If 'reader_id' is not empty, messages that are not
+  // in the log cache are read ahead for this reader, and 'msgs' could be empty while they are read.
+  virtual CHECKED_STATUS ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs,
+                                                const std::string& reader_id = std::string()) = 0;
 
  protected:
   friend class RefCountedThreadSafe<Consensus>;
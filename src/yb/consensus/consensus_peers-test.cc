@@ -55,6 +55,10 @@
 
 using namespace std::chrono_literals;
 
+DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_int32(consensus_max_inflight_update_requests);
+DECLARE_int32(raft_heartbeat_interval_ms);
+
 METRIC_DECLARE_entity(tablet);
 
 namespace yb {
@@ -73,6 +77,135 @@ const char* kTabletId = "test-peers-tablet";
 const char* kLeaderUuid = "peer-0";
 const char* kFollowerUuid = "peer-1";
 
+// Proxy that accepts heartbeats for batching, and answers them as a regular UpdateAsync.
+class HeartbeatBatchingPeerProxy : public NoOpTestPeerProxy {
+ public:
+  using NoOpTestPeerProxy::NoOpTestPeerProxy;
+
+  bool BatchHeartbeatAsync(const ConsensusRequestPB* request,
+                           ConsensusResponsePB* response,
+                           const std::function<void(const Status&)>& callback) override {
+    EXPECT_EQ(0, request->ops_size());
+    ++num_batched_heartbeats_;
+    UpdateAsync(request, RequestTriggerMode::kAlwaysSend, response, &controller_,
+                [callback] { callback(Status::OK()); });
+    return true;
+  }
+
+  int num_batched_heartbeats() const {
+    return num_batched_heartbeats_.load();
+  }
+
+ private:
+  rpc::RpcController controller_;
+  std::atomic<int> num_batched_heartbeats_{0};
+};
+
+// Proxy that answers update requests like NoOpTestPeerProxy, but holds responses until
+// RespondAll() is called, so several requests could be in flight. It could also accept only part
+// of the next request with ops, or fail the first held response, as if it was lost.
+class HoldingPeerProxy : public PeerProxy {
+ public:
+  HoldingPeerProxy(ThreadPool* pool, const RaftPeerPB& peer_pb)
+      : pool_(pool), peer_pb_(peer_pb) {}
+
+  void UpdateAsync(const ConsensusRequestPB* request,
+                   RequestTriggerMode trigger_mode,
+                   ConsensusResponsePB* response,
+                   rpc::RpcController* controller,
+                   const rpc::ResponseCallback& callback) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    response->Clear();
+    if (request->pipelined()) {
+      ++num_pipelined_requests_;
+    }
+    if (last_received_.index < request->preceding_id().index()) {
+      ++num_mismatched_requests_;
+      ConsensusErrorPB* error = response->mutable_status()->mutable_error();
+      error->set_code(ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH);
+      StatusToPB(STATUS(IllegalState, ""), error->mutable_status());
+    } else if (request->ops_size() > 0) {
+      auto num_accepted_ops = accept_first_op_only_ ? 1 : request->ops_size();
+      accept_first_op_only_ = false;
+      last_received_ = yb::OpId::FromPB(request->ops(num_accepted_ops - 1).id());
+    }
+    response->set_responder_uuid(peer_pb_.permanent_uuid());
+    response->set_responder_term(request->caller_term());
+    last_received_.ToPB(response->mutable_status()->mutable_last_received());
+    last_received_.ToPB(response->mutable_status()->mutable_last_received_current_leader());
+    response->mutable_status()->set_last_committed_idx(last_received_.index);
+
+    held_responses_.push_back({response, callback});
+    max_in_flight_ = std::max(max_in_flight_, held_responses_.size());
+  }
+
+  void RequestConsensusVoteAsync(const VoteRequestPB* request,
+                                 VoteResponsePB* response,
+                                 rpc::RpcController* controller,
+                                 const rpc::ResponseCallback& callback) override {
+    LOG(FATAL) << "Not implemented";
+  }
+
+  void RespondAll(bool fail_first = false) {
+    std::vector<HeldResponse> held_responses;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      held_responses.swap(held_responses_);
+    }
+    if (fail_first && !held_responses.empty()) {
+      auto* response = held_responses.front().response;
+      response->Clear();
+      response->mutable_error()->set_code(tserver::TabletServerErrorPB::UNKNOWN_ERROR);
+      StatusToPB(STATUS(NetworkError, "Response lost"), response->mutable_error()->mutable_status());
+    }
+    for (const auto& held_response : held_responses) {
+      WARN_NOT_OK(pool_->SubmitFunc(held_response.callback), "Submit failed");
+    }
+  }
+
+  // The next request with ops is accepted up to its first op only.
+  void AcceptFirstOpOnly() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    accept_first_op_only_ = true;
+  }
+
+  size_t num_in_flight() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return held_responses_.size();
+  }
+
+  size_t num_pipelined_requests() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_pipelined_requests_;
+  }
+
+  size_t max_in_flight() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_in_flight_;
+  }
+
+  size_t num_mismatched_requests() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_mismatched_requests_;
+  }
+
+ private:
+  struct HeldResponse {
+    ConsensusResponsePB* response;
+    rpc::ResponseCallback callback;
+  };
+
+  ThreadPool* const pool_;
+  const RaftPeerPB peer_pb_;
+  std::mutex mutex_;
+  yb::OpId last_received_ = yb::OpId(0, 0);
+  std::vector<HeldResponse> held_responses_;
+  bool accept_first_op_only_ = false;
+  size_t max_in_flight_ = 0;
+  size_t num_mismatched_requests_ = 0;
+  size_t num_pipelined_requests_ = 0;
+};
+
 class ConsensusPeersTest : public YBTest {
  public:
   ConsensusPeersTest()
@@ -140,6 +273,39 @@ class ConsensusPeersTest : public YBTest {
     return proxy_ptr;
   }
 
+  static constexpr int kNumPipelinedOps = 20;
+  static constexpr size_t kMaxInFlight = 3;
+
+  HoldingPeerProxy* NewPipeliningPeer(std::shared_ptr<Peer>* peer) {
+    auto proxy = new HoldingPeerProxy(raft_pool_.get(), FakeRaftPeerPB(kFollowerUuid));
+    *peer = CHECK_RESULT(Peer::NewRemotePeer(
+        FakeRaftPeerPB(kFollowerUuid), kTabletId, kLeaderUuid, message_queue_.get(),
+        raft_pool_token_.get(), PeerProxyPtr(proxy), nullptr /* consensus */, messenger_.get()));
+    return proxy;
+  }
+
+  // Negotiates with the peer and waits until it pipelines kMaxInFlight requests with ops.
+  void StartPipelining(Peer* peer, HoldingPeerProxy* proxy) {
+    AppendReplicateMessagesToQueue(
+        message_queue_.get(), clock_, 1, kNumPipelinedOps, 1000 /* payload */);
+
+    // The first request only finds out the state of the peer.
+    ASSERT_OK(peer->SignalRequest(RequestTriggerMode::kAlwaysSend));
+    ASSERT_OK(WaitFor([proxy] { return proxy->num_in_flight() == 1; }, 10s, "Negotiation sent"));
+    proxy->RespondAll();
+
+    // Batches with ops should be pipelined up to the limit, without waiting for responses.
+    ASSERT_OK(WaitFor([proxy] { return proxy->num_in_flight() == kMaxInFlight; },
+                      10s, "Requests pipelined"));
+  }
+
+  void WaitForPipelinedOpsReplicated(HoldingPeerProxy* proxy) {
+    ASSERT_OK(WaitFor([this, proxy] {
+      proxy->RespondAll();
+      return consensus_->IsMajorityReplicated(kNumPipelinedOps);
+    }, 30s, "All ops replicated"));
+  }
+
   void CheckLastLogEntry(int term, int index) {
     ASSERT_EQ(log_->GetLatestEntryOpId(), yb::OpId(term, index));
   }
@@ -411,5 +577,94 @@ TEST_F(ConsensusPeersTest, TestDontSendOneRpcPerWriteWhenPeerIsDown) {
   ASSERT_LT(mock_proxy->update_count() - initial_update_count, 5);
 }
 
+// Tests that heartbeats go through the batching path of the proxy, while requests with ops are
+// still sent directly.
+TEST_F(ConsensusPeersTest, BatchHeartbeats) {
+  auto proxy = new HeartbeatBatchingPeerProxy(raft_pool_.get(), FakeRaftPeerPB(kFollowerUuid));
+  auto peer = ASSERT_RESULT(Peer::NewRemotePeer(
+      FakeRaftPeerPB(kFollowerUuid), kTabletId, kLeaderUuid, message_queue_.get(),
+      raft_pool_token_.get(), PeerProxyPtr(proxy), nullptr /* consensus */, messenger_.get()));
+
+  BOOST_SCOPE_EXIT(&peer) {
+    // This guarantees that the Peer object doesn't get destroyed if there is a pending request.
+    peer->Close();
+  } BOOST_SCOPE_EXIT_END
+
+  ASSERT_OK(peer->SignalRequest(RequestTriggerMode::kAlwaysSend));
+  ASSERT_OK(WaitFor([proxy] { return proxy->num_batched_heartbeats() > 0; },
+                    10s, "Heartbeat batched"));
+
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_, 1, 20);
+  peer->SetTermForTest(2);
+  ASSERT_OK(peer->SignalRequest(RequestTriggerMode::kNonEmptyOnly));
+  WaitForMajorityReplicatedIndex(20);
+  ASSERT_EQ(yb::OpId::FromPB(proxy->last_received()), yb::OpId(2, 20));
+}
+
+TEST_F(ConsensusPeersTest, PipelinedRequests) {
+  FLAGS_consensus_max_inflight_update_requests = kMaxInFlight;
+  FLAGS_consensus_max_batch_size_bytes = 3000;
+
+  std::shared_ptr<Peer> peer;
+  auto proxy = NewPipeliningPeer(&peer);
+  BOOST_SCOPE_EXIT(&peer) {
+    // This guarantees that the Peer object doesn't get destroyed if there is a pending request.
+    peer->Close();
+  } BOOST_SCOPE_EXIT_END
+
+  ASSERT_NO_FATALS(StartPipelining(peer.get(), proxy));
+  ASSERT_NO_FATALS(WaitForPipelinedOpsReplicated(proxy));
+
+  ASSERT_EQ(kMaxInFlight, proxy->max_in_flight());
+  ASSERT_EQ(0U, proxy->num_mismatched_requests());
+  ASSERT_GT(proxy->num_pipelined_requests(), 0U);
+  ASSERT_TRUE(message_queue_->PeerAcceptedOurLease(kFollowerUuid));
+}
+
+// The leader lease is only sent in the first request, so when its response is lost, responses to
+// the requests pipelined after it should not acknowledge the lease, nor their ops.
+TEST_F(ConsensusPeersTest, PipelinedRequestsAfterFailedRequest) {
+  FLAGS_consensus_max_inflight_update_requests = kMaxInFlight;
+  FLAGS_consensus_max_batch_size_bytes = 3000;
+
+  std::shared_ptr<Peer> peer;
+  auto proxy = NewPipeliningPeer(&peer);
+  BOOST_SCOPE_EXIT(&peer) {
+    peer->Close();
+  } BOOST_SCOPE_EXIT_END
+
+  ASSERT_NO_FATALS(StartPipelining(peer.get(), proxy));
+  proxy->RespondAll(true /* fail_first */);
+
+  // Requests are sent again, starting from the first op, only after all the responses are
+  // processed.
+  ASSERT_OK(WaitFor([proxy] { return proxy->num_in_flight() > 0; }, 10s, "Request resent"));
+  ASSERT_FALSE(consensus_->IsMajorityReplicated(1));
+  ASSERT_FALSE(message_queue_->PeerAcceptedOurLease(kFollowerUuid));
+
+  ASSERT_NO_FATALS(WaitForPipelinedOpsReplicated(proxy));
+  ASSERT_TRUE(message_queue_->PeerAcceptedOurLease(kFollowerUuid));
+}
+
+// When the first request is accepted partially, the peer mismatches the requests pipelined after
+// it, and ops are sent again right after their responses, without waiting for a heartbeat.
+TEST_F(ConsensusPeersTest, PipelinedRequestsAfterPartiallyAcceptedRequest) {
+  FLAGS_consensus_max_inflight_update_requests = kMaxInFlight;
+  FLAGS_consensus_max_batch_size_bytes = 3000;
+  FLAGS_raft_heartbeat_interval_ms = 60000;
+
+  std::shared_ptr<Peer> peer;
+  auto proxy = NewPipeliningPeer(&peer);
+  BOOST_SCOPE_EXIT(&peer) {
+    peer->Close();
+  } BOOST_SCOPE_EXIT_END
+
+  proxy->AcceptFirstOpOnly();
+  ASSERT_NO_FATALS(StartPipelining(peer.get(), proxy));
+  ASSERT_EQ(kMaxInFlight - 1, proxy->num_mismatched_requests());
+  ASSERT_NO_FATALS(WaitForPipelinedOpsReplicated(proxy));
+  ASSERT_EQ(kMaxInFlight - 1, proxy->num_mismatched_requests());
+}
+
 }  // namespace consensus
 }  // namespace yb
@@ -48,6 +48,8 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/consensus_queue.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/multi_raft_batcher.h"
+#include "yb/consensus/replicate_compression.h"
 #include "yb/consensus/replicate_msgs_holder.h"
 
 #include "yb/gutil/map-util.h"
@@ -79,6 +81,20 @@ DEFINE_int32(max_wait_for_processresponse_before_closing_ms, 5000,
              "finish before returning proceding to close the Peer and return");
 TAG_FLAG(max_wait_for_processresponse_before_closing_ms, advanced);
 
+DEFINE_int32(consensus_max_inflight_update_requests, 1,
+             "Maximum number of UpdateConsensus requests with ops that a leader keeps in flight to "
+             "a single follower. Values above 1 pipeline replication, so the next batch is sent "
+             "without waiting for the follower to respond to the previous one.");
+TAG_FLAG(consensus_max_inflight_update_requests, advanced);
+TAG_FLAG(consensus_max_inflight_update_requests, runtime);
+
+DEFINE_bool(consensus_send_serialized_ops, false,
+            "Send ops to followers serialized once by the log cache, instead of serializing them "
+            "for each follower. The serialized copy of each cached op is charged to the log "
+            "cache memory limit, so fewer ops fit into the cache.");
+TAG_FLAG(consensus_send_serialized_ops, advanced);
+TAG_FLAG(consensus_send_serialized_ops, runtime);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
@@ -133,8 +149,30 @@ Peer::Peer(
       consensus_(consensus),
       messenger_(messenger) {}
 
+// An update request sent to the peer, together with its response.
+struct Peer::UpdateCall {
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  rpc::RpcController controller;
+
+  // Index of the last op in the request, or kInvalidOpIdIndex if it does not have ops.
+  int64_t last_op_index = kInvalidOpIdIndex;
+
+  // The following fields are protected by in_flight_lock_.
+  bool done = false;
+  Status status;
+
+  ~UpdateCall() {
+    // Ops are owned by the log cache, so they should not be deleted with the request.
+    request.mutable_ops()->ExtractSubrange(0, request.ops().size(), nullptr /* elements */);
+  }
+};
+
 void Peer::SetTermForTest(int term) {
-  response_.set_responder_term(term);
+  std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+  for (const auto& call : in_flight_calls_) {
+    call->response.set_responder_term(term);
+  }
 }
 
 Status Peer::Init() {
@@ -161,7 +199,27 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
   // If there are new requests in the queue we'll get them on ProcessResponse().
   auto performing_lock = LockPerforming(std::try_to_lock);
   if (!performing_lock.owns_lock()) {
-    return Status::OK();
+    // New ops could still be pipelined after the requests in flight.
+    if (trigger_mode != RequestTriggerMode::kNonEmptyOnly) {
+      return Status::OK();
+    }
+    {
+      std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+      if (!performing_parked_ || !can_pipeline_ || in_flight_calls_.size() >=
+              static_cast<size_t>(FLAGS_consensus_max_inflight_update_requests)) {
+        return Status::OK();
+      }
+      performing_parked_ = false;
+    }
+    using_thread_pool_.fetch_add(1, std::memory_order_acq_rel);
+    auto status = raft_pool_token_->SubmitFunc(
+        std::bind(&Peer::SendNextRequest, shared_from_this(), trigger_mode));
+    using_thread_pool_.fetch_sub(1, std::memory_order_acq_rel);
+    if (!status.ok()) {
+      // Park performing_mutex_ back, or process responses received meanwhile.
+      ProcessResponses();
+    }
+    return status;
   }
 
   {
@@ -203,30 +261,50 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
 
 void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   auto retain_self = shared_from_this();
+  if (SendRequests(trigger_mode)) {
+    ProcessResponses();
+  }
+}
+
+bool Peer::SendRequests(RequestTriggerMode trigger_mode) {
   DCHECK(performing_mutex_.is_locked()) << "Cannot send request";
 
   auto performing_lock = LockPerforming(std::adopt_lock);
   auto processing_lock = StartProcessingUnlocked();
   if (!processing_lock.owns_lock()) {
-    return;
+    return false;
+  }
+
+  bool has_in_flight_calls;
+  {
+    std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+    has_in_flight_calls = !in_flight_calls_.empty();
+  }
+  if (has_in_flight_calls) {
+    processing_lock.unlock();
+    SendPipelinedRequests();
+    performing_lock.release();
+    return true;
   }
 
   // The peer has no pending request nor is sending: send the request.
   bool needs_remote_bootstrap = false;
   bool last_exchange_successful = false;
   RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
+  int64_t commit_index_before = last_request_committed_index_;
+  auto call = std::make_shared<UpdateCall>();
+  auto& request = call->request;
   ReplicateMsgsHolder msgs_holder;
   Status s = queue_->RequestForPeer(
-      peer_pb_.permanent_uuid(), &request_, &msgs_holder, &needs_remote_bootstrap,
+      peer_pb_.permanent_uuid(), &request, &msgs_holder, &needs_remote_bootstrap,
       &member_type, &last_exchange_successful);
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index().index() : kMinimumOpIdIndex;
+  int64_t commit_index_after = request.has_committed_index() ?
+      request.committed_index().index() : kMinimumOpIdIndex;
+  last_request_committed_index_ = commit_index_after;
 
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX(INFO) << "Could not obtain request from queue for peer: " << s;
-    return;
+    return false;
   }
 
   if (PREDICT_FALSE(needs_remote_bootstrap)) {
@@ -240,7 +318,7 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     if (!status.ok()) {
       LOG_WITH_PREFIX(WARNING) << "Unable to generate remote bootstrap request for peer: "
                                << status;
-      return;
+      return false;
     }
 
     using_thread_pool_.fetch_add(1, std::memory_order_acq_rel);
@@ -249,13 +327,14 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     if (s.ok()) {
       performing_lock.release();
     }
-    return;
+    return false;
   }
 
-  // If the peer doesn't need remote bootstrap, but it is a PRE_VOTER or PRE_OBSERVER in the config,
-  // we need to promote it.
+  // If the peer doesn't need remote bootstrap, but it is a PRE_VOTER, PRE_OBSERVER or PRE_WITNESS
+  // in the config, we need to promote it.
   if (last_exchange_successful &&
-      (member_type == RaftPeerPB::PRE_VOTER || member_type == RaftPeerPB::PRE_OBSERVER)) {
+      (member_type == RaftPeerPB::PRE_VOTER || member_type == RaftPeerPB::PRE_OBSERVER ||
+       member_type == RaftPeerPB::PRE_WITNESS)) {
     if (PREDICT_TRUE(consensus_)) {
       auto uuid = peer_pb_.permanent_uuid();
       processing_lock.unlock();
@@ -284,20 +363,16 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
                        << status;
         }
       }
-      return;
+      return false;
     }
   }
 
-  request_.set_tablet_id(tablet_id_);
-  request_.set_caller_uuid(leader_uuid_);
-  request_.set_dest_uuid(peer_pb_.permanent_uuid());
-
-  const bool req_has_ops = (request_.ops_size() > 0) || (commit_index_after > commit_index_before);
+  const bool req_has_ops = (request.ops_size() > 0) || (commit_index_after > commit_index_before);
 
   // If the queue is empty, check if we were told to send a status-only message (which is what
   // happens during heartbeats). If not, just return.
   if (PREDICT_FALSE(!req_has_ops && trigger_mode == RequestTriggerMode::kNonEmptyOnly)) {
-    return;
+    return false;
   }
 
   // If we're actually sending ops there's no need to heartbeat for a while, reset the heartbeater.
@@ -310,37 +385,199 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   processing_lock.unlock();
   performing_lock.release();
 
-  // We will cleanup ops from request in ProcessResponse, because otherwise there could be race
-  // condition. When rest of this function is running in parallel to ProcessResponse.
+  // Ops are removed from the request when the call is destroyed, because otherwise there could be
+  // race condition. When rest of this function is running in parallel to ProcessResponse.
   msgs_holder.ReleaseOps();
 
-  proxy_->UpdateAsync(&request_, trigger_mode, &response_, &controller_,
-                      std::bind(&Peer::ProcessResponse, retain_self));
+  can_pipeline_ = request.ops_size() > 0 && FLAGS_consensus_max_inflight_update_requests > 1;
+  if (request.ops_size() > 0) {
+    last_in_flight_op_index_ = request.ops(request.ops_size() - 1).id().index();
+  }
+
+  // Heartbeats without ops could be combined with heartbeats of other tablets to the same server.
+  SendUpdateCall(call, trigger_mode, !req_has_ops /* batch_heartbeat */);
+  SendPipelinedRequests();
+  return true;
+}
+
+void Peer::SendPipelinedRequests() {
+  DCHECK(performing_mutex_.is_locked());
+
+  const size_t max_in_flight = std::max(FLAGS_consensus_max_inflight_update_requests, 1);
+  while (can_pipeline_) {
+    {
+      std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+      if (in_flight_calls_.size() >= max_in_flight) {
+        return;
+      }
+    }
+
+    auto call = std::make_shared<UpdateCall>();
+    ReplicateMsgsHolder msgs_holder;
+    {
+      auto processing_lock = StartProcessingUnlocked();
+      if (!processing_lock.owns_lock()) {
+        return;
+      }
+      auto status = queue_->PipelinedRequestForPeer(
+          peer_pb_.permanent_uuid(), last_in_flight_op_index_, &call->request, &msgs_holder);
+      if (!status.ok()) {
+        LOG_WITH_PREFIX(INFO) << "Could not obtain pipelined request from queue for peer: "
+                              << status;
+        can_pipeline_ = false;
+        return;
+      }
+    }
+    auto& request = call->request;
+    if (request.ops().empty()) {
+      return;
+    }
+
+    heartbeater_->Snooze();
+    msgs_holder.ReleaseOps();
+    request.set_pipelined(true);
+    last_in_flight_op_index_ = request.ops(request.ops_size() - 1).id().index();
+    last_request_committed_index_ = request.committed_index().index();
+    SendUpdateCall(call, RequestTriggerMode::kNonEmptyOnly, false /* batch_heartbeat */);
+  }
 }
 
-std::unique_lock<simple_spinlock> Peer::StartProcessingUnlocked() {
-  std::unique_lock<simple_spinlock> lock(peer_lock_);
+void Peer::SendUpdateCall(const UpdateCallPtr& call, RequestTriggerMode trigger_mode,
+                          bool batch_heartbeat) {
+  auto& request = call->request;
+  request.set_tablet_id(tablet_id_);
+  request.set_caller_uuid(leader_uuid_);
+  request.set_dest_uuid(peer_pb_.permanent_uuid());
+
+  if (request.ops_size() > 0) {
+    call->last_op_index = request.ops(request.ops_size() - 1).id().index();
+    MaybeCompressOps(&request);
+    MaybeSerializeOps(call.get());
+  }
+
+  {
+    std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+    in_flight_calls_.push_back(call);
+  }
 
-  if (state_ == kPeerClosed) {
-    lock.unlock();
+  // The call is kept alive by in_flight_calls_ until its response is processed.
+  auto retain_self = shared_from_this();
+  auto* call_ptr = call.get();
+  if (batch_heartbeat &&
+      proxy_->BatchHeartbeatAsync(
+          &request, &call->response, [retain_self, call_ptr](const Status& status) {
+        retain_self->UpdateCallDone(call_ptr, status);
+      })) {
+    return;
   }
 
-  return lock;
+  proxy_->UpdateAsync(&request, trigger_mode, &call->response, &call->controller,
+                      [retain_self, call_ptr] {
+    retain_self->UpdateCallDone(call_ptr, call_ptr->controller.status());
+  });
 }
 
-void Peer::ProcessResponse() {
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops().size(), nullptr /* elements */);
+void Peer::UpdateCallDone(UpdateCall* call, const Status& status) {
+  {
+    std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+    call->status = status;
+    call->done = true;
+    // Otherwise the response will be processed by the holder of performing_mutex_, or after the
+    // responses to requests sent earlier.
+    if (!performing_parked_ || in_flight_calls_.empty() ||
+        in_flight_calls_.front().get() != call) {
+      return;
+    }
+    performing_parked_ = false;
+  }
+  ProcessResponses();
+}
 
+void Peer::ProcessResponses() {
   DCHECK(performing_mutex_.is_locked()) << "Got a response when nothing was pending";
-  Status status = controller_.status();
-  controller_.Reset();
 
   auto performing_lock = LockPerforming(std::adopt_lock);
+  for (;;) {
+    UpdateCallPtr call;
+    bool has_in_flight_calls;
+    {
+      std::lock_guard<simple_spinlock> lock(in_flight_lock_);
+      if (in_flight_calls_.empty()) {
+        return;
+      }
+      if (!in_flight_calls_.front()->done) {
+        performing_parked_ = true;
+        performing_lock.release();
+        return;
+      }
+      call = std::move(in_flight_calls_.front());
+      in_flight_calls_.pop_front();
+      has_in_flight_calls = !in_flight_calls_.empty();
+    }
 
-  auto processing_lock = StartProcessingUnlocked();
-  if (!processing_lock.owns_lock()) {
+    bool more_pending;
+    {
+      auto processing_lock = StartProcessingUnlocked();
+      if (!processing_lock.owns_lock()) {
+        return;
+      }
+      if (discard_responses_) {
+        // The peer could not accept ops of this call after a partially accepted one, and its
+        // response would acknowledge the leader lease sent in a failed one. Ops are sent again from
+        // the queue's next index after the responses to all calls in flight are received.
+        more_pending = failed_attempts_ == 0;
+      } else {
+        more_pending = ProcessResponse(call.get());
+      }
+      if (!has_in_flight_calls) {
+        discard_responses_ = false;
+      }
+    }
+
+    if (has_in_flight_calls) {
+      SendPipelinedRequests();
+    } else if (more_pending) {
+      performing_lock.release();
+      if (!SendRequests(RequestTriggerMode::kAlwaysSend)) {
+        return;
+      }
+      performing_lock = LockPerforming(std::adopt_lock);
+    }
+  }
+}
+
+void Peer::MaybeCompressOps(ConsensusRequestPB* request) {
+  auto compression = GetReplicateCompressionType();
+  if (compression == NO_REPLICATE_COMPRESSION) {
     return;
   }
+  auto status = queue_->CompressOps(compression, request);
+  if (!status.ok()) {
+    LOG_WITH_PREFIX(WARNING) << "Failed to compress ops, sending them uncompressed: " << status;
+    request->clear_compressed_ops();
+    request->clear_ops_compression();
+    return;
+  }
+  // Ops are owned by the log cache, so they are just removed from the request.
+  request->mutable_ops()->ExtractSubrange(0, request->ops().size(), nullptr /* elements */);
+}
+
+void Peer::MaybeSerializeOps(UpdateCall* call) {
+  auto& request = call->request;
+  if (!FLAGS_consensus_send_serialized_ops || request.ops().empty() ||
+      !proxy_->CanSendSerializedOps()) {
+    return;
+  }
+  std::vector<RefCntBuffer> fields;
+  queue_->SerializeOps(request.ops(), &fields);
+  // Ops are owned by the log cache, so they are just removed from the request.
+  request.mutable_ops()->ExtractSubrange(0, request.ops().size(), nullptr /* elements */);
+  call->controller.set_serialized_request_fields(std::move(fields));
+}
+
+bool Peer::ProcessResponse(UpdateCall* call) {
+  const auto& status = call->status;
+  const auto& response = call->response;
 
   if (!status.ok()) {
     if (status.IsRemoteError()) {
@@ -352,43 +589,46 @@ void Peer::ProcessResponse() {
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
     ProcessResponseError(status);
-    return;
+    return false;
   }
 
   // We should try to evict a follower which returns a WRONG UUID error.
-  if (response_.has_error() &&
-      response_.error().code() == tserver::TabletServerErrorPB::WRONG_SERVER_UUID) {
+  if (response.has_error() &&
+      response.error().code() == tserver::TabletServerErrorPB::WRONG_SERVER_UUID) {
     queue_->NotifyObserversOfFailedFollower(
         peer_pb_.permanent_uuid(),
         Substitute("Leader communication with peer $0 received error $1, will try to "
                    "evict peer", peer_pb_.permanent_uuid(),
-                   response_.error().ShortDebugString()));
-    ProcessResponseError(StatusFromPB(response_.error().status()));
-    return;
+                   response.error().ShortDebugString()));
+    ProcessResponseError(StatusFromPB(response.error().status()));
+    return false;
   }
 
   // Pass through errors we can respond to, like not found, since in that case
   // we will need to remotely bootstrap. TODO: Handle DELETED response once implemented.
-  if ((response_.has_error() &&
-      response_.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
-      (response_.status().has_error() &&
-          response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
+  if ((response.has_error() &&
+      response.error().code() != tserver::TabletServerErrorPB::TABLET_NOT_FOUND) ||
+      (response.status().has_error() &&
+          response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE)) {
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
-    ProcessResponseError(StatusFromPB(response_.error().status()));
-    return;
+    ProcessResponseError(StatusFromPB(response.error().status()));
+    return false;
+  }
+
+  // Requests pipelined after this one would not be accepted if the peer did not accept all of its
+  // ops, so stop pipelining and discard their responses.
+  if (response.has_error() || response.status().has_error() ||
+      response.status().last_received().index() < call->last_op_index) {
+    can_pipeline_ = false;
+    discard_responses_ = true;
   }
 
   failed_attempts_ = 0;
   bool more_pending = false;
-  queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_, &more_pending);
-
-  if (more_pending) {
-    processing_lock.unlock();
-    performing_lock.release();
-    SendNextRequest(RequestTriggerMode::kAlwaysSend);
-  }
+  queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response, &more_pending);
+  return more_pending;
 }
 
 Status Peer::SendRemoteBootstrapRequest() {
@@ -430,6 +670,8 @@ void Peer::ProcessRemoteBootstrapResponse() {
 void Peer::ProcessResponseError(const Status& status) {
   DCHECK(performing_mutex_.is_locked());
   failed_attempts_++;
+  can_pipeline_ = false;
+  discard_responses_ = true;
   YB_LOG_WITH_PREFIX_EVERY_N_SECS(WARNING, 5) << "Couldn't send request. "
       << " Status: " << status.ToString() << ". Retrying in the next heartbeat period."
       << " Already tried " << failed_attempts_ << " times. State: " << state_;
@@ -480,8 +722,10 @@ Peer::~Peer() {
   CHECK_EQ(state_, kPeerClosed) << "Peer cannot be implicitly closed";
 }
 
-RpcPeerProxy::RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy)
-    : hostport_(std::move(hostport)), consensus_proxy_(std::move(consensus_proxy)) {
+RpcPeerProxy::RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy,
+                           MultiRaftHeartbeatBatcherPtr heartbeat_batcher)
+    : hostport_(std::move(hostport)), consensus_proxy_(std::move(consensus_proxy)),
+      heartbeat_batcher_(std::move(heartbeat_batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
@@ -493,6 +737,21 @@ void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
 
+bool RpcPeerProxy::BatchHeartbeatAsync(const ConsensusRequestPB* request,
+                                       ConsensusResponsePB* response,
+                                       const std::function<void(const Status&)>& callback) {
+  if (!heartbeat_batcher_) {
+    return false;
+  }
+  heartbeat_batcher_->AddRequestToBatch(*request, response, callback);
+  return true;
+}
+
+bool RpcPeerProxy::CanSendSerializedOps() const {
+  // Local calls pass the request object to the service, without serialization.
+  return !consensus_proxy_->proxy().IsServiceLocal();
+}
+
 void RpcPeerProxy::RequestConsensusVoteAsync(const VoteRequestPB* request,
                                              VoteResponsePB* response,
                                              rpc::RpcController* controller,
@@ -525,13 +784,16 @@ void RpcPeerProxy::StartRemoteBootstrap(const StartRemoteBootstrapRequestPB* req
 RpcPeerProxy::~RpcPeerProxy() {}
 
 RpcPeerProxyFactory::RpcPeerProxyFactory(
-    Messenger* messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from)
-    : messenger_(messenger), proxy_cache_(proxy_cache), from_(std::move(from)) {}
+    Messenger* messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from,
+    MultiRaftManager* multi_raft_manager)
+    : messenger_(messenger), proxy_cache_(proxy_cache), from_(std::move(from)),
+      multi_raft_manager_(multi_raft_manager) {}
 
 PeerProxyPtr RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb) {
   auto hostport = HostPortFromPB(DesiredHostPort(peer_pb, from_));
   auto proxy = std::make_unique<ConsensusServiceProxy>(proxy_cache_, hostport);
-  return std::make_unique<RpcPeerProxy>(std::move(hostport), std::move(proxy));
+  auto batcher = multi_raft_manager_ ? multi_raft_manager_->AddOrGetBatcher(peer_pb) : nullptr;
+  return std::make_unique<RpcPeerProxy>(std::move(hostport), std::move(proxy), std::move(batcher));
 }
 
 RpcPeerProxyFactory::~RpcPeerProxyFactory() {}
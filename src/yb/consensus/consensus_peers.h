@@ -33,6 +33,8 @@
 #ifndef YB_CONSENSUS_CONSENSUS_PEERS_H_
 #define YB_CONSENSUS_CONSENSUS_PEERS_H_
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,6 +44,7 @@
 #include "yb/consensus/consensus.pb.h"
 #include "yb/consensus/metadata.pb.h"
 #include "yb/consensus/consensus_util.h"
+#include "yb/consensus/opid_util.h"
 
 #include "yb/rpc/response_callback.h"
 #include "yb/rpc/rpc_controller.h"
@@ -118,6 +121,14 @@ namespace consensus {
 //        v                               v
 //  SignalRequest()                    return
 //
+// With consensus_max_inflight_update_requests above 1, requests with ops are pipelined: while
+// requests are in flight, further ops are sent in new requests without waiting for responses, up
+// to the configured number of requests. Responses are processed in the order the requests were
+// sent. "processing" above then means that there are requests in flight. After any error or
+// partial acceptance pipelining stops, and responses to the requests sent after the failed one are
+// discarded, since the peer could not accept their ops or the leader lease they would acknowledge
+// was sent in the failed request.
+//
 class Peer;
 typedef std::shared_ptr<Peer> PeerPtr;
 
@@ -176,11 +187,42 @@ class Peer : public std::enable_shared_from_this<Peer> {
   }
 
  private:
+  struct UpdateCall;
+  typedef std::shared_ptr<UpdateCall> UpdateCallPtr;
+
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
-  // Signals that a response was received from the peer. This method does response handling that
-  // requires IO or may block.
-  void ProcessResponse();
+  // Sends the next request, or pipelined requests if there are requests in flight. Should be
+  // called with performing_mutex_ held. Returns true if performing_mutex_ is still held by the
+  // caller, which should then call ProcessResponses(), and false if it was already released.
+  bool SendRequests(RequestTriggerMode trigger_mode);
+
+  // Sends requests with ops following the ones in flight, while there are less than
+  // consensus_max_inflight_update_requests of them.
+  void SendPipelinedRequests();
+
+  // Adds the call to in_flight_calls_ and sends it to the peer.
+  void SendUpdateCall(const UpdateCallPtr& call, RequestTriggerMode trigger_mode,
+                      bool batch_heartbeat);
+
+  // Signals that a response to the call was received from the peer.
+  void UpdateCallDone(UpdateCall* call, const Status& status);
+
+  // Processes received responses in the order their requests were sent, sending further requests
+  // when there are more pending ops. Should be called with performing_mutex_ held. If responses to
+  // some requests are not received yet, leaves performing_mutex_ held on their behalf, so the
+  // response to the first of them continues processing.
+  void ProcessResponses();
+
+  // Processes the response to the call. Returns true if there are more pending ops for the peer.
+  bool ProcessResponse(UpdateCall* call);
+
+  // Moves ops of the request into compressed_ops, if replicate compression is enabled.
+  void MaybeCompressOps(ConsensusRequestPB* request);
+
+  // Replaces ops of the request with their serialized form shared with other peers, when the proxy
+  // supports it.
+  void MaybeSerializeOps(UpdateCall* call);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -217,20 +259,43 @@ class Peer : public std::enable_shared_from_this<Peer> {
   PeerMessageQueue* queue_;
   uint64_t failed_attempts_ = 0;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
-
   // The latest remote bootstrap request and response.
   StartRemoteBootstrapRequestPB rb_request_;
   StartRemoteBootstrapResponsePB rb_response_;
 
   rpc::RpcController controller_;
 
-  // Held if there is an outstanding request.  This is used in order to ensure that we only have a
-  // single request outstanding at a time, and to wait for the outstanding requests at Close().
+  // Held if there is an outstanding request.  This is used in order to ensure that only one thread
+  // sends requests or processes responses at a time, and to wait for the outstanding requests at
+  // Close().
   AtomicTryMutex performing_mutex_;
 
+  // Protects in_flight_calls_ and performing_parked_.
+  simple_spinlock in_flight_lock_;
+
+  // Update requests sent to the peer whose responses were not processed yet, in the order they
+  // were sent.
+  std::deque<UpdateCallPtr> in_flight_calls_;
+
+  // Whether performing_mutex_ is held on behalf of in_flight_calls_, i.e. no thread is sending
+  // requests or processing responses.
+  bool performing_parked_ = false;
+
+  // The following fields are only changed by the holder of performing_mutex_.
+
+  // Whether more requests could be pipelined after the ones in flight.
+  bool can_pipeline_ = false;
+
+  // Index of the last op sent in the requests in flight.
+  int64_t last_in_flight_op_index_ = 0;
+
+  // Committed index sent in the latest request.
+  int64_t last_request_committed_index_ = kMinimumOpIdIndex;
+
+  // Whether responses to the requests in flight are discarded, because an earlier request failed
+  // or was partially accepted.
+  bool discard_responses_ = false;
+
   // Heartbeater for remote peer implementations.  This will send status only requests to the remote
   // peers whenever we go more than 'FLAGS_raft_heartbeat_interval_ms' without sending actual data.
   std::shared_ptr<rpc::PeriodicTimer> heartbeater_;
@@ -295,6 +360,21 @@ class PeerProxy {
     LOG(DFATAL) << "Not implemented";
   }
 
+  // Sends a heartbeat, i.e. a request without ops, together with heartbeats of other tablets to
+  // the same server. Returns false if heartbeats are not batched, in which case the request should
+  // be sent with UpdateAsync.
+  virtual bool BatchHeartbeatAsync(const ConsensusRequestPB* request,
+                                   ConsensusResponsePB* response,
+                                   const std::function<void(const Status&)>& callback) {
+    return false;
+  }
+
+  // Whether ops could be sent to the peer as fields serialized by the log cache, set in the RPC
+  // controller instead of the request.
+  virtual bool CanSendSerializedOps() const {
+    return false;
+  }
+
   virtual ~PeerProxy() {}
 };
 
@@ -316,7 +396,8 @@ class PeerProxyFactory {
 // PeerProxy implementation that does RPC calls
 class RpcPeerProxy : public PeerProxy {
  public:
-  RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy);
+  RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy,
+               MultiRaftHeartbeatBatcherPtr heartbeat_batcher = nullptr);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            RequestTriggerMode trigger_mode,
@@ -344,17 +425,25 @@ class RpcPeerProxy : public PeerProxy {
                                        rpc::RpcController* controller,
                                        const rpc::ResponseCallback& callback) override;
 
+  bool BatchHeartbeatAsync(const ConsensusRequestPB* request,
+                           ConsensusResponsePB* response,
+                           const std::function<void(const Status&)>& callback) override;
+
+  bool CanSendSerializedOps() const override;
+
   virtual ~RpcPeerProxy();
 
  private:
   HostPort hostport_;
   ConsensusServiceProxyPtr consensus_proxy_;
+  MultiRaftHeartbeatBatcherPtr heartbeat_batcher_;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
 class RpcPeerProxyFactory : public PeerProxyFactory {
  public:
-  RpcPeerProxyFactory(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from);
+  RpcPeerProxyFactory(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB from,
+                      MultiRaftManager* multi_raft_manager = nullptr);
 
   PeerProxyPtr NewProxy(const RaftPeerPB& peer_pb) override;
 
@@ -366,6 +455,7 @@ class RpcPeerProxyFactory : public PeerProxyFactory {
   rpc::Messenger* messenger_ = nullptr;
   rpc::ProxyCache* const proxy_cache_;
   const CloudInfoPB from_;
+  MultiRaftManager* const multi_raft_manager_;
 };
 
 // Query the consensus service at last known host/port that is specified in 'remote_peer' and set
@@ -56,6 +56,7 @@
 
 DECLARE_bool(enable_data_block_fsync);
 DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_int32(follower_unavailable_considered_failed_sec);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -102,7 +103,7 @@ class ConsensusQueueTest : public YBTest {
     queue_->RegisterObserver(consensus_.get());
   }
 
-  void CloseAndReopenQueue() {
+  void CloseAndReopenQueue(bool log_prefetch = false) {
     // Blow away the memtrackers before creating the new queue.
     queue_.reset();
     queue_.reset(new PeerMessageQueue(metric_entity_,
@@ -111,7 +112,8 @@ class ConsensusQueueTest : public YBTest {
                                       FakeRaftPeerPB(kLeaderUuid),
                                       kTestTablet,
                                       clock_,
-    raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL)));
+    raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL),
+    log_prefetch ? raft_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL) : nullptr));
   }
 
   void TearDown() override {
@@ -487,6 +489,47 @@ TEST_F(ConsensusQueueTest, TestQueueAdvancesCommittedIndex) {
   ASSERT_OPID_EQ(queue_->GetMajorityReplicatedOpIdForTests(), MakeOpIdForIndex(10));
 }
 
+// Tests that the leader and a witness could not commit operations without the other full replica,
+// unless that replica is considered failed.
+TEST_F(ConsensusQueueTest, TestWitnessDoesNotMakeMajorityWithLeader) {
+  auto config = BuildRaftConfigPBForTests(3);
+  config.mutable_peers(2)->set_member_type(RaftPeerPB::WITNESS);
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), config);
+  queue_->TrackPeer("peer-1");
+  queue_->TrackPeer("peer-2");
+
+  AppendReplicateMessagesToQueue(queue_.get(), clock_, 1, 10);
+  WaitForLocalPeerToAckIndex(10);
+
+  ConsensusResponsePB response;
+  response.set_responder_term(1);
+  bool more_pending;
+
+  // Leader and witness are a majority of voters, but not a majority of full replicas.
+  response.set_responder_uuid("peer-2");
+  SetLastReceivedAndLastCommitted(&response, MakeOpIdForIndex(10), MinimumOpId().index());
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  queue_->raft_pool_observers_token_->Wait();
+  ASSERT_OPID_EQ(queue_->GetMajorityReplicatedOpIdForTests(), MinimumOpId());
+
+  // The other full replica makes a majority of full replicas.
+  response.set_responder_uuid("peer-1");
+  SetLastReceivedAndLastCommitted(&response, MakeOpIdForIndex(5), MinimumOpId().index());
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  queue_->raft_pool_observers_token_->Wait();
+  ASSERT_OPID_EQ(queue_->GetMajorityReplicatedOpIdForTests(), MakeOpIdForIndex(5));
+
+  // Once the other full replica is considered failed, the leader and witness are enough.
+  FLAGS_follower_unavailable_considered_failed_sec = 0;
+  SleepFor(MonoDelta::FromMilliseconds(10));
+  response.set_responder_uuid("peer-2");
+  SetLastReceivedAndLastCommitted(&response, MakeOpIdForIndex(10), MinimumOpId().index());
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  queue_->raft_pool_observers_token_->Wait();
+  ASSERT_OPID_EQ(queue_->GetMajorityReplicatedOpIdForTests(), MakeOpIdForIndex(10));
+}
+
 // In this test we append a sequence of operations to a log
 // and then start tracking a peer whose first required operation
 // is before the first operation in the queue.
@@ -547,6 +590,50 @@ TEST_F(ConsensusQueueTest, TestQueueLoadsOperationsForPeer) {
   ASSERT_EQ(request.ops_size(), 50);
 }
 
+// Tests that ops a lagging peer needs are read from disk by the prefetcher of the peer, which is
+// created when the peer is tracked and reused by all requests for it.
+TEST_F(ConsensusQueueTest, TestQueuePrefetchesOperationsForPeer) {
+  OpId opid = MakeOpId(1, 1);
+  for (int i = 1; i <= 100; i++) {
+    ASSERT_OK(log::AppendNoOpToLogSync(clock_, log_.get(), &opid));
+    if (i % 10 == 0) {
+      ASSERT_OK(log_->AllocateSegmentAndRollOver());
+    }
+  }
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // Reopen the queue with prefetching, its log cache does not have the ops written above.
+  CloseAndReopenQueue(true /* log_prefetch */);
+  queue_->RegisterObserver(consensus_.get());
+  OpId committed_index = MakeOpId(1, 100);
+  queue_->Init(committed_index);
+  queue_->SetLeaderMode(committed_index, committed_index.term(), BuildRaftConfigPBForTests(3));
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  bool more_pending = false;
+  ASSERT_NO_FATALS(UpdatePeerWatermarkToOp(
+      &request, &response, MakeOpId(1, 50), MinimumOpId(), &more_pending));
+  auto prefetcher = queue_->GetTrackedPeerForTests(kPeerUuid).log_prefetcher;
+  ASSERT_NE(prefetcher, nullptr);
+
+  // The first request only starts reading, so it does not wait for the disk.
+  ReplicateMsgsHolder refs;
+  bool needs_remote_bootstrap;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap));
+  ASSERT_FALSE(needs_remote_bootstrap);
+
+  ASSERT_OK(WaitFor([&]() -> Result<bool> {
+    request.Clear();
+    refs = ReplicateMsgsHolder();
+    RETURN_NOT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap));
+    return request.ops_size() > 0;
+  }, 10s, "Ops prefetched"));
+  ASSERT_EQ(51, request.ops(0).id().index());
+  ASSERT_EQ(prefetcher, queue_->GetTrackedPeerForTests(kPeerUuid).log_prefetcher);
+}
+
 // This tests that the queue is able to handle operation overwriting, i.e. when a
 // newly tracked peer reports the last received operations as some operation that
 // doesn't exist in the leader's log. In particular it tests the case where a
@@ -44,6 +44,7 @@
 
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log.h"
+#include "yb/consensus/log_prefetcher.h"
 #include "yb/consensus/log_reader.h"
 #include "yb/consensus/log_util.h"
 #include "yb/consensus/opid_util.h"
@@ -97,6 +98,16 @@ TAG_FLAG(consensus_inject_latency_ms_in_notifications, unsafe);
 
 DEFINE_bool(propagate_safe_time, true, "Propagate safe time to read from leader to followers");
 
+DEFINE_int32(log_prefetch_reader_wait_ms, 200,
+             "Max time a read of replicated messages, e.g. by CDC, waits for log entries that are "
+             "being read from disk.");
+TAG_FLAG(log_prefetch_reader_wait_ms, advanced);
+
+DEFINE_int32(log_prefetch_reader_idle_timeout_sec, 60,
+             "Log entries prefetched for a reader of replicated messages are dropped after this "
+             "many seconds without reads.");
+TAG_FLAG(log_prefetch_reader_idle_timeout_sec, advanced);
+
 namespace yb {
 namespace consensus {
 
@@ -146,8 +157,12 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
                                    const RaftPeerPB& local_peer_pb,
                                    const string& tablet_id,
                                    const server::ClockPtr& clock,
-                                   unique_ptr<ThreadPoolToken> raft_pool_token)
+                                   unique_ptr<ThreadPoolToken> raft_pool_token,
+                                   unique_ptr<ThreadPoolToken> log_prefetch_token)
     : raft_pool_observers_token_(std::move(raft_pool_token)),
+      log_prefetch_token_(std::move(log_prefetch_token)),
+      log_(log),
+      server_tracker_(server_tracker),
       local_peer_pb_(local_peer_pb),
       local_peer_uuid_(local_peer_pb_.has_permanent_uuid() ? local_peer_pb_.permanent_uuid()
                                                            : string()),
@@ -223,6 +238,13 @@ PeerMessageQueue::TrackedPeer* PeerMessageQueue::TrackPeerUnlocked(const string&
   // assert leadership. If we guessed wrong, and the peer does not have a log that matches ours, the
   // normal queue negotiation process will eventually find the right point to resume from.
   tracked_peer->next_index = queue_state_.last_appended.index() + 1;
+  if (log_prefetch_token_) {
+    // The queue is closed only after the prefetch token is shut down, so the callback does not
+    // outlive the queue.
+    tracked_peer->log_prefetcher = std::make_shared<LogPrefetcher>(
+        log_, log_prefetch_token_.get(), server_tracker_, uuid, MonoDelta::kZero,
+        std::bind(&PeerMessageQueue::NotifyObserversOfOpsPrefetched, this));
+  }
   InsertOrDie(&peers_map_, uuid, tracked_peer);
 
   CheckPeersInActiveConfigIfLeaderUnlocked();
@@ -237,6 +259,9 @@ void PeerMessageQueue::UntrackPeer(const string& uuid) {
   LockGuard lock(queue_lock_);
   TrackedPeer* peer = EraseKeyReturnValuePtr(&peers_map_, uuid);
   if (peer != nullptr) {
+    if (peer->log_prefetcher) {
+      peer->log_prefetcher->Shutdown();
+    }
     delete peer;
   }
 }
@@ -338,6 +363,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   bool is_new;
   int64_t next_index;
   HybridTime propagated_safe_time;
+  std::shared_ptr<LogPrefetcher> prefetcher;
   {
     LockGuard lock(queue_lock_);
     DCHECK_EQ(queue_state_.state, State::kQueueOpen);
@@ -347,6 +373,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     if (PREDICT_FALSE(peer == nullptr || queue_state_.mode == Mode::NON_LEADER)) {
       return STATUS(NotFound, "Peer not tracked or queue not in leader mode.");
     }
+    prefetcher = peer->log_prefetcher;
 
     HybridTime now_ht;
 
@@ -394,13 +421,19 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     preceding_id = queue_state_.last_appended;
     request->mutable_committed_index()->CopyFrom(queue_state_.committed_index);
     request->set_caller_term(queue_state_.current_term);
+    if (IsWitnessMemberType(peer->member_type)) {
+      request->set_full_replicas_replicated_index(
+          queue_state_.full_replicas_replicated_opid.index());
+    } else {
+      request->clear_full_replicas_replicated_index();
+    }
     unreachable_time =
         MonoTime::Now().GetDeltaSince(peer->last_successful_communication_time);
     if (member_type) *member_type = peer->member_type;
     if (last_exchange_successful) *last_exchange_successful = peer->is_last_exchange_successful;
     *needs_remote_bootstrap = peer->needs_remote_bootstrap;
     next_index = peer->next_index;
-    if (peer->member_type == RaftPeerPB::VOTER) {
+    if (IsVotingMemberType(peer->member_type)) {
       is_voter = true;
     }
   }
@@ -409,7 +442,8 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     if (!is_voter || CountVoters(*queue_state_.active_config) > 2) {
       // We never drop from 2 voters to 1 voter automatically, at least for now (12/4/18). We may
       // want to revisit this later, we're just being cautious with this.
-      // We remove unconditionally any failed non-voter replica (PRE_VOTER, PRE_OBSERVER, OBSERVER).
+      // We remove unconditionally any failed non-voter replica (PRE_VOTER, PRE_OBSERVER, OBSERVER,
+      // PRE_WITNESS).
       string msg = Substitute("Leader has been unable to successfully communicate "
                               "with Peer $0 for more than $1 seconds ($2)",
                               uuid,
@@ -436,7 +470,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
 
     Status s = ReadFromLogCache(next_index - 1, 0 /* to_index */, max_batch_size, uuid,
-                                &messages, &preceding_id, &have_more_messages);
+                                &messages, &preceding_id, &have_more_messages, prefetcher.get());
     if (PREDICT_FALSE(!s.ok())) {
       if (PREDICT_TRUE(s.IsNotFound())) {
         string msg = Substitute("The logs necessary to catch up peer $0 have been "
@@ -483,13 +517,77 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   return Status::OK();
 }
 
+Status PeerMessageQueue::PipelinedRequestForPeer(const string& uuid,
+                                                 int64_t after_index,
+                                                 ConsensusRequestPB* request,
+                                                 ReplicateMsgsHolder* msgs_holder) {
+  DCHECK(request->ops().empty());
+
+  HybridTime propagated_safe_time;
+  std::shared_ptr<LogPrefetcher> prefetcher;
+  {
+    LockGuard lock(queue_lock_);
+    DCHECK_EQ(queue_state_.state, State::kQueueOpen);
+
+    auto peer = FindPtrOrNull(peers_map_, uuid);
+    if (PREDICT_FALSE(peer == nullptr || queue_state_.mode == Mode::NON_LEADER)) {
+      return STATUS(NotFound, "Peer not tracked or queue not in leader mode.");
+    }
+    prefetcher = peer->log_prefetcher;
+    if (peer->is_new || peer->needs_remote_bootstrap ||
+        !log_cache_.HasOpBeenWritten(after_index + 1)) {
+      return Status::OK();
+    }
+
+    if (propagated_safe_time_provider_ && FLAGS_propagate_safe_time) {
+      propagated_safe_time = propagated_safe_time_provider_();
+    }
+    request->clear_leader_lease_duration_ms();
+    request->clear_ht_lease_expiration();
+    request->set_propagated_hybrid_time(clock_->Now().ToUint64());
+    request->mutable_committed_index()->CopyFrom(queue_state_.committed_index);
+    request->set_caller_term(queue_state_.current_term);
+  }
+
+  ReplicateMsgs messages;
+  OpId preceding_id;
+  bool have_more_messages = false;
+  int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
+  RETURN_NOT_OK(ReadFromLogCache(after_index, 0 /* to_index */, max_batch_size, uuid,
+                                 &messages, &preceding_id, &have_more_messages, prefetcher.get()));
+
+  for (const auto& msg : messages) {
+    request->mutable_ops()->AddAllocated(msg.get());
+  }
+  *msgs_holder = ReplicateMsgsHolder(request->mutable_ops(), std::move(messages));
+
+  if (propagated_safe_time && !have_more_messages) {
+    request->set_propagated_safe_time(propagated_safe_time.ToUint64());
+  } else {
+    request->clear_propagated_safe_time();
+  }
+
+  DCHECK(preceding_id.IsInitialized());
+  request->mutable_preceding_id()->CopyFrom(preceding_id);
+
+  if (PREDICT_FALSE(VLOG_IS_ON(2)) && request->ops_size() > 0) {
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending pipelined request with operations to Peer: " << uuid
+        << ". Size: " << request->ops_size()
+        << ". From: " << request->ops(0).id().ShortDebugString() << ". To: "
+        << request->ops(request->ops_size() - 1).id().ShortDebugString();
+  }
+
+  return Status::OK();
+}
+
 Status PeerMessageQueue::ReadFromLogCache(int64_t from_index,
                                           int64_t to_index,
                                           int max_batch_size,
                                           const std::string& peer_uuid,
                                           ReplicateMsgs* messages,
                                           OpId* preceding_id,
-                                          bool* have_more_messages) {
+                                          bool* have_more_messages,
+                                          LogPrefetcher* prefetcher) {
   DCHECK_LT(FLAGS_consensus_max_batch_size_bytes + 1_KB, FLAGS_rpc_max_message_size);
   *have_more_messages = false;
 
@@ -500,7 +598,8 @@ Status PeerMessageQueue::ReadFromLogCache(int64_t from_index,
                                 max_batch_size,
                                 messages,
                                 preceding_id,
-                                have_more_messages);
+                                have_more_messages,
+                                prefetcher);
   if (PREDICT_FALSE(!s.ok())) {
     if (PREDICT_TRUE(s.IsNotFound())) {
       return s;
@@ -513,6 +612,9 @@ Status PeerMessageQueue::ReadFromLogCache(int64_t from_index,
                                       << s.ToString() << ". Destination peer: "
                                       << peer_uuid;
       return s;
+    } else if (prefetcher && s.IsServiceUnavailable()) {
+      // The peer was untracked or the queue is being closed.
+      return s;
     } else {
       LOG_WITH_PREFIX_UNLOCKED(FATAL) << "Error reading the log while preparing peer request: "
                                       << s.ToString() << ". Destination peer: "
@@ -523,7 +625,46 @@ Status PeerMessageQueue::ReadFromLogCache(int64_t from_index,
   return s;
 }
 
-Status PeerMessageQueue::ReadReplicatedMessages(const OpId& last_op_id, ReplicateMsgs *msgs) {
+std::shared_ptr<LogPrefetcher> PeerMessageQueue::GetReaderLogPrefetcher(
+    const std::string& reader_id) {
+  if (!log_prefetch_token_ || reader_id.empty()) {
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<LogPrefetcher>> idle_prefetchers;
+  std::shared_ptr<LogPrefetcher> result;
+  {
+    LockGuard lock(queue_lock_);
+    const auto idle_deadline =
+        CoarseMonoClock::Now() - FLAGS_log_prefetch_reader_idle_timeout_sec * 1s;
+    for (auto it = reader_log_prefetchers_.begin(); it != reader_log_prefetchers_.end();) {
+      if (it->first != reader_id && it->second->last_read_time() < idle_deadline) {
+        idle_prefetchers.push_back(std::move(it->second));
+        it = reader_log_prefetchers_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    auto it = reader_log_prefetchers_.find(reader_id);
+    if (it != reader_log_prefetchers_.end()) {
+      result = it->second;
+    }
+  }
+  for (const auto& prefetcher : idle_prefetchers) {
+    prefetcher->Shutdown();
+  }
+  if (result) {
+    return result;
+  }
+
+  result = std::make_shared<LogPrefetcher>(
+      log_, log_prefetch_token_.get(), server_tracker_, reader_id,
+      FLAGS_log_prefetch_reader_wait_ms * 1ms, nullptr /* ready_callback */);
+  LockGuard lock(queue_lock_);
+  return reader_log_prefetchers_.emplace(reader_id, result).first->second;
+}
+
+Status PeerMessageQueue::ReadReplicatedMessages(const OpId& last_op_id, ReplicateMsgs *msgs,
+                                                const std::string& reader_id) {
   // The batch of messages read from cache.
   ReplicateMsgs messages;
   bool have_more_messages = false;
@@ -534,9 +675,11 @@ Status PeerMessageQueue::ReadReplicatedMessages(const OpId& last_op_id, Replicat
     return Status::OK();
   }
 
+  auto prefetcher = GetReaderLogPrefetcher(reader_id);
   Status s = ReadFromLogCache(last_op_id.index(), local_peer_->last_known_committed_idx,
                               FLAGS_consensus_max_batch_size_bytes,
-                              local_peer_uuid_, &messages, &preceding_id, &have_more_messages);
+                              local_peer_uuid_, &messages, &preceding_id, &have_more_messages,
+                              prefetcher.get());
   if (PREDICT_FALSE(!s.ok())) {
     if (PREDICT_TRUE(s.IsNotFound())) {
       string msg = Format("The logs from index $0 have been garbage collected and cannot be read "
@@ -567,7 +710,8 @@ Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
     return STATUS(IllegalState, "Peer does not need to remotely bootstrap", uuid);
   }
 
-  if (peer->member_type == RaftPeerPB::VOTER || peer->member_type == RaftPeerPB::OBSERVER) {
+  if (peer->member_type == RaftPeerPB::VOTER || peer->member_type == RaftPeerPB::OBSERVER ||
+      peer->member_type == RaftPeerPB::WITNESS) {
     LOG(INFO) << "Remote bootstrapping peer " << uuid << " with type "
               << RaftPeerPB::MemberType_Name(peer->member_type);
   }
@@ -584,10 +728,13 @@ Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
   return Status::OK();
 }
 
-void PeerMessageQueue::UpdateAllReplicatedOpId(OpId* result) {
+void PeerMessageQueue::UpdateAllReplicatedOpId(OpId* result, bool full_replicas_only) {
   OpId new_op_id = MaximumOpId();
 
   for (const auto& peer : peers_map_) {
+    if (full_replicas_only && IsWitnessMemberType(peer.second->member_type)) {
+      continue;
+    }
     if (!peer.second->is_last_exchange_successful) {
       return;
     }
@@ -601,13 +748,34 @@ void PeerMessageQueue::UpdateAllReplicatedOpId(OpId* result) {
 }
 
 template <class Policy>
-typename Policy::result_type PeerMessageQueue::GetWatermark() {
+typename Policy::result_type PeerMessageQueue::GetWatermark(bool full_replicas_only) {
   DCHECK(queue_lock_.is_locked());
-  const int num_peers_required = queue_state_.majority_size_;
+  int num_peers_required = queue_state_.majority_size_;
   if (num_peers_required == kUninitializedMajoritySize) {
     // We don't even know the quorum majority size yet.
     return Policy::Min();
   }
+  if (full_replicas_only) {
+    // Full replicas that the leader could not reach for longer than
+    // follower_unavailable_considered_failed_sec are about to be removed from the config, so they
+    // don't count. Otherwise, after a full replica fails, the leader could not commit anything,
+    // including the config change that removes the failed replica.
+    const auto now = MonoTime::Now();
+    int num_live_full_replicas = 0;
+    for (const auto& peer_map_entry : peers_map_) {
+      const TrackedPeer& peer = *peer_map_entry.second;
+      if (!IsRaftConfigVoter(peer.uuid, *queue_state_.active_config) ||
+          IsRaftConfigWitness(peer.uuid, *queue_state_.active_config)) {
+        continue;
+      }
+      if (peer.uuid == local_peer_uuid_ ||
+          now.GetDeltaSince(peer.last_successful_communication_time).ToSeconds() <=
+              FLAGS_follower_unavailable_considered_failed_sec) {
+        ++num_live_full_replicas;
+      }
+    }
+    num_peers_required = MajoritySize(num_live_full_replicas);
+  }
   CHECK_GE(num_peers_required, 0);
 
   const size_t num_peers = peers_map_.size();
@@ -643,6 +811,9 @@ typename Policy::result_type PeerMessageQueue::GetWatermark() {
       // Only votes from VOTERs in the active config should be taken into consideration
       continue;
     }
+    if (full_replicas_only && IsRaftConfigWitness(peer.uuid, *queue_state_.active_config)) {
+      continue;
+    }
     if (peer.is_last_exchange_successful) {
       watermarks.push_back(Policy::ExtractValue(peer));
     }
@@ -779,7 +950,17 @@ OpId PeerMessageQueue::OpIdWatermark() {
     }
   };
 
-  return GetWatermark<Policy>();
+  auto watermark = GetWatermark<Policy>();
+  // A majority that consists of the leader and witnesses is not enough to commit an operation.
+  // Otherwise, if the leader fails, the operation would be lost, since a witness could not become
+  // a leader, while other full replicas don't have it.
+  if (CountMemberType(*queue_state_.active_config, RaftPeerPB::WITNESS) != 0) {
+    auto full_replicas_watermark = GetWatermark<Policy>(true /* full_replicas_only */);
+    if (full_replicas_watermark.index() < watermark.index()) {
+      watermark = full_replicas_watermark;
+    }
+  }
+  return watermark;
 }
 
 void PeerMessageQueue::NotifyPeerIsResponsiveDespiteError(const std::string& peer_uuid) {
@@ -943,6 +1124,12 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     // our own, set 'more_pending' to true.
     *more_pending = log_cache_.HasOpBeenWritten(peer->next_index) ||
         (peer->last_known_committed_idx < queue_state_.committed_index.index());
+    // Ops that are still being read from disk would not be sent anyway. The peer is signalled when
+    // they are ready, instead of exchanging empty requests with it meanwhile.
+    if (*more_pending && peer->log_prefetcher &&
+        peer->log_prefetcher->IsReading(peer->next_index)) {
+      *more_pending = false;
+    }
 
     mode_copy = queue_state_.mode;
     if (mode_copy == Mode::LEADER) {
@@ -968,6 +1155,8 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     }
 
     UpdateAllReplicatedOpId(&queue_state_.all_replicated_opid);
+    UpdateAllReplicatedOpId(
+        &queue_state_.full_replicas_replicated_opid, true /* full_replicas_only */);
 
     log_cache_.EvictThroughOp(queue_state_.all_replicated_opid.index());
 
@@ -1034,7 +1223,11 @@ void PeerMessageQueue::ClearUnlocked() {
 
 void PeerMessageQueue::Close() {
   raft_pool_observers_token_->Shutdown();
+  if (log_prefetch_token_) {
+    log_prefetch_token_->Shutdown();
+  }
   LockGuard lock(queue_lock_);
+  reader_log_prefetchers_.clear();
   ClearUnlocked();
 }
 
@@ -1176,6 +1369,17 @@ void PeerMessageQueue::NotifyObserversOfFailedFollower(const string& uuid,
               LogPrefixUnlocked() + "Unable to notify RaftConsensus of abandoned follower.");
 }
 
+void PeerMessageQueue::NotifyObserversOfOpsPrefetched() {
+  std::vector<PeerMessageQueueObserver*> observers_copy;
+  {
+    LockGuard lock(queue_lock_);
+    observers_copy = observers_;
+  }
+  for (PeerMessageQueueObserver* observer : observers_copy) {
+    observer->NotifyOpsPrefetched();
+  }
+}
+
 void PeerMessageQueue::NotifyObserversOfFailedFollowerTask(const string& uuid,
                                                            int64_t term,
                                                            const string& reason) {
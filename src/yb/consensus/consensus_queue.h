@@ -69,6 +69,7 @@ class AsyncLogReader;
 }
 
 namespace consensus {
+class LogPrefetcher;
 class PeerMessageQueueObserver;
 struct MajorityReplicatedData;
 
@@ -152,6 +153,11 @@ class PeerMessageQueue {
     // Member type of this peer in the config.
     RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
 
+    // Reads ops this peer needs from disk, when it fell behind the log cache. Created when the peer
+    // is tracked, if log prefetching is enabled, so requests pick it up together with the rest of
+    // the peer state.
+    std::shared_ptr<LogPrefetcher> log_prefetcher;
+
    private:
     // The last term we saw from a given peer.
     // This is only used for sanity checking that a peer doesn't
@@ -165,7 +171,8 @@ class PeerMessageQueue {
                    const RaftPeerPB& local_peer_pb,
                    const std::string& tablet_id,
                    const server::ClockPtr& clock,
-                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token);
+                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token,
+                   std::unique_ptr<ThreadPoolToken> log_prefetch_token = nullptr);
 
   // Initialize the queue.
   virtual void Init(const OpId& last_locally_replicated);
@@ -243,6 +250,16 @@ class PeerMessageQueue {
       RaftPeerPB::MemberType* member_type = nullptr,
       bool* last_exchange_successful = nullptr);
 
+  // Assembles a request with ops that follow after_index, to be sent to the peer while requests
+  // with earlier ops are still in flight. Unlike RequestForPeer, it does not extend leader leases,
+  // so a response to an earlier request could not acknowledge a lease sent later. The request has
+  // no ops if nothing was appended after after_index.
+  CHECKED_STATUS PipelinedRequestForPeer(
+      const std::string& uuid,
+      int64_t after_index,
+      ConsensusRequestPB* request,
+      ReplicateMsgsHolder* msgs_holder);
+
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
   // peer->needs_remote_bootstrap to false.
@@ -312,11 +329,27 @@ class PeerMessageQueue {
     return local_peer_pb_.cloud_info();
   }
 
+  // Serializes ops read for a peer, see LogCache::SerializeOps.
+  void SerializeOps(const google::protobuf::RepeatedPtrField<ReplicateMsg>& ops,
+                    std::vector<RefCntBuffer>* fields) {
+    log_cache_.SerializeOps(ops, fields);
+  }
+
+  // Compresses ops read for a peer, see LogCache::CompressOps.
+  CHECKED_STATUS CompressOps(ReplicateCompressionType type, ConsensusRequestPB* request) {
+    return log_cache_.CompressOps(type, request);
+  }
+
   // Read replicated log records starting from the OpId immediately after last_op_id.
-  CHECKED_STATUS ReadReplicatedMessages(const OpId& last_op_id, ReplicateMsgs *msgs);
+  //
+  // If reader_id is specified, records that are not in the log cache are read ahead for this
+  // reader in background, and msgs could be empty if they were not read yet.
+  CHECKED_STATUS ReadReplicatedMessages(const OpId& last_op_id, ReplicateMsgs *msgs,
+                                        const std::string& reader_id = std::string());
 
  private:
   FRIEND_TEST(ConsensusQueueTest, TestQueueAdvancesCommittedIndex);
+  FRIEND_TEST(ConsensusQueueTest, TestWitnessDoesNotMakeMajorityWithLeader);
 
   // Mode specifies how the queue currently behaves:
   //
@@ -349,6 +382,10 @@ class PeerMessageQueue {
     // The first operation that has been replicated to all currently tracked peers.
     OpId all_replicated_opid = MinimumOpId();
 
+    // Like all_replicated_opid, but ignores witnesses. Sent to witnesses, so they keep the log
+    // that full replicas could still need.
+    OpId full_replicas_replicated_opid = MinimumOpId();
+
     // The index of the last operation replicated to a majority.  This is usually the same as
     // 'committed_index' but might not be if the terms changed.
     OpId majority_replicated_opid = MinimumOpId();
@@ -424,14 +461,16 @@ class PeerMessageQueue {
   void LocalPeerAppendFinished(const OpId& id,
                                const Status& status);
 
-  // Updates op id replicated on each node.
-  void UpdateAllReplicatedOpId(OpId* result);
+  // Updates op id replicated on each node, or on each full replica if full_replicas_only is true.
+  void UpdateAllReplicatedOpId(OpId* result, bool full_replicas_only = false);
 
   // Policy is responsible for tuning of watermark calculation.
   // I.e. simple leader lease or hybrid time leader lease etc.
   // It should provide result type and a function for extracting a value from a peer.
+  // When full_replicas_only is true, the watermark is calculated for a majority of full replicas
+  // that are not considered failed, ignoring witnesses.
   template <class Policy>
-  typename Policy::result_type GetWatermark();
+  typename Policy::result_type GetWatermark(bool full_replicas_only = false);
 
   CoarseTimePoint LeaderLeaseExpirationWatermark();
   MicrosTime HybridTimeLeaseExpirationWatermark();
@@ -443,13 +482,26 @@ class PeerMessageQueue {
                                   const std::string& peer_uuid,
                                   ReplicateMsgs* messages,
                                   OpId* preceding_id,
-                                  bool* have_more_messages);
+                                  bool* have_more_messages,
+                                  LogPrefetcher* prefetcher = nullptr);
+
+  // Returns the prefetcher for a reader of replicated messages, e.g. a CDC consumer, or nullptr if
+  // log prefetching is disabled. Prefetchers of peers are created when they are tracked.
+  std::shared_ptr<LogPrefetcher> GetReaderLogPrefetcher(const std::string& reader_id);
+
+  void NotifyObserversOfOpsPrefetched();
 
   std::vector<PeerMessageQueueObserver*> observers_;
 
   // The pool token which executes observer notifications.
   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token_;
 
+  // The pool token which reads ops for lagging peers and readers from disk. Optional.
+  std::unique_ptr<ThreadPoolToken> log_prefetch_token_;
+
+  const scoped_refptr<log::Log> log_;
+  const std::shared_ptr<MemTracker> server_tracker_;
+
   // PB containing identifying information about the local peer.
   const RaftPeerPB local_peer_pb_;
   const yb::PeerId local_peer_uuid_;
@@ -472,6 +524,9 @@ class PeerMessageQueue {
 
   LogCache log_cache_;
 
+  // Prefetchers of replicated messages readers, by reader id.
+  std::unordered_map<std::string, std::shared_ptr<LogPrefetcher>> reader_log_prefetchers_;
+
   Metrics metrics_;
 
   server::ClockPtr clock_;
@@ -517,6 +572,10 @@ class PeerMessageQueueObserver {
                                     int64_t term,
                                     const std::string& reason) = 0;
 
+  // Notify Consensus that ops for a lagging peer were read from disk, so a request with them could
+  // be sent.
+  virtual void NotifyOpsPrefetched() {}
+
   virtual ~PeerMessageQueueObserver() {}
 };
 
@@ -39,6 +39,7 @@
 #include "yb/consensus/consensus_peers.h"
 #include "yb/consensus/metadata.pb.h"
 #include "yb/consensus/opid_util.h"
+#include "yb/consensus/quorum_util.h"
 #include "yb/gutil/bind.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/port.h"
@@ -158,8 +159,8 @@ LeaderElection::LeaderElection(const RaftConfigPB& config,
       decision_callback_(std::move(decision_callback)) {
   for (const RaftPeerPB& peer : config.peers()) {
     if (request.candidate_uuid() == peer.permanent_uuid()) continue;
-    // Only peers with member_type == VOTER are allowed to vote.
-    if (peer.member_type() != RaftPeerPB::VOTER) {
+    // Only peers with member_type == VOTER or WITNESS are allowed to vote.
+    if (!IsVotingMemberType(peer.member_type())) {
       LOG(INFO) << "Ignoring peer " << peer.permanent_uuid() << " vote because its member type is "
                 << RaftPeerPB::MemberType_Name(peer.member_type());
       continue;
@@ -472,6 +472,17 @@ TEST_F(LogTest, TestSegmentRollover) {
           << ".\nSegments: " << DumpSegmentsToString(segments);
     }
     total_read += read_entries.entries.size();
+
+    // Footer should record the hybrid time range of the segment's replicates.
+    ASSERT_FALSE(read_entries.entries.empty());
+    uint64_t min_hybrid_time = std::numeric_limits<uint64_t>::max();
+    uint64_t max_hybrid_time = 0;
+    for (const auto& read_entry : read_entries.entries) {
+      min_hybrid_time = std::min(min_hybrid_time, read_entry->replicate().hybrid_time());
+      max_hybrid_time = std::max(max_hybrid_time, read_entry->replicate().hybrid_time());
+    }
+    ASSERT_EQ(min_hybrid_time, entry->footer().min_replicate_hybrid_time());
+    ASSERT_EQ(max_hybrid_time, entry->footer().max_replicate_hybrid_time());
   }
 
   ASSERT_EQ(num_entries, total_read);
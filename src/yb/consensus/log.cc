@@ -37,11 +37,11 @@
 #include <thread>
 
 #include <boost/thread/shared_mutex.hpp>
-#include <boost/scope_exit.hpp>
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log_index.h"
 #include "yb/consensus/log_metrics.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/log_sync_group.h"
 #include "yb/consensus/log_util.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/map-util.h"
@@ -184,6 +184,11 @@ class Log::Appender {
   void ProcessBatch(LogEntryBatch* entry_batch);
   void GroupWork();
 
+  // Invokes callbacks of the group of entry batches once it is synced.
+  void GroupSynced(
+      const Status& status, MonoTime time_started,
+      std::vector<std::unique_ptr<LogEntryBatch>>* group);
+
   Log* const log_;
 
   // Lock to protect access to thread_ during shutdown.
@@ -259,28 +264,32 @@ void Log::Appender::GroupWork() {
   }
   TRACE_EVENT1("log", "batch", "batch_size", sync_batch_.size());
 
-  BOOST_SCOPE_EXIT(this_) {
-    if (this_->log_->metrics_) {
-      MonoTime time_now = MonoTime::Now();
-      this_->log_->metrics_->group_commit_latency->Increment(
-          time_now.GetDeltaSince(this_->time_started_).ToMicroseconds());
-    }
-    this_->sync_batch_.clear();
-  } BOOST_SCOPE_EXIT_END;
+  // The next group could be appended while this one is synced, so callbacks are invoked once its
+  // sync completes.
+  auto group = std::make_shared<std::vector<std::unique_ptr<LogEntryBatch>>>(
+      std::move(sync_batch_));
+  sync_batch_.clear();
+  auto time_started = time_started_;
+  log_->SyncAsync([this, group, time_started](const Status& status) {
+    GroupSynced(status, time_started, group.get());
+  });
+}
 
-  Status s = log_->Sync();
-  if (PREDICT_FALSE(!s.ok())) {
-    LOG_WITH_PREFIX(DFATAL) << "Error syncing log: " << s;
-    for (std::unique_ptr<LogEntryBatch>& entry_batch : sync_batch_) {
+void Log::Appender::GroupSynced(
+    const Status& status, MonoTime time_started,
+    std::vector<std::unique_ptr<LogEntryBatch>>* group) {
+  if (PREDICT_FALSE(!status.ok())) {
+    LOG_WITH_PREFIX(DFATAL) << "Error syncing log: " << status;
+    for (std::unique_ptr<LogEntryBatch>& entry_batch : *group) {
       if (!entry_batch->callback().is_null()) {
-        entry_batch->callback().Run(s);
+        entry_batch->callback().Run(status);
       }
     }
   } else {
     TRACE_EVENT0("log", "Callbacks");
-    VLOG_WITH_PREFIX(2) << "Synchronized " << sync_batch_.size() << " entry batches";
+    VLOG_WITH_PREFIX(2) << "Synchronized " << group->size() << " entry batches";
     SCOPED_WATCH_STACK(FLAGS_consensus_log_scoped_watch_delay_callback_threshold_ms);
-    for (std::unique_ptr<LogEntryBatch>& entry_batch : sync_batch_) {
+    for (std::unique_ptr<LogEntryBatch>& entry_batch : *group) {
       if (PREDICT_TRUE(!entry_batch->failed_to_append() && !entry_batch->callback().is_null())) {
         entry_batch->callback().Run(Status::OK());
       }
@@ -288,7 +297,11 @@ void Log::Appender::GroupWork() {
       // from memory trackers, and the callback of a later batch may want to use that memory.
       entry_batch.reset();
     }
-    sync_batch_.clear();
+  }
+  group->clear();
+  if (log_->metrics_) {
+    log_->metrics_->group_commit_latency->Increment(
+        MonoTime::Now().GetDeltaSince(time_started).ToMicroseconds());
   }
   VLOG_WITH_PREFIX(1) << "Exiting AppendTask for tablet " << log_->tablet_id();
 }
@@ -633,15 +646,12 @@ void Log::UpdateFooterForBatch(LogEntryBatch* batch) {
   // over to a new segment, we set the first operation in the footer immediately.
   // Update the index bounds for the current segment.
   for (const LogEntryPB& entry_pb : batch->entry_batch_pb_.entry()) {
-    int64_t index = entry_pb.replicate().id().index();
-    if (!footer_builder_.has_min_replicate_index() ||
-        index < footer_builder_.min_replicate_index()) {
-      footer_builder_.set_min_replicate_index(index);
-    }
-    if (!footer_builder_.has_max_replicate_index() ||
-        index > footer_builder_.max_replicate_index()) {
-      footer_builder_.set_max_replicate_index(index);
-    }
+    UpdateSegmentFooterForReplicate(entry_pb.replicate(), &footer_builder_);
+  }
+  if (batch->entry_batch_pb_.has_mono_time()) {
+    UpdateSegmentFooterForEntryTime(
+        RestartSafeCoarseTimePoint::FromUInt64(batch->entry_batch_pb_.mono_time()),
+        &footer_builder_);
   }
 }
 
@@ -654,51 +664,99 @@ Status Log::Sync() {
   TRACE_EVENT0("log", "Sync");
   SCOPED_LATENCY_METRIC(metrics_, sync_latency);
 
-  if (!sync_disabled_) {
-    if (PREDICT_FALSE(GetAtomicFlag(&FLAGS_log_inject_latency))) {
-      Random r(GetCurrentTimeMicros());
-      int sleep_ms = r.Normal(GetAtomicFlag(&FLAGS_log_inject_latency_ms_mean),
-                              GetAtomicFlag(&FLAGS_log_inject_latency_ms_stddev));
-      if (sleep_ms > 0) {
-        LOG_WITH_PREFIX(INFO) << "Injecting " << sleep_ms << "ms of latency in Log::Sync()";
-        SleepFor(MonoDelta::FromMilliseconds(sleep_ms));
+  if (SyncNeeded()) {
+    LOG_SLOW_EXECUTION(WARNING, 50, "Fsync log took a long time") {
+      if (options_.sync_group) {
+        RETURN_NOT_OK(options_.sync_group->Sync(active_segment_->writable_file().get()));
+      } else {
+        RETURN_NOT_OK(active_segment_->Sync());
       }
     }
+  }
 
-    bool timed_or_data_limit_sync = false;
-    if (!durable_wal_write_ && periodic_sync_needed_.load()) {
-      if (interval_durable_wal_write_) {
-        if (MonoTime::Now() > periodic_sync_earliest_unsync_entry_time_
-            + interval_durable_wal_write_) {
-          timed_or_data_limit_sync = true;
-        }
-      }
-      if (bytes_durable_wal_write_mb_ > 0) {
-        if (periodic_sync_unsynced_bytes_ >= bytes_durable_wal_write_mb_ * 1_MB) {
-          timed_or_data_limit_sync = true;
-        }
-      }
+  SyncDone(active_segment_->written_offset(), last_appended_entry_op_id_);
+  return Status::OK();
+}
+
+void Log::SyncAsync(StdStatusCallback callback) {
+  // Sync group coordinates syncs of several logs, so it is used synchronously.
+  if (options_.sync_group) {
+    callback(Sync());
+    return;
+  }
+
+  TRACE_EVENT0("log", "SyncAsync");
+  const auto offset = active_segment_->written_offset();
+  const auto op_id = last_appended_entry_op_id_;
+  if (!SyncNeeded()) {
+    SyncDone(offset, op_id);
+    callback(Status::OK());
+    return;
+  }
+
+  const auto start = MonoTime::Now();
+  active_segment_->SyncAsync([this, offset, op_id, start, callback](const Status& status) {
+    const auto elapsed = MonoTime::Now() - start;
+    if (metrics_) {
+      metrics_->sync_latency->Increment(elapsed.ToMicroseconds());
     }
+    if (elapsed > MonoDelta::FromMilliseconds(50)) {
+      LOG_WITH_PREFIX(WARNING) << "Fsync log took a long time: " << elapsed;
+    }
+    if (status.ok()) {
+      SyncDone(offset, op_id);
+    }
+    callback(status);
+  });
+}
 
-    if (durable_wal_write_ || timed_or_data_limit_sync) {
-      periodic_sync_needed_.store(false);
-      periodic_sync_unsynced_bytes_ = 0;
-      LOG_SLOW_EXECUTION(WARNING, 50, "Fsync log took a long time") {
-        RETURN_NOT_OK(active_segment_->Sync());
+bool Log::SyncNeeded() {
+  if (sync_disabled_) {
+    return false;
+  }
+
+  if (PREDICT_FALSE(GetAtomicFlag(&FLAGS_log_inject_latency))) {
+    Random r(GetCurrentTimeMicros());
+    int sleep_ms = r.Normal(GetAtomicFlag(&FLAGS_log_inject_latency_ms_mean),
+                            GetAtomicFlag(&FLAGS_log_inject_latency_ms_stddev));
+    if (sleep_ms > 0) {
+      LOG_WITH_PREFIX(INFO) << "Injecting " << sleep_ms << "ms of latency in Log::Sync()";
+      SleepFor(MonoDelta::FromMilliseconds(sleep_ms));
+    }
+  }
+
+  bool timed_or_data_limit_sync = false;
+  if (!durable_wal_write_ && periodic_sync_needed_.load()) {
+    if (interval_durable_wal_write_) {
+      if (MonoTime::Now() > periodic_sync_earliest_unsync_entry_time_
+          + interval_durable_wal_write_) {
+        timed_or_data_limit_sync = true;
+      }
+    }
+    if (bytes_durable_wal_write_mb_ > 0) {
+      if (periodic_sync_unsynced_bytes_ >= bytes_durable_wal_write_mb_ * 1_MB) {
+        timed_or_data_limit_sync = true;
       }
     }
   }
 
+  if (!durable_wal_write_ && !timed_or_data_limit_sync) {
+    return false;
+  }
+  periodic_sync_needed_.store(false);
+  periodic_sync_unsynced_bytes_ = 0;
+  return true;
+}
+
+void Log::SyncDone(int64_t offset, const yb::OpId& op_id) {
   // Update the reader on how far it can read the active segment.
-  reader_->UpdateLastSegmentOffset(active_segment_->written_offset());
+  reader_->UpdateLastSegmentOffset(offset);
 
   {
     std::lock_guard<std::mutex> write_lock(last_synced_entry_op_id_mutex_);
-    last_synced_entry_op_id_.store(last_appended_entry_op_id_, boost::memory_order_release);
+    last_synced_entry_op_id_.store(op_id, boost::memory_order_release);
     last_synced_entry_op_id_cond_.notify_all();
   }
-
-  return Status::OK();
 }
 
 Status Log::GetSegmentsToGCUnlocked(int64_t min_op_idx, SegmentSequence* segments_to_gc) const {
@@ -909,6 +967,10 @@ LogReader* Log::GetLogReader() const {
   return reader_.get();
 }
 
+Status Log::OpenExistingIndexChunks(int64_t min_index, int64_t max_index) {
+  return log_index_->OpenExistingChunks(min_index, max_index);
+}
+
 Status Log::GetSegmentsSnapshot(SegmentSequence* segments) const {
   boost::shared_lock<rw_spinlock> read_lock(state_lock_.get_lock());
   if (!reader_) {
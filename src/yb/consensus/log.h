@@ -167,6 +167,10 @@ class Log : public RefCountedThreadSafe<Log> {
 
   CHECKED_STATUS GetSegmentsSnapshot(SegmentSequence* segments) const;
 
+  // Makes entries of existing segments from min_index to max_index available to the log index,
+  // used by bootstrap for segments that it does not replay. See LogIndex::OpenExistingChunks.
+  CHECKED_STATUS OpenExistingIndexChunks(int64_t min_index, int64_t max_index);
+
   void SetMaxSegmentSizeForTests(uint64_t max_segment_size) {
     max_segment_size_ = max_segment_size;
   }
@@ -342,6 +346,16 @@ class Log : public RefCountedThreadSafe<Log> {
 
   CHECKED_STATUS Sync();
 
+  // Like Sync, but does not wait for the active segment to be synced when its file supports
+  // asynchronous syncs. callback is invoked once the sync completes, possibly from another thread.
+  void SyncAsync(StdStatusCallback callback);
+
+  // Returns whether the active segment should be made durable by the current sync.
+  bool SyncNeeded();
+
+  // Updates the state visible to readers once the log is synced up to offset and op_id.
+  void SyncDone(int64_t offset, const yb::OpId& op_id);
+
   // Helper method to get the segment sequence to GC based on the provided min_op_idx.
   CHECKED_STATUS GetSegmentsToGCUnlocked(int64_t min_op_idx, SegmentSequence* segments_to_gc) const;
 
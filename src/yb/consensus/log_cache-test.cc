@@ -44,6 +44,8 @@
 #include "yb/consensus/consensus-test-util.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_cache.h"
+#include "yb/consensus/log_prefetcher.h"
+#include "yb/consensus/replicate_compression.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/bind_helpers.h"
 #include "yb/gutil/stl_util.h"
@@ -51,8 +53,10 @@
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
+#include "yb/util/random_util.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/test_util.h"
+#include "yb/util/threadpool.h"
 
 using std::atomic;
 using std::shared_ptr;
@@ -60,6 +64,7 @@ using std::thread;
 
 DECLARE_int32(log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_mb);
+DECLARE_string(replicate_compression_type);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -137,6 +142,14 @@ class LogCacheTest : public YBTest {
     return Status::OK();
   }
 
+  Status AppendReplicateMessageToCache(int64_t index, const std::string& payload) {
+    auto msg = CreateDummyReplicate(index / kTermDivisor, index, clock_->Now(), 0);
+    msg->mutable_noop_request()->set_payload_for_tests(payload);
+    return cache_->AppendOperations(
+        { msg }, yb::OpId() /* committed_op_id */, RestartSafeCoarseMonoClock().Now(),
+        Bind(&FatalOnError));
+  }
+
   const Schema schema_;
   MetricRegistry metric_registry_;
   scoped_refptr<MetricEntity> metric_entity_;
@@ -336,6 +349,132 @@ TEST_F(LogCacheTest, TestGlobalMemoryLimit) {
   ASSERT_LE(cache_->BytesUsed(), 1_MB);
 }
 
+// Test that under memory pressure entries are compressed instead of being evicted, and could still
+// be read from the cache.
+TEST_F(LogCacheTest, TestCompressUnderMemoryLimit) {
+  FLAGS_log_cache_size_limit_mb = 1;
+  FLAGS_replicate_compression_type = "lz4";
+  CloseAndReopenCache(MinimumOpId());
+
+  const int kPayloadSize = 400_KB;
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_OK(AppendReplicateMessagesToCache(i, 1, kPayloadSize));
+    ASSERT_OK(log_->WaitUntilAllFlushed());
+  }
+
+  // Dummy payload is well compressible, so nothing has to be evicted.
+  ASSERT_EQ(3, cache_->num_cached_ops());
+  ASSERT_LT(cache_->BytesUsed(), 1_MB);
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8_MB, &messages, &preceding));
+  ASSERT_EQ(3, messages.size());
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_EQ(i + 1, messages[i]->id().index());
+    ASSERT_EQ(kPayloadSize, messages[i]->noop_request().payload_for_tests().size());
+  }
+
+  // Compressed entries are evicted as usual.
+  cache_->EvictThroughOp(3);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+  ASSERT_EQ(0, cache_->BytesUsed());
+}
+
+// Test that when compression frees less memory than required, entries are evicted to stay within
+// the limit.
+TEST_F(LogCacheTest, TestEvictWhenCompressionIsNotEnough) {
+  FLAGS_log_cache_size_limit_mb = 1;
+  FLAGS_replicate_compression_type = "lz4";
+  CloseAndReopenCache(MinimumOpId());
+
+  // Random part of the payload could not be compressed, so compression frees only about a third of
+  // the entry.
+  const size_t kRandomSize = 200_KB;
+  const size_t kZerosSize = 100_KB;
+  constexpr int kNumOps = 6;
+  for (int i = 1; i <= kNumOps; ++i) {
+    auto bytes = RandomBytes(kRandomSize);
+    std::string payload(bytes.begin(), bytes.end());
+    payload.append(kZerosSize, 0);
+    ASSERT_OK(AppendReplicateMessageToCache(i, payload));
+    ASSERT_OK(log_->WaitUntilAllFlushed());
+    ASSERT_LE(cache_->BytesUsed(), 1_MB);
+  }
+
+  ASSERT_LT(cache_->num_cached_ops(), kNumOps);
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8_MB, &messages, &preceding));
+  ASSERT_EQ(kNumOps, messages.size());
+  for (int i = 0; i != kNumOps; ++i) {
+    ASSERT_EQ(i + 1, messages[i]->id().index());
+    ASSERT_EQ(kRandomSize + kZerosSize, messages[i]->noop_request().payload_for_tests().size());
+  }
+}
+
+// Tests that an op is compressed once for all peers, and that its compressed form is reused when
+// the entry is compressed under memory pressure.
+TEST_F(LogCacheTest, TestCompressOps) {
+  constexpr int kNumOps = 3;
+  const int kPayloadSize = 100_KB;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumOps, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8_MB, &messages, &preceding));
+  ASSERT_EQ(kNumOps, messages.size());
+
+  ConsensusRequestPB request;
+  for (const auto& msg : messages) {
+    request.mutable_ops()->AddAllocated(msg.get());
+  }
+  const auto bytes_before = cache_->BytesUsed();
+  ASSERT_OK(cache_->CompressOps(LZ4_REPLICATE_COMPRESSION, &request));
+  // Ops are owned by the cache.
+  request.mutable_ops()->ExtractSubrange(0, request.ops().size(), nullptr /* elements */);
+  const auto bytes_after = cache_->BytesUsed();
+  ASSERT_GT(bytes_after, bytes_before);
+  ASSERT_EQ(kNumOps, request.compressed_ops_size());
+
+  // Ops of another request are matched to cache entries by id, so the cached compressed form is
+  // returned instead of compressing these ops.
+  ConsensusRequestPB request2;
+  for (int i = 1; i <= kNumOps; ++i) {
+    *request2.add_ops()->mutable_id() = MakeOpId(i / kTermDivisor, i);
+  }
+  ASSERT_OK(cache_->CompressOps(LZ4_REPLICATE_COMPRESSION, &request2));
+  request2.clear_ops();
+  ASSERT_EQ(bytes_after, cache_->BytesUsed());
+  ASSERT_OK(UncompressOps(&request2));
+  ASSERT_EQ(kNumOps, request2.ops_size());
+  for (int i = 0; i != kNumOps; ++i) {
+    ASSERT_EQ(messages[i]->ShortDebugString(), request2.ops(i).ShortDebugString());
+  }
+
+  // Entries that already have a compressed form just drop their messages under memory pressure.
+  FLAGS_replicate_compression_type = "lz4";
+  messages.clear();
+  LogCache::CompressionCandidates to_compress;
+  {
+    std::lock_guard<simple_spinlock> lock(cache_->lock_);
+    cache_->EvictSomeUnlocked(kNumOps, std::numeric_limits<int64_t>::max(), &to_compress);
+  }
+  ASSERT_TRUE(to_compress.empty());
+  ASSERT_EQ(kNumOps, cache_->num_cached_ops());
+  ASSERT_LT(cache_->BytesUsed(), bytes_before);
+
+  ConsensusRequestPB request3;
+  for (int i = 1; i <= kNumOps; ++i) {
+    *request3.add_ops()->mutable_id() = MakeOpId(i / kTermDivisor, i);
+  }
+  ASSERT_OK(cache_->CompressOps(LZ4_REPLICATE_COMPRESSION, &request3));
+  for (int i = 0; i != kNumOps; ++i) {
+    ASSERT_EQ(request.compressed_ops(i), request3.compressed_ops(i));
+  }
+}
+
 // Test that the log cache properly replaces messages when an index
 // is reused. This is a regression test for a bug where the memtracker's
 // consumption wasn't properly managed when messages were replaced.
@@ -359,6 +498,86 @@ TEST_F(LogCacheTest, TestReplaceMessages) {
             cache_->ToString());
 }
 
+// Tests that ops evicted from the cache are read from disk in background when a prefetcher is used.
+TEST_F(LogCacheTest, TestPrefetchEvictedMessages) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumMessages));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  cache_->EvictThroughOp(kMessageIndex2);
+
+  std::atomic<int> num_ready(0);
+  std::unique_ptr<ThreadPool> prefetch_pool;
+  ASSERT_OK(ThreadPoolBuilder("prefetch").Build(&prefetch_pool));
+  auto token = prefetch_pool->NewToken(ThreadPool::ExecutionMode::SERIAL);
+  auto prefetcher = std::make_shared<LogPrefetcher>(
+      log_, token.get(), nullptr /* parent_tracker */, "test", MonoDelta::kZero,
+      [&num_ready] { ++num_ready; });
+
+  // The first read does not wait for the disk, it only starts prefetching.
+  ReplicateMsgs messages;
+  OpId preceding;
+  bool have_more_messages = false;
+  ASSERT_OK(cache_->ReadOps(0, 0 /* to_op_index */, 8_MB, &messages, &preceding,
+                            &have_more_messages, prefetcher.get()));
+  ASSERT_TRUE(messages.empty());
+  ASSERT_TRUE(have_more_messages);
+
+  ASSERT_OK(WaitFor([&num_ready] { return num_ready > 0; }, 10s, "Ops prefetched"));
+  ASSERT_OK(cache_->ReadOps(0, 0 /* to_op_index */, 8_MB, &messages, &preceding,
+                            &have_more_messages, prefetcher.get()));
+  ASSERT_EQ(kNumMessages, messages.size());
+  for (int i = 0; i != kNumMessages; ++i) {
+    ASSERT_EQ(i + 1, messages[i]->id().index());
+  }
+  ASSERT_EQ(0, prefetcher->BytesUsed());
+}
+
+// Tests that ops serialized by the cache could be parsed as part of ConsensusRequestPB, and that
+// cached ops are serialized only once.
+TEST_F(LogCacheTest, TestSerializeOps) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumMessages));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8_MB, &messages, &preceding));
+  ASSERT_EQ(kNumMessages, messages.size());
+
+  ConsensusRequestPB request;
+  request.set_tablet_id(kTestTablet);
+  request.set_caller_uuid(kPeerUuid);
+  request.set_caller_term(1);
+  *request.mutable_committed_index() = MinimumOpId();
+  for (const auto& msg : messages) {
+    request.mutable_ops()->AddAllocated(msg.get());
+  }
+  const auto bytes_before = cache_->BytesUsed();
+  std::vector<RefCntBuffer> fields;
+  cache_->SerializeOps(request.ops(), &fields);
+  const auto bytes_after = cache_->BytesUsed();
+  std::vector<RefCntBuffer> fields2;
+  cache_->SerializeOps(request.ops(), &fields2);
+  // Ops are owned by the cache.
+  request.mutable_ops()->ExtractSubrange(0, request.ops().size(), nullptr /* elements */);
+
+  ASSERT_GT(bytes_after, bytes_before);
+  ASSERT_EQ(kNumMessages, fields.size());
+  ASSERT_EQ(kNumMessages, fields2.size());
+  for (int i = 0; i != kNumMessages; ++i) {
+    ASSERT_EQ(fields[i].data(), fields2[i].data());
+  }
+
+  std::string serialized = request.SerializeAsString();
+  for (const auto& field : fields) {
+    serialized.append(field.data(), field.size());
+  }
+  ConsensusRequestPB parsed;
+  ASSERT_TRUE(parsed.ParseFromString(serialized));
+  ASSERT_EQ(kNumMessages, parsed.ops_size());
+  for (int i = 0; i != kNumMessages; ++i) {
+    ASSERT_EQ(messages[i]->ShortDebugString(), parsed.ops(i).ShortDebugString());
+  }
+}
+
 TEST_F(LogCacheTest, TestMTReadAndWrite) {
   atomic<bool> stop { false };
   bool stopped = false;
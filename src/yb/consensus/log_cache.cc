@@ -42,7 +42,9 @@
 #include <google/protobuf/wire_format_lite_inl.h>
 
 #include "yb/consensus/log.h"
+#include "yb/consensus/log_prefetcher.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/replicate_compression.h"
 #include "yb/gutil/bind.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
@@ -151,6 +153,8 @@ Result<LogCache::PrepareAppendResult> LogCache::PrepareAppendOperations(const Re
   int64_t first_idx_in_batch = msgs.front()->id().index();
   result.last_idx_in_batch = msgs.back()->id().index();
 
+  CompressionCandidates to_compress;
+  int64_t bytes_to_evict = 0;
   std::unique_lock<simple_spinlock> lock(lock_);
   // If we're not appending a consecutive op we're likely overwriting and need to replace operations
   // in the cache.
@@ -182,7 +186,8 @@ Result<LogCache::PrepareAppendResult> LogCache::PrepareAppendOperations(const Re
 
     // TODO: we should also try to evict from other tablets - probably better to evict really old
     // ops from another tablet than evict recent ops from this one.
-    EvictSomeUnlocked(min_pinned_op_index_, need_to_free);
+    bytes_to_evict =
+        need_to_free - EvictSomeUnlocked(min_pinned_op_index_, need_to_free, &to_compress);
 
     // Force consuming, so that we don't refuse appending data. We might blow past our limit a
     // little bit (as much as the number of tablets times the amount of in-flight data in the log),
@@ -198,6 +203,9 @@ Result<LogCache::PrepareAppendResult> LogCache::PrepareAppendOperations(const Re
     next_sequential_op_index_ = index + 1;
   }
 
+  lock.unlock();
+  CompressEntries(std::move(to_compress), bytes_to_evict);
+
   return result;
 }
 
@@ -230,7 +238,9 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
                            const StatusCallback& user_callback,
                            const Status& log_status) {
   if (log_status.ok()) {
-    std::lock_guard<simple_spinlock> l(lock_);
+    CompressionCandidates to_compress;
+    int64_t bytes_to_evict = 0;
+    std::unique_lock<simple_spinlock> l(lock_);
     if (min_pinned_op_index_ <= last_idx_in_batch) {
       VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
       min_pinned_op_index_ = last_idx_in_batch + 1;
@@ -241,9 +251,12 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
     if (borrowed_memory) {
       int64_t spare_capacity = parent_tracker_->SpareCapacity();
       if (spare_capacity < 0) {
-        EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity);
+        bytes_to_evict = -spare_capacity -
+                         EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity, &to_compress);
       }
     }
+    l.unlock();
+    CompressEntries(std::move(to_compress), bytes_to_evict);
   }
   user_callback.Run(log_status);
 }
@@ -281,13 +294,39 @@ namespace {
 
 // Calculate the total byte size that will be used on the wire to replicate this message as part of
 // a consensus update request. This accounts for the length delimiting and tagging of the message.
-int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
-  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
-    msg.ByteSize());
+int64_t TotalByteSizeForMessage(int64_t byte_size) {
+  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(byte_size);
   msg_size += 1; // for the type tag
   return msg_size;
 }
 
+int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
+  return TotalByteSizeForMessage(msg.ByteSize());
+}
+
+RefCntBuffer SerializeOpsField(const ReplicateMsg& msg) {
+  using google::protobuf::internal::WireFormatLite;
+  using google::protobuf::io::CodedOutputStream;
+
+  const int msg_size = msg.ByteSize();
+  RefCntBuffer result(TotalByteSizeForMessage(msg_size));
+  auto* dst = WireFormatLite::WriteTagToArray(
+      ConsensusRequestPB::kOpsFieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+      result.udata());
+  dst = CodedOutputStream::WriteVarint32ToArray(msg_size, dst);
+  dst = msg.SerializeWithCachedSizesToArray(dst);
+  DCHECK_EQ(dst, result.uend());
+  return result;
+}
+
+// Returns a message with only the id and op type of msg, that represents a compressed cache entry.
+ReplicateMsgPtr MakeHeader(const ReplicateMsg& msg) {
+  auto header = std::make_shared<ReplicateMsg>();
+  *header->mutable_id() = msg.id();
+  header->set_op_type(msg.op_type());
+  return header;
+}
+
 } // anonymous namespace
 
 Status LogCache::ReadOps(int64_t after_op_index,
@@ -304,7 +343,8 @@ Status LogCache::ReadOps(int64_t after_op_index,
                          int max_size_bytes,
                          ReplicateMsgs* messages,
                          OpId* preceding_op,
-                         bool* have_more_messages) {
+                         bool* have_more_messages,
+                         LogPrefetcher* prefetcher) {
   DCHECK_ONLY_NOTNULL(messages);
   DCHECK_ONLY_NOTNULL(preceding_op);
   DCHECK_GE(after_op_index, 0);
@@ -313,6 +353,22 @@ Status LogCache::ReadOps(int64_t after_op_index,
     *have_more_messages = false;
   }
 
+  // Compressed cache entries are only uncompressed after the lock is released.
+  std::vector<std::pair<size_t, std::shared_ptr<const CompressedMsg>>> compressed_msgs;
+  auto uncompress_msgs = [messages, &compressed_msgs]() -> Status {
+    for (const auto& p : compressed_msgs) {
+      faststring serialized;
+      RETURN_NOT_OK(UncompressReplicateData(p.second->type, p.second->data, &serialized));
+      auto msg = std::make_shared<ReplicateMsg>();
+      if (!msg->ParseFromArray(serialized.data(), serialized.size())) {
+        return STATUS(Corruption, "Failed to parse compressed log cache entry");
+      }
+      (*messages)[p.first] = std::move(msg);
+    }
+    compressed_msgs.clear();
+    return Status::OK();
+  };
+
   std::unique_lock<simple_spinlock> l(lock_);
   int64_t next_index = after_op_index + 1;
   int64_t to_index = to_op_index > 0 ? to_op_index + 1 : next_sequential_op_index_;
@@ -334,6 +390,29 @@ Status LogCache::ReadOps(int64_t after_op_index,
       }
 
       l.unlock();
+      RETURN_NOT_OK(uncompress_msgs());
+
+      if (prefetcher) {
+        const size_t old_size = messages->size();
+        auto status = prefetcher->ReadOps(next_index - 1, up_to, remaining_space, messages);
+        if (!status.ok() && !status.IsTryAgain()) {
+          return status.CloneAndPrepend(Substitute("Failed to read ops $0..$1", next_index, up_to));
+        }
+        for (size_t i = old_size; i != messages->size(); ++i) {
+          CHECK_EQ(next_index, (*messages)[i]->id().index());
+          remaining_space -= TotalByteSizeForMessage(*(*messages)[i]);
+          next_index++;
+        }
+        if (messages->size() == old_size) {
+          // The prefetcher is still reading these ops, or they do not fit into the remaining space.
+          if (have_more_messages) {
+            *have_more_messages = true;
+          }
+          return Status::OK();
+        }
+        l.lock();
+        continue;
+      }
 
       ReplicateMsgs raw_replicate_ptrs;
       RETURN_NOT_OK_PREPEND(
@@ -362,13 +441,15 @@ Status LogCache::ReadOps(int64_t after_op_index,
         if (to_op_index > 0 && next_index > to_op_index) {
           break;
         }
-        const ReplicateMsgPtr& msg = iter->second.msg;
+        const CacheEntry& entry = iter->second;
+        const ReplicateMsgPtr& msg = entry.msg;
         int64_t index = msg->id().index();
         if (index != next_index) {
           continue;
         }
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
+        remaining_space -= entry.header_only ? TotalByteSizeForMessage(entry.compressed->byte_size)
+                                             : TotalByteSizeForMessage(*msg);
         if (remaining_space < 0 && !messages->empty()) {
           if (have_more_messages) {
             *have_more_messages = true;
@@ -376,12 +457,18 @@ Status LogCache::ReadOps(int64_t after_op_index,
           break;
         }
 
-        messages->push_back(msg);
+        if (entry.header_only) {
+          compressed_msgs.emplace_back(messages->size(), entry.compressed);
+          messages->push_back(nullptr);
+        } else {
+          messages->push_back(msg);
+        }
         next_index++;
       }
     }
   }
-  return Status::OK();
+  l.unlock();
+  return uncompress_msgs();
 }
 
 void LogCache::EvictThroughOp(int64_t index) {
@@ -390,16 +477,22 @@ void LogCache::EvictThroughOp(int64_t index) {
   EvictSomeUnlocked(index, MathLimits<int64_t>::kMax);
 }
 
-void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
+int64_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict,
+                                    CompressionCandidates* to_compress) {
   DCHECK(lock_.is_locked());
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting log cache index <= "
                       << stop_after_index
                       << " or " << HumanReadableNumBytes::ToString(bytes_to_evict)
                       << ": before state: " << ToStringUnlocked();
 
+  // Compress instead of evicting only under memory pressure, ops that were replicated everywhere
+  // are not needed anymore.
+  const auto compression = to_compress ? GetReplicateCompressionType() : NO_REPLICATE_COMPRESSION;
   int64_t bytes_evicted = 0;
+  // Size of the entries queued for compression, an upper bound of what compressing them would free.
+  int64_t bytes_to_compress = 0;
   for (auto iter = cache_.begin(); iter != cache_.end();) {
-    const CacheEntry& entry = iter->second;
+    CacheEntry& entry = iter->second;
     const ReplicateMsgPtr& msg = entry.msg;
     VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
     int64_t msg_index = msg->id().index();
@@ -420,6 +513,22 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
       continue;
     }
 
+    if (compression != NO_REPLICATE_COMPRESSION && !entry.header_only) {
+      if (entry.compressed) {
+        VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Keeping compressed: " << msg->id();
+        bytes_evicted += DropCompressedPayloadUnlocked(MakeHeader(*msg), &entry);
+      } else {
+        VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Compressing: " << msg->id();
+        to_compress->push_back({msg_index, msg, compression});
+        bytes_to_compress += entry.mem_usage;
+      }
+      if (bytes_evicted + bytes_to_compress >= bytes_to_evict) {
+        break;
+      }
+      ++iter;
+      continue;
+    }
+
     VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
     AccountForMessageRemovalUnlocked(entry);
     bytes_evicted += entry.mem_usage;
@@ -430,6 +539,212 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
     }
   }
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Evicting log cache: after state: " << ToStringUnlocked();
+  return bytes_evicted;
+}
+
+int64_t LogCache::DropCompressedPayloadUnlocked(ReplicateMsgPtr header, CacheEntry* entry) {
+  const int64_t old_mem_usage = entry->mem_usage;
+  entry->msg = std::move(header);
+  entry->serialized = RefCntBuffer();
+  entry->header_only = true;
+  entry->mem_usage = entry->msg->SpaceUsedLong() + entry->compressed->MemUsage();
+  const int64_t bytes_freed = old_mem_usage - entry->mem_usage;
+  tracker_->Release(bytes_freed);
+  metrics_.log_cache_size->DecrementBy(bytes_freed);
+  return bytes_freed;
+}
+
+LogCache::CacheEntry* LogCache::FindEntryUnlocked(int64_t index, MessageCache::iterator* hint) {
+  const auto key = static_cast<uint64_t>(index);
+  if (*hint == cache_.end() || (*hint)->first != key) {
+    *hint = cache_.find(key);
+  }
+  if (*hint == cache_.end()) {
+    return nullptr;
+  }
+  CacheEntry* entry = &(*hint)->second;
+  ++*hint;
+  return entry;
+}
+
+void LogCache::SerializeOps(const google::protobuf::RepeatedPtrField<ReplicateMsg>& ops,
+                            std::vector<RefCntBuffer>* fields) {
+  fields->clear();
+  fields->resize(ops.size());
+
+  // Only the message instance stored in the cache is serialized once, ops uncompressed or read from
+  // disk are serialized for each request.
+  auto find_entry = [this, &ops](int i, MessageCache::iterator* it) -> CacheEntry* {
+    const auto& op = ops.Get(i);
+    auto* entry = FindEntryUnlocked(op.id().index(), it);
+    return entry && entry->msg.get() == &op ? entry : nullptr;
+  };
+
+  std::vector<int> to_serialize;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    auto it = cache_.end();
+    for (int i = 0; i != ops.size(); ++i) {
+      auto* entry = find_entry(i, &it);
+      if (entry && entry->serialized) {
+        (*fields)[i] = entry->serialized;
+      } else {
+        to_serialize.push_back(i);
+      }
+    }
+  }
+  if (to_serialize.empty()) {
+    return;
+  }
+
+  for (int i : to_serialize) {
+    (*fields)[i] = SerializeOpsField(ops.Get(i));
+  }
+
+  std::lock_guard<simple_spinlock> lock(lock_);
+  auto it = cache_.end();
+  for (int i : to_serialize) {
+    auto* entry = find_entry(i, &it);
+    if (!entry || entry->serialized) {
+      continue;
+    }
+    const auto& field = (*fields)[i];
+    if (!tracker_->TryConsume(field.size())) {
+      continue;
+    }
+    entry->serialized = field;
+    entry->mem_usage += field.size();
+    metrics_.log_cache_size->IncrementBy(field.size());
+  }
+}
+
+Status LogCache::CompressOps(ReplicateCompressionType type, ConsensusRequestPB* request) {
+  const auto& ops = request->ops();
+  std::vector<std::shared_ptr<const CompressedMsg>> compressed(ops.size());
+
+  // Entries are matched by op id rather than by message instance, so the compressed form of entries
+  // that were compressed under memory pressure, and uncompressed by ReadOps, is reused as well.
+  auto find_entry = [this, &ops](int i, MessageCache::iterator* it) -> CacheEntry* {
+    const auto& id = ops.Get(i).id();
+    auto* entry = FindEntryUnlocked(id.index(), it);
+    return entry && entry->msg->id().term() == id.term() ? entry : nullptr;
+  };
+
+  std::vector<int> to_compress;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    auto it = cache_.end();
+    for (int i = 0; i != ops.size(); ++i) {
+      auto* entry = find_entry(i, &it);
+      if (entry && entry->compressed && entry->compressed->type == type) {
+        compressed[i] = entry->compressed;
+      } else {
+        to_compress.push_back(i);
+      }
+    }
+  }
+
+  for (int i : to_compress) {
+    compressed[i] = VERIFY_RESULT(CompressMsg(type, ops.Get(i)));
+  }
+
+  if (!to_compress.empty()) {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    auto it = cache_.end();
+    for (int i : to_compress) {
+      auto* entry = find_entry(i, &it);
+      if (!entry || entry->compressed) {
+        continue;
+      }
+      const int64_t mem_usage = compressed[i]->MemUsage();
+      if (!tracker_->TryConsume(mem_usage)) {
+        continue;
+      }
+      entry->compressed = compressed[i];
+      entry->mem_usage += mem_usage;
+      metrics_.log_cache_size->IncrementBy(mem_usage);
+    }
+  }
+
+  request->clear_compressed_ops();
+  for (const auto& msg : compressed) {
+    request->add_compressed_ops(msg->data);
+  }
+  request->set_ops_compression(type);
+  return Status::OK();
+}
+
+Result<std::shared_ptr<const LogCache::CompressedMsg>> LogCache::CompressMsg(
+    ReplicateCompressionType type, const ReplicateMsg& msg) {
+  faststring buffer;
+  RETURN_NOT_OK(CompressReplicateMsg(type, msg, &buffer));
+  auto result = std::make_shared<CompressedMsg>();
+  result->type = type;
+  result->data.assign(buffer.c_str(), buffer.size());
+  result->byte_size = msg.ByteSize();
+  return result;
+}
+
+void LogCache::CompressEntries(CompressionCandidates candidates, int64_t bytes_to_evict) {
+  if (candidates.empty()) {
+    return;
+  }
+
+  struct CompressedEntry {
+    ReplicateMsgPtr header;
+    std::shared_ptr<const CompressedMsg> compressed;
+    int64_t mem_usage = 0;
+  };
+  std::vector<CompressedEntry> compressed_entries(candidates.size());
+  for (size_t i = 0; i != candidates.size(); ++i) {
+    const auto& candidate = candidates[i];
+    const ReplicateMsg& msg = *candidate.msg;
+    auto compressed = CompressMsg(candidate.type, msg);
+    if (!compressed.ok()) {
+      LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Failed to compress " << msg.id() << ": "
+                                        << compressed.status();
+      continue;
+    }
+
+    auto& entry = compressed_entries[i];
+    entry.header = MakeHeader(msg);
+    entry.compressed = std::move(*compressed);
+    entry.mem_usage = entry.header->SpaceUsedLong() + entry.compressed->MemUsage();
+  }
+
+  std::lock_guard<simple_spinlock> lock(lock_);
+  int64_t bytes_evicted = 0;
+  for (size_t i = 0; i != candidates.size(); ++i) {
+    auto& candidate = candidates[i];
+    auto it = cache_.find(candidate.index);
+    // The entry was evicted or overwritten while the lock was released.
+    if (it == cache_.end() || it->second.msg != candidate.msg) {
+      continue;
+    }
+    candidate.msg.reset();
+
+    CacheEntry& entry = it->second;
+    auto& compressed_entry = compressed_entries[i];
+    if (compressed_entry.compressed && compressed_entry.mem_usage < entry.mem_usage) {
+      VLOG_WITH_PREFIX_UNLOCKED(2) << "Compressed " << entry.msg->id() << " from "
+                                   << entry.mem_usage << " to " << compressed_entry.mem_usage
+                                   << " bytes";
+      // Replaces the compressed form that could have been added for a peer in the meantime.
+      entry.compressed = std::move(compressed_entry.compressed);
+      bytes_evicted += DropCompressedPayloadUnlocked(std::move(compressed_entry.header), &entry);
+    } else if (entry.msg.unique() && candidate.index < min_pinned_op_index_) {
+      VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << entry.msg->id();
+      bytes_evicted += entry.mem_usage;
+      AccountForMessageRemovalUnlocked(entry);
+      cache_.erase(it);
+    }
+  }
+
+  // Compression usually frees less than the whole entry, so evict the oldest entries if it was not
+  // enough.
+  if (bytes_evicted < bytes_to_evict) {
+    EvictSomeUnlocked(min_pinned_op_index_, bytes_to_evict - bytes_evicted);
+  }
 }
 
 void LogCache::AccountForMessageRemovalUnlocked(const CacheEntry& entry) {
@@ -489,7 +804,7 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
       Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
                  counter++, msg->id().term(), msg->id().index(),
                  OperationType_Name(msg->op_type()),
-                 msg->ByteSize()));
+                 entry.second.header_only ? entry.second.compressed->byte_size : msg->ByteSize()));
   }
 }
 
@@ -508,7 +823,9 @@ void LogCache::DumpToHtml(std::ostream& out) const {
                       "<td>$4</td><td>$5</td></tr>",
                       counter++, msg->id().term(), msg->id().index(),
                       OperationType_Name(msg->op_type()),
-                      msg->ByteSize(), msg->id().ShortDebugString()) << endl;
+                      entry.second.header_only ? entry.second.compressed->byte_size
+                                               : msg->ByteSize(),
+                      msg->id().ShortDebugString()) << endl;
   }
   out << "</table>";
 }
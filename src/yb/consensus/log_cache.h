@@ -47,6 +47,7 @@
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
 #include "yb/util/opid.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/restart_safe_clock.h"
 #include "yb/util/result.h"
 
@@ -62,6 +63,7 @@ class LogReader;
 
 namespace consensus {
 
+class LogPrefetcher;
 class ReplicateMsg;
 
 // Write-through cache for the log.
@@ -108,12 +110,17 @@ class LogCache {
   // until 'to_op_index' (inclusive).
   //
   // If 'to_op_index' is 0, then all operations after 'after_op_index' will be included.
+  //
+  // If 'prefetcher' is specified, ops that are not in the cache are taken from it instead of being
+  // read from disk synchronously. When the prefetcher does not have them yet, fewer ops (possibly
+  // none) are returned and *have_more_messages is set.
   CHECKED_STATUS ReadOps(int64_t after_op_index,
                          int64_t to_op_index,
                          int max_size_bytes,
                          ReplicateMsgs* messages,
                          OpId* preceding_op,
-                         bool* have_more_messages = nullptr);
+                         bool* have_more_messages = nullptr,
+                         LogPrefetcher* prefetcher = nullptr);
 
   // Append the operations into the log and the cache.  When the messages have completed writing
   // into the on-disk log, fires 'callback'.
@@ -126,6 +133,17 @@ class LogCache {
                                   RestartSafeCoarseTimePoint batch_mono_time,
                                   const StatusCallback& callback);
 
+  // Fills 'fields' with 'ops' serialized as elements of ConsensusRequestPB::ops, i.e. including
+  // the field tag and length. Operations returned by ReadOps are serialized once, while they are in
+  // the cache, and the same buffer is returned to all peers they are sent to.
+  void SerializeOps(const google::protobuf::RepeatedPtrField<ReplicateMsg>& ops,
+                    std::vector<RefCntBuffer>* fields);
+
+  // Fills compressed_ops of the request from its ops, see consensus::CompressOps. Each operation is
+  // compressed once, while it is in the cache, and the compressed form is shared by all peers and
+  // reused when the entry is compressed under memory pressure. Ops are left in the request.
+  CHECKED_STATUS CompressOps(ReplicateCompressionType type, ConsensusRequestPB* request);
+
   // Return true if an operation with the given index has been written through the cache. The
   // operation may not necessarily be durable yet -- it could still be en route to the log.
   bool HasOpBeenWritten(int64_t log_index) const;
@@ -162,22 +180,80 @@ class LogCache {
 
  private:
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
+  FRIEND_TEST(LogCacheTest, TestCompressOps);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   friend class LogCacheTest;
 
+  // Replicate message compressed to save memory.
+  struct CompressedMsg {
+    ReplicateCompressionType type;
+    std::string data;
+    // ByteSize() of the original message.
+    int64_t byte_size;
+
+    int64_t MemUsage() const {
+      return sizeof(*this) + data.capacity();
+    }
+  };
+
   // An entry in the cache.
   struct CacheEntry {
     ReplicateMsgPtr msg;
     // The cached value of msg->SpaceUsedLong(). This method is expensive
     // to compute, so we compute it only once upon insertion.
     int64_t mem_usage;
+    // Compressed form of msg, set when it is first sent compressed to a peer or when the entry is
+    // compressed under memory pressure. Included in mem_usage.
+    std::shared_ptr<const CompressedMsg> compressed;
+    // The entry was compressed under memory pressure, so msg only has the id and op type of the
+    // original message and the payload is only available in compressed.
+    bool header_only = false;
+    // msg serialized as an element of ConsensusRequestPB::ops, set when it is first sent to a peer.
+    // Included in mem_usage.
+    RefCntBuffer serialized;
   };
 
+  typedef std::map<uint64_t, CacheEntry> MessageCache;
+
+  // Operation picked for compression while holding lock_, compressed after it is released.
+  struct CompressionCandidate {
+    int64_t index;
+    // Keeps the message alive and lets us detect that the entry was replaced in the meantime.
+    ReplicateMsgPtr msg;
+    ReplicateCompressionType type;
+  };
+  typedef std::vector<CompressionCandidate> CompressionCandidates;
+
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
   // 'stop_after_index' has been evicted, whichever comes first.
-  void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+  //
+  // When replicate compression is enabled and to_compress is specified, operations are compressed
+  // instead of being evicted. Entries that already have a compressed form just drop their message,
+  // others are added to to_compress. The caller should pass them to CompressEntries after releasing
+  // lock_, since only the size of the entries that were actually freed is known at this point.
+  //
+  // Returns the number of bytes freed.
+  int64_t EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict,
+                            CompressionCandidates* to_compress = nullptr);
+
+  // Compresses candidates without holding lock_, then replaces messages of the cache entries that
+  // still contain them with their compressed form. Entries that compression would not shrink are
+  // evicted instead. If that frees less than bytes_to_evict, the oldest unpinned entries are
+  // evicted to make up the difference.
+  void CompressEntries(CompressionCandidates candidates, int64_t bytes_to_evict);
+
+  // Replaces the message of the entry, that should already be compressed, with the given header.
+  // Returns the number of bytes freed.
+  int64_t DropCompressedPayloadUnlocked(ReplicateMsgPtr header, CacheEntry* entry);
+
+  // Returns the entry with the given index, using and advancing hint to look up consecutive
+  // indexes without searching the whole cache.
+  CacheEntry* FindEntryUnlocked(int64_t index, MessageCache::iterator* hint);
+
+  static Result<std::shared_ptr<const CompressedMsg>> CompressMsg(
+      ReplicateCompressionType type, const ReplicateMsg& msg);
 
   // Update metrics and MemTracker to account for the removal of the
   // given message.
@@ -220,7 +296,6 @@ class LogCache {
   // Maps from log index -> ReplicateMsg
   // An ordered map that serves as the buffer for the cached messages.  Maps from log index ->
   // CacheEntry
-  typedef std::map<uint64_t, CacheEntry> MessageCache;
   MessageCache cache_;
 
   // The next log index to append. Each append operation must either start with this log index, or
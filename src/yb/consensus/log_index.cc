@@ -113,15 +113,20 @@ class LogIndex::IndexChunk : public RefCountedThreadSafe<LogIndex::IndexChunk> {
   explicit IndexChunk(string path);
   ~IndexChunk();
 
-  // Open and map the memory.
-  Status Open();
+  // Open and map the memory. A read only chunk should already exist and is not modified.
+  Status Open(bool read_only);
   void GetEntry(int entry_index, PhysicalEntry* ret);
   void SetEntry(int entry_index, const PhysicalEntry& entry);
 
+  bool read_only() const {
+    return read_only_;
+  }
+
  private:
   const string path_;
   int fd_;
   uint8_t* mapping_;
+  bool read_only_ = false;
 };
 
 namespace  {
@@ -147,15 +152,31 @@ LogIndex::IndexChunk::~IndexChunk() {
   }
 }
 
-Status LogIndex::IndexChunk::Open() {
-  RETRY_ON_EINTR(fd_, open(path_.c_str(), O_CLOEXEC | O_CREAT | O_RDWR, 0666));
-  RETURN_NOT_OK(CheckError(fd_, "open"));
+Status LogIndex::IndexChunk::Open(bool read_only) {
+  read_only_ = read_only;
+  if (read_only) {
+    RETRY_ON_EINTR(fd_, open(path_.c_str(), O_CLOEXEC | O_RDONLY));
+    if (fd_ < 0 && errno == ENOENT) {
+      return STATUS(NotFound, "Index chunk not found", path_);
+    }
+    RETURN_NOT_OK(CheckError(fd_, "open"));
+
+    struct stat st;
+    RETURN_NOT_OK(CheckError(fstat(fd_, &st), "fstat"));
+    if (st.st_size < kChunkFileSize) {
+      return STATUS_FORMAT(NotFound, "Index chunk $0 is truncated: $1 bytes", path_, st.st_size);
+    }
+  } else {
+    RETRY_ON_EINTR(fd_, open(path_.c_str(), O_CLOEXEC | O_CREAT | O_RDWR, 0666));
+    RETURN_NOT_OK(CheckError(fd_, "open"));
 
-  int err;
-  RETRY_ON_EINTR(err, ftruncate(fd_, kChunkFileSize));
-  RETURN_NOT_OK(CheckError(fd_, "truncate"));
+    int err;
+    RETRY_ON_EINTR(err, ftruncate(fd_, kChunkFileSize));
+    RETURN_NOT_OK(CheckError(fd_, "truncate"));
+  }
 
-  mapping_ = static_cast<uint8_t*>(mmap(nullptr, kChunkFileSize, PROT_READ | PROT_WRITE,
+  mapping_ = static_cast<uint8_t*>(mmap(nullptr, kChunkFileSize,
+                                        read_only ? PROT_READ : PROT_READ | PROT_WRITE,
                                         MAP_SHARED, fd_, 0));
   if (mapping_ == nullptr) {
     int err = errno;
@@ -174,6 +195,7 @@ void LogIndex::IndexChunk::GetEntry(int entry_index, PhysicalEntry* ret) {
 
 void LogIndex::IndexChunk::SetEntry(int entry_index, const PhysicalEntry& phys) {
   DCHECK_GE(fd_, 0) << "Must Open() first";
+  DCHECK(!read_only_) << path_;
   DCHECK_LT(entry_index, kEntriesPerIndexChunk);
 
   memcpy(mapping_ + sizeof(PhysicalEntry) * entry_index, &phys, sizeof(PhysicalEntry));
@@ -192,11 +214,11 @@ string LogIndex::GetChunkPath(int64_t chunk_idx) {
   return StringPrintf("%s/index.%09" PRId64, base_dir_.c_str(), chunk_idx);
 }
 
-Status LogIndex::OpenChunk(int64_t chunk_idx, scoped_refptr<IndexChunk>* chunk) {
+Status LogIndex::OpenChunk(int64_t chunk_idx, bool read_only, scoped_refptr<IndexChunk>* chunk) {
   string path = GetChunkPath(chunk_idx);
 
   scoped_refptr<IndexChunk> new_chunk(new IndexChunk(path));
-  RETURN_NOT_OK(new_chunk->Open());
+  RETURN_NOT_OK(new_chunk->Open(read_only));
   chunk->swap(new_chunk);
   return Status::OK();
 }
@@ -208,7 +230,8 @@ Status LogIndex::GetChunkForIndex(int64_t log_index, bool create,
 
   {
     std::lock_guard<simple_spinlock> l(open_chunks_lock_);
-    if (FindCopy(open_chunks_, chunk_idx, chunk)) {
+    // A chunk opened by OpenExistingChunks is reopened for writing.
+    if (FindCopy(open_chunks_, chunk_idx, chunk) && (!create || !(*chunk)->read_only())) {
       return Status::OK();
     }
   }
@@ -217,23 +240,43 @@ Status LogIndex::GetChunkForIndex(int64_t log_index, bool create,
     return STATUS(NotFound, "chunk not found");
   }
 
-  RETURN_NOT_OK_PREPEND(OpenChunk(chunk_idx, chunk),
+  RETURN_NOT_OK_PREPEND(OpenChunk(chunk_idx, false /* read_only */, chunk),
                         "Couldn't open index chunk");
   {
     std::lock_guard<simple_spinlock> l(open_chunks_lock_);
-    if (PREDICT_FALSE(ContainsKey(open_chunks_, chunk_idx))) {
+    auto& open_chunk = open_chunks_[chunk_idx];
+    if (PREDICT_FALSE(open_chunk && !open_chunk->read_only())) {
       // Someone else opened the chunk in the meantime.
       // We'll just return that one.
-      *chunk = FindOrDie(open_chunks_, chunk_idx);
+      *chunk = open_chunk;
       return Status::OK();
     }
 
-    InsertOrDie(&open_chunks_, chunk_idx, *chunk);
+    open_chunk = *chunk;
   }
 
   return Status::OK();
 }
 
+Status LogIndex::OpenExistingChunks(int64_t min_index, int64_t max_index) {
+  for (int64_t chunk_idx = min_index / kEntriesPerIndexChunk;
+       chunk_idx <= max_index / kEntriesPerIndexChunk; ++chunk_idx) {
+    {
+      std::lock_guard<simple_spinlock> l(open_chunks_lock_);
+      if (ContainsKey(open_chunks_, chunk_idx)) {
+        continue;
+      }
+    }
+
+    scoped_refptr<IndexChunk> chunk;
+    RETURN_NOT_OK(OpenChunk(chunk_idx, true /* read_only */, &chunk));
+    std::lock_guard<simple_spinlock> l(open_chunks_lock_);
+    // Keep the chunk if it was opened by someone else in the meantime.
+    open_chunks_.emplace(chunk_idx, std::move(chunk));
+  }
+  return Status::OK();
+}
+
 Status LogIndex::AddEntry(const LogIndexEntry& entry) {
   scoped_refptr<IndexChunk> chunk;
   RETURN_NOT_OK(GetChunkForIndex(entry.op_id.index(),
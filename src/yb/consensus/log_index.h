@@ -84,6 +84,12 @@ class LogIndex : public RefCountedThreadSafe<LogIndex> {
   // Returns NotFound() if the given log entry was never written.
   CHECKED_STATUS GetEntry(int64_t index, LogIndexEntry* entry);
 
+  // Opens the on-disk chunks containing entries from min_index to max_index read only, so that
+  // GetEntry could find entries written before restart. Used by bootstrap for log segments that
+  // are not replayed, so they are not added to the index again.
+  // Returns NotFound() if one of these chunks does not exist.
+  CHECKED_STATUS OpenExistingChunks(int64_t min_index, int64_t max_index);
+
   // Indicate that we no longer need to retain information about indexes lower than the
   // given index. Note that the implementation is conservative and _may_ choose to retain
   // earlier entries.
@@ -97,7 +103,8 @@ class LogIndex : public RefCountedThreadSafe<LogIndex> {
 
   // Open the on-disk chunk with the given index.
   // Note: 'chunk_idx' is the index of the index chunk, not the index of a log _entry_.
-  CHECKED_STATUS OpenChunk(int64_t chunk_idx, scoped_refptr<IndexChunk>* chunk);
+  CHECKED_STATUS OpenChunk(
+      int64_t chunk_idx, bool read_only, scoped_refptr<IndexChunk>* chunk);
 
   // Return the index chunk which contains the given log index.
   // If 'create' is true, creates it on-demand. If 'create' is false, and
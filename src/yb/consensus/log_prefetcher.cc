@@ -0,0 +1,248 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/log_prefetcher.h"
+
+#include <google/protobuf/wire_format_lite.h>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/log.h"
+#include "yb/consensus/log_reader.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/threadpool.h"
+
+using namespace yb::size_literals;
+
+DEFINE_int32(log_prefetch_size_limit_mb, 16,
+             "Max size of log entries that are read ahead for a single follower or CDC consumer "
+             "that fell behind the log cache.");
+TAG_FLAG(log_prefetch_size_limit_mb, advanced);
+
+DEFINE_int32(global_log_prefetch_size_limit_mb, 512,
+             "Server-wide version of 'log_prefetch_size_limit_mb'.");
+TAG_FLAG(global_log_prefetch_size_limit_mb, advanced);
+
+DEFINE_int32(log_prefetch_read_size_kb, 4096,
+             "Size of log entries read from disk at once by the log prefetcher.");
+TAG_FLAG(log_prefetch_read_size_kb, advanced);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+const std::string kParentMemTrackerId = "log_prefetch";
+
+// Size of the message on the wire as part of a consensus update request, same as in LogCache.
+int64_t WireSizeForMessage(const ReplicateMsg& msg) {
+  return google::protobuf::internal::WireFormatLite::LengthDelimitedSize(msg.ByteSize()) + 1;
+}
+
+} // namespace
+
+LogPrefetcher::LogPrefetcher(const scoped_refptr<log::Log>& log,
+                             ThreadPoolToken* token,
+                             const std::shared_ptr<MemTracker>& parent_tracker,
+                             const std::string& reader_id,
+                             MonoDelta wait_timeout,
+                             std::function<void()> ready_callback)
+    : log_(log),
+      token_(token),
+      parent_tracker_(parent_tracker),
+      tracker_id_(Format("$0-$1", kParentMemTrackerId, reader_id)),
+      wait_timeout_(wait_timeout),
+      ready_callback_(std::move(ready_callback)),
+      last_read_time_(CoarseMonoClock::Now()) {
+}
+
+LogPrefetcher::~LogPrefetcher() {
+  Shutdown();
+  if (tracker_) {
+    tracker_->UnregisterFromParent();
+  }
+}
+
+Status LogPrefetcher::ReadOps(int64_t after_op_index,
+                              int64_t to_op_index,
+                              int64_t max_size_bytes,
+                              ReplicateMsgs* messages) {
+  const int64_t first_index = after_op_index + 1;
+  DCHECK_GE(to_op_index, first_index);
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (shutdown_) {
+    return STATUS(ServiceUnavailable, "Log prefetcher is shut down");
+  }
+  last_read_time_ = CoarseMonoClock::Now();
+
+  // Operations the reader has passed are not needed anymore.
+  while (!ops_.empty() && ops_.front().msg->id().index() < first_index) {
+    PopFrontUnlocked();
+  }
+
+  if (ops_.empty() || ops_.front().msg->id().index() != first_index) {
+    if (!ops_.empty() || next_index_ != first_index) {
+      // The reader moved to another position, e.g. because of a log mismatch with the follower.
+      ClearUnlocked();
+      next_index_ = first_index;
+      limit_index_ = 0;
+      read_status_ = Status::OK();
+      ++generation_;
+    }
+    limit_index_ = std::max(limit_index_, to_op_index);
+    StartReadUnlocked();
+    if (wait_timeout_.Initialized() && wait_timeout_ > MonoDelta::kZero) {
+      cond_.wait_for(lock, wait_timeout_.ToSteadyDuration(), [this] {
+        return !ops_.empty() || !read_status_.ok() || !reading_ || shutdown_;
+      });
+    }
+    if (ops_.empty()) {
+      if (!read_status_.ok()) {
+        // Report the error once, the next call will try to read again.
+        Status status;
+        std::swap(status, read_status_);
+        return status;
+      }
+      return STATUS_FORMAT(TryAgain, "Operations from $0 are being read from the log",
+                           first_index);
+    }
+  }
+
+  limit_index_ = std::max(limit_index_, to_op_index);
+  int64_t remaining_space = max_size_bytes;
+  while (!ops_.empty()) {
+    const auto& entry = ops_.front();
+    if (entry.msg->id().index() > to_op_index) {
+      break;
+    }
+    remaining_space -= entry.wire_size;
+    if (remaining_space <= 0 && !messages->empty()) {
+      break;
+    }
+    messages->push_back(entry.msg);
+    PopFrontUnlocked();
+  }
+
+  // Read the next batch while the reader is busy with this one.
+  StartReadUnlocked();
+  return Status::OK();
+}
+
+void LogPrefetcher::StartReadUnlocked() {
+  if (reading_ || shutdown_ || !read_status_.ok() || next_index_ > limit_index_) {
+    return;
+  }
+  // The first batch is always read, since the reader is waiting for it.
+  if (!ops_.empty() &&
+      (bytes_ >= FLAGS_log_prefetch_size_limit_mb * 1_MB || tracker_->AnyLimitExceeded())) {
+    return;
+  }
+
+  if (!tracker_) {
+    auto global_tracker = MemTracker::FindOrCreateTracker(
+        FLAGS_global_log_prefetch_size_limit_mb * 1_MB, kParentMemTrackerId, parent_tracker_);
+    tracker_ = MemTracker::CreateTracker(
+        -1 /* byte_limit */, tracker_id_, global_tracker, AddToParent::kTrue,
+        CreateMetrics::kFalse);
+  }
+
+  reading_ = true;
+  auto status = token_->SubmitFunc(std::bind(
+      &LogPrefetcher::DoRead, shared_from_this(), next_index_, limit_index_, generation_));
+  if (!status.ok()) {
+    reading_ = false;
+    read_status_ = status;
+  }
+}
+
+void LogPrefetcher::DoRead(int64_t from_index, int64_t up_to_index, uint64_t generation) {
+  ReplicateMsgs msgs;
+  auto status = log_->GetLogReader()->ReadReplicatesInRange(
+      from_index, up_to_index, FLAGS_log_prefetch_read_size_kb * 1_KB, &msgs);
+
+  bool notify;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reading_ = false;
+    notify = generation == generation_ && !shutdown_;
+    if (notify) {
+      if (status.ok() && msgs.empty()) {
+        status = STATUS_FORMAT(Incomplete, "No operations in the log from $0 to $1",
+                               from_index, up_to_index);
+      }
+      if (status.ok()) {
+        for (auto& msg : msgs) {
+          Entry entry = { std::move(msg), 0, 0 };
+          entry.wire_size = WireSizeForMessage(*entry.msg);
+          entry.mem_size = entry.msg->SpaceUsed();
+          bytes_ += entry.mem_size;
+          tracker_->Consume(entry.mem_size);
+          ops_.push_back(std::move(entry));
+        }
+        if (!ops_.empty()) {
+          next_index_ = ops_.back().msg->id().index() + 1;
+        }
+      } else {
+        read_status_ = status;
+      }
+    }
+    // Keep reading ahead, or start reading from the new position of the reader.
+    StartReadUnlocked();
+    cond_.notify_all();
+  }
+
+  if (notify && ready_callback_) {
+    ready_callback_();
+  }
+}
+
+void LogPrefetcher::Shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shutdown_ = true;
+  ClearUnlocked();
+  cond_.notify_all();
+}
+
+bool LogPrefetcher::IsReading(int64_t op_index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reading_ && !shutdown_ && op_index >= next_index_;
+}
+
+CoarseTimePoint LogPrefetcher::last_read_time() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_read_time_;
+}
+
+int64_t LogPrefetcher::BytesUsed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+void LogPrefetcher::PopFrontUnlocked() {
+  bytes_ -= ops_.front().mem_size;
+  tracker_->Release(ops_.front().mem_size);
+  ops_.pop_front();
+}
+
+void LogPrefetcher::ClearUnlocked() {
+  if (tracker_) {
+    tracker_->Release(bytes_);
+  }
+  bytes_ = 0;
+  ops_.clear();
+}
+
+}  // namespace consensus
+}  // namespace yb
@@ -0,0 +1,133 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_LOG_PREFETCHER_H
+#define YB_CONSENSUS_LOG_PREFETCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "yb/consensus/consensus_fwd.h"
+#include "yb/gutil/macros.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/monotime.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class MemTracker;
+class ThreadPoolToken;
+
+namespace log {
+class Log;
+}
+
+namespace consensus {
+
+// Reads operations from the log ahead of a single sequential reader, such as a follower or a CDC
+// consumer that fell behind the log cache. Reads are performed on the specified thread pool token,
+// so the reader does not block on disk, and the next batch is read while the reader sends the
+// previous one. Memory used by the prefetched operations is tracked by a child of parent_tracker,
+// and read ahead stops when it reaches log_prefetch_size_limit_mb or any limit of its ancestors.
+class LogPrefetcher : public std::enable_shared_from_this<LogPrefetcher> {
+ public:
+  // ready_callback is invoked on the thread pool after operations were read, or reading failed.
+  // If wait_timeout is positive, ReadOps waits up to that long for the operations to be read.
+  LogPrefetcher(const scoped_refptr<log::Log>& log,
+                ThreadPoolToken* token,
+                const std::shared_ptr<MemTracker>& parent_tracker,
+                const std::string& reader_id,
+                MonoDelta wait_timeout,
+                std::function<void()> ready_callback);
+
+  ~LogPrefetcher();
+
+  // Appends prefetched operations following after_op_index, up to to_op_index (inclusive), to
+  // messages. The total wire size of the appended operations is less than max_size_bytes, unless
+  // messages is empty, in which case at least one operation is appended.
+  //
+  // Returns TryAgain if the operation following after_op_index was not read yet. In this case the
+  // read of operations starting from it is started, and ready_callback is invoked when it is done.
+  CHECKED_STATUS ReadOps(int64_t after_op_index,
+                         int64_t to_op_index,
+                         int64_t max_size_bytes,
+                         ReplicateMsgs* messages);
+
+  // Drops prefetched operations and prevents further reads, so ReadOps returns ServiceUnavailable.
+  // The read in progress, if any, is still completed on the thread pool, but its result is dropped.
+  void Shutdown();
+
+  // Whether the operation with the specified index is not prefetched yet, but is being read.
+  bool IsReading(int64_t op_index) const;
+
+  // Time of the last ReadOps call, used to drop prefetchers of readers that went away.
+  CoarseTimePoint last_read_time() const;
+
+  int64_t BytesUsed() const;
+
+ private:
+  struct Entry {
+    ReplicateMsgPtr msg;
+    int64_t wire_size;
+    int64_t mem_size;
+  };
+
+  void StartReadUnlocked();
+  void DoRead(int64_t from_index, int64_t up_to_index, uint64_t generation);
+  void PopFrontUnlocked();
+  void ClearUnlocked();
+
+  const scoped_refptr<log::Log> log_;
+  ThreadPoolToken* const token_;
+  const std::shared_ptr<MemTracker> parent_tracker_;
+  const std::string tracker_id_;
+  // Created on the first read, so readers that never fall behind the log cache do not register
+  // mem trackers.
+  std::shared_ptr<MemTracker> tracker_;
+  const MonoDelta wait_timeout_;
+  const std::function<void()> ready_callback_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+
+  // Prefetched operations, with consecutive indexes ending right before next_index_.
+  std::deque<Entry> ops_;
+  int64_t bytes_ = 0;
+
+  // Index of the next operation to read from the log.
+  int64_t next_index_ = 0;
+
+  // Operations after this index are not read ahead, since the reader could get them from the log
+  // cache.
+  int64_t limit_index_ = 0;
+
+  bool reading_ = false;
+  bool shutdown_ = false;
+  Status read_status_;
+  CoarseTimePoint last_read_time_;
+
+  // Incremented when the reader moves to another position, so the result of the read in progress
+  // is dropped.
+  uint64_t generation_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(LogPrefetcher);
+};
+
+}  // namespace consensus
+}  // namespace yb
+
+#endif // YB_CONSENSUS_LOG_PREFETCHER_H
@@ -0,0 +1,212 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "yb/consensus/log_sync_group.h"
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/env.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(log_group_syncfs_min_logs);
+
+namespace yb {
+namespace log {
+
+namespace {
+
+class CountingWritableFile : public WritableFileWrapper {
+ public:
+  explicit CountingWritableFile(std::unique_ptr<WritableFile> target)
+      : WritableFileWrapper(std::move(target)) {}
+
+  CHECKED_STATUS Flush(FlushMode mode) override {
+    if (on_flush) {
+      on_flush();
+    }
+    ++num_flushes;
+    return WritableFileWrapper::Flush(mode);
+  }
+
+  CHECKED_STATUS Sync() override {
+    if (on_sync) {
+      on_sync();
+    }
+    ++num_syncs;
+    return WritableFileWrapper::Sync();
+  }
+
+  std::atomic<int> num_flushes{0};
+  std::atomic<int> num_syncs{0};
+  std::function<void()> on_flush;
+  std::function<void()> on_sync;
+};
+
+} // namespace
+
+class LogSyncGroupTest : public YBTest {
+ protected:
+  void CreateFiles(int num_files) {
+    for (int i = 0; i != num_files; ++i) {
+      std::unique_ptr<WritableFile> file;
+      ASSERT_OK(env_->NewWritableFile(GetTestPath(Format("wal-$0", i)), &file));
+      files_.push_back(std::make_unique<CountingWritableFile>(std::move(file)));
+    }
+  }
+
+  // Appends to every file and syncs it through the group from its own thread.
+  void SyncConcurrently(LogSyncGroup* group, int syncs_per_file = kSyncsPerFile) {
+    std::vector<std::thread> threads;
+    for (auto& file : files_) {
+      threads.emplace_back([group, &file, syncs_per_file] {
+        for (int i = 0; i != syncs_per_file; ++i) {
+          ASSERT_OK(file->Append(Slice("entry")));
+          ASSERT_OK(group->Sync(file.get()));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Checks that logs are synced by their own callers in parallel, i.e. every file sync waits until
+  // all files are being synced at the same time.
+  void CheckParallelSyncs(LogSyncGroup* group) {
+    CountDownLatch all_syncing(files_.size());
+    for (auto& file : files_) {
+      file->on_sync = [&all_syncing] {
+        all_syncing.CountDown();
+        ASSERT_TRUE(all_syncing.WaitFor(MonoDelta::FromSeconds(30)))
+            << "Log syncs were serialized";
+      };
+    }
+    SyncConcurrently(group, 1);
+    for (auto& file : files_) {
+      ASSERT_EQ(1, file->num_syncs.load());
+      ASSERT_EQ(0, file->num_flushes.load());
+      file->on_sync = nullptr;
+    }
+    ASSERT_EQ(0U, group->TEST_num_groups());
+  }
+
+  static constexpr int kSyncsPerFile = 20;
+
+  std::vector<std::unique_ptr<CountingWritableFile>> files_;
+};
+
+TEST_F(LogSyncGroupTest, SyncEachFile) {
+  FLAGS_log_group_syncfs_min_logs = 0;
+  constexpr int kNumFiles = 8;
+  CreateFiles(kNumFiles);
+
+  LogSyncGroup group(GetTestDataDirectory());
+  ASSERT_OK(group.Init());
+  ASSERT_FALSE(group.SyncfsEnabled());
+  ASSERT_NO_FATALS(CheckParallelSyncs(&group));
+  SyncConcurrently(&group);
+
+  for (auto& file : files_) {
+    ASSERT_EQ(kSyncsPerFile + 1, file->num_syncs.load());
+    ASSERT_EQ((kSyncsPerFile + 1) * 5, file->Size());
+  }
+  // Without syncfs() logs are never grouped.
+  ASSERT_EQ(0U, group.TEST_num_groups());
+}
+
+// Groups with fewer logs than log_group_syncfs_min_logs are synced by their callers in parallel.
+TEST_F(LogSyncGroupTest, SmallGroupsSyncEachFile) {
+  constexpr int kNumFiles = 8;
+  FLAGS_log_group_syncfs_min_logs = kNumFiles + 1;
+  CreateFiles(kNumFiles);
+
+  LogSyncGroup group(GetTestDataDirectory());
+  ASSERT_OK(group.Init());
+  if (!group.SyncfsEnabled()) {
+    LOG(INFO) << "syncfs() is not supported, skipping test";
+    return;
+  }
+  ASSERT_NO_FATALS(CheckParallelSyncs(&group));
+}
+
+// Syncs requested while a syncfs() is in progress are combined into a single group.
+TEST_F(LogSyncGroupTest, GroupSyncfs) {
+  FLAGS_log_group_syncfs_min_logs = 1;
+  constexpr int kNumFiles = 8;
+  CreateFiles(kNumFiles);
+
+  LogSyncGroup group(GetTestDataDirectory());
+  ASSERT_OK(group.Init());
+  if (!group.SyncfsEnabled()) {
+    LOG(INFO) << "syncfs() is not supported, skipping test";
+    return;
+  }
+
+  // The first log is synced alone, and stays in its syncfs() until other logs are queued.
+  CountDownLatch first_sync_started(1);
+  CountDownLatch release_first_sync(1);
+  files_[0]->on_flush = [&first_sync_started, &release_first_sync] {
+    first_sync_started.CountDown();
+    release_first_sync.Wait();
+  };
+  std::vector<std::thread> threads;
+  for (auto& file : files_) {
+    threads.emplace_back([&group, &file] {
+      ASSERT_OK(file->Append(Slice("entry")));
+      ASSERT_OK(group.Sync(file.get()));
+    });
+    if (&file == &files_.front()) {
+      first_sync_started.Wait();
+    }
+  }
+  ASSERT_OK(WaitFor([&group] { return group.TEST_pending_group_size() == kNumFiles - 1; },
+                    MonoDelta::FromSeconds(30), "Logs joined the pending group"));
+  release_first_sync.CountDown();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(2U, group.TEST_num_groups());
+  for (auto& file : files_) {
+    ASSERT_EQ(1, file->num_flushes.load());
+    ASSERT_EQ(0, file->num_syncs.load());
+  }
+}
+
+TEST_F(LogSyncGroupTest, GroupSyncfsConcurrently) {
+  FLAGS_log_group_syncfs_min_logs = 2;
+  constexpr int kNumFiles = 16;
+  CreateFiles(kNumFiles);
+
+  LogSyncGroup group(GetTestDataDirectory());
+  ASSERT_OK(group.Init());
+  SyncConcurrently(&group);
+
+  // Every request is satisfied either by its own sync, or by a flush followed by a syncfs.
+  int num_syncfs_requests = 0;
+  for (auto& file : files_) {
+    ASSERT_EQ(kSyncsPerFile, file->num_syncs.load() + file->num_flushes.load());
+    num_syncfs_requests += file->num_flushes.load();
+  }
+  LOG(INFO) << "Groups: " << group.TEST_num_groups()
+            << ", requests synced by syncfs: " << num_syncfs_requests;
+  // Each syncfs() covers at least log_group_syncfs_min_logs requests.
+  ASSERT_LE(group.TEST_num_groups() * FLAGS_log_group_syncfs_min_logs,
+            static_cast<size_t>(num_syncfs_requests));
+}
+
+}  // namespace log
+}  // namespace yb
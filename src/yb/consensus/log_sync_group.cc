@@ -0,0 +1,186 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/log_sync_group.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/utsname.h>
+#endif
+
+#include <glog/logging.h>
+
+#include "yb/util/env.h"
+#include "yb/util/errno.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/stopwatch.h"
+#include "yb/util/thread_restrictions.h"
+
+DEFINE_int32(log_group_syncfs_min_logs, 0,
+             "Minimal number of tablet logs in a WAL sync group to make them durable with a single "
+             "syncfs() on the WAL root directory instead of syncing each log separately. "
+             "syncfs() flushes every dirty file of the filesystem that contains the WAL root, not "
+             "only the logs, so it should only be used when WALs have a dedicated filesystem. "
+             "Ignored on Linux kernels older than 5.8, whose syncfs() does not report writeback "
+             "errors. 0 disables syncfs().");
+TAG_FLAG(log_group_syncfs_min_logs, advanced);
+
+DECLARE_bool(never_fsync);
+
+namespace yb {
+namespace log {
+
+struct LogSyncGroup::Group {
+  std::vector<WritableFile*> files;
+  bool done = false;
+  // Whether files of the group were made durable with syncfs(), otherwise each caller syncs its
+  // own file.
+  bool synced_by_syncfs = false;
+  Status status;
+};
+
+LogSyncGroup::LogSyncGroup(std::string wal_root_dir)
+    : wal_root_dir_(std::move(wal_root_dir)) {
+}
+
+LogSyncGroup::~LogSyncGroup() {
+  if (dir_fd_ >= 0) {
+    close(dir_fd_);
+  }
+}
+
+namespace {
+
+#if defined(__linux__)
+// Before Linux 5.8 syncfs() returned success even if writeback of some file failed.
+bool SyncfsReportsErrors() {
+  struct utsname uts_name;
+  if (uname(&uts_name) == -1) {
+    LOG(WARNING) << "Failed to get kernel version: " << ErrnoToString(errno);
+    return false;
+  }
+  int major_version = 0;
+  int minor_version = 0;
+  if (sscanf(uts_name.release, "%d.%d", &major_version, &minor_version) != 2) {
+    LOG(WARNING) << "Failed to parse kernel version: " << uts_name.release;
+    return false;
+  }
+  return major_version * 1000 + minor_version >= 5008;
+}
+#endif
+
+} // namespace
+
+Status LogSyncGroup::Init() {
+#if defined(__linux__)
+  if (!SyncfsReportsErrors()) {
+    LOG_IF(WARNING, FLAGS_log_group_syncfs_min_logs > 0)
+        << "syncfs() does not report writeback errors on this kernel, syncing each log of "
+        << wal_root_dir_ << " separately";
+    return Status::OK();
+  }
+  dir_fd_ = open(wal_root_dir_.c_str(), O_DIRECTORY | O_RDONLY);
+  if (dir_fd_ < 0) {
+    return STATUS(IOError, "Failed to open WAL root dir " + wal_root_dir_,
+                  ErrnoToString(errno), errno);
+  }
+#endif
+  return Status::OK();
+}
+
+bool LogSyncGroup::SyncfsEnabled() const {
+  return dir_fd_ >= 0 && FLAGS_log_group_syncfs_min_logs > 0;
+}
+
+Status LogSyncGroup::Sync(WritableFile* file) {
+  if (!SyncfsEnabled()) {
+    return file->Sync();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!pending_group_) {
+    pending_group_ = std::make_shared<Group>();
+  }
+  auto group = pending_group_;
+  group->files.push_back(file);
+
+  while (!group->done) {
+    if (!sync_in_progress_) {
+      // Our group is still pending, since a group is only taken when no sync is in progress.
+      DCHECK_EQ(group, pending_group_);
+      pending_group_.reset();
+      if (group->files.size() < static_cast<size_t>(FLAGS_log_group_syncfs_min_logs)) {
+        // syncfs() is not worth it for a few logs, so their callers sync them in parallel.
+        group->done = true;
+        cond_.notify_all();
+        break;
+      }
+      sync_in_progress_ = true;
+      lock.unlock();
+      auto status = SyncfsGroup(*group);
+      lock.lock();
+      group->status = std::move(status);
+      group->synced_by_syncfs = true;
+      group->done = true;
+      sync_in_progress_ = false;
+      ++num_groups_;
+      cond_.notify_all();
+      break;
+    }
+    cond_.wait(lock);
+  }
+
+  if (!group->synced_by_syncfs) {
+    lock.unlock();
+    return file->Sync();
+  }
+  return group->status;
+}
+
+Status LogSyncGroup::SyncfsGroup(const Group& group) {
+  ThreadRestrictions::AssertIOAllowed();
+#if defined(__linux__)
+  // Start writeback of every log first (for O_DIRECT logs this writes out the buffered tail), so
+  // that a single syncfs() waits for all of them and flushes the device cache once.
+  for (auto* file : group.files) {
+    RETURN_NOT_OK(file->Flush(WritableFile::FLUSH_ASYNC));
+  }
+  if (FLAGS_never_fsync) {
+    return Status::OK();
+  }
+  LOG_SLOW_EXECUTION(WARNING, 50, "syncfs of WAL group took a long time") {
+    if (syncfs(dir_fd_) != 0) {
+      return STATUS(IOError, "syncfs failed for WAL root dir " + wal_root_dir_,
+                    ErrnoToString(errno), errno);
+    }
+  }
+  VLOG(2) << "Synced " << group.files.size() << " logs in " << wal_root_dir_ << " with syncfs";
+#endif
+  return Status::OK();
+}
+
+size_t LogSyncGroup::TEST_num_groups() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_groups_;
+}
+
+size_t LogSyncGroup::TEST_pending_group_size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_group_ ? pending_group_->files.size() : 0;
+}
+
+}  // namespace log
+}  // namespace yb
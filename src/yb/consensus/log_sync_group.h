@@ -0,0 +1,93 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_LOG_SYNC_GROUP_H
+#define YB_CONSENSUS_LOG_SYNC_GROUP_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+class WritableFile;
+
+namespace log {
+
+// Group commit of WAL syncs across all tablet replicas whose WALs live under the same WAL root
+// directory (normally one per disk).
+//
+// Each Log still owns its own segments. Grouping is only used when enabled by
+// log_group_syncfs_min_logs, otherwise every log syncs its own file, in parallel with other logs.
+// While one syncfs() is in progress, syncs requested by other logs accumulate into the next group,
+// and the next caller to find the group idle takes the whole group. When the group is large enough,
+// its files are flushed asynchronously and made durable with a single syncfs() on the WAL root,
+// instead of one fsync per tablet. Logs of a smaller group are synced by their own callers in
+// parallel. syncfs() covers the whole filesystem of the WAL root, so it also waits for writeback of
+// unrelated files there.
+class LogSyncGroup {
+ public:
+  explicit LogSyncGroup(std::string wal_root_dir);
+  ~LogSyncGroup();
+
+  // Opens the WAL root directory that is used for syncfs(), if the kernel's syncfs() reports
+  // writeback errors.
+  CHECKED_STATUS Init();
+
+  // Makes all data appended to file durable. Blocks until the group that contains this request
+  // has been synced, and returns the status of that group.
+  CHECKED_STATUS Sync(WritableFile* file);
+
+  // Whether logs could be made durable with syncfs(), i.e. it is enabled and reports errors.
+  bool SyncfsEnabled() const;
+
+  const std::string& wal_root_dir() const {
+    return wal_root_dir_;
+  }
+
+  // Number of groups synced with syncfs() so far, for tests.
+  size_t TEST_num_groups() const;
+
+  // Number of logs in the group that new sync requests join, for tests.
+  size_t TEST_pending_group_size() const;
+
+ private:
+  struct Group;
+
+  CHECKED_STATUS SyncfsGroup(const Group& group);
+
+  const std::string wal_root_dir_;
+
+  // Descriptor of wal_root_dir_ used for syncfs(), or -1 if syncfs() is not available.
+  int dir_fd_ = -1;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+
+  // Group that new sync requests join. Taken by the next caller that finds no sync in progress.
+  std::shared_ptr<Group> pending_group_;
+  bool sync_in_progress_ = false;
+  size_t num_groups_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(LogSyncGroup);
+};
+
+}  // namespace log
+}  // namespace yb
+
+#endif // YB_CONSENSUS_LOG_SYNC_GROUP_H
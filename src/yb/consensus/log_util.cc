@@ -241,18 +241,12 @@ Status ReadableLogSegment::RebuildFooterByScanning() {
   // Rebuild the min/max replicate index (by scanning)
   for (const auto& entry : read_entries.entries) {
     if (entry->has_replicate()) {
-      int64_t index = entry->replicate().id().index();
-      // TODO: common code with Log::UpdateFooterForBatch
-      if (!footer_.has_min_replicate_index() ||
-          index < footer_.min_replicate_index()) {
-        footer_.set_min_replicate_index(index);
-      }
-      if (!footer_.has_max_replicate_index() ||
-          index > footer_.max_replicate_index()) {
-        footer_.set_max_replicate_index(index);
-      }
+      UpdateSegmentFooterForReplicate(entry->replicate(), &footer_);
     }
   }
+  for (const auto& metadata : read_entries.entry_metadata) {
+    UpdateSegmentFooterForEntryTime(metadata.entry_time, &footer_);
+  }
 
   DCHECK(footer_.IsInitialized());
   DCHECK_EQ(read_entries.entries.size(), footer_.num_entries());
@@ -853,6 +847,39 @@ LogEntryBatchPB CreateBatchFromAllocatedOperations(const ReplicateMsgs& msgs) {
   return result;
 }
 
+void UpdateSegmentFooterForReplicate(
+    const consensus::ReplicateMsg& replicate, LogSegmentFooterPB* footer) {
+  int64_t index = replicate.id().index();
+  if (!footer->has_min_replicate_index() || index < footer->min_replicate_index()) {
+    footer->set_min_replicate_index(index);
+  }
+  if (!footer->has_max_replicate_index() || index > footer->max_replicate_index()) {
+    footer->set_max_replicate_index(index);
+  }
+  if (replicate.has_hybrid_time()) {
+    uint64_t hybrid_time = replicate.hybrid_time();
+    if (!footer->has_min_replicate_hybrid_time() ||
+        hybrid_time < footer->min_replicate_hybrid_time()) {
+      footer->set_min_replicate_hybrid_time(hybrid_time);
+    }
+    if (!footer->has_max_replicate_hybrid_time() ||
+        hybrid_time > footer->max_replicate_hybrid_time()) {
+      footer->set_max_replicate_hybrid_time(hybrid_time);
+    }
+  }
+  if (replicate.has_monotonic_counter() &&
+      replicate.monotonic_counter() > footer->max_monotonic_counter()) {
+    footer->set_max_monotonic_counter(replicate.monotonic_counter());
+  }
+}
+
+void UpdateSegmentFooterForEntryTime(
+    RestartSafeCoarseTimePoint entry_time, LogSegmentFooterPB* footer) {
+  if (entry_time.ToUInt64() > footer->max_entry_mono_time()) {
+    footer->set_max_entry_mono_time(entry_time.ToUInt64());
+  }
+}
+
 bool IsLogFileName(const string& fname) {
   if (HasPrefixString(fname, ".")) {
     // Hidden file or ./..
@@ -77,6 +77,7 @@ extern const size_t kEntryHeaderSize;
 extern const int kLogMajorVersion;
 extern const int kLogMinorVersion;
 
+class LogSyncGroup;
 class ReadableLogSegment;
 
 // Options for the State Machine/Write Ahead Log
@@ -106,6 +107,9 @@ struct LogOptions {
 
   std::string peer_uuid;
 
+  // If set, syncs are coalesced with the other logs under the same WAL root directory.
+  LogSyncGroup* sync_group = nullptr;
+
   LogOptions();
 };
 
@@ -384,6 +388,10 @@ class WritableLogSegment {
     return writable_file_->Sync();
   }
 
+  void SyncAsync(StdStatusCallback callback) {
+    writable_file_->SyncAsync(std::move(callback));
+  }
+
   // Returns true if the segment header has already been written to disk.
   bool IsHeaderWritten() const {
     return is_header_written_;
@@ -416,12 +424,12 @@ class WritableLogSegment {
     return written_offset_;
   }
 
- private:
-
   const std::shared_ptr<WritableFile>& writable_file() const {
     return writable_file_;
   }
 
+ private:
+
   // The path to the log file.
   const std::string path_;
 
@@ -453,6 +461,14 @@ using consensus::ReplicateMsgs;
 // in some hot paths.
 LogEntryBatchPB CreateBatchFromAllocatedOperations(const ReplicateMsgs& msgs);
 
+// Updates the index, hybrid time and monotonic counter bounds of 'footer' with 'replicate'.
+void UpdateSegmentFooterForReplicate(
+    const consensus::ReplicateMsg& replicate, LogSegmentFooterPB* footer);
+
+// Updates the max entry mono time of 'footer' with the time of an entry batch.
+void UpdateSegmentFooterForEntryTime(
+    RestartSafeCoarseTimePoint entry_time, LogSegmentFooterPB* footer);
+
 // Checks if 'fname' is a correctly formatted name of log segment file.
 bool IsLogFileName(const std::string& fname);
 
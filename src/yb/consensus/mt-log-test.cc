@@ -50,6 +50,11 @@ DEFINE_int32(num_writer_threads, 1, "Number of threads writing to the log");
 DEFINE_int32(num_batches_per_thread, 2000, "Number of batches per thread");
 DEFINE_int32(num_ops_per_batch_avg, 5, "Target average number of ops per batch");
 
+DECLARE_bool(o_direct_use_io_uring);
+
+METRIC_DECLARE_histogram(log_group_commit_latency);
+METRIC_DECLARE_histogram(log_sync_latency);
+
 namespace yb {
 namespace log {
 
@@ -191,5 +196,30 @@ TEST_F(MultiThreadedLogTest, TestAppends) {
   ASSERT_TRUE(std::is_sorted(ids.begin(), ids.end()));
 }
 
+class DurableLogTest : public MultiThreadedLogTest, public testing::WithParamInterface<bool> {
+};
+
+// Benchmark of appends with durable WAL writes, done with pwritev or through io_uring.
+TEST_P(DurableLogTest, Appends) {
+  FLAGS_o_direct_use_io_uring = GetParam();
+  options_.durable_wal_write = true;
+  BuildLog();
+  const char* const method = GetParam() ? "through io_uring" : "with pwritev";
+  LOG_TIMING(INFO, strings::Substitute("inserting $0 durable batches $1",
+                                      FLAGS_num_writer_threads * FLAGS_num_batches_per_thread,
+                                      method)) {
+    ASSERT_NO_FATALS(Run());
+  }
+  auto group_commit_latency = METRIC_log_group_commit_latency.Instantiate(metric_entity_);
+  auto sync_latency = METRIC_log_sync_latency.Instantiate(metric_entity_);
+  LOG(INFO) << "Appended " << method << ": " << group_commit_latency->TotalCount()
+            << " groups, mean group commit latency: "
+            << group_commit_latency->MeanValueForTests() << "us, mean sync latency: "
+            << sync_latency->MeanValueForTests() << "us";
+  ASSERT_OK(log_->Close());
+}
+
+INSTANTIATE_TEST_CASE_P(IoUring, DurableLogTest, ::testing::Bool());
+
 } // namespace log
 } // namespace yb
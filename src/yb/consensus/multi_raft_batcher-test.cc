@@ -0,0 +1,233 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "yb/consensus/consensus.service.h"
+#include "yb/consensus/multi_raft_batcher.h"
+#include "yb/consensus/opid_util.h"
+
+#include "yb/rpc/proxy.h"
+#include "yb/rpc/rpc-test-base.h"
+#include "yb/rpc/rpc_context.h"
+
+#include "yb/util/countdown_latch.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(multi_raft_heartbeat_window_ms);
+DECLARE_int32(multi_raft_batch_size);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+YB_DEFINE_ENUM(MultiRaftMode, (kSupported)(kMissingResponse)(kUnsupported));
+
+// Answers heartbeats with the tablet id as responder uuid, so that tests could check that every
+// caller got its own response.
+class FakeConsensusService : public ConsensusServiceIf {
+ public:
+  FakeConsensusService(const scoped_refptr<MetricEntity>& entity, MultiRaftMode mode)
+      : ConsensusServiceIf(entity), mode_(mode) {}
+
+  void UpdateConsensus(const ConsensusRequestPB* req, ConsensusResponsePB* resp,
+                       rpc::RpcContext context) override {
+    ++num_single_calls_;
+    resp->set_responder_uuid(req->tablet_id());
+    context.RespondSuccess();
+  }
+
+  void MultiRaftUpdateConsensus(const MultiRaftConsensusRequestPB* req,
+                                MultiRaftConsensusResponsePB* resp,
+                                rpc::RpcContext context) override {
+    if (mode_ == MultiRaftMode::kUnsupported) {
+      // The same error a server without this method responds with.
+      context.RespondRpcFailure(rpc::ErrorStatusPB::ERROR_NO_SUCH_METHOD,
+                                STATUS(InvalidArgument, "Bad method"));
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch_sizes_.push_back(req->consensus_request_size());
+    }
+    auto num_responses = req->consensus_request_size();
+    if (mode_ == MultiRaftMode::kMissingResponse) {
+      --num_responses;
+    }
+    for (int i = 0; i != num_responses; ++i) {
+      resp->add_consensus_response()->set_responder_uuid(req->consensus_request(i).tablet_id());
+    }
+    context.RespondSuccess();
+  }
+
+#define FAKE_CONSENSUS_SERVICE_UNSUPPORTED(method, request, response) \
+  void method(const request* req, response* resp, rpc::RpcContext context) override { \
+    context.RespondFailure(STATUS(NotSupported, #method)); \
+  }
+
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(RequestConsensusVote, VoteRequestPB, VoteResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(ChangeConfig, ChangeConfigRequestPB, ChangeConfigResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      GetNodeInstance, GetNodeInstanceRequestPB, GetNodeInstanceResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      RunLeaderElection, RunLeaderElectionRequestPB, RunLeaderElectionResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      LeaderElectionLost, LeaderElectionLostRequestPB, LeaderElectionLostResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      LeaderStepDown, LeaderStepDownRequestPB, LeaderStepDownResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(GetLastOpId, GetLastOpIdRequestPB, GetLastOpIdResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      GetConsensusState, GetConsensusStateRequestPB, GetConsensusStateResponsePB);
+  FAKE_CONSENSUS_SERVICE_UNSUPPORTED(
+      StartRemoteBootstrap, StartRemoteBootstrapRequestPB, StartRemoteBootstrapResponsePB);
+
+#undef FAKE_CONSENSUS_SERVICE_UNSUPPORTED
+
+  std::vector<int> batch_sizes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batch_sizes_;
+  }
+
+  int num_single_calls() const {
+    return num_single_calls_.load();
+  }
+
+ private:
+  const MultiRaftMode mode_;
+  std::atomic<int> num_single_calls_{0};
+  std::mutex mutex_;
+  std::vector<int> batch_sizes_;
+};
+
+struct Heartbeat {
+  ConsensusResponsePB response;
+  Status status;
+};
+
+} // namespace
+
+class MultiRaftBatcherTest : public rpc::RpcTestBase {
+ protected:
+  void StartServer(MultiRaftMode mode) {
+    auto service = std::make_unique<FakeConsensusService>(metric_entity(), mode);
+    service_ = service.get();
+    test_server_.reset(new rpc::TestServer(std::move(service), CreateMessenger("TestServer")));
+    client_messenger_ = CreateMessenger("Client");
+    proxy_cache_ = std::make_unique<rpc::ProxyCache>(client_messenger_.get());
+    batcher_ = std::make_shared<MultiRaftHeartbeatBatcher>(
+        HostPort::FromBoundEndpoint(test_server_->bound_endpoint()), proxy_cache_.get(),
+        client_messenger_.get());
+  }
+
+  void TearDown() override {
+    batcher_.reset();
+    if (client_messenger_) {
+      client_messenger_->Shutdown();
+    }
+    test_server_.reset();
+    rpc::RpcTestBase::TearDown();
+  }
+
+  // Sends heartbeats for tablets with ids from 0 to num_heartbeats - 1 and waits for all of them.
+  std::vector<Heartbeat> SendHeartbeats(int num_heartbeats) {
+    std::vector<Heartbeat> heartbeats(num_heartbeats);
+    CountDownLatch latch(num_heartbeats);
+    for (int i = 0; i != num_heartbeats; ++i) {
+      ConsensusRequestPB request;
+      request.set_tablet_id(std::to_string(i));
+      request.set_caller_uuid("leader");
+      request.set_caller_term(1);
+      *request.mutable_committed_index() = MinimumOpId();
+      auto* heartbeat = &heartbeats[i];
+      batcher_->AddRequestToBatch(
+          request, &heartbeat->response, [heartbeat, &latch](const Status& status) {
+            heartbeat->status = status;
+            latch.CountDown();
+          });
+    }
+    EXPECT_TRUE(latch.WaitFor(MonoDelta::FromSeconds(10)));
+    return heartbeats;
+  }
+
+  std::unique_ptr<rpc::TestServer> test_server_;
+  FakeConsensusService* service_ = nullptr;
+  std::unique_ptr<rpc::Messenger> client_messenger_;
+  std::unique_ptr<rpc::ProxyCache> proxy_cache_;
+  MultiRaftHeartbeatBatcherPtr batcher_;
+};
+
+void CheckResponses(const std::vector<Heartbeat>& heartbeats) {
+  for (size_t i = 0; i != heartbeats.size(); ++i) {
+    ASSERT_OK(heartbeats[i].status);
+    ASSERT_EQ(std::to_string(i), heartbeats[i].response.responder_uuid());
+  }
+}
+
+TEST_F(MultiRaftBatcherTest, BatchingWindow) {
+  FLAGS_multi_raft_heartbeat_window_ms = 1000;
+  FLAGS_multi_raft_batch_size = 64;
+  StartServer(MultiRaftMode::kSupported);
+
+  auto start = MonoTime::Now();
+  auto heartbeats = SendHeartbeats(10);
+  // Nothing flushes the batch before the window ends.
+  ASSERT_GE(MonoTime::Now() - start, MonoDelta::FromMilliseconds(900));
+  ASSERT_NO_FATALS(CheckResponses(heartbeats));
+  ASSERT_EQ(std::vector<int>({10}), service_->batch_sizes());
+  ASSERT_EQ(0, service_->num_single_calls());
+}
+
+TEST_F(MultiRaftBatcherTest, FlushFullBatch) {
+  FLAGS_multi_raft_heartbeat_window_ms = 60000;
+  FLAGS_multi_raft_batch_size = 4;
+  StartServer(MultiRaftMode::kSupported);
+
+  // Heartbeats are sent as soon as the batch is full, long before the window ends.
+  auto heartbeats = SendHeartbeats(12);
+  ASSERT_NO_FATALS(CheckResponses(heartbeats));
+  ASSERT_EQ(std::vector<int>({4, 4, 4}), service_->batch_sizes());
+}
+
+TEST_F(MultiRaftBatcherTest, ResponseCountMismatch) {
+  FLAGS_multi_raft_heartbeat_window_ms = 60000;
+  FLAGS_multi_raft_batch_size = 3;
+  StartServer(MultiRaftMode::kMissingResponse);
+
+  auto heartbeats = SendHeartbeats(3);
+  for (const auto& heartbeat : heartbeats) {
+    ASSERT_TRUE(heartbeat.status.IsIllegalState()) << heartbeat.status;
+    ASSERT_FALSE(heartbeat.response.has_responder_uuid());
+  }
+}
+
+TEST_F(MultiRaftBatcherTest, FallbackToSingleHeartbeats) {
+  FLAGS_multi_raft_heartbeat_window_ms = 60000;
+  FLAGS_multi_raft_batch_size = 3;
+  StartServer(MultiRaftMode::kUnsupported);
+
+  // The first batch is rejected and resent as separate heartbeats.
+  auto heartbeats = SendHeartbeats(3);
+  ASSERT_NO_FATALS(CheckResponses(heartbeats));
+  ASSERT_EQ(3, service_->num_single_calls());
+
+  // Later heartbeats are sent right away, without waiting for the window.
+  heartbeats = SendHeartbeats(2);
+  ASSERT_NO_FATALS(CheckResponses(heartbeats));
+  ASSERT_EQ(5, service_->num_single_calls());
+}
+
+} // namespace consensus
+} // namespace yb
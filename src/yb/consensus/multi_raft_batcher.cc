@@ -0,0 +1,205 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <glog/logging.h>
+
+#include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.proxy.h"
+#include "yb/consensus/consensus_meta.h"
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/util/debug-util.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_bool(enable_multi_raft_heartbeat_batcher, false,
+            "If true, heartbeats that tablet leaders send to the same tablet server are combined "
+            "into a single MultiRaftUpdateConsensus RPC.");
+TAG_FLAG(enable_multi_raft_heartbeat_batcher, advanced);
+
+DEFINE_int32(multi_raft_heartbeat_window_ms, 5,
+             "Maximal time a heartbeat waits for other heartbeats to the same tablet server before "
+             "the batch is sent.");
+TAG_FLAG(multi_raft_heartbeat_window_ms, advanced);
+
+DEFINE_int32(multi_raft_batch_size, 64,
+             "Maximal number of heartbeats sent in a single MultiRaftUpdateConsensus RPC.");
+TAG_FLAG(multi_raft_batch_size, advanced);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+namespace yb {
+namespace consensus {
+
+struct MultiRaftHeartbeatBatcher::Batch {
+  struct ResponseData {
+    ConsensusResponsePB* response;
+    MultiRaftHeartbeatCallback callback;
+  };
+
+  uint64_t id = 0;
+  MultiRaftConsensusRequestPB request;
+  MultiRaftConsensusResponsePB response;
+  rpc::RpcController controller;
+  std::vector<ResponseData> response_data;
+};
+
+struct MultiRaftHeartbeatBatcher::SingleRequest {
+  ConsensusRequestPB request;
+  rpc::RpcController controller;
+};
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(const HostPort& hostport,
+                                                     rpc::ProxyCache* proxy_cache,
+                                                     rpc::Messenger* messenger)
+    : hostport_(hostport),
+      messenger_(messenger),
+      consensus_proxy_(std::make_unique<ConsensusServiceProxy>(proxy_cache, hostport)) {
+}
+
+MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() = default;
+
+void MultiRaftHeartbeatBatcher::AddRequestToBatch(const ConsensusRequestPB& request,
+                                                  ConsensusResponsePB* response,
+                                                  MultiRaftHeartbeatCallback callback) {
+  uint64_t batch_id;
+  bool schedule_flush = false;
+  bool flush_now = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (multi_raft_unsupported_) {
+      lock.unlock();
+      SendSingleRequest(request, response, std::move(callback));
+      return;
+    }
+    if (!current_batch_) {
+      current_batch_ = std::make_shared<Batch>();
+      current_batch_->id = ++next_batch_id_;
+      schedule_flush = true;
+    }
+    auto& batch = *current_batch_;
+    *batch.request.add_consensus_request() = request;
+    batch.response_data.push_back({response, std::move(callback)});
+    batch_id = batch.id;
+    flush_now = batch.request.consensus_request_size() >= FLAGS_multi_raft_batch_size;
+  }
+
+  if (flush_now) {
+    FlushBatch(batch_id);
+  } else if (schedule_flush) {
+    auto self = shared_from_this();
+    // Scheduled task is also invoked when messenger is shutting down, in which case the batch RPC
+    // fails and every caller gets an error.
+    auto task_id = messenger_->ScheduleOnReactor(
+        [self, batch_id](const Status&) { self->FlushBatch(batch_id); },
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_window_ms),
+        SOURCE_LOCATION(), messenger_);
+    if (task_id == rpc::kInvalidTaskId) {
+      FlushBatch(batch_id);
+    }
+  }
+}
+
+void MultiRaftHeartbeatBatcher::FlushBatch(uint64_t batch_id) {
+  std::shared_ptr<Batch> batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_batch_ || current_batch_->id != batch_id) {
+      // Already sent because it became full.
+      return;
+    }
+    batch.swap(current_batch_);
+  }
+
+  VLOG(3) << "Sending " << batch->request.consensus_request_size() << " heartbeats to "
+          << hostport_;
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  auto self = shared_from_this();
+  consensus_proxy_->MultiRaftUpdateConsensusAsync(
+      batch->request, &batch->response, &batch->controller,
+      [self, batch] { self->ProcessResponse(batch); });
+}
+
+void MultiRaftHeartbeatBatcher::ProcessResponse(const std::shared_ptr<Batch>& batch) {
+  Status status = batch->controller.status();
+  const auto* error = batch->controller.error_response();
+  if (status.IsRemoteError() && error &&
+      error->code() == rpc::ErrorStatusPB::ERROR_NO_SUCH_METHOD) {
+    LOG(INFO) << hostport_ << " does not support MultiRaftUpdateConsensus, sending heartbeats "
+              << "separately";
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      multi_raft_unsupported_ = true;
+    }
+    for (int i = 0; i != batch->request.consensus_request_size(); ++i) {
+      auto& data = batch->response_data[i];
+      SendSingleRequest(batch->request.consensus_request(i), data.response,
+                        std::move(data.callback));
+    }
+    return;
+  }
+
+  if (status.ok() &&
+      batch->response.consensus_response_size() != batch->request.consensus_request_size()) {
+    status = STATUS_FORMAT(IllegalState, "Expected $0 consensus responses, but got $1",
+                           batch->request.consensus_request_size(),
+                           batch->response.consensus_response_size());
+  }
+  for (size_t i = 0; i != batch->response_data.size(); ++i) {
+    auto& data = batch->response_data[i];
+    if (status.ok()) {
+      data.response->Swap(batch->response.mutable_consensus_response(i));
+    }
+    data.callback(status);
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendSingleRequest(const ConsensusRequestPB& request,
+                                                  ConsensusResponsePB* response,
+                                                  MultiRaftHeartbeatCallback callback) {
+  auto single_request = std::make_shared<SingleRequest>();
+  single_request->request = request;
+  single_request->controller.set_timeout(
+      MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  consensus_proxy_->UpdateConsensusAsync(
+      single_request->request, response, &single_request->controller,
+      [single_request, callback = std::move(callback)] {
+        callback(single_request->controller.status());
+      });
+}
+
+MultiRaftManager::MultiRaftManager(rpc::Messenger* messenger,
+                                   rpc::ProxyCache* proxy_cache,
+                                   CloudInfoPB local_peer)
+    : messenger_(messenger), proxy_cache_(proxy_cache), local_peer_(std::move(local_peer)) {
+}
+
+MultiRaftHeartbeatBatcherPtr MultiRaftManager::AddOrGetBatcher(const RaftPeerPB& remote_peer) {
+  if (!FLAGS_enable_multi_raft_heartbeat_batcher) {
+    return nullptr;
+  }
+
+  auto hostport = HostPortFromPB(DesiredHostPort(remote_peer, local_peer_));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& weak_batcher = batchers_[hostport];
+  auto batcher = weak_batcher.lock();
+  if (!batcher) {
+    batcher = std::make_shared<MultiRaftHeartbeatBatcher>(hostport, proxy_cache_, messenger_);
+    weak_batcher = batcher;
+  }
+  return batcher;
+}
+
+}  // namespace consensus
+}  // namespace yb
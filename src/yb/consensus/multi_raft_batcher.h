@@ -0,0 +1,109 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/common/common.pb.h"
+#include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus_fwd.h"
+#include "yb/gutil/macros.h"
+#include "yb/rpc/rpc_fwd.h"
+#include "yb/util/net/net_util.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace consensus {
+
+typedef std::function<void(const Status&)> MultiRaftHeartbeatCallback;
+
+// Coalesces heartbeats that leaders of different tablets send to the same tablet server into a
+// single MultiRaftUpdateConsensus RPC.
+//
+// Heartbeats are collected for up to multi_raft_heartbeat_window_ms, or until
+// multi_raft_batch_size heartbeats are pending, and then sent together. Each response is copied
+// back to its caller, and the callback is invoked with the status of the batch RPC.
+//
+// If the tablet server does not know MultiRaftUpdateConsensus, i.e. runs an older version, the
+// heartbeats are resent and from then on sent with a separate UpdateConsensus each.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(const HostPort& hostport,
+                            rpc::ProxyCache* proxy_cache,
+                            rpc::Messenger* messenger);
+  ~MultiRaftHeartbeatBatcher();
+
+  // Adds a copy of request to the current batch. response should stay alive until callback is
+  // invoked.
+  void AddRequestToBatch(const ConsensusRequestPB& request,
+                         ConsensusResponsePB* response,
+                         MultiRaftHeartbeatCallback callback);
+
+ private:
+  struct Batch;
+  struct SingleRequest;
+
+  // Sends the current batch, if it is still the one with the specified id.
+  void FlushBatch(uint64_t batch_id);
+
+  void ProcessResponse(const std::shared_ptr<Batch>& batch);
+
+  // Sends the request with a regular UpdateConsensus RPC.
+  void SendSingleRequest(const ConsensusRequestPB& request,
+                         ConsensusResponsePB* response,
+                         MultiRaftHeartbeatCallback callback);
+
+  const HostPort hostport_;
+  rpc::Messenger* const messenger_;
+  std::unique_ptr<ConsensusServiceProxy> consensus_proxy_;
+
+  std::mutex mutex_;
+  std::shared_ptr<Batch> current_batch_;
+  uint64_t next_batch_id_ = 0;
+  // Set when the tablet server responded that it does not know MultiRaftUpdateConsensus.
+  bool multi_raft_unsupported_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftHeartbeatBatcher);
+};
+
+// Keeps a single heartbeat batcher per remote tablet server, shared by all local tablet leaders.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(rpc::Messenger* messenger, rpc::ProxyCache* proxy_cache, CloudInfoPB local_peer);
+
+  // Returns the batcher for the peer, or nullptr if heartbeat batching is disabled.
+  MultiRaftHeartbeatBatcherPtr AddOrGetBatcher(const RaftPeerPB& remote_peer);
+
+ private:
+  rpc::Messenger* const messenger_;
+  rpc::ProxyCache* const proxy_cache_;
+  const CloudInfoPB local_peer_;
+
+  std::mutex mutex_;
+  // Batchers are owned by peer proxies, so a batcher is destroyed when no leader sends heartbeats
+  // to its tablet server anymore.
+  std::unordered_map<HostPort, std::weak_ptr<MultiRaftHeartbeatBatcher>, HostPortHash> batchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftManager);
+};
+
+}  // namespace consensus
+}  // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
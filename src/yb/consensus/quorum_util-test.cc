@@ -71,5 +71,33 @@ TEST(QuorumUtilTest, TestMemberExtraction) {
   ASSERT_EQ("B", peer_pb.permanent_uuid());
 }
 
+TEST(QuorumUtilTest, TestWitness) {
+  RaftConfigPB config;
+  SetPeerInfo("A", RaftPeerPB::VOTER, config.add_peers());
+  SetPeerInfo("B", RaftPeerPB::VOTER, config.add_peers());
+  SetPeerInfo("C", RaftPeerPB::WITNESS, config.add_peers());
+  SetPeerInfo("D", RaftPeerPB::PRE_WITNESS, config.add_peers());
+
+  // Witness votes, but pre-witness does not.
+  ASSERT_EQ(3, CountVoters(config));
+  ASSERT_EQ(1, CountVotersInTransition(config));
+  ASSERT_EQ(1, CountServersInTransition(config));
+  ASSERT_TRUE(IsRaftConfigVoter("C", config));
+  ASSERT_TRUE(IsRaftConfigWitness("C", config));
+  ASSERT_FALSE(IsRaftConfigVoter("D", config));
+  ASSERT_FALSE(IsRaftConfigWitness("A", config));
+
+  ConsensusStatePB cstate;
+  *cstate.mutable_config() = config;
+  cstate.set_current_term(1);
+  cstate.set_leader_uuid("A");
+  ASSERT_EQ(RaftPeerPB::FOLLOWER, GetConsensusRole("C", cstate));
+  ASSERT_EQ(RaftPeerPB::LEARNER, GetConsensusRole("D", cstate));
+
+  // Witness could not be a leader.
+  cstate.set_leader_uuid("C");
+  ASSERT_EQ(RaftPeerPB::NON_PARTICIPANT, GetConsensusRole("C", cstate));
+}
+
 } // namespace consensus
 } // namespace yb
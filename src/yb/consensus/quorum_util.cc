@@ -56,10 +56,27 @@ bool IsRaftConfigMember(const std::string& uuid, const RaftConfigPB& config) {
   return false;
 }
 
+bool IsVotingMemberType(RaftPeerPB::MemberType member_type) {
+  return member_type == RaftPeerPB::VOTER || member_type == RaftPeerPB::WITNESS;
+}
+
+bool IsWitnessMemberType(RaftPeerPB::MemberType member_type) {
+  return member_type == RaftPeerPB::WITNESS || member_type == RaftPeerPB::PRE_WITNESS;
+}
+
 bool IsRaftConfigVoter(const std::string& uuid, const RaftConfigPB& config) {
   for (const RaftPeerPB& peer : config.peers()) {
     if (peer.permanent_uuid() == uuid) {
-      return peer.member_type() == RaftPeerPB::VOTER;
+      return IsVotingMemberType(peer.member_type());
+    }
+  }
+  return false;
+}
+
+bool IsRaftConfigWitness(const std::string& uuid, const RaftConfigPB& config) {
+  for (const RaftPeerPB& peer : config.peers()) {
+    if (peer.permanent_uuid() == uuid) {
+      return peer.member_type() == RaftPeerPB::WITNESS;
     }
   }
   return false;
@@ -147,16 +164,18 @@ bool RemoveFromRaftConfig(RaftConfigPB* config, const ChangeConfigRequestPB& req
 }
 
 int CountVoters(const RaftConfigPB& config) {
-  return CountMemberType(config, RaftPeerPB::VOTER);
+  return CountMemberType(config, RaftPeerPB::VOTER) + CountMemberType(config, RaftPeerPB::WITNESS);
 }
 
 int CountVotersInTransition(const RaftConfigPB& config) {
-  return CountMemberType(config, RaftPeerPB::PRE_VOTER);
+  return CountMemberType(config, RaftPeerPB::PRE_VOTER) +
+      CountMemberType(config, RaftPeerPB::PRE_WITNESS);
 }
 
 int CountServersInTransition(const RaftConfigPB& config, const string& ignore_uuid) {
   return CountMemberType(config, RaftPeerPB::PRE_VOTER, ignore_uuid) +
-      CountMemberType(config, RaftPeerPB::PRE_OBSERVER, ignore_uuid);
+      CountMemberType(config, RaftPeerPB::PRE_OBSERVER, ignore_uuid) +
+      CountMemberType(config, RaftPeerPB::PRE_WITNESS, ignore_uuid);
 }
 
 int CountMemberType(const RaftConfigPB& config, const RaftPeerPB::MemberType member_type,
@@ -188,7 +207,7 @@ RaftPeerPB::MemberType GetConsensusMemberType(const std::string& permanent_uuid,
 RaftPeerPB::Role GetConsensusRole(const std::string& permanent_uuid,
                                   const ConsensusStatePB& cstate) {
   if (cstate.leader_uuid() == permanent_uuid) {
-    if (IsRaftConfigVoter(permanent_uuid, cstate.config())) {
+    if (GetConsensusMemberType(permanent_uuid, cstate) == RaftPeerPB::VOTER) {
       return RaftPeerPB::LEADER;
     }
     return RaftPeerPB::NON_PARTICIPANT;
@@ -197,12 +216,15 @@ RaftPeerPB::Role GetConsensusRole(const std::string& permanent_uuid,
   for (const RaftPeerPB& peer : cstate.config().peers()) {
     if (peer.permanent_uuid() == permanent_uuid) {
       switch (peer.member_type()) {
+        // A WITNESS votes like any other follower, it just never becomes a leader.
         case RaftPeerPB::VOTER:
+        case RaftPeerPB::WITNESS:
           return RaftPeerPB::FOLLOWER;
 
-        // PRE_VOTER, PRE_OBSERVER peers are considered LEARNERs.
+        // PRE_VOTER, PRE_OBSERVER, PRE_WITNESS peers are considered LEARNERs.
         case RaftPeerPB::PRE_VOTER:
         case RaftPeerPB::PRE_OBSERVER:
+        case RaftPeerPB::PRE_WITNESS:
           return RaftPeerPB::LEARNER;
 
         case RaftPeerPB::OBSERVER:
@@ -278,7 +300,7 @@ Status VerifyConsensusState(const ConsensusStatePB& cstate, RaftConfigState type
   RETURN_NOT_OK(VerifyRaftConfig(cstate.config(), type));
 
   if (cstate.has_leader_uuid() && !cstate.leader_uuid().empty()) {
-    if (!IsRaftConfigVoter(cstate.leader_uuid(), cstate.config())) {
+    if (GetConsensusMemberType(cstate.leader_uuid(), cstate) != RaftPeerPB::VOTER) {
       return STATUS(IllegalState,
           Substitute("Leader with UUID $0 is not a VOTER in the config! Consensus state: $1",
                      cstate.leader_uuid(), cstate.ShortDebugString()));
@@ -51,8 +51,15 @@ enum RaftConfigState {
   COMMITTED_QUORUM,
 };
 
+// Whether members of this type vote and count towards the majority, i.e. VOTER or WITNESS.
+bool IsVotingMemberType(RaftPeerPB::MemberType member_type);
+
+// Whether members of this type do not have data, i.e. WITNESS or PRE_WITNESS.
+bool IsWitnessMemberType(RaftPeerPB::MemberType member_type);
+
 bool IsRaftConfigMember(const std::string& uuid, const RaftConfigPB& config);
 bool IsRaftConfigVoter(const std::string& uuid, const RaftConfigPB& config);
+bool IsRaftConfigWitness(const std::string& uuid, const RaftConfigPB& config);
 
 // Get the specified member of the config.
 // Returns Status::NotFound if a member with the specified uuid could not be
@@ -88,13 +95,14 @@ int CountMemberType(const RaftConfigPB& config,
                     const RaftPeerPB::MemberType member_type,
                     const std::string& ignore_uuid = "");
 
-// Counts the number of voters in the configuration.
+// Counts the number of voters in the configuration, including witnesses.
 int CountVoters(const RaftConfigPB& config);
 
-// Counts the number of servers that are in transition (being bootstrapped) to become voters.
+// Counts the number of servers that are in transition (being bootstrapped) to become voters or
+// witnesses.
 int CountVotersInTransition(const RaftConfigPB& config);
 
-// Counts the number of servers that are in transition to become voters or observers.
+// Counts the number of servers that are in transition to become voters, observers or witnesses.
 int CountServersInTransition(const RaftConfigPB& config, const std::string& ignore_uuid = "");
 
 // Calculates size of a configuration majority based on # of voters.
@@ -30,6 +30,8 @@
 // under the License.
 //
 
+#include <thread>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -43,6 +45,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/server/logical_clock.h"
 #include "yb/util/async_util.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
 #include "yb/util/test_macros.h"
@@ -50,6 +53,7 @@
 #include "yb/tablet/preparer.h"
 
 DECLARE_bool(enable_leader_failure_detection);
+DECLARE_int32(consensus_wait_for_preceding_update_ms);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -801,5 +805,75 @@ TEST_F(RaftConsensusTest, TestResetRcvdFromCurrentLeaderOnNewTerm) {
   ASSERT_OPID_EQ(response.status().last_received_current_leader(), noop_opid);
 }
 
+// A follower postpones a request received before the preceding ops only when the request was
+// pipelined by the leader, otherwise a request that does not match the log is rejected right away.
+TEST_F(RaftConsensusTest, TestParkPipelinedUpdate) {
+  FLAGS_consensus_wait_for_preceding_update_ms = 60000;
+  SetUpConsensus(kMinimumTerm, 3);
+  SetUpGeneralExpectations();
+  ConsensusBootstrapInfo info;
+  ASSERT_OK(consensus_->Start(info));
+
+  const int64_t caller_term = 1;
+  const string caller_uuid = config_.peers(0).permanent_uuid();
+  ConsensusResponsePB response;
+
+  auto request = MakeConsensusRequest(caller_term, caller_uuid, MinimumOpId());
+  AddNoOpToConsensusRequest(&request, MakeOpId(caller_term, 1));
+  ASSERT_OK(consensus_->Update(&request, &response, CoarseBigDeadline()));
+  ASSERT_FALSE(response.status().has_error()) << response.ShortDebugString();
+
+  // Op 3 is received before op 2.
+  request = MakeConsensusRequest(caller_term, caller_uuid, MakeOpId(caller_term, 2));
+  AddNoOpToConsensusRequest(&request, MakeOpId(caller_term, 3));
+  ASSERT_FALSE(consensus_->ParkUpdate(request, CoarseBigDeadline(), [] {}));
+  response.Clear();
+  ASSERT_OK(consensus_->Update(&request, &response, CoarseBigDeadline()));
+  ASSERT_TRUE(response.status().has_error()) << response.ShortDebugString();
+  ASSERT_EQ(ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH, response.status().error().code());
+
+  // The same request, pipelined, is resumed when op 2 is received.
+  request.set_pipelined(true);
+  ConsensusResponsePB pipelined_response;
+  CountDownLatch pipelined_done(1);
+  auto resume = [this, &request, &pipelined_response, &pipelined_done] {
+    ASSERT_OK(consensus_->Update(&request, &pipelined_response, CoarseBigDeadline()));
+    pipelined_done.CountDown();
+  };
+  ASSERT_TRUE(consensus_->ParkUpdate(request, CoarseBigDeadline(), resume));
+  ASSERT_FALSE(pipelined_done.WaitFor(MonoDelta::FromMilliseconds(500)));
+
+  auto preceding_request = MakeConsensusRequest(
+      caller_term, caller_uuid, MakeOpId(caller_term, 1));
+  AddNoOpToConsensusRequest(&preceding_request, MakeOpId(caller_term, 2));
+  response.Clear();
+  ASSERT_OK(consensus_->Update(&preceding_request, &response, CoarseBigDeadline()));
+  ASSERT_FALSE(response.status().has_error()) << response.ShortDebugString();
+
+  ASSERT_TRUE(pipelined_done.WaitFor(MonoDelta::FromSeconds(30)));
+  ASSERT_FALSE(pipelined_response.status().has_error()) << pipelined_response.ShortDebugString();
+  ASSERT_OPID_EQ(pipelined_response.status().last_received(), MakeOpId(caller_term, 3));
+
+  // A pipelined request whose preceding ops are never received is resumed after the wait time,
+  // and rejected as not matching the log.
+  FLAGS_consensus_wait_for_preceding_update_ms = 100;
+  request = MakeConsensusRequest(caller_term, caller_uuid, MakeOpId(caller_term, 5));
+  AddNoOpToConsensusRequest(&request, MakeOpId(caller_term, 6));
+  request.set_pipelined(true);
+  pipelined_response.Clear();
+  CountDownLatch expired_done(1);
+  auto start = CoarseMonoClock::now();
+  ASSERT_TRUE(consensus_->ParkUpdate(
+      request, CoarseBigDeadline(), [this, &request, &pipelined_response, &expired_done] {
+    ASSERT_OK(consensus_->Update(&request, &pipelined_response, CoarseBigDeadline()));
+    expired_done.CountDown();
+  }));
+  ASSERT_TRUE(expired_done.WaitFor(MonoDelta::FromSeconds(30)));
+  ASSERT_GE(CoarseMonoClock::now() - start, 100ms);
+  ASSERT_TRUE(pipelined_response.status().has_error()) << pipelined_response.ShortDebugString();
+  ASSERT_EQ(ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH,
+            pipelined_response.status().error().code());
+}
+
 }  // namespace consensus
 }  // namespace yb
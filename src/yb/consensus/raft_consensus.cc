@@ -48,10 +48,12 @@
 #include "yb/consensus/peer_manager.h"
 #include "yb/consensus/quorum_util.h"
 #include "yb/consensus/replica_state.h"
+#include "yb/consensus/replicate_compression.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/human_readable.h"
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/periodic.h"
 #include "yb/server/clock.h"
 #include "yb/server/metadata.h"
@@ -193,6 +195,13 @@ DEFINE_test_flag(int32, log_change_config_every_n, 1, "How often to log change c
 
 DEFINE_bool(enable_lease_revocation, true, "Enables lease revocation mechanism");
 
+DEFINE_int32(consensus_wait_for_preceding_update_ms, 100,
+             "How long a follower postpones a request pipelined by the leader, when it is received "
+             "before the UpdateConsensus request with preceding ops. After this time the request "
+             "is rejected as not matching the log.");
+TAG_FLAG(consensus_wait_for_preceding_update_ms, advanced);
+TAG_FLAG(consensus_wait_for_preceding_update_ms, runtime);
+
 DEFINE_bool(quick_leader_election_on_create, true, "Do we trigger quick leader elections on table "
                                                    "creation.");
 TAG_FLAG(quick_leader_election_on_create, advanced);
@@ -224,9 +233,10 @@ shared_ptr<RaftConsensus> RaftConsensus::Create(
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     ThreadPool* raft_pool,
-    RetryableRequests* retryable_requests) {
+    RetryableRequests* retryable_requests,
+    MultiRaftManager* multi_raft_manager) {
   gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(
-      messenger, proxy_cache, local_peer_pb.cloud_info()));
+      messenger, proxy_cache, local_peer_pb.cloud_info(), multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -237,6 +247,7 @@ shared_ptr<RaftConsensus> RaftConsensus::Create(
                            local_peer_pb,
                            options.tablet_id,
                            clock,
+                           raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL),
                            raft_pool->NewToken(ThreadPool::ExecutionMode::SERIAL)));
 
   DCHECK(local_peer_pb.has_permanent_uuid());
@@ -458,6 +469,12 @@ Status RaftConsensus::DoStartElection(const LeaderElectionData& data, PreElected
                             << ", active_role=" << active_role;
       return Status::OK();
     }
+    if (IsRaftConfigWitness(state_->GetPeerUuid(), state_->GetActiveConfigUnlocked())) {
+      // A witness does not have the data to serve as a leader, it only votes for other peers.
+      SnoozeFailureDetector(DO_NOT_LOG);
+      LOG_WITH_PREFIX(INFO) << "Not starting " << election_name << " -- witness replica";
+      return Status::OK();
+    }
     if (PREDICT_FALSE(active_role == RaftPeerPB::NON_PARTICIPANT)) {
       // Avoid excessive election noise while in this state.
       SnoozeFailureDetector(DO_NOT_LOG);
@@ -1090,6 +1107,10 @@ void RaftConsensus::NotifyTermChange(int64_t term) {
   WARN_NOT_OK(HandleTermAdvanceUnlocked(term), "Couldn't advance consensus term.");
 }
 
+void RaftConsensus::NotifyOpsPrefetched() {
+  peer_manager_->SignalRequest(RequestTriggerMode::kNonEmptyOnly);
+}
+
 void RaftConsensus::NotifyFailedFollower(const string& uuid,
                                          int64_t term,
                                          const std::string& reason) {
@@ -1154,6 +1175,8 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
                                 "is set to true.");
   }
 
+  RETURN_NOT_OK(UncompressOps(request));
+
   auto reject_mode = reject_mode_.load(std::memory_order_acquire);
   if (reject_mode != RejectMode::kNone) {
     if (reject_mode == RejectMode::kAll ||
@@ -1182,6 +1205,7 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
   VLOG_WITH_PREFIX(2) << "Replica received request: " << request->ShortDebugString();
 
   UpdateReplicaResult result;
+  std::vector<std::function<void()>> ready_updates;
   {
     // see var declaration
     auto wait_start = CoarseMonoClock::now();
@@ -1195,11 +1219,23 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
     LongOperationTracker operation_tracker("UpdateReplica", 1s);
     result = VERIFY_RESULT(UpdateReplica(request, response));
 
+    if (request->has_full_replicas_replicated_index() && !response->status().has_error()) {
+      full_replicas_replicated_index_.store(
+          request->full_replicas_replicated_index(), std::memory_order_release);
+    }
+
+    if (response->status().has_last_received()) {
+      std::lock_guard<std::mutex> order_lock(update_order_mtx_);
+      last_update_received_index_ = response->status().last_received().index();
+      ready_updates = TakeReadyParkedUpdatesUnlocked();
+    }
+
     auto delay = TEST_delay_update_.load(std::memory_order_acquire);
     if (delay != MonoDelta::kZero) {
       std::this_thread::sleep_for(delay.ToSteadyDuration());
     }
   }
+  ResumeParkedUpdates(std::move(ready_updates));
 
   // Release the lock while we wait for the log append to finish so that commits can go through.
   if (result.wait_for_op_id) {
@@ -1770,11 +1806,93 @@ yb::OpId RaftConsensus::EnqueueWritesUnlocked(const LeaderRequest& deduped_req,
       yb::OpId::FromPB(deduped_req.messages.back()->id()) : deduped_req.preceding_opid;
 }
 
+bool RaftConsensus::ParkUpdate(
+    const ConsensusRequestPB& request, CoarseTimePoint deadline, std::function<void()> resume) {
+  auto wait_ms = GetAtomicFlag(&FLAGS_consensus_wait_for_preceding_update_ms);
+  auto* messenger = peer_proxy_factory_->messenger();
+  if (!request.pipelined() || wait_ms <= 0 || !messenger) {
+    return false;
+  }
+  auto wait_time = std::min<CoarseDuration>(deadline - CoarseMonoClock::now(), wait_ms * 1ms);
+  if (wait_time <= CoarseDuration::zero()) {
+    return false;
+  }
+
+  const auto preceding_index = request.preceding_id().index();
+  int64_t id;
+  {
+    std::lock_guard<std::mutex> lock(update_order_mtx_);
+    if (last_update_received_index_ == kInvalidOpIdIndex ||
+        last_update_received_index_ >= preceding_index) {
+      return false;
+    }
+    id = ++next_parked_update_id_;
+    parked_updates_.push_back(ParkedUpdate{id, preceding_index, std::move(resume)});
+  }
+
+  // The scheduled task is also invoked when the messenger is shutting down.
+  std::weak_ptr<RaftConsensus> weak_self = shared_from_this();
+  auto task_id = messenger->ScheduleOnReactor(
+      [weak_self, id](const Status&) {
+        if (auto self = weak_self.lock()) {
+          self->ResumeExpiredParkedUpdate(id);
+        }
+      },
+      MonoDelta(wait_time), SOURCE_LOCATION(), messenger);
+  if (task_id == rpc::kInvalidTaskId) {
+    ResumeExpiredParkedUpdate(id);
+  }
+  return true;
+}
+
+std::vector<std::function<void()>> RaftConsensus::TakeReadyParkedUpdatesUnlocked() {
+  std::vector<std::function<void()>> result;
+  auto keep = parked_updates_.begin();
+  for (auto& update : parked_updates_) {
+    if (last_update_received_index_ >= update.preceding_index) {
+      result.push_back(std::move(update.resume));
+    } else {
+      *keep++ = std::move(update);
+    }
+  }
+  parked_updates_.erase(keep, parked_updates_.end());
+  return result;
+}
+
+void RaftConsensus::ResumeExpiredParkedUpdate(int64_t id) {
+  std::function<void()> resume;
+  {
+    std::lock_guard<std::mutex> lock(update_order_mtx_);
+    auto it = std::find_if(
+        parked_updates_.begin(), parked_updates_.end(),
+        [id](const ParkedUpdate& update) { return update.id == id; });
+    if (it == parked_updates_.end()) {
+      return;
+    }
+    resume = std::move(it->resume);
+    parked_updates_.erase(it);
+  }
+  ResumeParkedUpdates({std::move(resume)});
+}
+
+void RaftConsensus::ResumeParkedUpdates(std::vector<std::function<void()>> resume_callbacks) {
+  for (auto& resume : resume_callbacks) {
+    // Resumed requests could wait for their ops to be appended, so they are not run on a reactor
+    // thread or under the update lock.
+    auto status = raft_pool_token_->SubmitFunc(resume);
+    if (!status.ok()) {
+      LOG_WITH_PREFIX(WARNING) << "Failed to submit parked update: " << status;
+      resume();
+    }
+  }
+}
+
 Status RaftConsensus::WaitForWrites(const yb::OpId& wait_for_op_id) {
   // 5 - We wait for the writes to be durable.
 
-  // Note that this is safe because dist consensus now only supports a single outstanding
-  // request at a time and this way we can allow commits to proceed while we wait.
+  // Note that this is safe because the update mutex is not held while we wait, so the next
+  // request, possibly pipelined by the leader, appends its ops while these are synced, and commits
+  // could proceed.
   TRACE("Waiting on the replicates to finish logging");
   TRACE_EVENT0("consensus", "Wait for log");
   for (;;) {
@@ -2108,10 +2226,11 @@ Status RaftConsensus::ChangeConfig(const ChangeConfigRequestPB& req,
                                    req.ShortDebugString()));
         }
         if (server.member_type() != RaftPeerPB::PRE_VOTER &&
-            server.member_type() != RaftPeerPB::PRE_OBSERVER) {
+            server.member_type() != RaftPeerPB::PRE_OBSERVER &&
+            server.member_type() != RaftPeerPB::PRE_WITNESS) {
           return STATUS(InvalidArgument,
-              Substitute("Server with UUID $0 must be of member_type PRE_VOTER or PRE_OBSERVER. "
-                         "member_type received: $1", server_uuid,
+              Substitute("Server with UUID $0 must be of member_type PRE_VOTER, PRE_OBSERVER or "
+                         "PRE_WITNESS. member_type received: $1", server_uuid,
                          RaftPeerPB::MemberType_Name(server.member_type())));
         }
         if (server.last_known_private_addr().empty()) {
@@ -2170,16 +2289,20 @@ Status RaftConsensus::ChangeConfig(const ChangeConfigRequestPB& req,
             Substitute("Server with UUID $0 not a member of the config. RaftConfig: $1",
                        server_uuid, new_config.ShortDebugString()));
         }
-        if (new_peer->member_type() != RaftPeerPB::PRE_OBSERVER &&
-            new_peer->member_type() != RaftPeerPB::PRE_VOTER) {
-          return STATUS(IllegalState, Substitute("Cannot change role of server with UUID $0 "
-                                                 "because its member type is $1",
-                                                 server_uuid, new_peer->member_type()));
-        }
-        if (new_peer->member_type() == RaftPeerPB::PRE_OBSERVER) {
-          new_peer->set_member_type(RaftPeerPB::OBSERVER);
-        } else {
-          new_peer->set_member_type(RaftPeerPB::VOTER);
+        switch (new_peer->member_type()) {
+          case RaftPeerPB::PRE_OBSERVER:
+            new_peer->set_member_type(RaftPeerPB::OBSERVER);
+            break;
+          case RaftPeerPB::PRE_WITNESS:
+            new_peer->set_member_type(RaftPeerPB::WITNESS);
+            break;
+          case RaftPeerPB::PRE_VOTER:
+            new_peer->set_member_type(RaftPeerPB::VOTER);
+            break;
+          default:
+            return STATUS(IllegalState, Substitute("Cannot change role of server with UUID $0 "
+                                                   "because its member type is $1",
+                                                   server_uuid, new_peer->member_type()));
         }
 
         VLOG(3) << "config after CHANGE_ROLE: " << new_config.DebugString();
@@ -2253,6 +2376,16 @@ void RaftConsensus::Shutdown() {
     LOG_WITH_PREFIX(INFO) << "Raft consensus is shut down!";
   }
 
+  // Requests that are still parked are rejected, since the replica is shut down.
+  std::vector<ParkedUpdate> parked_updates;
+  {
+    std::lock_guard<std::mutex> lock(update_order_mtx_);
+    parked_updates.swap(parked_updates_);
+  }
+  for (auto& update : parked_updates) {
+    update.resume();
+  }
+
   // Shut down things that might acquire locks during destruction.
   raft_pool_token_->Shutdown();
   DisableFailureDetector();
@@ -2920,8 +3053,9 @@ Status RaftConsensus::HandleTermAdvanceUnlocked(ConsensusTerm new_term) {
   return Status::OK();
 }
 
-Status RaftConsensus::ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs) {
-  return queue_->ReadReplicatedMessages(from, msgs);
+Status RaftConsensus::ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs,
+                                             const std::string& reader_id) {
+  return queue_->ReadReplicatedMessages(from, msgs, reader_id);
 }
 
 void RaftConsensus::RollbackIdAndDeleteOpId(const ReplicateMsgPtr& replicate_msg,
@@ -34,6 +34,7 @@
 #define YB_CONSENSUS_RAFT_CONSENSUS_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -109,7 +110,8 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     ThreadPool* raft_pool,
-    RetryableRequests* retryable_requests);
+    RetryableRequests* retryable_requests,
+    MultiRaftManager* multi_raft_manager = nullptr);
 
   RaftConsensus(
     const ConsensusOptions& options,
@@ -155,6 +157,10 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
       ConsensusResponsePB* response,
       CoarseTimePoint deadline) override;
 
+  bool ParkUpdate(const ConsensusRequestPB& request,
+                  CoarseTimePoint deadline,
+                  std::function<void()> resume) override;
+
   CHECKED_STATUS RequestVote(const VoteRequestPB* request,
                              VoteResponsePB* response) override;
 
@@ -215,6 +221,8 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
                             int64_t term,
                             const std::string& reason) override;
 
+  void NotifyOpsPrefetched() override;
+
   yb::OpId GetLastReceivedOpId() override;
 
   yb::OpId GetLastCommittedOpId() override;
@@ -232,6 +240,12 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
 
   yb::OpId MinRetryableRequestOpId();
 
+  // Index of the last operation that the leader reported as replicated to all full replicas. Used
+  // by a witness to keep the log that full replicas could still need.
+  int64_t GetFullReplicasReplicatedIndex() const {
+    return full_replicas_replicated_index_.load(std::memory_order_acquire);
+  }
+
   CHECKED_STATUS StartElection(const LeaderElectionData& data) override {
     return DoStartElection(data, PreElected::kFalse);
   }
@@ -246,7 +260,8 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
     TEST_delay_update_.store(duration, std::memory_order_release);
   }
 
-  CHECKED_STATUS ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs) override;
+  CHECKED_STATUS ReadReplicatedMessages(const OpId& from, ReplicateMsgs* msgs,
+                                        const std::string& reader_id = std::string()) override;
 
  protected:
   // Trigger that a non-Operation ConsensusRound has finished replication.
@@ -586,6 +601,16 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
                                                    yb::OpId last_from_leader);
   CHECKED_STATUS WaitForWrites(const yb::OpId& wait_for_op_id);
 
+  // Removes parked updates whose preceding ops were received, and returns their callbacks.
+  std::vector<std::function<void()>> TakeReadyParkedUpdatesUnlocked();
+
+  // Resumes the parked update with the specified id, if it is still parked, since it waited for
+  // too long.
+  void ResumeExpiredParkedUpdate(int64_t id);
+
+  // Invokes callbacks of parked updates on the Raft thread pool.
+  void ResumeParkedUpdates(std::vector<std::function<void()>> resume_callbacks);
+
   // See comment for ReplicaState::CancelPendingOperation
   void RollbackIdAndDeleteOpId(const ReplicateMsgPtr& replicate_msg, bool should_exists);
 
@@ -636,6 +661,9 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // This is used to calculate back-off of the election timeout.
   std::atomic<int> failed_elections_since_stable_leader_{0};
 
+  // See GetFullReplicasReplicatedIndex.
+  std::atomic<int64_t> full_replicas_replicated_index_{0};
+
   const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk_;
 
   // Lock ordering note: If both this lock and the ReplicaState lock are to be
@@ -655,6 +683,20 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   std::mutex leader_lease_wait_mtx_;
   std::condition_variable leader_lease_wait_cond_;
 
+  // Pipelined update request, that was received before the requests preceding it.
+  struct ParkedUpdate {
+    int64_t id;
+    int64_t preceding_index;
+    std::function<void()> resume;
+  };
+
+  // Mutex protecting the order of update requests and the requests waiting for preceding ones.
+  std::mutex update_order_mtx_;
+  // Index of the last op received from the leader, as reported in the latest update response.
+  int64_t last_update_received_index_ = kInvalidOpIdIndex; // Protected by update_order_mtx_.
+  std::vector<ParkedUpdate> parked_updates_; // Protected by update_order_mtx_.
+  int64_t next_parked_update_id_ = 0; // Protected by update_order_mtx_.
+
   // This is called every time majority-replicated watermarks (OpId / leader leases) change. This is
   // used for updating the "propagated safe time" value in MvccManager and unblocking readers
   // waiting for it to advance.
@@ -0,0 +1,90 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/replicate_compression.h"
+
+#include "yb/util/coding.h"
+#include "yb/util/random_util.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(rpc_max_message_size);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+const std::vector<ReplicateCompressionType> kCompressionTypes = {
+    NO_REPLICATE_COMPRESSION, SNAPPY_REPLICATE_COMPRESSION, LZ4_REPLICATE_COMPRESSION };
+
+} // namespace
+
+class ReplicateCompressionTest : public YBTest {
+};
+
+TEST_F(ReplicateCompressionTest, Data) {
+  std::string input = RandomHumanReadableString(1000) + std::string(10000, 'x');
+  for (auto type : kCompressionTypes) {
+    faststring compressed;
+    ASSERT_OK(CompressReplicateData(type, input, &compressed));
+    if (type != NO_REPLICATE_COMPRESSION) {
+      ASSERT_LT(compressed.size(), input.size());
+    }
+
+    faststring uncompressed;
+    ASSERT_OK(UncompressReplicateData(type, Slice(compressed.data(), compressed.size()),
+                                      &uncompressed));
+    ASSERT_EQ(input, uncompressed.ToString());
+
+    // Truncated data should be reported as corruption.
+    ASSERT_NOK(UncompressReplicateData(type, Slice(compressed.data(), compressed.size() / 2),
+                                       &uncompressed));
+
+    // Uncompressed size above the RPC message limit is rejected before allocating the output.
+    faststring huge_size;
+    PutVarint64(&huge_size, FLAGS_rpc_max_message_size + 1ULL);
+    huge_size.append(compressed.data(), compressed.size());
+    auto status = UncompressReplicateData(
+        type, Slice(huge_size.data(), huge_size.size()), &uncompressed);
+    ASSERT_TRUE(status.IsCorruption()) << status;
+  }
+}
+
+TEST_F(ReplicateCompressionTest, Ops) {
+  constexpr int kNumOps = 10;
+  for (auto type : kCompressionTypes) {
+    ConsensusRequestPB request;
+    for (int i = 1; i <= kNumOps; ++i) {
+      auto* op = request.add_ops();
+      op->mutable_id()->set_term(1);
+      op->mutable_id()->set_index(i);
+      op->set_op_type(NO_OP);
+      op->mutable_noop_request()->set_payload_for_tests(std::string(1000, 'a' + i));
+    }
+    auto original_ops = request.ops();
+
+    ASSERT_OK(CompressOps(type, &request));
+    ASSERT_EQ(kNumOps, request.compressed_ops_size());
+    request.clear_ops();
+
+    ASSERT_OK(UncompressOps(&request));
+    ASSERT_EQ(0, request.compressed_ops_size());
+    ASSERT_EQ(kNumOps, request.ops_size());
+    for (int i = 0; i != kNumOps; ++i) {
+      ASSERT_EQ(original_ops.Get(i).ShortDebugString(), request.ops(i).ShortDebugString());
+    }
+  }
+}
+
+}  // namespace consensus
+}  // namespace yb
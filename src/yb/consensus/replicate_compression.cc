@@ -0,0 +1,191 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/replicate_compression.h"
+
+#include <lz4.h>
+#include <snappy.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "yb/util/cast.h"
+#include "yb/util/coding.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_string(replicate_compression_type, "none",
+              "Compression of replicate messages that leaders send to followers and keep in the "
+              "log cache: none, snappy or lz4. Followers should run a version that understands "
+              "compressed ops before this is enabled.");
+TAG_FLAG(replicate_compression_type, advanced);
+TAG_FLAG(replicate_compression_type, runtime);
+
+DECLARE_int32(rpc_max_message_size);
+
+namespace yb {
+namespace consensus {
+
+namespace {
+
+bool ParseReplicateCompressionType(const std::string& value, ReplicateCompressionType* type) {
+  if (boost::iequals(value, "none")) {
+    *type = NO_REPLICATE_COMPRESSION;
+  } else if (boost::iequals(value, "snappy")) {
+    *type = SNAPPY_REPLICATE_COMPRESSION;
+  } else if (boost::iequals(value, "lz4")) {
+    *type = LZ4_REPLICATE_COMPRESSION;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ValidateReplicateCompressionType(const char* flagname, const std::string& value) {
+  ReplicateCompressionType type;
+  if (ParseReplicateCompressionType(value, &type)) {
+    return true;
+  }
+  LOG(ERROR) << flagname << " should be one of none, snappy or lz4, got: " << value;
+  return false;
+}
+
+bool dummy = google::RegisterFlagValidator(
+    &FLAGS_replicate_compression_type, &ValidateReplicateCompressionType);
+
+} // namespace
+
+ReplicateCompressionType GetReplicateCompressionType() {
+  ReplicateCompressionType result = NO_REPLICATE_COMPRESSION;
+  ParseReplicateCompressionType(FLAGS_replicate_compression_type, &result);
+  return result;
+}
+
+Status CompressReplicateData(
+    ReplicateCompressionType type, const Slice& input, faststring* output) {
+  output->clear();
+  PutVarint64(output, input.size());
+  const size_t header_size = output->size();
+  switch (type) {
+    case NO_REPLICATE_COMPRESSION:
+      output->append(input.data(), input.size());
+      return Status::OK();
+    case SNAPPY_REPLICATE_COMPRESSION: {
+      output->resize(header_size + snappy::MaxCompressedLength(input.size()));
+      size_t compressed_size = 0;
+      snappy::RawCompress(input.cdata(), input.size(),
+                          util::to_char_ptr(output->data() + header_size), &compressed_size);
+      output->resize(header_size + compressed_size);
+      return Status::OK();
+    }
+    case LZ4_REPLICATE_COMPRESSION: {
+      const int bound = LZ4_compressBound(input.size());
+      output->resize(header_size + bound);
+      const int compressed_size = LZ4_compress_default(
+          input.cdata(), util::to_char_ptr(output->data() + header_size), input.size(), bound);
+      if (compressed_size <= 0) {
+        return STATUS_FORMAT(RuntimeError, "LZ4 failed to compress $0 bytes", input.size());
+      }
+      output->resize(header_size + compressed_size);
+      return Status::OK();
+    }
+  }
+  return STATUS_FORMAT(NotSupported, "Unknown replicate compression type: $0",
+                       ReplicateCompressionType_Name(type));
+}
+
+Status UncompressReplicateData(
+    ReplicateCompressionType type, const Slice& input, faststring* output) {
+  Slice data = input;
+  uint64_t uncompressed_size = 0;
+  if (!GetVarint64(&data, &uncompressed_size)) {
+    return STATUS(Corruption, "Failed to read uncompressed size of replicate data");
+  }
+  // Uncompressed ops are limited by the RPC message size on the leader, so a larger size means the
+  // data is corrupted and we should not try to allocate that much memory.
+  if (uncompressed_size > static_cast<uint64_t>(FLAGS_rpc_max_message_size)) {
+    return STATUS_FORMAT(Corruption, "Uncompressed size of replicate data is too big: $0",
+                         uncompressed_size);
+  }
+  output->resize(uncompressed_size);
+  auto* out = util::to_char_ptr(output->data());
+  switch (type) {
+    case NO_REPLICATE_COMPRESSION:
+      if (data.size() != uncompressed_size) {
+        return STATUS_FORMAT(Corruption, "Expected $0 bytes of replicate data, but got $1",
+                             uncompressed_size, data.size());
+      }
+      memcpy(out, data.data(), data.size());
+      return Status::OK();
+    case SNAPPY_REPLICATE_COMPRESSION: {
+      size_t snappy_size = 0;
+      if (!snappy::GetUncompressedLength(data.cdata(), data.size(), &snappy_size) ||
+          snappy_size != uncompressed_size ||
+          !snappy::RawUncompress(data.cdata(), data.size(), out)) {
+        return STATUS(Corruption, "Failed to uncompress snappy replicate data");
+      }
+      return Status::OK();
+    }
+    case LZ4_REPLICATE_COMPRESSION: {
+      const int size = LZ4_decompress_safe(data.cdata(), out, data.size(), uncompressed_size);
+      if (size < 0 || static_cast<uint64_t>(size) != uncompressed_size) {
+        return STATUS(Corruption, "Failed to uncompress LZ4 replicate data");
+      }
+      return Status::OK();
+    }
+  }
+  return STATUS_FORMAT(NotSupported, "Unknown replicate compression type: $0",
+                       ReplicateCompressionType_Name(type));
+}
+
+Status CompressReplicateMsg(
+    ReplicateCompressionType type, const ReplicateMsg& msg, faststring* output) {
+  std::string serialized;
+  if (!msg.SerializeToString(&serialized)) {
+    return STATUS_FORMAT(InvalidArgument, "Failed to serialize op $0",
+                         msg.id().ShortDebugString());
+  }
+  return CompressReplicateData(type, serialized, output);
+}
+
+Status CompressOps(ReplicateCompressionType type, ConsensusRequestPB* request) {
+  request->clear_compressed_ops();
+  faststring compressed;
+  for (const auto& op : request->ops()) {
+    RETURN_NOT_OK(CompressReplicateMsg(type, op, &compressed));
+    request->add_compressed_ops(compressed.data(), compressed.size());
+  }
+  request->set_ops_compression(type);
+  return Status::OK();
+}
+
+Status UncompressOps(ConsensusRequestPB* request) {
+  if (request->compressed_ops().empty()) {
+    return Status::OK();
+  }
+  if (!request->ops().empty()) {
+    return STATUS(InvalidArgument, "Request has both ops and compressed ops");
+  }
+
+  faststring serialized;
+  for (const auto& compressed : request->compressed_ops()) {
+    RETURN_NOT_OK(UncompressReplicateData(request->ops_compression(), compressed, &serialized));
+    if (!request->add_ops()->ParseFromArray(serialized.data(), serialized.size())) {
+      return STATUS(Corruption, "Failed to parse uncompressed op");
+    }
+  }
+  request->clear_compressed_ops();
+  request->clear_ops_compression();
+  return Status::OK();
+}
+
+}  // namespace consensus
+}  // namespace yb
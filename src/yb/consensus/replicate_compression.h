@@ -0,0 +1,51 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_REPLICATE_COMPRESSION_H
+#define YB_CONSENSUS_REPLICATE_COMPRESSION_H
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/util/faststring.h"
+#include "yb/util/slice.h"
+#include "yb/util/status.h"
+
+namespace yb {
+namespace consensus {
+
+// Returns the compression configured with replicate_compression_type.
+ReplicateCompressionType GetReplicateCompressionType();
+
+// Compresses input to output. The output is prefixed with the uncompressed size, so it could be
+// uncompressed knowing only the compression type.
+CHECKED_STATUS CompressReplicateData(
+    ReplicateCompressionType type, const Slice& input, faststring* output);
+
+CHECKED_STATUS UncompressReplicateData(
+    ReplicateCompressionType type, const Slice& input, faststring* output);
+
+// Serializes msg and compresses it to output in the CompressReplicateData format.
+CHECKED_STATUS CompressReplicateMsg(
+    ReplicateCompressionType type, const ReplicateMsg& msg, faststring* output);
+
+// Fills compressed_ops of the request from its ops. Ops are left in place, since they are usually
+// not owned by the request, so the caller is responsible for removing them before sending.
+CHECKED_STATUS CompressOps(ReplicateCompressionType type, ConsensusRequestPB* request);
+
+// Replaces compressed_ops of the request with the ops they contain. No-op if the request does not
+// have compressed ops.
+CHECKED_STATUS UncompressOps(ConsensusRequestPB* request);
+
+}  // namespace consensus
+}  // namespace yb
+
+#endif // YB_CONSENSUS_REPLICATE_COMPRESSION_H
@@ -32,8 +32,14 @@ CHECKED_STATUS DocExprExecutor::EvalColumnRef(ColumnIdRep col_id,
     return table_row->ReadColumn(col_id, result);
   }
 
-  // Read key of the given row.
+  // Read key of the given row. Rows read in batches carry their own tuple id since the iterator
+  // has already moved past them.
   if (col_id == static_cast<int>(PgSystemAttrNum::kYBTupleId)) {
+    const auto tuple_id = table_row->GetValue(col_id);
+    if (tuple_id) {
+      result->set_binary_value(tuple_id->binary_value());
+      return Status::OK();
+    }
     return GetTupleId(result);
   }
 
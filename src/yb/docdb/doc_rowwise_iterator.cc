@@ -269,6 +269,10 @@ Status DiscreteScanChoices::SeekToCurrentTarget(IntentAwareIterator* db_iter) {
   return Status::OK();
 }
 
+// Scan choices for range bounds on the range columns. Bounds on non-leading range columns turn the
+// scan into a skip scan: e.g. for WHERE c2 = v on a (c1, c2) key, once the iterator lands past v
+// within some c1 prefix, we jump straight to the next distinct c1 value (and then to (c1', v))
+// rather than reading every row under the current prefix.
 class RangeBasedScanChoices : public ScanChoices {
  public:
   RangeBasedScanChoices(const Schema& schema, const DocQLScanSpec& doc_spec)
@@ -295,6 +299,17 @@ class RangeBasedScanChoices : public ScanChoices {
     }
   }
 
+  // Returns true if at least one range column is bounded, i.e. there is something to skip.
+  bool HasBoundedColumns() const {
+    for (size_t idx = 0; idx < lower_.size(); idx++) {
+      if (lower_[idx].value_type() != ValueType::kLowest ||
+          upper_[idx].value_type() != ValueType::kHighest) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   CHECKED_STATUS SkipTargetsUpTo(const Slice& new_target) override;
   CHECKED_STATUS DoneWithCurrentTarget() override;
   CHECKED_STATUS SeekToCurrentTarget(IntentAwareIterator* db_iter) override;
@@ -396,8 +411,11 @@ Status RangeBasedScanChoices::SeekToCurrentTarget(IntentAwareIterator* db_iter)
       VLOG(3) << __PRETTY_FUNCTION__ << " current_scan_target_ is non-empty. "
               << current_scan_target_;
       if (is_forward_scan_) {
-        VLOG(3) << __PRETTY_FUNCTION__ << " Seeking to " << current_scan_target_;
-        db_iter->Seek(current_scan_target_);
+        // The target is always past the current iterator position here, and the next distinct
+        // prefix is often just a few keys away for low-cardinality leading columns, so a forward
+        // seek is cheaper than a full re-seek of both the regular and intents iterators.
+        VLOG(3) << __PRETTY_FUNCTION__ << " Seeking forward to " << current_scan_target_;
+        db_iter->SeekForward(&current_scan_target_);
       } else {
         auto tmp = current_scan_target_;
         PrimitiveValue(ValueType::kHighest).AppendToKey(&tmp);
@@ -471,7 +489,11 @@ Result<bool> DocRowwiseIterator::InitScanChoices(
   }
 
   if (doc_spec.range_bounds()) {
-    scan_choices_.reset(new RangeBasedScanChoices(schema_, doc_spec));
+    auto range_choices = std::make_unique<RangeBasedScanChoices>(schema_, doc_spec);
+    // With no bounded range column every row matches, so don't pay for re-encoding the target.
+    if (range_choices->HasBoundedColumns()) {
+      scan_choices_ = std::move(range_choices);
+    }
   }
 
   return false;
@@ -562,6 +584,10 @@ Status DocRowwiseIterator::AdvanceIteratorToNextDesiredRow() const {
 }
 
 Result<bool> DocRowwiseIterator::HasNext() const {
+  return DoHasNext(false /* read_projection_values */);
+}
+
+Result<bool> DocRowwiseIterator::DoHasNext(bool read_projection_values) const {
   VLOG(4) << __PRETTY_FUNCTION__;
 
   // Repeated HasNext calls (without Skip/NextRow in between) should be idempotent:
@@ -645,7 +671,12 @@ Result<bool> DocRowwiseIterator::HasNext() const {
 
     GetSubDocumentData data = { sub_doc_key, &row_, &doc_found, TableTTL(schema_) };
     data.deadline_info = deadline_info_.get_ptr();
-    has_next_status_ = GetSubDocument(db_iter_.get(), data, &projection_subkeys_);
+    if (read_projection_values) {
+      has_next_status_ = GetProjectedSubDocumentValues(
+          db_iter_.get(), data, projection_subkeys_, &projection_values_);
+    } else {
+      has_next_status_ = GetSubDocument(db_iter_.get(), data, &projection_subkeys_);
+    }
     RETURN_NOT_OK(has_next_status_);
     // After this, the iter should be positioned right after the subdocument.
 
@@ -667,6 +698,7 @@ Result<bool> DocRowwiseIterator::HasNext() const {
     RETURN_NOT_OK(has_next_status_);
   }
   row_ready_ = true;
+  row_in_projection_values_ = read_projection_values;
   return true;
 }
 
@@ -699,6 +731,16 @@ CHECKED_STATUS SetQLPrimaryKeyColumnValues(const Schema& schema,
   return decoder->ConsumeGroupEnd();
 }
 
+void SetQLColumnValue(
+    const SubDocument& column_value, const std::shared_ptr<QLType>& ql_type,
+    QLTableColumn* column) {
+  SubDocument::ToQLValuePB(column_value, ql_type, &column->value);
+  column->ttl_seconds = column_value.GetTtl();
+  if (column_value.IsWriteTimeSet()) {
+    column->write_time = column_value.GetWriteTime();
+  }
+}
+
 } // namespace
 
 void DocRowwiseIterator::SkipRow() {
@@ -731,6 +773,91 @@ Status DocRowwiseIterator::DoNextRow(const Schema& projection, QLTableRow* table
     return STATUS(InternalError, "next row has not be prepared for reading");
   }
 
+  RETURN_NOT_OK(FillKeyColumns(table_row));
+
+  for (size_t i = projection.num_key_columns(); i < projection.num_columns(); i++) {
+    const auto& column_id = projection.column_id(i);
+    const SubDocument* column_value = row_.GetChild(PrimitiveValue(column_id));
+    if (column_value != nullptr) {
+      SetQLColumnValue(
+          *column_value, projection.column(i).type(), &table_row->AllocColumn(column_id));
+    }
+  }
+
+  row_ready_ = false;
+  return Status::OK();
+}
+
+Result<size_t> DocRowwiseIterator::NextRowBatch(const Schema& projection,
+                                                size_t max_rows,
+                                                std::vector<QLTableRow::SharedPtr>* table_rows) {
+  VLOG(4) << __PRETTY_FUNCTION__ << ", max_rows: " << max_rows;
+
+  // Rows are decoded into columns: for each row, values of the projection subkeys are read into
+  // projection_values_ and moved to the column of the batch they belong to. Then each column is
+  // converted to QL values in a separate loop over the batch.
+  const size_t num_key_columns = projection.num_key_columns();
+  const size_t num_value_columns = projection.num_columns() - num_key_columns;
+  batch_value_indexes_.clear();
+  for (size_t i = num_key_columns; i < projection.num_columns(); i++) {
+    const PrimitiveValue subkey(projection.column_id(i));
+    auto it = std::lower_bound(projection_subkeys_.begin(), projection_subkeys_.end(), subkey);
+    if (it == projection_subkeys_.end() || *it != subkey) {
+      return STATUS_FORMAT(InvalidArgument, "Column $0 is not in the iterator projection",
+                           projection.column_id(i));
+    }
+    batch_value_indexes_.push_back(it - projection_subkeys_.begin());
+  }
+  batch_columns_.resize(num_value_columns);
+
+  if (row_ready_ && !row_in_projection_values_) {
+    // The row was prepared by HasNext, so it was read into row_.
+    projection_values_.resize(projection_subkeys_.size());
+    for (size_t i = 0; i != projection_subkeys_.size(); ++i) {
+      const SubDocument* value = row_.GetChild(projection_subkeys_[i]);
+      projection_values_[i] = value ? *value : SubDocument(ValueType::kInvalid);
+    }
+    row_in_projection_values_ = true;
+  }
+
+  const auto tuple_id_column = static_cast<ColumnIdRep>(PgSystemAttrNum::kYBTupleId);
+  size_t num_rows = 0;
+  while (num_rows < max_rows && VERIFY_RESULT(DoHasNext(true /* read_projection_values */))) {
+    if (table_rows->size() == num_rows) {
+      table_rows->push_back(std::make_shared<QLTableRow>());
+    } else {
+      // Keep the tuple id of the reused row, so its buffer is overwritten instead of reallocated.
+      (*table_rows)[num_rows]->ClearExcept(tuple_id_column);
+    }
+    QLTableRow* table_row = (*table_rows)[num_rows].get();
+    RETURN_NOT_OK(FillKeyColumns(table_row));
+    const Slice tuple_id = VERIFY_RESULT(GetTupleId());
+    table_row->AllocColumn(tuple_id_column).value.mutable_binary_value()->assign(
+        tuple_id.cdata(), tuple_id.size());
+
+    for (size_t i = 0; i != num_value_columns; ++i) {
+      auto& column = batch_columns_[i];
+      if (column.size() == num_rows) {
+        column.emplace_back();
+      }
+      std::swap(column[num_rows], projection_values_[batch_value_indexes_[i]]);
+    }
+    row_ready_ = false;
+    num_rows++;
+  }
+
+  for (size_t i = 0; i != num_value_columns; ++i) {
+    const auto column_id = projection.column_id(num_key_columns + i);
+    const auto& ql_type = projection.column(num_key_columns + i).type();
+    const auto& column = batch_columns_[i];
+    for (size_t row = 0; row != num_rows; ++row) {
+      SetQLColumnValue(column[row], ql_type, &(*table_rows)[row]->AllocColumn(column_id));
+    }
+  }
+  return num_rows;
+}
+
+Status DocRowwiseIterator::FillKeyColumns(QLTableRow* table_row) const {
   DocKeyDecoder decoder(row_key_);
   RETURN_NOT_OK(decoder.DecodeCotableId());
   bool has_hash_components = VERIFY_RESULT(decoder.DecodeHashCode());
@@ -748,22 +875,6 @@ Status DocRowwiseIterator::DoNextRow(const Schema& projection, QLTableRow* table
         schema_, schema_.num_hash_key_columns(), schema_.num_range_key_columns(),
         "range", &decoder, table_row));
   }
-
-  for (size_t i = projection.num_key_columns(); i < projection.num_columns(); i++) {
-    const auto& column_id = projection.column_id(i);
-    const auto ql_type = projection.column(i).type();
-    const SubDocument* column_value = row_.GetChild(PrimitiveValue(column_id));
-    if (column_value != nullptr) {
-      QLTableColumn& column = table_row->AllocColumn(column_id);
-      SubDocument::ToQLValuePB(*column_value, ql_type, &column.value);
-      column.ttl_seconds = column_value->GetTtl();
-      if (column_value->IsWriteTimeSet()) {
-        column.write_time = column_value->GetWriteTime();
-      }
-    }
-  }
-
-  row_ready_ = false;
   return Status::OK();
 }
 
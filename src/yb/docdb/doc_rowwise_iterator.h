@@ -110,6 +110,12 @@ class DocRowwiseIterator : public common::YQLRowwiseIteratorIf {
   // Retrieves the next key to read after the iterator finishes for the given page.
   CHECKED_STATUS GetNextReadSubDocKey(SubDocKey* sub_doc_key) const override;
 
+  // Decodes up to max_rows rows in one call. Values of each non-key column are read into a column
+  // of the batch, without building a SubDocument per row, and converted in a loop per column.
+  Result<size_t> NextRowBatch(const Schema& projection,
+                              size_t max_rows,
+                              std::vector<QLTableRow::SharedPtr>* table_rows) override;
+
  private:
   template <class T>
   CHECKED_STATUS DoInit(const T& spec);
@@ -157,6 +163,13 @@ class DocRowwiseIterator : public common::YQLRowwiseIteratorIf {
   // Read next row into a value map using the specified projection.
   CHECKED_STATUS DoNextRow(const Schema& projection, QLTableRow* table_row) override;
 
+  // Implements HasNext. If read_projection_values is true, values of projection_subkeys_ are read
+  // into projection_values_ instead of row_.
+  Result<bool> DoHasNext(bool read_projection_values) const;
+
+  // Populates the key columns of table_row from the key of the prepared row.
+  CHECKED_STATUS FillKeyColumns(QLTableRow* table_row) const;
+
   const Schema& projection_;
   // Used to maintain ownership of projection_.
   // Separate field is used since ownership could be optional.
@@ -212,6 +225,17 @@ class DocRowwiseIterator : public common::YQLRowwiseIteratorIf {
 
   mutable std::vector<PrimitiveValue> projection_subkeys_;
 
+  // Values of projection_subkeys_ of the current row, when it was read by NextRowBatch.
+  mutable std::vector<SubDocument> projection_values_;
+
+  // Whether the prepared row was read into projection_values_ rather than row_.
+  mutable bool row_in_projection_values_ = false;
+
+  // Used by NextRowBatch: index in projection_subkeys_ and values of each non-key column of the
+  // batch projection.
+  std::vector<size_t> batch_value_indexes_;
+  std::vector<std::vector<SubDocument>> batch_columns_;
+
   // Used for keeping track of errors in HasNext.
   mutable Status has_next_status_;
 
@@ -961,10 +961,15 @@ yb::Status GetSubDocument(
   return GetSubDocument(iter.get(), data, nullptr /* projection */, SeekFwdSuffices::kFalse);
 }
 
-yb::Status GetSubDocument(
+namespace {
+
+// Implements GetSubDocument and GetProjectedSubDocumentValues. When projection_values is set,
+// values of the projected keys are stored there instead of data.result.
+yb::Status DoGetSubDocument(
     IntentAwareIterator *db_iter,
     const GetSubDocumentData& data,
     const std::vector<PrimitiveValue>* projection,
+    std::vector<SubDocument>* projection_values,
     const SeekFwdSuffices seek_fwd_suffices) {
   // TODO(dtxn) scan through all involved first transactions to cache statuses in a batch,
   // so during building subdocument we don't need to request them one by one.
@@ -1057,10 +1062,15 @@ yb::Status GetSubDocument(
   }
   // Seed key_bytes with the subdocument key. For each subkey in the projection, build subdocument
   // and reuse key_bytes while appending the subkey.
-  *data.result = SubDocument();
+  if (projection_values) {
+    projection_values->resize(projection->size());
+  } else {
+    *data.result = SubDocument();
+  }
   KeyBytes key_bytes(data.subdocument_key);
   const size_t subdocument_key_size = key_bytes.size();
-  for (const PrimitiveValue& subkey : *projection) {
+  for (size_t i = 0; i != projection->size(); ++i) {
+    const PrimitiveValue& subkey = (*projection)[i];
     // Append subkey to subdocument key. Reserve extra kMaxBytesPerEncodedHybridTime + 1 bytes in
     // key_bytes to avoid the internal buffer from getting reallocated and moved by SeekForward()
     // appending the hybrid time, thereby invalidating the buffer pointer saved by prefix_scope.
@@ -1069,13 +1079,17 @@ yb::Status GetSubDocument(
     // This seek is to initialize the iterator for BuildSubDocument call.
     IntentAwareIteratorPrefixScope prefix_scope(key_bytes, db_iter);
     db_iter->SeekForward(&key_bytes);
-    SubDocument descendant(ValueType::kInvalid);
+    SubDocument local_descendant;
+    SubDocument& descendant = projection_values ? (*projection_values)[i] : local_descendant;
+    descendant = SubDocument(ValueType::kInvalid);
     int64 num_values_observed = 0;
     RETURN_NOT_OK(BuildSubDocument(
         db_iter, data.Adjusted(key_bytes, &descendant), max_overwrite_ht,
         &num_values_observed));
     *data.doc_found = descendant.value_type() != ValueType::kInvalid;
-    data.result->SetChild(subkey, std::move(descendant));
+    if (!projection_values) {
+      data.result->SetChild(subkey, std::move(descendant));
+    }
 
     // Restore subdocument key by truncating the appended subkey.
     key_bytes.Truncate(subdocument_key_size);
@@ -1087,6 +1101,26 @@ yb::Status GetSubDocument(
   return Status::OK();
 }
 
+}  // namespace
+
+yb::Status GetSubDocument(
+    IntentAwareIterator *db_iter,
+    const GetSubDocumentData& data,
+    const std::vector<PrimitiveValue>* projection,
+    const SeekFwdSuffices seek_fwd_suffices) {
+  return DoGetSubDocument(
+      db_iter, data, projection, nullptr /* projection_values */, seek_fwd_suffices);
+}
+
+yb::Status GetProjectedSubDocumentValues(
+    IntentAwareIterator *db_iter,
+    const GetSubDocumentData& data,
+    const std::vector<PrimitiveValue>& projection,
+    std::vector<SubDocument>* projection_values,
+    const SeekFwdSuffices seek_fwd_suffices) {
+  return DoGetSubDocument(db_iter, data, &projection, projection_values, seek_fwd_suffices);
+}
+
 // Note: Do not use if also retrieving other value, as some work will be repeated.
 // Assumes every value has a TTL, and the TTL is stored in the row with this key.
 // Also observe that tombstone checking only works because we assume the key has
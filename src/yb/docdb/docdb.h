@@ -444,6 +444,17 @@ yb::Status GetSubDocument(
     const std::vector<PrimitiveValue>* projection = nullptr,
     SeekFwdSuffices seek_fwd_suffices = SeekFwdSuffices::kTrue);
 
+// Like GetSubDocument with a projection, but stores the value of projection[i] into
+// (*projection_values)[i] instead of building an object SubDocument with a child per projected
+// key. A value is kInvalid when there is no such key. data.result is not used. Lets a reader of
+// many rows reuse the values instead of building a SubDocument tree per row.
+yb::Status GetProjectedSubDocumentValues(
+    IntentAwareIterator *db_iter,
+    const GetSubDocumentData& data,
+    const std::vector<PrimitiveValue>& projection,
+    std::vector<SubDocument>* projection_values,
+    SeekFwdSuffices seek_fwd_suffices = SeekFwdSuffices::kTrue);
+
 // This version of GetSubDocument creates a new iterator every time. This is not recommended for
 // multiple calls to subdocs that are sequential or near each other, in e.g. doc_rowwise_iterator.
 // low_subkey and high_subkey are optional ranges that we can specify for the subkeys to ensure
@@ -16,12 +16,15 @@
 
 #include "yb/common/transaction-test-util.h"
 
+#include "yb/docdb/doc_ql_scanspec.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
 #include "yb/docdb/docdb.h"
 #include "yb/docdb/docdb_test_base.h"
 #include "yb/docdb/docdb_test_util.h"
 #include "yb/docdb/intent.h"
 
+#include "yb/rocksdb/statistics.h"
+
 #include "yb/server/hybrid_clock.h"
 
 #include "yb/util/size_literals.h"
@@ -1055,5 +1058,181 @@ TEST_F(DocRowwiseIteratorTest, ScanWithinTheSameTxn) {
   ASSERT_FALSE(ASSERT_RESULT(iter.HasNext()));
 }
 
+TEST_F(DocRowwiseIteratorTest, NextRowBatch) {
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue(30_ColId)),
+      PrimitiveValue("row1_c"), HybridTime::FromMicros(1000)));
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue(40_ColId)),
+      PrimitiveValue(10000), HybridTime::FromMicros(1000)));
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue(40_ColId)),
+      PrimitiveValue(20000), HybridTime::FromMicros(2000)));
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue(50_ColId)),
+      PrimitiveValue("row2_e"), HybridTime::FromMicros(2000)));
+
+  const Schema &projection = kProjectionForIteratorTests;
+  const auto tuple_id_column = static_cast<ColumnIdRep>(PgSystemAttrNum::kYBTupleId);
+
+  DocRowwiseIterator iter(
+      projection, kSchemaForIteratorTests, kNonTransactionalOperationContext, doc_db(),
+      CoarseTimePoint::max() /* deadline */, ReadHybridTime::FromMicros(5000));
+  ASSERT_OK(iter.Init());
+
+  std::vector<QLTableRow::SharedPtr> rows;
+  QLValue value;
+
+  // The first batch is limited by max_rows.
+  ASSERT_EQ(1, ASSERT_RESULT(iter.NextRowBatch(projection, 1, &rows)));
+  ASSERT_EQ(1, rows.size());
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(0), &value));
+  ASSERT_EQ("row1_c", value.string_value());
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(1), &value));
+  ASSERT_EQ(10000, value.int64_value());
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(2), &value));
+  ASSERT_TRUE(value.IsNull());
+  ASSERT_OK(rows[0]->GetValue(tuple_id_column, &value));
+  ASSERT_EQ(kEncodedDocKey1.AsSlice(), Slice(value.binary_value()));
+
+  // The second batch reuses the allocated row and stops at the end of the scan. It also returns
+  // the row prepared by HasNext before the batch.
+  auto first_row = rows[0];
+  ASSERT_TRUE(ASSERT_RESULT(iter.HasNext()));
+  ASSERT_EQ(1, ASSERT_RESULT(iter.NextRowBatch(projection, 10, &rows)));
+  ASSERT_EQ(first_row, rows[0]);
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(0), &value));
+  ASSERT_TRUE(value.IsNull());
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(1), &value));
+  ASSERT_EQ(20000, value.int64_value());
+  ASSERT_OK(rows[0]->GetValue(projection.column_id(2), &value));
+  ASSERT_EQ("row2_e", value.string_value());
+  ASSERT_OK(rows[0]->GetValue(tuple_id_column, &value));
+  ASSERT_EQ(kEncodedDocKey2.AsSlice(), Slice(value.binary_value()));
+
+  ASSERT_EQ(0, ASSERT_RESULT(iter.NextRowBatch(projection, 10, &rows)));
+}
+
+// Compares decoding rows one by one with decoding them in batches. Uses a larger data set when slow
+// tests are allowed.
+TEST_F(DocRowwiseIteratorTest, NextRowBatchPerformance) {
+  const int kNumRows = AllowSlowTests() ? 100000 : 1000;
+  const size_t kBatchSize = 1024;
+  for (int i = 0; i != kNumRows; ++i) {
+    const KeyBytes doc_key(DocKey(PrimitiveValues(Format("row$0", i), i)).Encode());
+    const HybridTime write_time = HybridTime::FromMicros(1000 + i);
+    ASSERT_OK(SetPrimitive(
+        DocPath(doc_key, PrimitiveValue(30_ColId)), PrimitiveValue("c"), write_time));
+    ASSERT_OK(SetPrimitive(
+        DocPath(doc_key, PrimitiveValue(40_ColId)), PrimitiveValue(i), write_time));
+    ASSERT_OK(SetPrimitive(
+        DocPath(doc_key, PrimitiveValue(50_ColId)), PrimitiveValue("e"), write_time));
+  }
+
+  const Schema &projection = kProjectionForIteratorTests;
+  const auto read_time = ReadHybridTime::FromMicros(1000 + kNumRows);
+
+  MonoDelta row_time;
+  {
+    DocRowwiseIterator iter(
+        projection, kSchemaForIteratorTests, kNonTransactionalOperationContext, doc_db(),
+        CoarseTimePoint::max() /* deadline */, read_time);
+    ASSERT_OK(iter.Init());
+    auto start = MonoTime::Now();
+    QLTableRow row;
+    int num_rows = 0;
+    while (ASSERT_RESULT(iter.HasNext())) {
+      row.Clear();
+      ASSERT_OK(iter.NextRow(projection, &row));
+      ++num_rows;
+    }
+    row_time = MonoTime::Now() - start;
+    ASSERT_EQ(kNumRows, num_rows);
+  }
+
+  MonoDelta batch_time;
+  {
+    DocRowwiseIterator iter(
+        projection, kSchemaForIteratorTests, kNonTransactionalOperationContext, doc_db(),
+        CoarseTimePoint::max() /* deadline */, read_time);
+    ASSERT_OK(iter.Init());
+    auto start = MonoTime::Now();
+    std::vector<QLTableRow::SharedPtr> rows;
+    int num_rows = 0;
+    while (auto batch_rows = ASSERT_RESULT(iter.NextRowBatch(projection, kBatchSize, &rows))) {
+      num_rows += batch_rows;
+    }
+    batch_time = MonoTime::Now() - start;
+    ASSERT_EQ(kNumRows, num_rows);
+  }
+
+  LOG(INFO) << "Rows: " << kNumRows << ", one by one: " << row_time
+            << ", in batches of " << kBatchSize << ": " << batch_time;
+  // Batches should at least double the scan throughput. Timing of the small data set is too noisy
+  // to check.
+  if (AllowSlowTests()) {
+    ASSERT_LE(batch_time.ToSeconds() * 2, row_time.ToSeconds());
+  }
+}
+
+// Returns number of seeks, nexts and prevs done by iterators of DB with specified statistics.
+uint64_t IteratorMoves(const rocksdb::Statistics& statistics) {
+  return statistics.getTickerCount(rocksdb::NUMBER_DB_SEEK) +
+         statistics.getTickerCount(rocksdb::NUMBER_DB_NEXT) +
+         statistics.getTickerCount(rocksdb::NUMBER_DB_PREV);
+}
+
+TEST_F(DocRowwiseIteratorTest, SkipScanOnNonLeadingRangeColumn) {
+  constexpr int64_t kRowsPerPrefix = 100;
+  const std::vector<std::string> prefixes = {"a", "b", "c"};
+  for (const auto& prefix : prefixes) {
+    for (int64_t b = 1; b <= kRowsPerPrefix; ++b) {
+      ASSERT_OK(SetPrimitive(
+          DocPath(DocKey(PrimitiveValues(prefix, b)).Encode(), PrimitiveValue(30_ColId)),
+          PrimitiveValue(Format("$0_$1", prefix, b)), HybridTime::FromMicros(1000)));
+    }
+  }
+
+  // WHERE b = 3, with no condition on the leading range column a.
+  QLConditionPB condition;
+  condition.add_operands()->set_column_id(20_ColId);
+  condition.set_op(QL_OP_EQUAL);
+  condition.add_operands()->mutable_value()->set_int64_value(3);
+
+  const Schema &projection = kProjectionForIteratorTests;
+  const std::vector<PrimitiveValue> hashed_components;
+  const auto& statistics = *options().statistics;
+  for (const bool is_forward_scan : {true, false}) {
+    const auto moves_before_scan = IteratorMoves(statistics);
+    DocQLScanSpec ql_scan_spec(
+        kSchemaForIteratorTests, boost::none /* hash_code */, boost::none /* max_hash_code */,
+        hashed_components, &condition, rocksdb::kDefaultQueryId, is_forward_scan);
+    DocRowwiseIterator iter(
+        projection, kSchemaForIteratorTests, kNonTransactionalOperationContext, doc_db(),
+        CoarseTimePoint::max() /* deadline */, ReadHybridTime::FromMicros(2000));
+    ASSERT_OK(iter.Init(ql_scan_spec));
+
+    std::vector<std::string> fetched;
+    QLTableRow row;
+    QLValue value;
+    while (ASSERT_RESULT(iter.HasNext())) {
+      ASSERT_OK(iter.NextRow(&row));
+      ASSERT_OK(row.GetValue(projection.column_id(0), &value));
+      fetched.push_back(value.string_value());
+    }
+
+    std::vector<std::string> expected = {"a_3", "b_3", "c_3"};
+    if (!is_forward_scan) {
+      std::reverse(expected.begin(), expected.end());
+    }
+    ASSERT_EQ(expected, fetched);
+
+    // Rows of a prefix that are past b = 3 are skipped by a seek to the next prefix, instead of
+    // being read one by one.
+    ASSERT_LT(IteratorMoves(statistics) - moves_before_scan, static_cast<uint64_t>(kRowsPerPrefix))
+        << "Forward: " << is_forward_scan;
+  }
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -26,6 +26,10 @@
 
 DECLARE_bool(trace_docdb_calls);
 
+DEFINE_int32(ysql_scan_batch_size, 128,
+             "Number of rows decoded by the DocDB iterator per batch when serving a YSQL read "
+             "without an index request. Set to 1 to read rows one at a time.");
+
 namespace yb {
 namespace docdb {
 
@@ -403,41 +407,46 @@ Status PgsqlReadOperation::Execute(const common::YQLStorageIf& ql_storage,
   // Fetching data.
   int match_count = 0;
   QLTableRow::SharedPtr row = std::make_shared<QLTableRow>();
-  while (resultset->rsrow_count() < row_count_limit && VERIFY_RESULT(iter->HasNext())) {
+  if (!request_.has_index_request()) {
+    // Rows are decoded in batches, but never more than the remaining row limit so that the
+    // iterator is left positioned at the first unread row for the paging state.
+    const size_t batch_size = std::max(FLAGS_ysql_scan_batch_size, 1);
+    std::vector<QLTableRow::SharedPtr> rows;
+    while (resultset->rsrow_count() < row_count_limit) {
+      const size_t num_rows = VERIFY_RESULT(iter->NextRowBatch(
+          projection, std::min(batch_size, row_count_limit - resultset->rsrow_count()), &rows));
+      for (size_t i = 0; i < num_rows; i++) {
+        if (VERIFY_RESULT(EvalRow(rows[i], resultset))) {
+          match_count++;
+        }
+      }
+      if (num_rows > 0) {
+        row = rows[num_rows - 1];
+      } else {
+        break;
+      }
+    }
+  }
+  while (request_.has_index_request() &&
+         resultset->rsrow_count() < row_count_limit && VERIFY_RESULT(iter->HasNext())) {
 
     row->Clear();
 
     // If there is an index request, fetch ybbasectid from the index and use it as ybctid
-    // to fetch from the base table. Otherwise, fetch from the base table directly.
-    if (request_.has_index_request()) {
-      RETURN_NOT_OK(iter->NextRow(row.get()));
-      const auto& tuple_id = row->GetValue(ybbasectid_id);
-      SCHECK_NE(tuple_id, boost::none, Corruption, "ybbasectid not found in index row");
-      if (!VERIFY_RESULT(table_iter_->SeekTuple(tuple_id->binary_value()))) {
-        DocKey doc_key;
-        RETURN_NOT_OK(doc_key.DecodeFrom(tuple_id->binary_value()));
-        return STATUS_FORMAT(Corruption, "ybctid $0 not found in indexed table", doc_key);
-      }
-      row->Clear();
-      RETURN_NOT_OK(table_iter_->NextRow(projection, row.get()));
-    } else {
-      RETURN_NOT_OK(iter->NextRow(projection, row.get()));
+    // to fetch from the base table.
+    RETURN_NOT_OK(iter->NextRow(row.get()));
+    const auto& tuple_id = row->GetValue(ybbasectid_id);
+    SCHECK_NE(tuple_id, boost::none, Corruption, "ybbasectid not found in index row");
+    if (!VERIFY_RESULT(table_iter_->SeekTuple(tuple_id->binary_value()))) {
+      DocKey doc_key;
+      RETURN_NOT_OK(doc_key.DecodeFrom(tuple_id->binary_value()));
+      return STATUS_FORMAT(Corruption, "ybctid $0 not found in indexed table", doc_key);
     }
+    row->Clear();
+    RETURN_NOT_OK(table_iter_->NextRow(projection, row.get()));
 
-    // Match the row with the where condition before adding to the row block.
-    bool is_match = true;
-    if (request_.has_where_expr()) {
-      QLValue match;
-      RETURN_NOT_OK(EvalExpr(request_.where_expr(), row, &match));
-      is_match = match.bool_value();
-    }
-    if (is_match) {
+    if (VERIFY_RESULT(EvalRow(row, resultset))) {
       match_count++;
-      if (request_.is_aggregate()) {
-        RETURN_NOT_OK(EvalAggregate(row));
-      } else {
-        RETURN_NOT_OK(PopulateResultSet(row, resultset));
-      }
     }
   }
 
@@ -453,6 +462,24 @@ Status PgsqlReadOperation::Execute(const common::YQLStorageIf& ql_storage,
   return SetPagingStateIfNecessary(iter, resultset, row_count_limit);
 }
 
+Result<bool> PgsqlReadOperation::EvalRow(const QLTableRow::SharedPtr& table_row,
+                                         PgsqlResultSet* resultset) {
+  // Match the row with the where condition before adding to the row block.
+  if (request_.has_where_expr()) {
+    QLValue match;
+    RETURN_NOT_OK(EvalExpr(request_.where_expr(), table_row, &match));
+    if (!match.bool_value()) {
+      return false;
+    }
+  }
+  if (request_.is_aggregate()) {
+    RETURN_NOT_OK(EvalAggregate(table_row));
+  } else {
+    RETURN_NOT_OK(PopulateResultSet(table_row, resultset));
+  }
+  return true;
+}
+
 Status PgsqlReadOperation::SetPagingStateIfNecessary(const common::YQLRowwiseIteratorIf* iter,
                                                      const PgsqlResultSet* resultset,
                                                      const size_t row_count_limit) {
@@ -125,6 +125,10 @@ class PgsqlReadOperation : public DocExprExecutor {
   CHECKED_STATUS PopulateResultSet(const QLTableRow::SharedPtr& table_row,
                                    PgsqlResultSet *result_set);
 
+  // Applies the where condition to the row and, if it matches, adds the row to the result set
+  // or to the aggregate. Returns whether the row matched.
+  Result<bool> EvalRow(const QLTableRow::SharedPtr& table_row, PgsqlResultSet* resultset);
+
   CHECKED_STATUS EvalAggregate(const QLTableRow::SharedPtr& table_row);
 
   CHECKED_STATUS PopulateAggregate(const QLTableRow::SharedPtr& table_row,
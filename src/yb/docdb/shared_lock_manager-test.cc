@@ -14,6 +14,7 @@
 #include <atomic>
 #include <future>
 #include <mutex>
+#include <numeric>
 #include <random>
 #include <stack>
 #include <thread>
@@ -22,6 +23,7 @@
 
 #include "yb/rpc/thread_pool.h"
 
+#include "yb/util/monotime.h"
 #include "yb/util/random_util.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
@@ -184,5 +186,107 @@ TEST_F(SharedLockManagerTest, LockConflicts) {
   tp.Shutdown();
 }
 
+// A waiter that times out in the middle of the wait queue should not block the waiters behind it.
+TEST_F(SharedLockManagerTest, WaitQueueTimeout) {
+  const IntentTypeSet kWrite({IntentType::kStrongWrite});
+  const IntentTypeSet kRead({IntentType::kStrongRead});
+
+  LockBatch holder(&lm_, {{kKey1, kWrite}}, CoarseTimePoint::max());
+  ASSERT_OK(holder.status());
+
+  auto reader = std::async(std::launch::async, [this, &kRead] {
+    return LockBatch(&lm_, {{kKey1, kRead}}, CoarseMonoClock::now() + 500ms).status();
+  });
+  std::this_thread::sleep_for(100ms);
+
+  // Queued behind the reader, that conflicts with the current holder.
+  LockBatch writer(&lm_, {{kKey1, kWrite}}, CoarseMonoClock::now() + 100ms);
+  ASSERT_FALSE(writer.status().ok());
+
+  holder.Reset();
+  ASSERT_OK(reader.get());
+
+  LockBatch writer2(&lm_, {{kKey1, kWrite}}, CoarseMonoClock::now() + 1s);
+  ASSERT_OK(writer2.status());
+}
+
+// Conflicting waiters should get the lock in the order they started waiting for it.
+TEST_F(SharedLockManagerTest, WaitQueueOrder) {
+  constexpr int kWaiters = 8;
+  const IntentTypeSet kWrite({IntentType::kStrongWrite});
+
+  LockBatch holder(&lm_, {{kKey1, kWrite}}, CoarseTimePoint::max());
+  ASSERT_OK(holder.status());
+
+  std::mutex order_mutex;
+  std::vector<int> order;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i != kWaiters; ++i) {
+    waiters.emplace_back([this, i, &kWrite, &order_mutex, &order] {
+      LockBatch lb(&lm_, {{kKey1, kWrite}}, CoarseMonoClock::now() + 30s);
+      ASSERT_OK(lb.status());
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(i);
+    });
+    // Give the waiter time to get into the queue before starting the next one.
+    std::this_thread::sleep_for(50ms);
+  }
+
+  holder.Reset();
+  for (auto& thread : waiters) {
+    thread.join();
+  }
+
+  std::vector<int> expected(kWaiters);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(expected, order);
+}
+
+// Measures lock/unlock throughput of single key batches over a small set of hot keys.
+TEST_F(SharedLockManagerTest, LockUnlockThroughput) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping benchmark in quick test mode, since it runs for ~7s";
+    return;
+  }
+
+  constexpr int kKeys = 100;
+  const auto kTestTime = 1s;
+
+  std::vector<RefCntPrefix> keys;
+  for (int i = 0; i != kKeys; ++i) {
+    keys.emplace_back(Format("key_$0", i));
+  }
+
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    std::atomic<bool> stop_requested{false};
+    std::atomic<size_t> total_ops{0};
+    std::vector<std::thread> threads;
+    while (threads.size() != num_threads) {
+      threads.emplace_back([this, &keys, &stop_requested, &total_ops] {
+        std::mt19937_64 rng(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        size_t ops = 0;
+        while (!stop_requested.load(std::memory_order_acquire)) {
+          const auto& key = keys[rng() % keys.size()];
+          // Weak writes do not conflict, strong ones make some threads wait for each other.
+          auto intent_type = (ops % 8) == 0 ? IntentType::kStrongWrite : IntentType::kWeakWrite;
+          LockBatch lb(&lm_, {{key, IntentTypeSet({intent_type})}}, CoarseTimePoint::max());
+          ++ops;
+        }
+        total_ops.fetch_add(ops, std::memory_order_acq_rel);
+      });
+    }
+
+    std::this_thread::sleep_for(kTestTime);
+    stop_requested.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    auto ops = total_ops.load(std::memory_order_acquire);
+    LOG(INFO) << "Threads: " << num_threads << ", lock/unlock ops: " << ops
+              << ", ops/sec: " << ops * 1000 / ToMilliseconds(kTestTime);
+  }
+}
+
 } // namespace docdb
 } // namespace yb
@@ -13,10 +13,11 @@
 
 #include "yb/docdb/shared_lock_manager.h"
 
+#include <algorithm>
+#include <deque>
 #include <vector>
 
 #include <boost/range/adaptor/reversed.hpp>
-#include <boost/scope_exit.hpp>
 #include <glog/logging.h>
 
 #include "yb/util/bytes_formatter.h"
@@ -101,14 +102,26 @@ bool IntentTypeSetsConflict(IntentTypeSet lhs, IntentTypeSet rhs) {
   return false;
 }
 
+// Lock request that could not be granted immediately. Lives on the stack of the waiting thread,
+// while it is linked into the wait queue of the entry.
+struct LockWaiter {
+  explicit LockWaiter(IntentTypeSet intent_types_) : intent_types(intent_types_) {}
+
+  const IntentTypeSet intent_types;
+
+  // Waiter is notified personally, so unlock does not wake up threads that cannot proceed.
+  std::condition_variable cond_var;
+
+  // Set when the lock was acquired on behalf of this waiter. Protected by the entry mutex.
+  bool granted = false;
+};
+
 struct LockedBatchEntry {
   // Taken only for short duration, with no blocking wait.
   mutable std::mutex mutex;
 
-  std::condition_variable cond_var;
-
-  // Refcounting for garbage collection. Can only be used while the global mutex is locked.
-  // Global mutex resides in lock manager and the same for all LockBatchEntries.
+  // Refcounting for garbage collection. Can only be used while the mutex of the owning shard
+  // is locked.
   size_t ref_count = 0;
 
   // Number of holders for each type
@@ -116,10 +129,22 @@ struct LockedBatchEntry {
 
   std::atomic<size_t> num_waiters{0};
 
+  // Waiters in arrival order. Locks are granted to them strictly in this order, so a stream of
+  // compatible lockers cannot starve a conflicting one.
+  std::deque<LockWaiter*> wait_queue GUARDED_BY(mutex);
+
   MUST_USE_RESULT bool Lock(IntentTypeSet lock, CoarseTimePoint deadline);
 
   void Unlock(IntentTypeSet lock);
 
+  // Tries to atomically add the intent type set with index type_idx to the holders.
+  // Returns false if it conflicts with the locks that are already held.
+  bool TryAcquire(size_t type_idx);
+
+  // Grants locks to waiters from the head of the queue, until the first one that conflicts.
+  // Should be called while holding mutex.
+  void GrantWaiters();
+
   std::string ToString() const {
     std::lock_guard<std::mutex> lock(mutex);
     return Format("{ ref_count: $0 num_holding: $1 num_waiters: $2 }",
@@ -134,30 +159,46 @@ class SharedLockManager::Impl {
   void Unlock(const LockBatchEntries& key_to_intent_type);
 
   ~Impl() {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    LOG_IF(DFATAL, !locks_.empty()) << "Locks not empty in dtor: " << yb::ToString(locks_);
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      LOG_IF(DFATAL, !shard.locks.empty())
+          << "Locks not empty in dtor: " << yb::ToString(shard.locks);
+    }
   }
 
  private:
   typedef std::unordered_map<RefCntPrefix, LockedBatchEntry*, RefCntPrefixHash> LockEntryMap;
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
-  // as the keys in the batch.
+  // Part of the lock table responsible for keys with the same hash modulo kNumShards, so that
+  // concurrent batches with different keys rarely contend on the same mutex.
+  struct Shard {
+    // Should be taken only for very short duration, with no blocking wait.
+    std::mutex mutex;
+
+    LockEntryMap locks GUARDED_BY(mutex);
+    // Cache of lock entries, to avoid allocation/deallocation of heavy LockedBatchEntry.
+    std::vector<std::unique_ptr<LockedBatchEntry>> lock_entries GUARDED_BY(mutex);
+    std::vector<LockedBatchEntry*> free_lock_entries GUARDED_BY(mutex);
+  };
+
+  static constexpr size_t kNumShards = 32;
+
+  Shard& ShardForKey(const RefCntPrefix& key) {
+    return shards_[RefCntPrefixHash()(key) % kNumShards];
+  }
+
+  // Make sure the entries exist in the lock table and store pointers to them in the batch, so we
+  // can access them without holding the shard locks.
   void Reserve(LockBatchEntries* batch);
 
   // Update refcounts and maybe collect garbage.
   void Cleanup(const LockBatchEntries& key_to_intent_type);
 
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
-
-  LockEntryMap locks_ GUARDED_BY(global_mutex_);
-  // Cache of lock entries, to avoid allocation/deallocation of heavy LockedBatchEntry.
-  std::vector<std::unique_ptr<LockedBatchEntry>> lock_entries_ GUARDED_BY(global_mutex_);
-  std::vector<LockedBatchEntry*> free_lock_entries_ GUARDED_BY(global_mutex_);
+  std::array<Shard, kNumShards> shards_;
 };
 
+constexpr size_t SharedLockManager::Impl::kNumShards;
+
 const std::array<LockState, kIntentTypeSetMapSize> kIntentTypeSetMask = GenerateByMask(
     kSingleIntentMask);
 
@@ -180,37 +221,63 @@ std::string SharedLockManager::ToString(const LockState& state) {
   return result;
 }
 
-bool LockedBatchEntry::Lock(IntentTypeSet lock_type, CoarseTimePoint deadline) {
-  size_t type_idx = lock_type.ToUIntPtr();
-  auto& num_holding = this->num_holding;
-  auto old_value = num_holding.load(std::memory_order_acquire);
-  auto add = kIntentTypeSetAdd[type_idx];
+bool LockedBatchEntry::TryAcquire(size_t type_idx) {
+  // Sequentially consistent, so a waiter that has just incremented num_waiters either sees the
+  // concurrent Unlock or is seen by it.
+  auto old_value = num_holding.load();
   for (;;) {
-    if ((old_value & kIntentTypeSetConflicts[type_idx]) == 0) {
-      auto new_value = old_value + add;
-      if (num_holding.compare_exchange_weak(old_value, new_value, std::memory_order_acq_rel)) {
-        return true;
-      }
-      continue;
-    }
-    num_waiters.fetch_add(1, std::memory_order_release);
-    BOOST_SCOPE_EXIT(this_) {
-      this_->num_waiters.fetch_sub(1, std::memory_order_release);
-    } BOOST_SCOPE_EXIT_END;
-    std::unique_lock<std::mutex> lock(mutex);
-    old_value = num_holding.load(std::memory_order_acquire);
     if ((old_value & kIntentTypeSetConflicts[type_idx]) != 0) {
-      if (deadline != CoarseTimePoint::max()) {
-        if (cond_var.wait_until(lock, deadline) == std::cv_status::timeout) {
-          return false;
-        }
-      } else {
-        cond_var.wait(lock);
-      }
+      return false;
+    }
+    auto new_value = old_value + kIntentTypeSetAdd[type_idx];
+    if (num_holding.compare_exchange_weak(old_value, new_value)) {
+      return true;
+    }
+  }
+}
+
+void LockedBatchEntry::GrantWaiters() {
+  while (!wait_queue.empty()) {
+    auto* waiter = wait_queue.front();
+    if (!TryAcquire(waiter->intent_types.ToUIntPtr())) {
+      break;
     }
+    wait_queue.pop_front();
+    num_waiters.fetch_sub(1);
+    waiter->granted = true;
+    waiter->cond_var.notify_one();
   }
 }
 
+bool LockedBatchEntry::Lock(IntentTypeSet lock_type, CoarseTimePoint deadline) {
+  size_t type_idx = lock_type.ToUIntPtr();
+  // Fast path, only when nobody is queued, otherwise we would overtake waiters.
+  if (num_waiters.load(std::memory_order_acquire) == 0 && TryAcquire(type_idx)) {
+    return true;
+  }
+
+  LockWaiter waiter(lock_type);
+  std::unique_lock<std::mutex> lock(mutex);
+  // Should be incremented before GrantWaiters checks num_holding, pairs with Unlock that
+  // decrements num_holding before checking num_waiters.
+  num_waiters.fetch_add(1);
+  wait_queue.push_back(&waiter);
+  GrantWaiters();
+  while (!waiter.granted) {
+    if (deadline == CoarseTimePoint::max()) {
+      waiter.cond_var.wait(lock);
+    } else if (waiter.cond_var.wait_until(lock, deadline) == std::cv_status::timeout &&
+               !waiter.granted) {
+      wait_queue.erase(std::find(wait_queue.begin(), wait_queue.end(), &waiter));
+      num_waiters.fetch_sub(1);
+      // We could block waiters that are compatible with current holders.
+      GrantWaiters();
+      return false;
+    }
+  }
+  return true;
+}
+
 void LockedBatchEntry::Unlock(IntentTypeSet lock_types) {
   size_t type_idx = lock_types.ToUIntPtr();
   auto sub = kIntentTypeSetAdd[type_idx];
@@ -220,12 +287,12 @@ void LockedBatchEntry::Unlock(IntentTypeSet lock_types) {
   LockState new_state;
   for (;;) {
     new_state = old_state - sub;
-    if (num_holding.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel)) {
+    if (num_holding.compare_exchange_weak(old_state, new_state)) {
       break;
     }
   }
 
-  if (!num_waiters.load(std::memory_order_acquire)) {
+  if (!num_waiters.load()) {
     return;
   }
 
@@ -242,13 +309,8 @@ void LockedBatchEntry::Unlock(IntentTypeSet lock_types) {
     return;
   }
 
-  {
-    // Lock/unlock mutex as a barrier for Lock.
-    // So we don't unlock and notify between check and wait in Lock.
-    std::lock_guard<std::mutex> lock(mutex);
-  }
-
-  cond_var.notify_all();
+  std::lock_guard<std::mutex> lock(mutex);
+  GrantWaiters();
 }
 
 bool SharedLockManager::Impl::Lock(LockBatchEntries* key_to_intent_type, CoarseTimePoint deadline) {
@@ -274,16 +336,17 @@ bool SharedLockManager::Impl::Lock(LockBatchEntries* key_to_intent_type, CoarseT
 }
 
 void SharedLockManager::Impl::Reserve(LockBatchEntries* key_to_intent_type) {
-  std::lock_guard<std::mutex> lock(global_mutex_);
   for (auto& key_and_intent_type : *key_to_intent_type) {
-    auto& value = locks_[key_and_intent_type.key];
+    auto& shard = ShardForKey(key_and_intent_type.key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& value = shard.locks[key_and_intent_type.key];
     if (!value) {
-      if (!free_lock_entries_.empty()) {
-        value = free_lock_entries_.back();
-        free_lock_entries_.pop_back();
+      if (!shard.free_lock_entries.empty()) {
+        value = shard.free_lock_entries.back();
+        shard.free_lock_entries.pop_back();
       } else {
-        lock_entries_.emplace_back(std::make_unique<LockedBatchEntry>());
-        value = lock_entries_.back().get();
+        shard.lock_entries.emplace_back(std::make_unique<LockedBatchEntry>());
+        value = shard.lock_entries.back().get();
       }
     }
     value->ref_count++;
@@ -302,11 +365,12 @@ void SharedLockManager::Impl::Unlock(const LockBatchEntries& key_to_intent_type)
 }
 
 void SharedLockManager::Impl::Cleanup(const LockBatchEntries& key_to_intent_type) {
-  std::lock_guard<std::mutex> lock(global_mutex_);
   for (const auto& item : key_to_intent_type) {
+    auto& shard = ShardForKey(item.key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     if (--(item.locked->ref_count) == 0) {
-      locks_.erase(item.key);
-      free_lock_entries_.push_back(item.locked);
+      shard.locks.erase(item.key);
+      shard.free_lock_entries.push_back(item.locked);
     }
   }
 }
@@ -0,0 +1,288 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <limits>
+#include <map>
+#include <thread>
+
+#include "yb/client/client.h"
+#include "yb/client/ql-dml-test-base.h"
+#include "yb/client/session.h"
+#include "yb/client/table_handle.h"
+
+#include "yb/consensus/consensus.h"
+#include "yb/consensus/log.h"
+#include "yb/consensus/log_reader.h"
+#include "yb/integration-tests/mini_cluster.h"
+#include "yb/master/catalog_manager.h"
+#include "yb/master/master.h"
+#include "yb/master/master.pb.h"
+#include "yb/master/mini_master.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/util/test_util.h"
+
+using namespace std::literals;
+
+DECLARE_int32(catalog_manager_bg_task_wait_ms);
+DECLARE_int32(follower_unavailable_considered_failed_sec);
+DECLARE_int32(log_min_seconds_to_retain);
+DECLARE_int32(log_min_segments_to_retain);
+DECLARE_uint64(log_segment_size_bytes);
+
+namespace yb {
+namespace client {
+
+class WitnessReplicasTest : public YBTest {
+ protected:
+  static constexpr int kNumTservers = 3;
+  static constexpr int kNumTablets = 6;
+  static constexpr int kNumRows = 500;
+
+  void SetUp() override {
+    FLAGS_catalog_manager_bg_task_wait_ms = 100;
+    // Small segments, so there is something to collect in the log GC test.
+    FLAGS_log_segment_size_bytes = 1024;
+
+    YBTest::SetUp();
+    MiniClusterOptions opts;
+    opts.num_masters = 1;
+    opts.num_tablet_servers = kNumTservers;
+    cluster_.reset(new MiniCluster(env_.get(), opts));
+    ASSERT_OK(cluster_->Start());
+    client_ = ASSERT_RESULT(cluster_->CreateClient());
+
+    // Every tablet gets 2 full replicas and 1 witness.
+    master::SysClusterConfigEntryPB config;
+    ASSERT_OK(catalog_manager()->GetClusterConfig(&config));
+    auto* live_replicas = config.mutable_replication_info()->mutable_live_replicas();
+    live_replicas->set_num_replicas(kNumTservers);
+    live_replicas->set_num_witness_replicas(1);
+    master::ChangeMasterClusterConfigRequestPB change_req;
+    master::ChangeMasterClusterConfigResponsePB change_resp;
+    *change_req.mutable_cluster_config() = config;
+    ASSERT_OK(catalog_manager()->SetClusterConfig(&change_req, &change_resp));
+    ASSERT_FALSE(change_resp.has_error()) << change_resp.ShortDebugString();
+
+    ASSERT_NO_FATALS(KeyValueTableTest::CreateTable(
+        Transactional::kFalse, kNumTablets, client_.get(), &table_));
+  }
+
+  void TearDown() override {
+    client_.reset();
+    if (cluster_) {
+      cluster_->Shutdown();
+      cluster_.reset();
+    }
+    YBTest::TearDown();
+  }
+
+  master::CatalogManager* catalog_manager() {
+    return cluster_->leader_mini_master()->master()->catalog_manager();
+  }
+
+  // Returns leader uuid of each tablet, or an error if a tablet does not have a voter leader or
+  // the expected witness yet.
+  Result<std::map<TabletId, std::string>> GetLeaders() {
+    master::GetTableLocationsRequestPB req;
+    master::GetTableLocationsResponsePB resp;
+    kTableName.SetIntoTableIdentifierPB(req.mutable_table());
+    req.set_max_returned_locations(kNumTablets);
+    RETURN_NOT_OK(catalog_manager()->GetTableLocations(&req, &resp));
+    if (resp.tablet_locations_size() != kNumTablets) {
+      return STATUS_FORMAT(IllegalState, "Wrong number of tablets: $0", resp.ShortDebugString());
+    }
+
+    std::map<TabletId, std::string> leaders;
+    for (const auto& tablet : resp.tablet_locations()) {
+      int num_witnesses = 0;
+      for (const auto& replica : tablet.replicas()) {
+        const bool is_witness = replica.member_type() == consensus::RaftPeerPB::WITNESS;
+        num_witnesses += is_witness;
+        if (replica.role() != consensus::RaftPeerPB::LEADER) {
+          continue;
+        }
+        // A witness could not become leader, neither by election nor by the load balancer.
+        if (is_witness) {
+          return STATUS_FORMAT(Corruption, "Witness is leader: $0", tablet.ShortDebugString());
+        }
+        leaders.emplace(tablet.tablet_id(), replica.ts_info().permanent_uuid());
+      }
+      if (num_witnesses != 1 || !leaders.count(tablet.tablet_id())) {
+        return STATUS_FORMAT(IllegalState, "Tablet is not ready: $0", tablet.ShortDebugString());
+      }
+    }
+    return leaders;
+  }
+
+  bool IsLoadBalancerIdle() {
+    master::IsLoadBalancerIdleRequestPB req;
+    master::IsLoadBalancerIdleResponsePB resp;
+    return catalog_manager()->IsLoadBalancerIdle(&req, &resp).ok() && !resp.has_error();
+  }
+
+  void WaitTabletsReady() {
+    ASSERT_OK(WaitFor([this]() -> Result<bool> {
+      auto result = GetLeaders();
+      if (!result.ok() && result.status().IsCorruption()) {
+        return result.status();
+      }
+      return result.ok();
+    }, 60s, "Tablets ready"));
+  }
+
+  void WriteRows(const YBSessionPtr& session, int begin, int end) {
+    for (int key = begin; key != end; ++key) {
+      ASSERT_RESULT(KeyValueTableTest::WriteRow(&table_, session, key, key));
+    }
+  }
+
+  // Returns peers of the tablet servers with the specified indexes, grouped by tablet id.
+  std::map<TabletId, std::vector<tablet::TabletPeerPtr>> GetPeers(
+      const std::vector<int>& tserver_indexes) {
+    std::map<TabletId, std::vector<tablet::TabletPeerPtr>> result;
+    for (auto idx : tserver_indexes) {
+      for (const auto& peer : cluster_->GetTabletPeers(idx)) {
+        if (peer->tablet()) {
+          result[peer->tablet_id()].push_back(peer);
+        }
+      }
+    }
+    return result;
+  }
+
+  std::unique_ptr<MiniCluster> cluster_;
+  std::unique_ptr<YBClient> client_;
+  TableHandle table_;
+};
+
+// The load balancer should balance leaders only over full replicas, and stay idle once they are
+// balanced, instead of trying to move leaders to witnesses.
+TEST_F(WitnessReplicasTest, LeaderBalancing) {
+  std::map<TabletId, std::string> leaders;
+  ASSERT_OK(WaitFor([this, &leaders]() -> Result<bool> {
+    auto result = GetLeaders();
+    if (!result.ok()) {
+      if (result.status().IsCorruption()) {
+        return result.status();
+      }
+      return false;
+    }
+    leaders = std::move(*result);
+    return IsLoadBalancerIdle();
+  }, 60s, "Leaders balanced"));
+
+  // Several load balancer runs later leaders should stay where they are.
+  std::this_thread::sleep_for(FLAGS_catalog_manager_bg_task_wait_ms * 20ms);
+  ASSERT_EQ(leaders, ASSERT_RESULT(GetLeaders()));
+  ASSERT_TRUE(IsLoadBalancerIdle());
+}
+
+// After a tablet server fails, tablets should elect full replicas as leaders. Tablets that lost a
+// full replica commit with the witness once the failed replica is considered failed.
+TEST_F(WitnessReplicasTest, Failover) {
+  FLAGS_follower_unavailable_considered_failed_sec = 3;
+  ASSERT_NO_FATALS(WaitTabletsReady());
+
+  auto session = client_->NewSession();
+  session->SetTimeout(15s);
+  ASSERT_NO_FATALS(WriteRows(session, 0, kNumRows));
+
+  cluster_->mini_tablet_server(0)->Shutdown();
+
+  int key = kNumRows;
+  ASSERT_OK(WaitFor([this, &session, &key] {
+    for (; key != 2 * kNumRows; ++key) {
+      auto result = KeyValueTableTest::WriteRow(&table_, session, key, key);
+      if (!result.ok()) {
+        LOG(INFO) << "Write of " << key << " failed: " << result.status();
+        return false;
+      }
+    }
+    return true;
+  }, 60s, "Write after failover"));
+
+  auto rows = ASSERT_RESULT(KeyValueTableTest::SelectAllRows(&table_, session));
+  ASSERT_EQ(rows.size(), static_cast<size_t>(2 * kNumRows));
+  for (const auto& row : rows) {
+    ASSERT_EQ(row.first, row.second);
+  }
+
+  for (const auto& tablet_and_peers : GetPeers({1, 2})) {
+    for (const auto& peer : tablet_and_peers.second) {
+      if (peer->tablet()->is_witness()) {
+        ASSERT_NE(peer->consensus()->role(), consensus::RaftPeerPB::LEADER);
+        ASSERT_EQ(peer->tablet()->TEST_CountRegularDBRecords(), 0U);
+      }
+    }
+  }
+}
+
+// Witness does not flush data, so it should collect the log once full replicas have it, but not
+// before.
+TEST_F(WitnessReplicasTest, LogGC) {
+  FLAGS_log_min_seconds_to_retain = 0;
+  FLAGS_log_min_segments_to_retain = 1;
+  ASSERT_NO_FATALS(WaitTabletsReady());
+
+  auto session = client_->NewSession();
+  session->SetTimeout(15s);
+  ASSERT_NO_FATALS(WriteRows(session, 0, kNumRows));
+  ASSERT_OK(cluster_->FlushTablets());
+
+  std::map<TabletId, int> witness_segments;
+  for (const auto& tablet_and_peers : GetPeers({0, 1, 2})) {
+    for (const auto& peer : tablet_and_peers.second) {
+      if (peer->tablet()->is_witness()) {
+        auto num_segments = peer->log()->GetLogReader()->num_segments();
+        ASSERT_GT(num_segments, 1);
+        witness_segments.emplace(tablet_and_peers.first, num_segments);
+      }
+    }
+  }
+  ASSERT_EQ(witness_segments.size(), static_cast<size_t>(kNumTablets));
+
+  ASSERT_OK(WaitFor([this, &witness_segments]() -> Result<bool> {
+    RETURN_NOT_OK(cluster_->CleanTabletLogs());
+    for (const auto& tablet_and_peers : GetPeers({0, 1, 2})) {
+      for (const auto& peer : tablet_and_peers.second) {
+        if (peer->tablet()->is_witness() &&
+            peer->log()->GetLogReader()->num_segments() >=
+                witness_segments[tablet_and_peers.first]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }, 30s, "Witness log GC"));
+
+  for (const auto& tablet_and_peers : GetPeers({0, 1, 2})) {
+    int64_t witness_min_index = -1;
+    int64_t full_replicas_min_index = std::numeric_limits<int64_t>::max();
+    for (const auto& peer : tablet_and_peers.second) {
+      if (peer->tablet()->is_witness()) {
+        ASSERT_OK(peer->GetEarliestNeededLogIndex(&witness_min_index));
+        ASSERT_EQ(peer->tablet()->TEST_CountRegularDBRecords(), 0U);
+      } else {
+        full_replicas_min_index = std::min(
+            full_replicas_min_index, peer->log()->GetLatestEntryOpId().index);
+      }
+    }
+    ASSERT_GE(witness_min_index, 0);
+    ASSERT_LE(witness_min_index, full_replicas_min_index);
+  }
+}
+
+} // namespace client
+} // namespace yb
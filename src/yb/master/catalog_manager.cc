@@ -2002,6 +2002,19 @@ Status CatalogManager::CheckValidPlacementInfo(const PlacementInfoPB& placement_
     return s;
   }
 
+  // Verify that every majority contains at least one replica with data, so witnesses alone could
+  // not commit operations.
+  int num_witness_replicas = placement_info.num_witness_replicas();
+  if (num_witness_replicas < 0 ||
+      num_witness_replicas > num_replicas - consensus::MajoritySize(num_replicas)) {
+    msg = Substitute("Invalid number of witness replicas $0 for replication factor $1, should be "
+                     "less than a majority of replicas", num_witness_replicas, num_replicas);
+    LOG(WARNING) << msg;
+    s = STATUS(InvalidArgument, msg);
+    RETURN_NOT_OK(SetupError(resp->mutable_error(), MasterErrorPB::INVALID_SCHEMA, s));
+    return s;
+  }
+
   // Verify that placement requests are reasonable and we can satisfy the minimums.
   if (!placement_info.placement_blocks().empty()) {
     int minimum_sum = 0;
@@ -5217,6 +5230,7 @@ Status CatalogManager::HandlePlacementUsingPlacementInfo(const PlacementInfoPB&
   // Keep track of servers we've already selected, so that we don't attempt to
   // put two replicas on the same host.
   set<shared_ptr<TSDescriptor>> already_selected_ts;
+  const int first_selected_peer = config->peers_size();
   if (placement_info.placement_blocks().empty()) {
     // If we don't have placement info, just place the replicas as before, distributed across the
     // whole cluster.
@@ -5283,6 +5297,15 @@ Status CatalogManager::HandlePlacementUsingPlacementInfo(const PlacementInfoPB&
       SelectReplicas(all_allowed_ts, replicas_left, config, &already_selected_ts, member_type);
     }
   }
+
+  // The last selected replicas of the live placement become witnesses.
+  if (member_type == RaftPeerPB::VOTER) {
+    int num_witnesses = std::min(placement_info.num_witness_replicas(),
+                                 config->peers_size() - first_selected_peer);
+    for (int i = config->peers_size() - num_witnesses; i < config->peers_size(); ++i) {
+      config->mutable_peers(i)->set_member_type(RaftPeerPB::WITNESS);
+    }
+  }
   return Status::OK();
 }
 
@@ -371,6 +371,10 @@ Status ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
     }
   }
 
+  // Witnesses are not counted in leader load, and the threshold is adjusted only to the servers
+  // that could get leaders.
+  state_->RemoveWitnessOnlyServersFromLeaderLoad();
+
   // After updating the tablets and tablet servers, adjust the configured threshold if it is too
   // low for the given configuration.
   state_->AdjustLeaderBalanceThreshold();
@@ -674,8 +678,9 @@ Result<bool> ClusterLoadBalancer::GetLeaderToMove(
   // We will try to find two TSs that have at least one leader that can be moved amongst them, from
   // the higher load to the lower load TS. To do this, we will go through comparing the TSs
   // corresponding to our left and right indices. We go through leaders on the higher loaded TS
-  // and find a running replica on the lower loaded TS to move the leader. If no leader can be
-  // be picked, we advance our state.
+  // and find a running replica on the lower loaded TS to move the leader. Witness replicas could
+  // not become leaders, so they are never picked. If no leader can be picked, we advance our
+  // state.
   //
   // The state is defined as the positions of the start and end indices. We always try to move the
   // right index back, until we cannot any more, due to either reaching the left index (cannot
@@ -707,15 +712,20 @@ Result<bool> ClusterLoadBalancer::GetLeaderToMove(
         }
       }
 
-      // Find the leaders on the higher loaded TS that have running peers on the lower loaded TS.
-      // If there are, we have a candidate we want, so fill in the output params and return.
+      // Find the leaders on the higher loaded TS that have running non-witness peers on the lower
+      // loaded TS. If there are, we have a candidate we want, so fill in the output params and
+      // return.
       const set<TabletId>& leaders = state_->per_ts_meta_[high_load_uuid].leaders;
-      const set<TabletId>& peers = state_->per_ts_meta_[low_load_uuid].running_tablets;
+      const auto& low_load_ts_meta = state_->per_ts_meta_[low_load_uuid];
+      const set<TabletId>& peers = low_load_ts_meta.running_tablets;
       set<TabletId> intersection;
       const auto& itr = std::inserter(intersection, intersection.begin());
       std::set_intersection(leaders.begin(), leaders.end(), peers.begin(), peers.end(), itr);
 
       for (const auto& tablet_id : intersection) {
+        if (low_load_ts_meta.witnesses.count(tablet_id)) {
+          continue;
+        }
         *moving_tablet_id = tablet_id;
         *from_ts = high_load_uuid;
         *to_ts = low_load_uuid;
@@ -949,7 +959,8 @@ void ClusterLoadBalancer::SendReplicaChanges(
     // always doing the right thing.
     CHECK_EQ(state_->pending_add_replica_tasks_[tablet->table()->id()].count(tablet->tablet_id()),
              0);
-    catalog_manager_->SendAddServerRequest(tablet, GetDefaultMemberType(),
+    catalog_manager_->SendAddServerRequest(
+        tablet, GetMemberTypeForNewReplica(l->data().pb.committed_consensus_state().config()),
         l->data().pb.committed_consensus_state(), ts_uuid);
   } else {
     // If the replica is also the leader, first step it down and then remove.
@@ -976,6 +987,20 @@ consensus::RaftPeerPB::MemberType ClusterLoadBalancer::GetDefaultMemberType() {
   return consensus::RaftPeerPB::PRE_VOTER;
 }
 
+consensus::RaftPeerPB::MemberType ClusterLoadBalancer::GetMemberTypeForNewReplica(
+    const consensus::RaftConfigPB& config) {
+  auto member_type = GetDefaultMemberType();
+  if (member_type != consensus::RaftPeerPB::PRE_VOTER) {
+    return member_type;
+  }
+  int num_witnesses = CountMemberType(config, consensus::RaftPeerPB::WITNESS) +
+                      CountMemberType(config, consensus::RaftPeerPB::PRE_WITNESS);
+  if (num_witnesses < GetClusterPlacementInfo().num_witness_replicas()) {
+    return consensus::RaftPeerPB::PRE_WITNESS;
+  }
+  return member_type;
+}
+
 Result<bool> ClusterLoadBalancer::IsConfigMemberInTransitionMode(const TabletId &tablet_id) const {
   auto tablet = GetTabletMap().at(tablet_id);
   auto l = tablet->LockForRead();
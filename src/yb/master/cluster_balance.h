@@ -140,6 +140,11 @@ class ClusterLoadBalancer {
   // Returns default member type for newly created replicas (PRE_VOTER).
   virtual consensus::RaftPeerPB::MemberType GetDefaultMemberType();
 
+  // Returns member type for a replica added to the tablet with the specified config. Live replicas
+  // are added as PRE_WITNESS while the tablet has less witnesses than the placement requires.
+  consensus::RaftPeerPB::MemberType GetMemberTypeForNewReplica(
+      const consensus::RaftConfigPB& config);
+
   //
   // Higher level methods and members.
   //
@@ -14,6 +14,7 @@
 #ifndef YB_MASTER_CLUSTER_BALANCE_UTIL_H
 #define YB_MASTER_CLUSTER_BALANCE_UTIL_H
 
+#include <algorithm>
 #include <unordered_set>
 
 #include <map>
@@ -141,6 +142,9 @@ struct CBTabletServerMetadata {
 
   // The set of tablet leader ids that this tablet server is currently running.
   std::set<TabletId> leaders;
+
+  // The set of tablet ids that this tablet server hosts as witness, which could not become leader.
+  std::set<TabletId> witnesses;
 };
 
 struct Options {
@@ -274,6 +278,11 @@ class ClusterLoadState {
         ts_meta_it->second.leaders.insert(tablet_id);
       }
 
+      if (replica.second.member_type == consensus::RaftPeerPB::WITNESS ||
+          replica.second.member_type == consensus::RaftPeerPB::PRE_WITNESS) {
+        ts_meta_it->second.witnesses.insert(tablet_id);
+      }
+
       const tablet::RaftGroupStatePB& tablet_state = replica.second.state;
       if (tablet_state == tablet::RUNNING) {
         ts_meta_it->second.running_tablets.insert(tablet_id);
@@ -580,6 +589,20 @@ class ClusterLoadState {
             (GetLeaderLoad(ts_uuid) <= leader_balance_threshold_));
   }
 
+  // Removes tablet servers that host only witnesses of this table from leader load balancing. They
+  // could never get leaders, so their zero leader load would only skew the balance.
+  void RemoveWitnessOnlyServersFromLeaderLoad() {
+    auto it = std::remove_if(
+        sorted_leader_load_.begin(), sorted_leader_load_.end(),
+        [this](const TabletServerId& ts_uuid) {
+          const auto& ts_meta = per_ts_meta_.at(ts_uuid);
+          return !ts_meta.witnesses.empty() &&
+                 ts_meta.witnesses.size() ==
+                     ts_meta.running_tablets.size() + ts_meta.starting_tablets.size();
+        });
+    sorted_leader_load_.erase(it, sorted_leader_load_.end());
+  }
+
   void AdjustLeaderBalanceThreshold() {
     if (leader_balance_threshold_ != 0) {
       int min_threshold = sorted_leader_load_.empty() ? 0 :
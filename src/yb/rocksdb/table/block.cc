@@ -122,9 +122,32 @@ void BlockIter::Seek(const Slice& target) {
   bool ok = false;
   if (prefix_index_) {
     ok = PrefixSeek(target, &index);
+  } else if (hash_index_) {
+    ok = HashSeek(target, &index);
   } else {
-    ok = hash_index_ ? HashSeek(target, &index)
-      : BinarySeek(target, 0, num_restarts_ - 1, &index);
+    uint32_t left = 0;
+    uint32_t right = num_restarts_ - 1;
+    int current_cmp = 0;
+    if (Valid()) {
+      // DocDB mostly seeks to keys close to the current position (next subkey, next document,
+      // next skip scan target), so use the current entry to narrow down the restart range.
+      current_cmp = Compare(key_.GetKey(), target);
+      if (current_cmp == 0) {
+        return;
+      }
+      if (current_cmp < 0) {
+        left = restart_index_;
+      } else {
+        right = restart_index_;
+      }
+    }
+    ok = BinarySeek(target, left, right, &index);
+    if (ok && current_cmp < 0 && index == restart_index_) {
+      // Target is within the current restart interval and after the current entry, so continue
+      // the linear search from here instead of decoding the interval from its restart point.
+      while (ParseNextKey() && Compare(key_.GetKey(), target) < 0) {}
+      return;
+    }
   }
 
   if (!ok) {
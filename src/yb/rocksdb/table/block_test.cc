@@ -18,6 +18,8 @@
 // under the License.
 //
 #include <stdio.h>
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -243,6 +245,57 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+// Seeks from an already positioned iterator narrow the search using the current entry. Check that
+// forward, backward and short-distance seeks land on the same entry as seeks from scratch.
+TEST_F(BlockTest, SeekFromCurrentPosition) {
+  const int kNumKeys = 10000;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  // Only even key ids are present, so odd ones can be used as non-existent seek targets.
+  GenerateRandomKVs(&keys, &values, 0, kNumKeys, 2 /* step */);
+
+  BlockBuilder builder(16);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    builder.Add(keys[i], values[i]);
+  }
+  BlockContents contents;
+  contents.data = builder.Finish();
+  contents.cachable = false;
+  Block reader(std::move(contents));
+
+  std::unique_ptr<InternalIterator> iter(reader.NewIterator(BytewiseComparator()));
+  std::unique_ptr<InternalIterator> fresh_iter;
+  Random rnd(301);
+  iter->SeekToFirst();
+  for (int i = 0; i < 100000; i++) {
+    int key_id;
+    switch (rnd.Uniform(3)) {
+      case 0:
+        key_id = rnd.Uniform(kNumKeys + 2);
+        break;
+      default:
+        // Short hops around the current position, both within and across restart intervals.
+        key_id = (iter->Valid() ? std::stoi(iter->key().ToString().substr(0, 6)) : 0) +
+                 static_cast<int>(rnd.Uniform(64)) - 16;
+        key_id = std::max(key_id, 0);
+        break;
+    }
+    const auto target = GenerateKey(key_id, 0, 0, nullptr);
+    iter->Seek(target);
+    ASSERT_OK(iter->status());
+
+    fresh_iter.reset(reader.NewIterator(BytewiseComparator()));
+    fresh_iter->Seek(target);
+    ASSERT_EQ(fresh_iter->Valid(), iter->Valid()) << target;
+    if (!iter->Valid()) {
+      iter->SeekToFirst();
+      continue;
+    }
+    ASSERT_EQ(fresh_iter->key().ToString(), iter->key().ToString());
+    ASSERT_EQ(fresh_iter->value().ToString(), iter->value().ToString());
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char **argv) {
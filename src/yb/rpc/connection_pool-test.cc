@@ -0,0 +1,101 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rpc/connection_pool.h"
+
+#include "yb/util/test_util.h"
+
+DECLARE_int32(min_connections_to_server);
+DECLARE_int32(rpc_connection_scale_up_calls);
+DECLARE_int64(rpc_connection_scale_up_bytes);
+DECLARE_int32(rpc_connection_idle_shrink_ms);
+
+namespace yb {
+namespace rpc {
+
+class ConnectionPoolTest : public YBTest {
+};
+
+TEST_F(ConnectionPoolTest, ScaleWithLoad) {
+  constexpr size_t kMaxConnections = 4;
+  FLAGS_min_connections_to_server = 1;
+  FLAGS_rpc_connection_scale_up_calls = 2;
+  FLAGS_rpc_connection_idle_shrink_ms = 0;
+
+  ConnectionPool pool(Endpoint(), nullptr, kMaxConnections, nullptr, "test");
+  ASSERT_EQ(1, pool.active_connections());
+
+  // Calls share the connection until it has enough outstanding calls.
+  std::vector<size_t> indexes;
+  for (size_t i = 0; i != 2 * kMaxConnections + 1; ++i) {
+    indexes.push_back(pool.Acquire(100));
+  }
+  ASSERT_EQ(kMaxConnections, pool.active_connections());
+  ASSERT_EQ(0, indexes[0]);
+  ASSERT_EQ(0, indexes[1]);
+  ASSERT_EQ(1, indexes[2]);
+  for (auto idx : indexes) {
+    ASSERT_LT(idx, kMaxConnections);
+  }
+
+  // Idle connections are dropped one at a time, down to the min number of connections.
+  for (auto idx : indexes) {
+    pool.Release(idx, 100);
+  }
+  SleepFor(MonoDelta::FromMilliseconds(10));
+  for (size_t i = kMaxConnections; i-- > 1;) {
+    pool.Release(pool.Acquire(100), 100);
+    ASSERT_EQ(i, pool.active_connections());
+    SleepFor(MonoDelta::FromMilliseconds(10));
+  }
+  pool.Release(pool.Acquire(100), 100);
+  ASSERT_EQ(1, pool.active_connections());
+}
+
+TEST_F(ConnectionPoolTest, ScaleWithBytes) {
+  FLAGS_rpc_connection_scale_up_calls = 1000;
+  FLAGS_rpc_connection_scale_up_bytes = 1000;
+
+  ConnectionPool pool(Endpoint(), nullptr, 8, nullptr, "test");
+  ASSERT_EQ(0, pool.Acquire(600));
+  ASSERT_EQ(0, pool.Acquire(600));
+  // First connection has 1200 outstanding bytes, so the next call goes to a new connection.
+  ASSERT_EQ(1, pool.Acquire(10));
+  ASSERT_EQ(2, pool.active_connections());
+}
+
+TEST_F(ConnectionPoolTest, ReleaseWrittenBytes) {
+  FLAGS_rpc_connection_scale_up_calls = 1000;
+  FLAGS_rpc_connection_scale_up_bytes = 1000;
+
+  ConnectionPool pool(Endpoint(), nullptr, 8, nullptr, "test");
+  ASSERT_EQ(0, pool.Acquire(600));
+  ASSERT_EQ(0, pool.Acquire(600));
+  // Requests were written to the socket, so calls waiting for responses do not count their bytes.
+  pool.ReleaseBytes(0, 600);
+  pool.ReleaseBytes(0, 600);
+  ASSERT_EQ(0, pool.Acquire(600));
+  ASSERT_EQ(0, pool.Acquire(10));
+  ASSERT_EQ(1, pool.active_connections());
+
+  // Bytes of the request that was not written are released with the call.
+  pool.Release(0, 0);
+  pool.Release(0, 0);
+  pool.Release(0, 600);
+  ASSERT_EQ(0, pool.Acquire(600));
+  ASSERT_EQ(0, pool.Acquire(600));
+  ASSERT_EQ(1, pool.Acquire(10));
+}
+
+} // namespace rpc
+} // namespace yb
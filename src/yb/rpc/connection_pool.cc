@@ -0,0 +1,174 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rpc/connection_pool.h"
+
+#include "yb/rpc/stream.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/tostring.h"
+
+using namespace std::literals;
+using namespace yb::size_literals;
+
+DEFINE_bool(adaptive_connections_to_server, true,
+            "Open connections to each server on demand, between min_connections_to_server and "
+            "num_connections_to_server depending on the load, instead of spreading calls over "
+            "num_connections_to_server connections.");
+TAG_FLAG(adaptive_connections_to_server, advanced);
+
+DEFINE_int32(min_connections_to_server, 1,
+             "Min number of connections to each server, when adaptive_connections_to_server is "
+             "enabled.");
+TAG_FLAG(min_connections_to_server, advanced);
+
+DEFINE_int32(rpc_connection_scale_up_calls, 16,
+             "Open another connection to the server when each used connection to it has at least "
+             "this number of outstanding calls.");
+TAG_FLAG(rpc_connection_scale_up_calls, advanced);
+TAG_FLAG(rpc_connection_scale_up_calls, runtime);
+
+DEFINE_int64(rpc_connection_scale_up_bytes, 4_MB,
+             "Open another connection to the server when each used connection to it has at least "
+             "this number of bytes in requests that are queued but not written to the socket "
+             "yet.");
+TAG_FLAG(rpc_connection_scale_up_bytes, advanced);
+TAG_FLAG(rpc_connection_scale_up_bytes, runtime);
+
+DEFINE_int32(rpc_connection_idle_shrink_ms, 10000,
+             "Stop using a connection to the server after it had no outstanding calls for this "
+             "amount of time.");
+TAG_FLAG(rpc_connection_idle_shrink_ms, advanced);
+TAG_FLAG(rpc_connection_idle_shrink_ms, runtime);
+
+METRIC_DEFINE_entity(rpc_destination);
+
+METRIC_DEFINE_gauge_int64(rpc_destination, rpc_connections_used,
+                          "Number of connections used to send calls to the destination.",
+                          yb::MetricUnit::kConnections,
+                          "Number of connections used to send calls to the destination.");
+
+METRIC_DEFINE_gauge_int64(rpc_destination, rpc_outstanding_calls,
+                          "Number of outstanding calls to the destination.",
+                          yb::MetricUnit::kRequests,
+                          "Number of outstanding calls to the destination.");
+
+namespace yb {
+namespace rpc {
+
+namespace {
+
+// Destinations are identified by entity attributes, so all destinations share the metric names.
+scoped_refptr<MetricEntity> CreateDestinationEntity(
+    MetricRegistry* metric_registry, const std::string& messenger_name, const Endpoint& remote,
+    const Protocol* protocol) {
+  if (!metric_registry) {
+    return nullptr;
+  }
+  const auto destination = yb::ToString(remote);
+  MetricEntity::AttributeMap attrs;
+  attrs["messenger"] = messenger_name;
+  attrs["destination"] = destination;
+  attrs["protocol"] = protocol->id();
+  return METRIC_ENTITY_rpc_destination.Instantiate(
+      metric_registry, Format("$0-$1-$2", messenger_name, protocol->id(), destination), attrs);
+}
+
+} // namespace
+
+ConnectionPool::ConnectionPool(const Endpoint& remote,
+                               const Protocol* protocol,
+                               size_t max_connections,
+                               MetricRegistry* metric_registry,
+                               const std::string& messenger_name)
+    : remote_(remote),
+      protocol_(protocol),
+      max_connections_(std::max<size_t>(max_connections, 1)),
+      min_connections_(std::min<size_t>(
+          std::max(FLAGS_min_connections_to_server, 1), max_connections_)),
+      metric_entity_(CreateDestinationEntity(metric_registry, messenger_name, remote, protocol)),
+      slots_(max_connections_),
+      active_(min_connections_) {
+  if (metric_entity_) {
+    connections_used_metric_ = METRIC_rpc_connections_used.Instantiate(metric_entity_, 0);
+    outstanding_calls_metric_ = METRIC_rpc_outstanding_calls.Instantiate(metric_entity_, 0);
+  }
+  UpdateMetricsUnlocked();
+}
+
+size_t ConnectionPool::Acquire(size_t request_bytes) {
+  const auto now = CoarseMonoClock::Now();
+  std::lock_guard<simple_spinlock> lock(mutex_);
+
+  // Stop using the last connection when it becomes idle, so the reactor would close it.
+  auto& last = slots_[active_ - 1];
+  if (active_ > min_connections_ && last.calls == 0 &&
+      now > last.last_busy + GetAtomicFlag(&FLAGS_rpc_connection_idle_shrink_ms) * 1ms) {
+    --active_;
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i != active_; ++i) {
+    const auto& slot = slots_[i];
+    if (slot.calls < slots_[best].calls ||
+        (slot.calls == slots_[best].calls && slot.bytes < slots_[best].bytes)) {
+      best = i;
+    }
+  }
+  if (active_ < max_connections_ &&
+      (slots_[best].calls >= GetAtomicFlag(&FLAGS_rpc_connection_scale_up_calls) ||
+       slots_[best].bytes >= GetAtomicFlag(&FLAGS_rpc_connection_scale_up_bytes))) {
+    best = active_++;
+  }
+
+  auto& slot = slots_[best];
+  ++slot.calls;
+  slot.bytes += request_bytes;
+  slot.last_busy = now;
+  ++outstanding_calls_;
+  UpdateMetricsUnlocked();
+  return best;
+}
+
+void ConnectionPool::ReleaseBytes(size_t idx, size_t request_bytes) {
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  slots_[idx].bytes -= request_bytes;
+}
+
+void ConnectionPool::Release(size_t idx, size_t request_bytes) {
+  const auto now = CoarseMonoClock::Now();
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  auto& slot = slots_[idx];
+  --slot.calls;
+  slot.bytes -= request_bytes;
+  slot.last_busy = now;
+  --outstanding_calls_;
+  UpdateMetricsUnlocked();
+}
+
+size_t ConnectionPool::active_connections() const {
+  std::lock_guard<simple_spinlock> lock(mutex_);
+  return active_;
+}
+
+void ConnectionPool::UpdateMetricsUnlocked() {
+  if (connections_used_metric_) {
+    connections_used_metric_->set_value(active_);
+    outstanding_calls_metric_->set_value(outstanding_calls_);
+  }
+}
+
+} // namespace rpc
+} // namespace yb
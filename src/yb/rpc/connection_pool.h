@@ -0,0 +1,104 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_RPC_CONNECTION_POOL_H
+#define YB_RPC_CONNECTION_POOL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yb/gutil/ref_counted.h"
+#include "yb/rpc/rpc_fwd.h"
+#include "yb/util/locks.h"
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
+#include "yb/util/net/sockaddr.h"
+
+namespace yb {
+namespace rpc {
+
+// Chooses outbound connections for calls to a single destination, shared by all proxies of the
+// messenger to this destination.
+//
+// Only as many connections as required by the load are used: a call goes to the connection with
+// the fewest outstanding calls, and a new connection is opened when even that connection has
+// rpc_connection_scale_up_calls outstanding calls or rpc_connection_scale_up_bytes of requests
+// that are not written to the socket yet. The last used connection is dropped after it was idle for
+// rpc_connection_idle_shrink_ms, and the reactor closes its socket after the keep alive time.
+//
+// The messenger keeps only weak references to pools, so a pool is destroyed together with the last
+// proxy to its destination and the last call sent through it.
+class ConnectionPool {
+ public:
+  // When metric_registry is specified, the pool reports its metrics to an rpc_destination entity
+  // with messenger, destination and protocol attributes.
+  ConnectionPool(const Endpoint& remote,
+                 const Protocol* protocol,
+                 size_t max_connections,
+                 MetricRegistry* metric_registry,
+                 const std::string& messenger_name);
+
+  ConnectionPool(const ConnectionPool&) = delete;
+  void operator=(const ConnectionPool&) = delete;
+
+  // Returns index of the connection that should be used for a call with the specified request
+  // size. The call is accounted as outstanding on this connection until Release is invoked, and its
+  // request bytes until they are released with ReleaseBytes or Release.
+  size_t Acquire(size_t request_bytes);
+
+  // Invoked when the request was written to the connection, while the call still waits for the
+  // response.
+  void ReleaseBytes(size_t idx, size_t request_bytes);
+
+  // Invoked when the call is finished, request_bytes are the bytes that were not released yet.
+  void Release(size_t idx, size_t request_bytes);
+
+  size_t active_connections() const;
+
+  const Endpoint& remote() const {
+    return remote_;
+  }
+
+  const Protocol* protocol() const {
+    return protocol_;
+  }
+
+ private:
+  struct Slot {
+    int64_t calls = 0;
+    int64_t bytes = 0;
+    CoarseTimePoint last_busy;
+  };
+
+  void UpdateMetricsUnlocked();
+
+  const Endpoint remote_;
+  const Protocol* const protocol_;
+  const size_t max_connections_;
+  const size_t min_connections_;
+  scoped_refptr<MetricEntity> metric_entity_;
+  scoped_refptr<AtomicGauge<int64_t>> connections_used_metric_;
+  scoped_refptr<AtomicGauge<int64_t>> outstanding_calls_metric_;
+
+  mutable simple_spinlock mutex_;
+  std::vector<Slot> slots_;
+  // Calls are sent over first active_ connections.
+  size_t active_;
+  int64_t outstanding_calls_ = 0;
+};
+
+} // namespace rpc
+} // namespace yb
+
+#endif // YB_RPC_CONNECTION_POOL_H
@@ -147,6 +147,11 @@ class InboundCall : public RpcCall, public MPSCQueueEntry<InboundCall> {
   // If the client did not specify a deadline, returns MonoTime::Max().
   virtual CoarseTimePoint GetClientDeadline() const = 0;
 
+  // Priority of the call requested by the client.
+  virtual RequestPriority priority() const {
+    return NORMAL_REQUEST_PRIORITY;
+  }
+
   // Returns the time spent in the service queue -- from the time the call was received, until
   // it gets handled.
   MonoDelta GetTimeInQueue() const;
@@ -34,11 +34,14 @@ LocalOutboundCall::LocalOutboundCall(
 
 Status LocalOutboundCall::SetRequestParam(
     const google::protobuf::Message& req, const MemTrackerPtr& mem_tracker) {
+  if (!controller()->serialized_request_fields().empty()) {
+    return STATUS(NotSupported, "Serialized request fields are not supported for local calls");
+  }
   req_ = &req;
   return Status::OK();
 }
 
-void LocalOutboundCall::Serialize(boost::container::small_vector_base<RefCntBuffer>* output) {
+void LocalOutboundCall::Serialize(boost::container::small_vector_base<RefCntSlice>* output) {
   LOG(FATAL) << "Local call should not require serialization";
 }
 
@@ -49,7 +52,7 @@ const std::shared_ptr<LocalYBInboundCall>& LocalOutboundCall::CreateLocalInbound
       timeout.Initialized() ? ToCoarse(start_) + timeout : CoarseTimePoint::max();
   auto outbound_call = std::static_pointer_cast<LocalOutboundCall>(shared_from(this));
   inbound_call_ = InboundCall::Create<LocalYBInboundCall>(
-      &rpc_metrics(), remote_method(), outbound_call, deadline);
+      &rpc_metrics(), remote_method(), outbound_call, deadline, controller()->priority());
   return inbound_call_;
 }
 
@@ -58,8 +61,7 @@ Status LocalOutboundCall::GetSidecar(int idx, Slice* sidecar) const {
     return STATUS(InvalidArgument, strings::Substitute(
         "Index $0 does not reference a valid sidecar", idx));
   }
-  const RefCntBuffer& car = inbound_call_->sidecars()[idx];
-  *sidecar = Slice(car.udata(), car.size());
+  *sidecar = inbound_call_->sidecars()[idx].as_slice();
   return Status::OK();
 }
 
@@ -67,9 +69,10 @@ LocalYBInboundCall::LocalYBInboundCall(
     RpcMetrics* rpc_metrics,
     const RemoteMethod& remote_method,
     std::weak_ptr<LocalOutboundCall> outbound_call,
-    CoarseTimePoint deadline)
+    CoarseTimePoint deadline,
+    RequestPriority priority)
     : YBInboundCall(rpc_metrics, remote_method), outbound_call_(outbound_call),
-      deadline_(deadline) {
+      deadline_(deadline), priority_(priority) {
 }
 
 const Endpoint& LocalYBInboundCall::remote_address() const {
@@ -38,7 +38,7 @@ class LocalOutboundCall : public OutboundCall {
   const std::shared_ptr<LocalYBInboundCall>& CreateLocalInboundCall();
 
  protected:
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override;
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override;
 
   CHECKED_STATUS GetSidecar(int idx, Slice* sidecar) const override;
 
@@ -55,13 +55,14 @@ class LocalYBInboundCall : public YBInboundCall {
  public:
   LocalYBInboundCall(RpcMetrics* rpc_metrics, const RemoteMethod& remote_method,
                      std::weak_ptr<LocalOutboundCall> outbound_call,
-                     CoarseTimePoint deadline);
+                     CoarseTimePoint deadline, RequestPriority priority);
 
   bool IsLocalCall() const override { return true; }
 
   const Endpoint& remote_address() const override;
   const Endpoint& local_address() const override;
   CoarseTimePoint GetClientDeadline() const override { return deadline_; }
+  RequestPriority priority() const override { return priority_; }
 
   CHECKED_STATUS ParseParam(google::protobuf::Message* message) override;
 
@@ -76,12 +77,13 @@ class LocalYBInboundCall : public YBInboundCall {
 
   std::shared_ptr<LocalOutboundCall> outbound_call() const { return outbound_call_.lock(); }
 
-  const std::vector<RefCntBuffer>& sidecars() const { return sidecars_; }
+  const std::vector<RefCntSlice>& sidecars() const { return sidecars_; }
 
   // Weak pointer back to the outbound call owning this inbound call to avoid circular reference.
   std::weak_ptr<LocalOutboundCall> outbound_call_;
 
   const CoarseTimePoint deadline_;
+  const RequestPriority priority_;
 };
 
 } // namespace rpc
@@ -55,6 +55,7 @@
 
 #include "yb/rpc/acceptor.h"
 #include "yb/rpc/connection.h"
+#include "yb/rpc/connection_pool.h"
 #include "yb/rpc/constants.h"
 #include "yb/rpc/proxy.h"
 #include "yb/rpc/rpc_header.pb.h"
@@ -542,6 +543,7 @@ Messenger::Messenger(const MessengerBuilder &bld)
       stream_factories_(bld.stream_factories_),
       listen_protocol_(bld.listen_protocol_),
       metric_entity_(bld.metric_entity_),
+      metric_registry_(bld.metric_registry_),
       io_thread_pool_(name_, FLAGS_io_thread_pool_size),
       scheduler_(&io_thread_pool_.io_service()),
       normal_thread_pool_(new rpc::ThreadPool(name_, bld.queue_limit_, bld.workers_limit_)),
@@ -576,6 +578,43 @@ size_t Messenger::max_concurrent_requests() const {
   return num_connections_to_server_;
 }
 
+constexpr size_t Messenger::kMinConnectionPoolsCleanupSize;
+
+ConnectionPoolPtr Messenger::ConnectionPoolFor(const Endpoint& remote, const Protocol* protocol) {
+  std::lock_guard<std::mutex> lock(connection_pools_mutex_);
+  auto& weak_pool = connection_pools_[ConnectionId(remote, 0, protocol)];
+  auto result = weak_pool.lock();
+  if (result) {
+    return result;
+  }
+  result = std::make_shared<ConnectionPool>(
+      remote, protocol, num_connections_to_server_, metric_registry_, name_);
+  weak_pool = result;
+  if (connection_pools_.size() >= connection_pools_cleanup_size_) {
+    RemoveReleasedConnectionPoolsUnlocked();
+  }
+  return result;
+}
+
+void Messenger::RemoveReleasedConnectionPoolsUnlocked() {
+  for (auto it = connection_pools_.begin(); it != connection_pools_.end();) {
+    if (it->second.expired()) {
+      it = connection_pools_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Cleanup cost is amortized by waiting until the number of entries doubles.
+  connection_pools_cleanup_size_ = std::max(
+      kMinConnectionPoolsCleanupSize, connection_pools_.size() * 2);
+}
+
+size_t Messenger::TEST_num_connection_pools() {
+  std::lock_guard<std::mutex> lock(connection_pools_mutex_);
+  RemoveReleasedConnectionPoolsUnlocked();
+  return connection_pools_.size();
+}
+
 Reactor* Messenger::RemoteToReactor(const Endpoint& remote, uint32_t idx) {
   uint32_t hashCode = hash_value(remote);
   int reactor_idx = (hashCode + idx) % reactors_.size();
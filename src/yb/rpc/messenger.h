@@ -36,6 +36,7 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <list>
 #include <string>
 #include <unordered_map>
@@ -93,6 +94,12 @@ class MessengerBuilder {
   // Set metric entity for use by RPC systems.
   MessengerBuilder &set_metric_entity(const scoped_refptr<MetricEntity>& metric_entity);
 
+  // Set metric registry used to create metric entities for outbound connection destinations.
+  MessengerBuilder &set_metric_registry(MetricRegistry* metric_registry) {
+    metric_registry_ = metric_registry;
+    return *this;
+  }
+
   // Uses the given connection type to handle the incoming connections.
   MessengerBuilder &UseConnectionContextFactory(const ConnectionContextFactoryPtr& factory) {
     connection_context_factory_ = factory;
@@ -160,6 +167,7 @@ class MessengerBuilder {
   int num_reactors_ = 4;
   CoarseMonoClock::Duration coarse_timer_granularity_ = std::chrono::milliseconds(100);
   scoped_refptr<MetricEntity> metric_entity_;
+  MetricRegistry* metric_registry_ = nullptr;
   ConnectionContextFactoryPtr connection_context_factory_;
   StreamFactories stream_factories_;
   const Protocol* listen_protocol_;
@@ -290,6 +298,11 @@ class Messenger : public ProxyContext {
     return num_connections_to_server_;
   }
 
+  ConnectionPoolPtr ConnectionPoolFor(const Endpoint& remote, const Protocol* protocol) override;
+
+  // Forgets released connection pools and returns the number of remaining ones.
+  size_t TEST_num_connection_pools();
+
   // Use specified IP address as base address for outbound connections from messenger.
   void TEST_SetOutboundIpBase(const IpAddress& value) {
     test_outbound_ip_base_ = value;
@@ -302,6 +315,8 @@ class Messenger : public ProxyContext {
  private:
   friend class DelayedTask;
 
+  static constexpr size_t kMinConnectionPoolsCleanupSize = 64;
+
   explicit Messenger(const MessengerBuilder &bld);
 
   Reactor* RemoteToReactor(const Endpoint& remote, uint32_t idx = 0);
@@ -317,6 +332,8 @@ class Messenger : public ProxyContext {
 
   bool TEST_ShouldArtificiallyRejectOutgoingCallsTo(const IpAddress &remote);
 
+  void RemoveReleasedConnectionPoolsUnlocked();
+
   const std::string name_;
 
   ConnectionContextFactoryPtr connection_context_factory_;
@@ -337,6 +354,7 @@ class Messenger : public ProxyContext {
   std::vector<std::unique_ptr<Reactor>> reactors_;
 
   const scoped_refptr<MetricEntity> metric_entity_;
+  MetricRegistry* const metric_registry_;
   const scoped_refptr<Histogram> outgoing_queue_time_;
 
   // Acceptor which is listening on behalf of this messenger.
@@ -378,6 +396,14 @@ class Messenger : public ProxyContext {
   // Number of outbound connections to create per each destination server address.
   int num_connections_to_server_;
 
+  std::mutex connection_pools_mutex_;
+  // Keyed by connection id with zero index. Pools are owned by proxies and by calls in progress,
+  // so a pool is released when nothing sends calls to its destination anymore.
+  std::unordered_map<ConnectionId, std::weak_ptr<ConnectionPool>, ConnectionIdHash>
+      connection_pools_;
+  // Released pools are removed when the number of entries reaches this value.
+  size_t connection_pools_cleanup_size_ = kMinConnectionPoolsCleanupSize;
+
 #ifndef NDEBUG
   // This is so we can log where exactly a Messenger was instantiated to better diagnose a CHECK
   // failure in the destructor (ENG-2838). This can be removed when that is fixed.
@@ -43,6 +43,7 @@
 #include "yb/gutil/walltime.h"
 
 #include "yb/rpc/connection.h"
+#include "yb/rpc/connection_pool.h"
 #include "yb/rpc/constants.h"
 #include "yb/rpc/outbound_call.h"
 #include "yb/rpc/rpc_controller.h"
@@ -81,7 +82,14 @@ DEFINE_int64(
     " (Advanced debugging option)");
 TAG_FLAG(rpc_callback_max_cycles, advanced);
 TAG_FLAG(rpc_callback_max_cycles, runtime);
+
+DEFINE_int32(rpc_zero_copy_min_buffer_size, 4096,
+             "Serialized request fields of at least this size are sent without being copied to "
+             "the call's buffer. Smaller ones are joined, to limit the number of buffers written "
+             "at once.");
+TAG_FLAG(rpc_zero_copy_min_buffer_size, advanced);
 DECLARE_bool(rpc_dump_all_traces);
+DECLARE_int32(rpc_max_message_size);
 
 namespace yb {
 namespace rpc {
@@ -226,10 +234,15 @@ OutboundCall::~OutboundCall() {
     trace_->Dump(&LOG(INFO), true);
   }
 
+  ReleaseConnection();
   DecrementGauge(rpc_metrics_->outbound_calls_alive);
 }
 
 void OutboundCall::NotifyTransferred(const Status& status, Connection* conn) {
+  // The request is not in the outbound queue of the connection anymore, so only the call itself
+  // stays outstanding until the response arrives.
+  ReleaseConnectionBytes();
+
   if (status.ok()) {
     // Even when call is already finished (timed out) we should notify connection that it was sent
     // because it should expect response with appropriate id.
@@ -247,21 +260,79 @@ void OutboundCall::NotifyTransferred(const Status& status, Connection* conn) {
   }
 }
 
-void OutboundCall::Serialize(boost::container::small_vector_base<RefCntBuffer>* output) {
+void OutboundCall::Serialize(boost::container::small_vector_base<RefCntSlice>* output) {
   output->push_back(std::move(buffer_));
+  for (auto& field : request_fields_) {
+    output->push_back(std::move(field));
+  }
+  request_fields_.clear();
   buffer_consumption_ = ScopedTrackedConsumption();
 }
 
+namespace {
+
+// Moves fields to output, joining runs of fields smaller than rpc_zero_copy_min_buffer_size.
+// Returns the number of bytes allocated for joint buffers.
+size_t JoinSmallFields(std::vector<RefCntBuffer>* fields, std::vector<RefCntBuffer>* output) {
+  const size_t min_size = std::max(FLAGS_rpc_zero_copy_min_buffer_size, 0);
+  size_t allocated = 0;
+  auto it = fields->begin();
+  while (it != fields->end()) {
+    if (it->size() >= min_size) {
+      output->push_back(std::move(*it));
+      ++it;
+      continue;
+    }
+    auto run_end = it;
+    size_t run_size = 0;
+    while (run_end != fields->end() && run_end->size() < min_size) {
+      run_size += run_end->size();
+      ++run_end;
+    }
+    if (run_end - it == 1) {
+      output->push_back(std::move(*it));
+    } else {
+      RefCntBuffer joint(run_size);
+      char* dst = joint.data();
+      for (; it != run_end; ++it) {
+        memcpy(dst, it->data(), it->size());
+        dst += it->size();
+      }
+      output->push_back(std::move(joint));
+      allocated += run_size;
+    }
+    it = run_end;
+  }
+  fields->clear();
+  return allocated;
+}
+
+} // namespace
+
 Status OutboundCall::SetRequestParam(
     const Message& message, const MemTrackerPtr& mem_tracker) {
   using serialization::SerializeHeader;
   using serialization::SerializeMessage;
 
+  std::vector<RefCntBuffer> fields;
+  fields.swap(controller_->serialized_request_fields_);
+  size_t fields_size = 0;
+  for (const auto& field : fields) {
+    fields_size += field.size();
+  }
+
+  // Checked before serializing, since serialization does not expect too long messages.
+  const size_t total_size = message.ByteSize() + fields_size;
+  if (total_size > static_cast<size_t>(FLAGS_rpc_max_message_size)) {
+    return STATUS_FORMAT(InvalidArgument, "RPC message too long: $0 vs $1",
+                         total_size, FLAGS_rpc_max_message_size);
+  }
+
   size_t message_size = 0;
   auto status = SerializeMessage(message,
                                  /* param_buf */ nullptr,
-                                 /* additional_size */ 0,
-                                 /* use_cached_size */ false,
+                                 /* additional_size */ fields_size,
+                                 /* use_cached_size */ true,
                                  /* offset */ 0,
                                  &message_size);
   if (!status.ok()) {
@@ -271,19 +342,21 @@ Status OutboundCall::SetRequestParam(
 
   RequestHeader header;
   InitHeader(&header);
-  status = SerializeHeader(header, message_size, &buffer_, message_size, &header_size);
+  status = SerializeHeader(
+      header, message_size + fields_size, &buffer_, message_size, &header_size);
   remote_method_pool_->Release(header.release_remote_method());
   if (!status.ok()) {
     return status;
   }
 
+  const size_t allocated = JoinSmallFields(&fields, &request_fields_);
   if (mem_tracker) {
-    buffer_consumption_ = ScopedTrackedConsumption(mem_tracker, buffer_.size());
+    buffer_consumption_ = ScopedTrackedConsumption(mem_tracker, buffer_.size() + allocated);
   }
 
   return SerializeMessage(message,
                           &buffer_,
-                          /* additional_size */ 0,
+                          /* additional_size */ fields_size,
                           /* use_cached_size */ true,
                           header_size);
 }
@@ -340,6 +413,35 @@ bool ValidStateTransition(RpcCallState old_state, RpcCallState new_state) {
   }
 }
 
+void OutboundCall::SetConnectionPool(ConnectionPoolPtr pool, const std::string* hostname) {
+  DCHECK(!connection_pool_);
+  size_t bytes = buffer_.size();
+  for (const auto& field : request_fields_) {
+    bytes += field.size();
+  }
+  auto idx = pool->Acquire(bytes);
+  connection_pool_bytes_.store(bytes, std::memory_order_release);
+  SetConnectionId(ConnectionId(pool->remote(), idx, pool->protocol()), hostname);
+  connection_pool_ = std::move(pool);
+}
+
+void OutboundCall::ReleaseConnectionBytes() {
+  if (!connection_pool_) {
+    return;
+  }
+  auto bytes = connection_pool_bytes_.exchange(0, std::memory_order_acq_rel);
+  if (bytes) {
+    connection_pool_->ReleaseBytes(conn_id_.idx(), bytes);
+  }
+}
+
+void OutboundCall::ReleaseConnection() {
+  if (connection_pool_ && !connection_released_.exchange(true, std::memory_order_acq_rel)) {
+    connection_pool_->Release(
+        conn_id_.idx(), connection_pool_bytes_.exchange(0, std::memory_order_acq_rel));
+  }
+}
+
 bool OutboundCall::SetState(State new_state) {
   auto old_state = state_.load(std::memory_order_acquire);
   // Sanity check state transitions.
@@ -358,6 +460,9 @@ bool OutboundCall::SetState(State new_state) {
       return false;
     }
     if (state_.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel)) {
+      if (FinishedState(new_state)) {
+        ReleaseConnection();
+      }
       return true;
     }
   }
@@ -542,6 +647,9 @@ void OutboundCall::InitHeader(RequestHeader* header) {
     if (timeout.Initialized()) {
       header->set_timeout_millis(timeout.ToMilliseconds());
     }
+    if (controller_->priority() != NORMAL_REQUEST_PRIORITY) {
+      header->set_priority(controller_->priority());
+    }
   }
   header->set_allocated_remote_method(remote_method_pool_->Take());
 }
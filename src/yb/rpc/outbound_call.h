@@ -227,7 +227,8 @@ class OutboundCall : public RpcCall {
                ThreadPool* callback_thread_pool);
   virtual ~OutboundCall();
 
-  // Serialize the given request PB into this call's internal storage.
+  // Serialize the given request PB into this call's internal storage. Serialized request fields
+  // set in the controller are moved to the call and sent after the request.
   //
   // Because the data is fully serialized by this call, 'req' may be
   // subsequently mutated with no ill effects.
@@ -236,7 +237,7 @@ class OutboundCall : public RpcCall {
 
   // Serialize the call for the wire. Requires that SetRequestParam()
   // is called first. This is called from the Reactor thread.
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override;
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override;
 
   // Sets thread pool to be used by `InvokeCallback` for callback execution.
   void SetCallbackThreadPool(ThreadPool* callback_thread_pool) {
@@ -279,6 +280,10 @@ class OutboundCall : public RpcCall {
     hostname_ = hostname;
   }
 
+  // Picks connection to the pool destination and sets connection id accordingly. The call is
+  // accounted as outstanding in the pool until it is finished.
+  void SetConnectionPool(ConnectionPoolPtr pool, const std::string* hostname);
+
   void InvokeCallbackSync();
 
   ////////////////////////////////////////////////////////////
@@ -327,6 +332,11 @@ class OutboundCall : public RpcCall {
   void NotifyTransferred(const Status& status, Connection* conn) override;
 
   bool SetState(State new_state);
+
+  void ReleaseConnection();
+
+  // Invoked when the request is written, or failed to be written, to the connection.
+  void ReleaseConnectionBytes();
   State state() const;
 
   // Same as set_state, but requires that the caller already holds
@@ -367,7 +377,17 @@ class OutboundCall : public RpcCall {
   // Buffers for storing segments of the wire-format request.
   RefCntBuffer buffer_;
 
-  // Consumption of buffer_.
+  // Already serialized request fields, sent after buffer_. Small fields are copied to joint
+  // buffers, so the number of buffers passed to writev stays low.
+  std::vector<RefCntBuffer> request_fields_;
+
+  // Pool that picked connection for this call. The call is released from it when finished.
+  ConnectionPoolPtr connection_pool_;
+  // Request bytes accounted in the pool, until the request is transferred to the connection.
+  std::atomic<size_t> connection_pool_bytes_{0};
+  std::atomic<bool> connection_released_{false};
+
+  // Consumption of buffer_ and of buffers allocated for request_fields_.
   ScopedTrackedConsumption buffer_consumption_;
 
   // Once a response has been received for this call, contains that response.
@@ -39,7 +39,7 @@ class OutboundData : public std::enable_shared_from_this<OutboundData> {
   virtual void Transferred(const Status& status, Connection* conn) = 0;
 
   // Serializes the data to be sent out via the RPC framework.
-  virtual void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) = 0;
+  virtual void Serialize(boost::container::small_vector_base<RefCntSlice>* output) = 0;
 
   virtual std::string ToString() const = 0;
 
@@ -62,7 +62,7 @@ class StringOutboundData : public OutboundData {
   void Transferred(const Status& status, Connection* conn) override {}
 
   // Serializes the data to be sent out via the RPC framework.
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override {
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override {
     output->push_back(buffer_);
   }
 
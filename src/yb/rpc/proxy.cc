@@ -42,6 +42,7 @@
 
 #include <glog/logging.h>
 
+#include "yb/rpc/connection_pool.h"
 #include "yb/rpc/local_call.h"
 #include "yb/rpc/outbound_call.h"
 #include "yb/rpc/messenger.h"
@@ -60,6 +61,8 @@
 DEFINE_int32(num_connections_to_server, 8,
              "Number of underlying connections to each server");
 
+DECLARE_bool(adaptive_connections_to_server);
+
 DEFINE_int32(proxy_resolve_cache_ms, 5000,
              "Time in milliseconds to cache resolution result in Proxy");
 
@@ -84,7 +87,8 @@ Proxy::Proxy(ProxyContext* context, const HostPort& remote, const Protocol* prot
       latency_hist_(ScopedDnsTracker::active_metric()),
       // Use the context->num_connections_to_server() here as opposed to directly reading the
       // FLAGS_num_connections_to_server, because the flag value could have changed since then.
-      num_connections_to_server_(context_->num_connections_to_server()) {
+      num_connections_to_server_(context_->num_connections_to_server()),
+      adaptive_connections_(FLAGS_adaptive_connections_to_server) {
   VLOG(1) << "Create proxy to " << remote << " with num_connections_to_server="
           << num_connections_to_server_;
   if (context_->parent_mem_tracker()) {
@@ -272,12 +276,24 @@ void Proxy::ResolveDone(
 }
 
 void Proxy::QueueCall(RpcController* controller, const Endpoint& endpoint) {
-  uint8_t idx = num_calls_.fetch_add(1) % num_connections_to_server_;
-  ConnectionId conn_id(endpoint, idx, protocol_);
-  controller->call_->SetConnectionId(conn_id, &remote_.host());
+  if (adaptive_connections_) {
+    controller->call_->SetConnectionPool(GetConnectionPool(endpoint), &remote_.host());
+  } else {
+    uint8_t idx = num_calls_.fetch_add(1) % num_connections_to_server_;
+    ConnectionId conn_id(endpoint, idx, protocol_);
+    controller->call_->SetConnectionId(conn_id, &remote_.host());
+  }
   context_->QueueOutboundCall(controller->call_);
 }
 
+ConnectionPoolPtr Proxy::GetConnectionPool(const Endpoint& endpoint) {
+  std::lock_guard<simple_spinlock> lock(connection_pool_mutex_);
+  if (!connection_pool_ || connection_pool_->remote() != endpoint) {
+    connection_pool_ = context_->ConnectionPoolFor(endpoint, protocol_);
+  }
+  return connection_pool_;
+}
+
 void Proxy::NotifyFailed(RpcController* controller, const Status& status) {
   // We should retain reference to call, so it would not be destroyed during SetFailed.
   auto call = controller->call_;
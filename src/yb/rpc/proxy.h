@@ -47,6 +47,7 @@
 #include "yb/rpc/rpc_header.pb.h"
 
 #include "yb/util/concurrent_pod.h"
+#include "yb/util/locks.h"
 #include "yb/util/monotime.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/net/sockaddr.h"
@@ -90,6 +91,10 @@ class ProxyContext {
   // Number of connections to create per destination address.
   virtual int num_connections_to_server() const = 0;
 
+  // Returns pool that picks connections for calls to the specified destination.
+  virtual ConnectionPoolPtr ConnectionPoolFor(const Endpoint& remote,
+                                              const Protocol* protocol) = 0;
+
   virtual ~ProxyContext() {}
 };
 
@@ -181,6 +186,8 @@ class Proxy {
 
   static void NotifyFailed(RpcController* controller, const Status& status);
 
+  ConnectionPoolPtr GetConnectionPool(const Endpoint& endpoint);
+
   ProxyContext* context_;
   HostPort remote_;
   const Protocol* const protocol_;
@@ -198,6 +205,13 @@ class Proxy {
   // Number of outbound connections to create per each destination server address.
   int num_connections_to_server_;
 
+  // Whether connections are picked by the connection pool of the context.
+  const bool adaptive_connections_;
+
+  // Pool for the last resolved endpoint, so the context is not looked up for each call.
+  simple_spinlock connection_pool_mutex_;
+  ConnectionPoolPtr connection_pool_;
+
   MemTrackerPtr mem_tracker_;
 };
 
@@ -49,12 +49,14 @@
 
 #include <glog/logging.h>
 
+#include "yb/gutil/atomicops.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/gutil/stringprintf.h"
 #include "yb/rpc/connection.h"
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc_controller.h"
 #include "yb/rpc/rpc_introspection.pb.h"
+#include "yb/rpc/thread_pool.h"
 #include "yb/rpc/yb_rpc.h"
 
 #include "yb/util/countdown_latch.h"
@@ -75,6 +77,12 @@ DECLARE_string(local_ip_for_outbound_sockets);
 DECLARE_int32(num_connections_to_server);
 DECLARE_int32(socket_receive_buffer_size);
 
+DEFINE_int32(reactor_busy_poll_us, 0,
+             "When positive, reactor threads poll for events without blocking, backing off "
+             "exponentially while idle, and block in epoll only after this number of microseconds "
+             "without events. Lowers wakeup latency at the cost of CPU. 0 to always block.");
+TAG_FLAG(reactor_busy_poll_us, advanced);
+
 namespace yb {
 namespace rpc {
 
@@ -121,6 +129,7 @@ Reactor::Reactor(Messenger* messenger,
                  int index,
                  const MessengerBuilder &bld)
     : messenger_(messenger),
+      index_(index),
       name_(StringPrintf("%s_R%03d", messenger->name().c_str(), index)),
       log_prefix_(name_ + ": "),
       loop_(kDefaultLibEvFlags),
@@ -477,11 +486,54 @@ bool Reactor::IsCurrentThreadOrStartedClosing() const {
 void Reactor::RunThread() {
   ThreadRestrictions::SetWaitAllowed(false);
   ThreadRestrictions::SetIOAllowed(false);
+  PinRpcThread(index_);
   DVLOG_WITH_PREFIX(6) << "Calling Reactor::RunThread()...";
-  loop_.run(/* flags */ 0);
+  auto busy_poll = std::chrono::microseconds(FLAGS_reactor_busy_poll_us);
+  if (busy_poll > 0us) {
+    RunBusyPollLoop(busy_poll);
+  } else {
+    loop_.run(/* flags */ 0);
+  }
   VLOG_WITH_PREFIX(1) << "thread exiting.";
 }
 
+void Reactor::RunBusyPollLoop(std::chrono::microseconds busy_poll) {
+  // Max number of CPU pauses between two polls without events.
+  constexpr size_t kMaxPauses = 1024;
+
+  ev_set_userdata(loop_, this);
+  ev_set_invoke_pending_cb(loop_, &Reactor::InvokePending);
+
+  size_t pauses = 1;
+  auto last_event_time = std::chrono::steady_clock::now();
+  // CheckReadyToStop marks reactor as closed before breaking the loop.
+  while (state_.load(std::memory_order_acquire) != ReactorState::kClosed) {
+    auto handled_events = handled_events_;
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_event_time >= busy_poll) {
+      // Nothing happened for too long, block until the next event.
+      loop_.run(ev::ONCE);
+    } else {
+      loop_.run(ev::NOWAIT);
+    }
+    if (handled_events_ != handled_events) {
+      last_event_time = std::chrono::steady_clock::now();
+      pauses = 1;
+    } else {
+      for (auto i = pauses; i-- > 0;) {
+        base::subtle::PauseCPU();
+      }
+      pauses = std::min(pauses * 2, kMaxPauses);
+    }
+  }
+}
+
+void Reactor::InvokePending(struct ev_loop* loop) {
+  auto reactor = static_cast<Reactor*>(ev_userdata(loop));
+  reactor->handled_events_ += ev_pending_count(loop);
+  ev_invoke_pending(loop);
+}
+
 namespace {
 
 Result<Socket> CreateClientSocket(const Endpoint& remote) {
@@ -34,6 +34,7 @@
 
 #include <stdint.h>
 
+#include <chrono>
 #include <functional>
 #include <list>
 #include <map>
@@ -381,6 +382,12 @@ class Reactor {
   // Run the main event loop of the reactor.
   void RunThread();
 
+  // Runs the event loop polling for events without blocking, see FLAGS_reactor_busy_poll_us.
+  void RunBusyPollLoop(std::chrono::microseconds busy_poll);
+
+  // Invokes pending watchers of the loop, counting handled events for busy polling.
+  static void InvokePending(struct ev_loop* loop);
+
   MUST_USE_RESULT bool ScheduleReactorTask(ReactorTaskPtr task, bool schedule_even_closing);
 
   // Find or create a new connection to the given remote.
@@ -424,6 +431,8 @@ class Reactor {
   // parent messenger
   Messenger* const messenger_;
 
+  const int index_;
+
   const std::string name_;
 
   const std::string log_prefix_;
@@ -456,6 +465,9 @@ class Reactor {
   // Handles the periodic timer.
   ev::timer timer_;
 
+  // Number of events handled by the loop, maintained only while busy polling.
+  size_t handled_events_ = 0;
+
   // Scheduled (but not yet run) delayed tasks.
   std::set<std::shared_ptr<DelayedTask>> scheduled_tasks_;
 
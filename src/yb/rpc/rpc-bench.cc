@@ -38,8 +38,13 @@
 #include "yb/rpc/rpc-test-base.h"
 #include "yb/rpc/rtest.proxy.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/hdr_histogram.h"
 #include "yb/util/test_util.h"
 
+DECLARE_bool(rpc_thread_pool_work_stealing);
+DECLARE_int32(reactor_busy_poll_us);
+DECLARE_int32(rpc_socket_busy_poll_us);
+
 using namespace std::literals; // NOLINT
 
 using std::string;
@@ -55,9 +60,15 @@ class RpcBench : public RpcTestBase {
  protected:
   friend class ClientThread;
 
+  // Runs num_threads client threads against the server for the specified time, returns total
+  // number of performed requests.
+  int RunClients(int num_threads, std::chrono::steady_clock::duration duration);
+
   HostPort server_hostport_;
   std::unique_ptr<Messenger> client_messenger_;
   std::atomic<bool> should_run_{true};
+  // Call latencies in microseconds, recorded when set.
+  std::unique_ptr<HdrHistogram> latency_;
 };
 
 class ClientThread {
@@ -89,7 +100,12 @@ class ClientThread {
       req.set_y(request_count_);
       RpcController controller;
       controller.set_timeout(MonoDelta::FromSeconds(10));
+      auto start = std::chrono::steady_clock::now();
       CHECK_OK(p.Add(req, &resp, &controller));
+      if (bench_->latency_) {
+        bench_->latency_->Increment(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+      }
       CHECK_EQ(req.x() + req.y(), resp.result());
       request_count_++;
     }
@@ -118,36 +134,116 @@ TEST_F(RpcBench, BenchmarkCalls) {
   Stopwatch sw(Stopwatch::ALL_THREADS);
   sw.start();
 
-  std::vector<std::unique_ptr<ClientThread>> threads;
 #if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
   constexpr int kNumThreads = 4;
 #else
   constexpr int kNumThreads = 16;
 #endif
-  for (int i = 0; i < kNumThreads; i++) {
+  int total_reqs = RunClients(kNumThreads, 10s);
+  sw.stop();
+
+  float reqs_per_second = static_cast<float>(total_reqs / sw.elapsed().wall_seconds());
+  float user_cpu_micros_per_req = static_cast<float>(sw.elapsed().user / 1000.0 / total_reqs);
+  float sys_cpu_micros_per_req = static_cast<float>(sw.elapsed().system / 1000.0 / total_reqs);
+
+  LOG(INFO) << "Reqs/sec:         " << reqs_per_second;
+  LOG(INFO) << "User CPU per req: " << user_cpu_micros_per_req << "us";
+  LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
+}
+
+// Measures how handler throughput scales with the number of RPC workers, with and without work
+// stealing between workers.
+TEST_F(RpcBench, WorkerScaling) {
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  const std::vector<size_t> kWorkerCounts = {8};
+  constexpr auto kRunTime = 2s;
+#else
+  const std::vector<size_t> kWorkerCounts = {8, 16, 32, 48, 64, 96};
+  constexpr auto kRunTime = 5s;
+#endif
+  const size_t num_cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+  for (auto num_workers : kWorkerCounts) {
+    if (num_workers > num_cpus && num_workers != kWorkerCounts.front()) {
+      LOG(INFO) << "Skip " << num_workers << " workers, only " << num_cpus << " CPUs available";
+      break;
+    }
+    for (bool work_stealing : {false, true}) {
+      FLAGS_rpc_thread_pool_work_stealing = work_stealing;
+
+      TestServerOptions options;
+      options.n_worker_threads = num_workers;
+      options.messenger_options.n_reactors = std::max<size_t>(num_workers / 8, 3);
+      StartTestServerWithGeneratedCode(&server_hostport_, options);
+
+      auto total_reqs = RunClients(static_cast<int>(num_workers * 2), kRunTime);
+      LOG(INFO) << "Workers: " << num_workers << ", work stealing: " << work_stealing
+                << ", reqs/sec: " << total_reqs / ToSeconds(kRunTime);
+    }
+  }
+}
+
+// Measures call latency with blocking and busy polling reactors under various loads.
+TEST_F(RpcBench, ReactorLatency) {
+  struct Mode {
+    std::string name;
+    int32_t reactor_busy_poll_us;
+    int32_t socket_busy_poll_us;
+  };
+  const std::vector<Mode> kModes = {
+      {"blocking", 0, 0},
+      {"busy poll", 100, 0},
+      {"busy poll + SO_BUSY_POLL", 100, 50},
+  };
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  const std::vector<int> kNumClients = {1};
+  constexpr auto kRunTime = 2s;
+#else
+  const std::vector<int> kNumClients = {1, 4, 16, 64};
+  constexpr auto kRunTime = 5s;
+#endif
+  constexpr uint64_t kMaxLatencyUs = 10000000;
+
+  for (const auto& mode : kModes) {
+    FLAGS_reactor_busy_poll_us = mode.reactor_busy_poll_us;
+    FLAGS_rpc_socket_busy_poll_us = mode.socket_busy_poll_us;
+
+    TestServerOptions options;
+    options.n_worker_threads = 4;
+    StartTestServerWithGeneratedCode(&server_hostport_, options);
+
+    for (auto num_clients : kNumClients) {
+      latency_ = std::make_unique<HdrHistogram>(kMaxLatencyUs, 2);
+      auto total_reqs = RunClients(num_clients, kRunTime);
+      LOG(INFO) << "Mode: " << mode.name << ", clients: " << num_clients
+                << ", reqs/sec: " << total_reqs / ToSeconds(kRunTime)
+                << ", latency us p50: " << latency_->ValueAtPercentile(50)
+                << ", p99: " << latency_->ValueAtPercentile(99)
+                << ", p99.9: " << latency_->ValueAtPercentile(99.9);
+    }
+  }
+  latency_.reset();
+}
+
+int RpcBench::RunClients(int num_threads, std::chrono::steady_clock::duration duration) {
+  should_run_.store(true, std::memory_order_release);
+
+  std::vector<std::unique_ptr<ClientThread>> threads;
+  for (int i = 0; i < num_threads; i++) {
     auto thr = std::make_unique<ClientThread>(this);
     thr->Start();
     threads.push_back(std::move(thr));
   }
 
-  std::this_thread::sleep_for(10s);
+  std::this_thread::sleep_for(duration);
   should_run_.store(false, std::memory_order_release);
 
   int total_reqs = 0;
-
   for (const auto& thr : threads) {
     thr->Join();
     total_reqs += thr->request_count_;
   }
-  sw.stop();
-
-  float reqs_per_second = static_cast<float>(total_reqs / sw.elapsed().wall_seconds());
-  float user_cpu_micros_per_req = static_cast<float>(sw.elapsed().user / 1000.0 / total_reqs);
-  float sys_cpu_micros_per_req = static_cast<float>(sw.elapsed().system / 1000.0 / total_reqs);
-
-  LOG(INFO) << "Reqs/sec:         " << reqs_per_second;
-  LOG(INFO) << "User CPU per req: " << user_cpu_micros_per_req << "us";
-  LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
+  return total_reqs;
 }
 
 } // namespace rpc
@@ -143,10 +143,16 @@ void GenericCalculatorService::DoSendStrings(InboundCall* incoming) {
   Random r(req.random_seed());
   SendStringsResponsePB resp;
   for (auto size : req.sizes()) {
-    auto sidecar = RefCntBuffer(size);
-    RandomString(sidecar.udata(), size, &r);
+    auto buffer = RefCntBuffer(size);
+    RandomString(buffer.udata(), size, &r);
+    // Odd sidecars reference external memory, to check that it is sent without being copied.
+    RefCntSlice sidecar(buffer);
+    if (resp.sidecars_size() % 2) {
+      auto holder = std::make_shared<std::string>(buffer.ToBuffer());
+      sidecar = RefCntSlice(Slice(*holder), holder);
+    }
     int idx = 0;
-    auto status = down_cast<YBInboundCall*>(incoming)->AddRpcSidecar(sidecar, &idx);
+    auto status = down_cast<YBInboundCall*>(incoming)->AddRpcSidecar(std::move(sidecar), &idx);
     if (!status.ok()) {
       incoming->RespondFailure(ErrorStatusPB::ERROR_APPLICATION, status);
       return;
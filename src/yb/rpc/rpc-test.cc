@@ -39,19 +39,23 @@
 #include <thread>
 #include <unordered_map>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <google/protobuf/io/coded_stream.h>
 #include <gtest/gtest.h>
 
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/join.h"
 #include "yb/rpc/serialization.h"
 #include "yb/rpc/yb_rpc.h"
+#include "yb/util/coding_consts.h"
 #include "yb/util/countdown_latch.h"
 #include "yb/util/env.h"
 #include "yb/util/test_util.h"
 
 METRIC_DECLARE_histogram(handler_latency_yb_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(rpc_incoming_queue_time);
+METRIC_DECLARE_histogram(rpc_incoming_queue_time_high_priority);
 
 DEFINE_int32(rpc_test_connection_keepalive_num_iterations, 1,
   "Number of iterations in TestRpc.TestConnectionKeepalive");
@@ -59,6 +63,9 @@ DEFINE_int32(rpc_test_connection_keepalive_num_iterations, 1,
 DECLARE_uint64(rpc_connection_timeout_ms);
 DECLARE_int32(num_connections_to_server);
 DECLARE_bool(enable_rpc_keepalive);
+DECLARE_int32(rpc_zero_copy_min_buffer_size);
+DECLARE_string(rpc_fair_queuing_key);
+DECLARE_int32(rpc_max_message_size);
 
 using namespace std::chrono_literals;
 using std::string;
@@ -393,6 +400,95 @@ TEST_F(TestRpc, TestRpcSidecar) {
   DoTestSidecar(&p, sizes, Status::kRemoteError);
 }
 
+// Test that request fields serialized by the caller reach the server appended to the message,
+// whether they are sent as separate buffers or joined together.
+TEST_F(TestRpc, TestSerializedRequestFields) {
+  using google::protobuf::io::CodedOutputStream;
+
+  HostPort server_addr;
+  StartTestServer(&server_addr);
+  std::unique_ptr<Messenger> client_messenger = CreateMessenger("Client");
+  Proxy p(client_messenger.get(), server_addr);
+
+  const uint32_t kSeed = 12345;
+  // With min buffer size 4, sizes encoded into 4 bytes are sent without copying, runs of
+  // smaller ones are joined, and 40 is a single small field between large ones.
+  const std::vector<size_t> kSizes = {10, 20, 30, 20000, 40, 50000, 60000, 70, 80};
+  for (int min_buffer_size : {0, 4, 4096}) {
+    FLAGS_rpc_zero_copy_min_buffer_size = min_buffer_size;
+
+    std::vector<RefCntBuffer> fields;
+    for (auto size : kSizes) {
+      uint8_t buffer[kMaxVarint64Length + 1];
+      auto* end = CodedOutputStream::WriteTagToArray(
+          rpc_test::SendStringsRequestPB::kSizesFieldNumber << 3, buffer);
+      end = CodedOutputStream::WriteVarint64ToArray(size, end);
+      fields.emplace_back(buffer, end - buffer);
+    }
+
+    rpc_test::SendStringsRequestPB req;
+    req.set_random_seed(kSeed);
+    rpc_test::SendStringsResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(MonoDelta::FromMilliseconds(10000));
+    controller.set_serialized_request_fields(std::move(fields));
+    ASSERT_OK(p.SyncRequest(
+        CalculatorServiceMethods::SendStringsMethod(), req, &resp, &controller));
+
+    ASSERT_EQ(kSizes.size(), static_cast<size_t>(resp.sidecars_size()))
+        << "Min buffer size: " << min_buffer_size;
+    Random rng(kSeed);
+    faststring expected;
+    for (size_t i = 0; i != kSizes.size(); ++i) {
+      expected.resize(kSizes[i]);
+      RandomString(expected.data(), expected.size(), &rng);
+      Slice sidecar;
+      ASSERT_OK(controller.GetSidecar(resp.sidecars(i), &sidecar));
+      ASSERT_EQ(0, sidecar.compare(expected))
+          << "Min buffer size: " << min_buffer_size << ", field: " << i;
+    }
+  }
+}
+
+// Serialized request fields count towards the maximum RPC message size.
+TEST_F(TestRpc, TestSerializedRequestFieldsTooLong) {
+  HostPort server_addr;
+  StartTestServer(&server_addr);
+  std::unique_ptr<Messenger> client_messenger = CreateMessenger("Client");
+  Proxy p(client_messenger.get(), server_addr);
+
+  FLAGS_rpc_max_message_size = 1000;
+  std::vector<RefCntBuffer> fields;
+  fields.emplace_back(FLAGS_rpc_max_message_size);
+
+  rpc_test::SendStringsRequestPB req;
+  req.set_random_seed(12345);
+  rpc_test::SendStringsResponsePB resp;
+  RpcController controller;
+  controller.set_timeout(MonoDelta::FromMilliseconds(10000));
+  controller.set_serialized_request_fields(std::move(fields));
+  auto status = p.SyncRequest(
+      CalculatorServiceMethods::SendStringsMethod(), req, &resp, &controller);
+  ASSERT_TRUE(status.IsInvalidArgument()) << status;
+}
+
+// Proxies to the same destination share a connection pool, which is released with the last proxy.
+TEST_F(TestRpc, ReleaseConnectionPool) {
+  HostPort server_addr;
+  StartTestServer(&server_addr);
+  std::unique_ptr<Messenger> client_messenger = CreateMessenger("Client");
+
+  {
+    Proxy p1(client_messenger.get(), server_addr);
+    Proxy p2(client_messenger.get(), server_addr);
+    ASSERT_OK(DoTestSyncCall(&p1, CalculatorServiceMethods::AddMethod()));
+    ASSERT_OK(DoTestSyncCall(&p2, CalculatorServiceMethods::AddMethod()));
+    ASSERT_EQ(1U, client_messenger->TEST_num_connection_pools());
+  }
+
+  ASSERT_EQ(0U, client_messenger->TEST_num_connection_pools());
+}
+
 // Test that timeouts are properly handled.
 TEST_F(TestRpc, TestCallTimeout) {
   HostPort server_addr;
@@ -694,6 +790,174 @@ TEST_F(TestRpc, QueueTimeout) {
   ASSERT_EQ(counter->value(), kCalls - 1);
 }
 
+// Checks that high priority call does not wait for low priority calls queued before it.
+TEST_F(TestRpc, QueuePriority) {
+  const MonoDelta kBlockingSleep = 1s;
+  const MonoDelta kSleep = 10ms;
+  constexpr int kLowPriorityCalls = 10;
+  constexpr int kCalls = kLowPriorityCalls + 2;
+
+  FLAGS_rpc_fair_queuing_key = "priority";
+  // Set up server with single worker, so calls are queued while it is busy.
+  TestServerOptions options;
+  options.n_worker_threads = 1;
+  HostPort server_addr;
+  StartTestServerWithGeneratedCode(&server_addr, options);
+
+  auto client_messenger = CreateMessenger("Client");
+  Proxy p(client_messenger.get(), server_addr);
+
+  struct Call {
+    rpc_test::SleepRequestPB req;
+    rpc_test::SleepResponsePB resp;
+    RpcController controller;
+  };
+  std::vector<Call> calls(kCalls);
+  CountDownLatch latch(kCalls);
+  std::mutex mutex;
+  std::vector<int> completion_order;
+
+  auto send = [&](int index, MonoDelta sleep, RequestPriority priority) {
+    auto& call = calls[index];
+    call.req.set_sleep_micros(sleep.ToMicroseconds());
+    call.controller.set_timeout(30s);
+    call.controller.set_priority(priority);
+    p.AsyncRequest(CalculatorServiceMethods::SleepMethod(), call.req, &call.resp,
+                   &call.controller, [&, index] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        completion_order.push_back(index);
+      }
+      latch.CountDown();
+    });
+  };
+
+  send(0, kBlockingSleep, NORMAL_REQUEST_PRIORITY);
+  // Wait until the blocking call is picked by the worker.
+  std::this_thread::sleep_for((kBlockingSleep / 5).ToSteadyDuration());
+  for (int i = 1; i <= kLowPriorityCalls; ++i) {
+    send(i, kSleep, LOW_REQUEST_PRIORITY);
+  }
+  const int high_priority_index = kCalls - 1;
+  send(high_priority_index, kSleep, HIGH_REQUEST_PRIORITY);
+
+  latch.Wait();
+  for (auto& call : calls) {
+    ASSERT_OK(call.controller.status());
+  }
+
+  LOG(INFO) << "Completion order: " << yb::ToString(completion_order);
+  auto it = std::find(completion_order.begin(), completion_order.end(), high_priority_index);
+  // Blocking call and at most one low priority call could complete before the high priority call.
+  ASSERT_LE(it - completion_order.begin(), 2);
+
+  const auto& metric_map = server_messenger()->metric_entity()->UnsafeMetricsMapForTests();
+  auto high_priority_queue_time = down_cast<Histogram*>(
+      FindOrDie(metric_map, &METRIC_rpc_incoming_queue_time_high_priority).get());
+  ASSERT_EQ(1, high_priority_queue_time->TotalCount());
+}
+
+// Checks that queue time is recorded for each fair queuing class when classes are keyed by method.
+TEST_F(TestRpc, QueueTimeByMethod) {
+  constexpr int kAddCalls = 3;
+  constexpr int kSleepCalls = 2;
+
+  FLAGS_rpc_fair_queuing_key = "method";
+  HostPort server_addr;
+  StartTestServerWithGeneratedCode(&server_addr);
+
+  auto client_messenger = CreateMessenger("Client");
+  Proxy p(client_messenger.get(), server_addr);
+  for (int i = 0; i != kAddCalls; ++i) {
+    rpc_test::AddRequestPB req;
+    req.set_x(i);
+    req.set_y(i);
+    rpc_test::AddResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(5s);
+    ASSERT_OK(p.SyncRequest(CalculatorServiceMethods::AddMethod(), req, &resp, &controller));
+  }
+  for (int i = 0; i != kSleepCalls; ++i) {
+    rpc_test::SleepRequestPB req;
+    req.set_sleep_micros(1000);
+    rpc_test::SleepResponsePB resp;
+    RpcController controller;
+    controller.set_timeout(5s);
+    controller.set_priority(LOW_REQUEST_PRIORITY);
+    ASSERT_OK(p.SyncRequest(CalculatorServiceMethods::SleepMethod(), req, &resp, &controller));
+  }
+
+  auto class_count = [this](const std::string& suffix) -> int64_t {
+    const auto& metric_map = server_messenger()->metric_entity()->UnsafeMetricsMapForTests();
+    for (const auto& entry : metric_map) {
+      const std::string name = entry.first->name();
+      if (boost::starts_with(name, "rpc_incoming_queue_time_") &&
+          boost::ends_with(name, suffix)) {
+        return down_cast<Histogram*>(entry.second.get())->TotalCount();
+      }
+    }
+    return -1;
+  };
+  ASSERT_EQ(kAddCalls, class_count("_Add_with_NORMAL_REQUEST_PRIORITY"));
+  ASSERT_EQ(kSleepCalls, class_count("_Sleep_with_LOW_REQUEST_PRIORITY"));
+}
+
+// Checks that local calls handled in the current thread are not lost by the fair queue, which
+// only contains queued calls.
+TEST_F(TestRpc, LocalCallWithFairQueuing) {
+  FLAGS_rpc_fair_queuing_key = "priority";
+  HostPort server_addr;
+  StartTestServerWithGeneratedCode(&server_addr);
+
+  class LocalCallTask : public ThreadPoolTask {
+   public:
+    LocalCallTask(Messenger* messenger, bool in_curr_thread)
+        : messenger_(messenger), in_curr_thread_(in_curr_thread) {}
+
+    void Run() override {
+      Proxy p(messenger_, HostPort());
+      rpc_test::AddRequestPB req;
+      req.set_x(10);
+      req.set_y(20);
+      rpc_test::AddResponsePB resp;
+      RpcController controller;
+      controller.set_timeout(5s);
+      controller.set_allow_local_calls_in_curr_thread(in_curr_thread_);
+      status_ = p.SyncRequest(CalculatorServiceMethods::AddMethod(), req, &resp, &controller);
+      if (status_.ok() && resp.result() != 30) {
+        status_ = STATUS_FORMAT(Corruption, "Wrong result: $0", resp.result());
+      }
+    }
+
+    void Done(const Status& status) override {
+      if (status_.ok()) {
+        status_ = status;
+      }
+      latch_.CountDown();
+    }
+
+    Status Wait() {
+      latch_.Wait();
+      return status_;
+    }
+
+    virtual ~LocalCallTask() {}
+
+   private:
+    Messenger* const messenger_;
+    const bool in_curr_thread_;
+    Status status_;
+    CountDownLatch latch_{1};
+  };
+
+  for (bool in_curr_thread : {false, true}) {
+    LocalCallTask task(server_messenger(), in_curr_thread);
+    ASSERT_TRUE(server_messenger()->ThreadPool().Enqueue(&task));
+    auto status = task.Wait();
+    ASSERT_TRUE(status.ok()) << "In current thread: " << in_curr_thread << ", status: " << status;
+  }
+}
+
 struct DisconnectShare {
   Proxy proxy;
   size_t left;
@@ -169,15 +169,15 @@ void RpcContext::RespondApplicationError(int error_ext_id, const std::string& me
   responded_ = true;
 }
 
-Status RpcContext::AddRpcSidecar(RefCntBuffer car, int* idx) {
-  return call_->AddRpcSidecar(car, idx);
+Status RpcContext::AddRpcSidecar(RefCntSlice car, int* idx) {
+  return call_->AddRpcSidecar(std::move(car), idx);
 }
 
 int RpcContext::RpcSidecarsSize() const {
   return call_->RpcSidecarsSize();
 }
 
-const RefCntBuffer& RpcContext::RpcSidecar(int idx) const {
+const RefCntSlice& RpcContext::RpcSidecar(int idx) const {
   return call_->RpcSidecar(idx);
 }
 
@@ -166,15 +166,17 @@ class RpcContext {
   // copies made by serializing the protobuf.
   //
   // Assumes no changes to the sidecar's data are made after insertion.
+  // The sidecar could reference external memory kept alive by its holder, e.g. see
+  // RefCntSlice::TakeOwnership, in this case data is written to the socket without copying.
   //
   // Upon success, writes the index of the sidecar (necessary to be retrieved
   // later) to 'idx'. Call may fail if all sidecars have already been used
   // by the RPC response.
-  CHECKED_STATUS AddRpcSidecar(RefCntBuffer car, int* idx);
+  CHECKED_STATUS AddRpcSidecar(RefCntSlice car, int* idx);
 
   int RpcSidecarsSize() const;
 
-  const RefCntBuffer& RpcSidecar(int idx) const;
+  const RefCntSlice& RpcSidecar(int idx) const;
 
   // Removes all RpcSidecars.
   void ResetRpcSidecars();
@@ -67,9 +67,11 @@ void RpcController::Swap(RpcController* other) {
   }
 
   std::swap(timeout_, other->timeout_);
+  std::swap(priority_, other->priority_);
   std::swap(allow_local_calls_in_curr_thread_, other->allow_local_calls_in_curr_thread_);
   std::swap(call_, other->call_);
   std::swap(invoke_callback_mode_, other->invoke_callback_mode_);
+  std::swap(serialized_request_fields_, other->serialized_request_fields_);
 }
 
 void RpcController::Reset() {
@@ -78,6 +80,7 @@ void RpcController::Reset() {
     CHECK(finished());
   }
   call_.reset();
+  serialized_request_fields_.clear();
 }
 
 bool RpcController::finished() const {
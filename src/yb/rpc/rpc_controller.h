@@ -33,13 +33,16 @@
 #define YB_RPC_RPC_CONTROLLER_H
 
 #include <memory>
+#include <vector>
 
 #include <glog/logging.h>
 
 #include "yb/gutil/macros.h"
 #include "yb/rpc/rpc_fwd.h"
+#include "yb/rpc/rpc_header.pb.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -146,6 +149,21 @@ class RpcController {
   // Return the configured timeout.
   MonoDelta timeout() const;
 
+  // Priority used by the server to order the call in the service queue.
+  void set_priority(RequestPriority priority) { priority_ = priority; }
+  RequestPriority priority() const { return priority_; }
+
+  // Sets protobuf fields of the request that are already serialized, and are sent right after the
+  // serialized request message. So the same data could be sent to several servers without being
+  // serialized for each of them. Not supported for local calls.
+  void set_serialized_request_fields(std::vector<RefCntBuffer> fields) {
+    serialized_request_fields_ = std::move(fields);
+  }
+
+  const std::vector<RefCntBuffer>& serialized_request_fields() const {
+    return serialized_request_fields_;
+  }
+
   // Fills the 'sidecar' parameter with the slice pointing to the i-th
   // sidecar upon success.
   //
@@ -160,6 +178,7 @@ class RpcController {
   friend class Proxy;
 
   MonoDelta timeout_;
+  RequestPriority priority_ = NORMAL_REQUEST_PRIORITY;
 
   mutable simple_spinlock lock_;
 
@@ -168,6 +187,9 @@ class RpcController {
   bool allow_local_calls_in_curr_thread_ = false;
   InvokeCallbackMode invoke_callback_mode_ = InvokeCallbackMode::kThreadPool;
 
+  // Moved to the call when the request is sent.
+  std::vector<RefCntBuffer> serialized_request_fields_;
+
   DISALLOW_COPY_AND_ASSIGN(RpcController);
 };
 
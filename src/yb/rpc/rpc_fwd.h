@@ -80,6 +80,9 @@ class ConnectionContext;
 typedef std::shared_ptr<Connection> ConnectionPtr;
 typedef std::weak_ptr<Connection> ConnectionWeakPtr;
 
+class ConnectionPool;
+typedef std::shared_ptr<ConnectionPool> ConnectionPoolPtr;
+
 class InboundCall;
 typedef std::shared_ptr<InboundCall> InboundCallPtr;
 
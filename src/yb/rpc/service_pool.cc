@@ -32,9 +32,12 @@
 
 #include "yb/rpc/service_pool.h"
 
+#include <array>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/asio/strand.hpp>
@@ -58,6 +61,7 @@
 #include "yb/util/status.h"
 #include "yb/util/thread.h"
 #include "yb/util/trace.h"
+#include "yb/util/weighted_fair_queue.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
@@ -74,6 +78,24 @@ DEFINE_int64(backpressure_recovery_period_ms, 600000,
              "for this duration (in ms)");
 TAG_FLAG(backpressure_recovery_period_ms, advanced);
 TAG_FLAG(backpressure_recovery_period_ms, runtime);
+DEFINE_string(rpc_fair_queuing_key, "none",
+              "How calls waiting in the service queue are split into classes that share the "
+              "workers according to their weights: none - single FIFO queue, priority - by request "
+              "priority, method - by request priority and method, client - by request priority "
+              "and client address.");
+TAG_FLAG(rpc_fair_queuing_key, advanced);
+DEFINE_int32(rpc_low_priority_weight, 1,
+             "Share of service workers given to the calls with low priority.");
+TAG_FLAG(rpc_low_priority_weight, advanced);
+TAG_FLAG(rpc_low_priority_weight, runtime);
+DEFINE_int32(rpc_normal_priority_weight, 4,
+             "Share of service workers given to the calls with normal priority.");
+TAG_FLAG(rpc_normal_priority_weight, advanced);
+TAG_FLAG(rpc_normal_priority_weight, runtime);
+DEFINE_int32(rpc_high_priority_weight, 16,
+             "Share of service workers given to the calls with high priority.");
+TAG_FLAG(rpc_high_priority_weight, advanced);
+TAG_FLAG(rpc_high_priority_weight, runtime);
 DEFINE_test_flag(bool, enable_backpressure_mode_for_testing, false,
             "For testing purposes. Enables the rpc's to be considered timed out in the queue even "
             "when we have not had any backpressure in the recent past.");
@@ -84,6 +106,27 @@ METRIC_DEFINE_histogram(server, rpc_incoming_queue_time,
                         "Number of microseconds incoming RPC requests spend in the worker queue",
                         60000000LU, 3);
 
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_low_priority,
+                        "RPC Queue Time for Low Priority Requests",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming RPC requests with low priority spend in "
+                        "the worker queue",
+                        60000000LU, 3);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_normal_priority,
+                        "RPC Queue Time for Normal Priority Requests",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming RPC requests with normal priority spend "
+                        "in the worker queue",
+                        60000000LU, 3);
+
+METRIC_DEFINE_histogram(server, rpc_incoming_queue_time_high_priority,
+                        "RPC Queue Time for High Priority Requests",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming RPC requests with high priority spend in "
+                        "the worker queue",
+                        60000000LU, 3);
+
 METRIC_DEFINE_counter(server, rpcs_timed_out_in_queue,
                       "RPC Queue Timeouts",
                       yb::MetricUnit::kRequests,
@@ -110,8 +153,68 @@ namespace rpc {
 namespace {
 
 const CoarseDuration kTimeoutCheckGranularity = 100ms;
+// Limits the number of fair queuing classes keyed by method or client that get their own queue
+// time histogram, since the number of distinct clients is not bounded.
+const size_t kMaxClassQueueTimeHistograms = 100;
 const char* const kTimedOutInQueue = "Call waited in the queue past deadline";
 
+YB_DEFINE_ENUM(FairQueuingKey, (kNone)(kPriority)(kMethod)(kClient));
+
+bool ParseFairQueuingKey(const std::string& value, FairQueuingKey* key) {
+  if (value == "none") {
+    *key = FairQueuingKey::kNone;
+  } else if (value == "priority") {
+    *key = FairQueuingKey::kPriority;
+  } else if (value == "method") {
+    *key = FairQueuingKey::kMethod;
+  } else if (value == "client") {
+    *key = FairQueuingKey::kClient;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ValidateFairQueuingKey(const char* flagname, const std::string& value) {
+  FairQueuingKey key;
+  if (ParseFairQueuingKey(value, &key)) {
+    return true;
+  }
+  LOG(ERROR) << flagname << " should be one of none, priority, method or client, got: " << value;
+  return false;
+}
+
+bool dummy = google::RegisterFlagValidator(&FLAGS_rpc_fair_queuing_key, &ValidateFairQueuingKey);
+
+// Converts an arbitrary string to a part of a metric name.
+std::string MetricNamePart(const std::string& input) {
+  std::string result = input;
+  for (auto& c : result) {
+    if (!isalnum(c)) {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+FairQueuingKey GetFairQueuingKey() {
+  FairQueuingKey result = FairQueuingKey::kNone;
+  ParseFairQueuingKey(FLAGS_rpc_fair_queuing_key, &result);
+  return result;
+}
+
+uint64_t PriorityWeight(RequestPriority priority) {
+  switch (priority) {
+    case LOW_REQUEST_PRIORITY:
+      return GetAtomicFlag(&FLAGS_rpc_low_priority_weight);
+    case NORMAL_REQUEST_PRIORITY:
+      return GetAtomicFlag(&FLAGS_rpc_normal_priority_weight);
+    case HIGH_REQUEST_PRIORITY:
+      return GetAtomicFlag(&FLAGS_rpc_high_priority_weight);
+  }
+  FATAL_INVALID_ENUM_VALUE(RequestPriority, priority);
+}
+
 } // namespace
 
 class ServicePoolImpl final : public InboundCallHandler {
@@ -126,10 +229,16 @@ class ServicePoolImpl final : public InboundCallHandler {
         scheduler_(*scheduler),
         service_(std::move(service)),
         incoming_queue_time_(METRIC_rpc_incoming_queue_time.Instantiate(entity)),
+        incoming_queue_time_by_priority_{
+            METRIC_rpc_incoming_queue_time_low_priority.Instantiate(entity),
+            METRIC_rpc_incoming_queue_time_normal_priority.Instantiate(entity),
+            METRIC_rpc_incoming_queue_time_high_priority.Instantiate(entity)},
         rpcs_timed_out_in_queue_(METRIC_rpcs_timed_out_in_queue.Instantiate(entity)),
         rpcs_timed_out_early_in_queue_(
             METRIC_rpcs_timed_out_early_in_queue.Instantiate(entity)),
         rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
+        fair_queuing_key_(GetFairQueuingKey()),
+        metric_entity_(entity),
         check_timeout_strand_(scheduler->io_service()),
         log_prefix_(Format("$0: ", service_->service_name())) {
   }
@@ -140,6 +249,9 @@ class ServicePoolImpl final : public InboundCallHandler {
     while (scheduled_tasks_.load(std::memory_order_acquire) != 0) {
       std::this_thread::sleep_for(10ms);
     }
+    for (const auto& p : class_queue_time_) {
+      metric_entity_->Remove(p.second->prototype());
+    }
   }
 
   void Shutdown() {
@@ -178,6 +290,13 @@ class ServicePoolImpl final : public InboundCallHandler {
       ScheduleCheckTimeout(call_deadline);
     }
 
+    if (fair_queuing_key_ != FairQueuingKey::kNone) {
+      auto key = FairQueuingClass(*call);
+      auto weight = PriorityWeight(call->priority());
+      std::lock_guard<std::mutex> lock(fair_queue_mutex_);
+      fair_queue_.Push(key, weight, call);
+    }
+
     thread_pool_.Enqueue(task);
   }
 
@@ -210,8 +329,9 @@ class ServicePoolImpl final : public InboundCallHandler {
         CoarseMonoClock::Now().time_since_epoch(), std::memory_order_release);
   }
 
-  void Failure(const InboundCallPtr& call, const Status& status) override {
-    if (!call->TryStartProcessing()) {
+  void Failure(const InboundCallPtr& failed_call, const Status& status) override {
+    auto call = RemoveFailedCall(failed_call);
+    if (!call || !call->TryStartProcessing()) {
       return;
     }
 
@@ -227,8 +347,21 @@ class ServicePoolImpl final : public InboundCallHandler {
     call->RespondFailure(ErrorStatusPB::FATAL_SERVER_SHUTTING_DOWN, response_status);
   }
 
-  void Handle(InboundCallPtr incoming) override {
+  // Invoked by the thread pool task of a queued call.
+  void Handle(InboundCallPtr call) override {
+    auto incoming = NextCall(call);
+    if (incoming) {
+      HandleCall(std::move(incoming));
+    }
+  }
+
+  // Local calls could be handled in the current thread without being queued, so they bypass the
+  // fair queue.
+  void HandleCall(InboundCallPtr incoming) {
     incoming->RecordHandlingStarted(incoming_queue_time_);
+    const auto queue_time_us = incoming->GetTimeInQueue().ToMicroseconds();
+    IncomingQueueTimeHistogram(incoming->priority())->Increment(queue_time_us);
+    IncrementHistogram(ClassQueueTimeHistogram(*incoming), queue_time_us);
     ADOPT_TRACE(incoming->trace());
 
     const char* error_message;
@@ -255,6 +388,91 @@ class ServicePoolImpl final : public InboundCallHandler {
   }
 
  private:
+  // When fair queuing is enabled, the thread pool task of a call handles the call selected by the
+  // fair queue, which is not necessarily the same call. Since each queued call has exactly one
+  // task, every call is still handled exactly once.
+  InboundCallPtr NextCall(const InboundCallPtr& call) {
+    if (fair_queuing_key_ == FairQueuingKey::kNone) {
+      return call;
+    }
+    InboundCallPtr result;
+    std::lock_guard<std::mutex> lock(fair_queue_mutex_);
+    fair_queue_.Pop(&result);
+    return result;
+  }
+
+  // The task of the failed call was not queued, so one call has to be removed from the fair queue
+  // to keep the number of queued calls equal to the number of tasks. It is the failed call itself,
+  // unless it was already picked by the task of another call. In this case that other call is the
+  // one that lost its task, and it is still in the queue.
+  InboundCallPtr RemoveFailedCall(const InboundCallPtr& call) {
+    if (fair_queuing_key_ == FairQueuingKey::kNone) {
+      return call;
+    }
+    auto key = FairQueuingClass(*call);
+    std::lock_guard<std::mutex> lock(fair_queue_mutex_);
+    if (fair_queue_.Remove(key, call)) {
+      return call;
+    }
+    InboundCallPtr result;
+    fair_queue_.Pop(&result);
+    return result;
+  }
+
+  // Returns queue time histogram of the fair queuing class of the call, when classes are keyed by
+  // method or client. Histograms are created on first use, up to kMaxClassQueueTimeHistograms.
+  scoped_refptr<Histogram> ClassQueueTimeHistogram(const InboundCall& call) {
+    if (fair_queuing_key_ != FairQueuingKey::kMethod &&
+        fair_queuing_key_ != FairQueuingKey::kClient) {
+      return nullptr;
+    }
+    auto key = FairQueuingClass(call);
+    std::lock_guard<std::mutex> lock(class_queue_time_mutex_);
+    auto it = class_queue_time_.find(key);
+    if (it != class_queue_time_.end()) {
+      return it->second;
+    }
+    if (class_queue_time_.size() >= kMaxClassQueueTimeHistograms) {
+      return nullptr;
+    }
+    auto class_name = Format(
+        "$0 with $1",
+        fair_queuing_key_ == FairQueuingKey::kMethod
+            ? call.method_name() : call.remote_address().address().to_string(),
+        RequestPriority_Name(call.priority()));
+    auto histogram = metric_entity_->FindOrCreateHistogram(
+        std::unique_ptr<HistogramPrototype>(new OwningHistogramPrototype(
+            metric_entity_->prototype().name(),
+            MetricNamePart(Format("rpc_incoming_queue_time_$0_$1",
+                                  service_->service_name(), class_name)),
+            Format("RPC Queue Time for $0 of $1", class_name, service_->service_name()),
+            MetricUnit::kMicroseconds,
+            Format("Number of microseconds incoming RPC requests of $0 to $1 spend in the worker "
+                   "queue", class_name, service_->service_name()),
+            60000000LU, 3)));
+    class_queue_time_.emplace(std::move(key), histogram);
+    return histogram;
+  }
+
+  std::string FairQueuingClass(const InboundCall& call) {
+    std::string result(1, static_cast<char>('0' + call.priority()));
+    switch (fair_queuing_key_) {
+      case FairQueuingKey::kNone: FALLTHROUGH_INTENDED;
+      case FairQueuingKey::kPriority:
+        return result;
+      case FairQueuingKey::kMethod:
+        return result + call.method_name();
+      case FairQueuingKey::kClient:
+        return result + call.remote_address().address().to_string();
+    }
+    FATAL_INVALID_ENUM_VALUE(FairQueuingKey, fair_queuing_key_);
+  }
+
+  const scoped_refptr<Histogram>& IncomingQueueTimeHistogram(RequestPriority priority) {
+    auto index = std::min<size_t>(priority, incoming_queue_time_by_priority_.size() - 1);
+    return incoming_queue_time_by_priority_[index];
+  }
+
   void TimedOut(InboundCall* call, const char* error_message, Counter* metric) {
     if (call->RespondTimedOutIfPending(error_message)) {
       metric->Increment();
@@ -382,6 +600,8 @@ class ServicePoolImpl final : public InboundCallHandler {
   Scheduler& scheduler_;
   ServiceIfPtr service_;
   scoped_refptr<Histogram> incoming_queue_time_;
+  // Indexed by RequestPriority.
+  std::array<scoped_refptr<Histogram>, RequestPriority_ARRAYSIZE> incoming_queue_time_by_priority_;
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_timed_out_early_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
@@ -389,6 +609,15 @@ class ServicePoolImpl final : public InboundCallHandler {
   std::atomic<CoarseDuration> last_backpressure_at_{CoarseTimePoint().time_since_epoch()};
   std::atomic<int64_t> queued_calls_{0};
 
+  const FairQueuingKey fair_queuing_key_;
+  std::mutex fair_queue_mutex_;
+  WeightedFairQueue<std::string, InboundCallPtr> fair_queue_;
+
+  scoped_refptr<MetricEntity> metric_entity_;
+  std::mutex class_queue_time_mutex_;
+  // Queue time histograms of fair queuing classes, keyed by FairQueuingClass.
+  std::unordered_map<std::string, scoped_refptr<Histogram>> class_queue_time_;
+
   // It is too expensive to update timeout priority queue when each call is received.
   // So we are doing the following trick.
   // All calls are added to pre_check_timeout_queue_, w/o priority.
@@ -449,7 +678,7 @@ void ServicePool::QueueInboundCall(InboundCallPtr call) {
 }
 
 void ServicePool::Handle(InboundCallPtr call) {
-  impl_->Handle(std::move(call));
+  impl_->HandleCall(std::move(call));
 }
 
 const Counter* ServicePool::RpcsTimedOutInQueueMetricForTests() const {
@@ -22,6 +22,12 @@
 using namespace std::literals;
 
 DECLARE_uint64(rpc_connection_timeout_ms);
+DEFINE_int32(rpc_socket_busy_poll_us, 0,
+             "Value of SO_BUSY_POLL set on RPC sockets, i.e. number of microseconds to busy poll "
+             "the device queue when there is no data to read. 0 to leave the socket default. "
+             "Raising it above net.core.busy_read could require CAP_NET_ADMIN.");
+TAG_FLAG(rpc_socket_busy_poll_us, advanced);
+
 DEFINE_test_flag(int32, TEST_delay_connect_ms, 0,
                  "Delay connect in tests for specified amount of milliseconds.");
 
@@ -58,6 +64,9 @@ Status TcpStream::Start(bool connect, ev::loop_ref* loop, StreamContext* context
   connected_ = !connect;
 
   RETURN_NOT_OK(socket_.SetNoDelay(true));
+  if (FLAGS_rpc_socket_busy_poll_us > 0) {
+    WARN_NOT_OK(socket_.SetBusyPoll(FLAGS_rpc_socket_busy_poll_us), "Failed to set busy poll");
+  }
   // These timeouts don't affect non-blocking sockets:
   RETURN_NOT_OK(socket_.SetSendTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
   RETURN_NOT_OK(socket_.SetRecvTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
@@ -165,7 +174,7 @@ TcpStream::FillIovResult TcpStream::FillIov(iovec* out) {
         continue;
       }
 
-      out[index].iov_base = bytes.data() + offset;
+      out[index].iov_base = const_cast<char*>(bytes.data()) + offset;
       out[index].iov_len = bytes.size() - offset;
       offset = 0;
       if (++index == kMaxIov) {
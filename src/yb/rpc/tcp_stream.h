@@ -117,7 +117,7 @@ class TcpStream : public Stream {
 
   bool read_buffer_full_ = false;
 
-  typedef boost::container::small_vector<RefCntBuffer, 4> SendingBytes;
+  typedef boost::container::small_vector<RefCntSlice, 4> SendingBytes;
 
   struct SendingData {
     SendingData(OutboundDataPtr data_, const MemTrackerPtr& mem_tracker);
@@ -24,6 +24,8 @@
 #include "yb/util/test_util.h"
 #include "yb/util/thread.h"
 
+DECLARE_bool(rpc_thread_pool_work_stealing);
+
 namespace yb {
 namespace rpc {
 
@@ -253,5 +255,98 @@ TEST_F(ThreadPoolTest, TestOwns) {
   ASSERT_TRUE(pool.Owns(task.thread()));
 }
 
+namespace {
+
+class ChildTask : public ThreadPoolTask {
+ public:
+  void Run() override {
+    thread_ = Thread::current_thread();
+  }
+
+  void Done(const Status& status) override {
+    ASSERT_OK(status);
+    latch_->CountDown();
+  }
+
+  virtual ~ChildTask() {}
+
+  CountDownLatch* latch_ = nullptr;
+  Thread* thread_ = nullptr;
+};
+
+// Enqueues children from a worker thread and blocks this worker until all of them are completed.
+class ParentTask : public ThreadPoolTask {
+ public:
+  ParentTask(ThreadPool* pool, std::vector<ChildTask>* children)
+      : pool_(pool), children_(children), children_latch_(children->size()) {}
+
+  void Run() override {
+    thread_ = Thread::current_thread();
+    for (auto& child : *children_) {
+      child.latch_ = &children_latch_;
+      ASSERT_TRUE(pool_->Enqueue(&child));
+    }
+    children_latch_.Wait();
+  }
+
+  void Done(const Status& status) override {
+    ASSERT_OK(status);
+    latch_.CountDown();
+  }
+
+  void Wait() {
+    latch_.Wait();
+  }
+
+  Thread* thread() const {
+    return thread_;
+  }
+
+  virtual ~ParentTask() {}
+
+ private:
+  ThreadPool* const pool_;
+  std::vector<ChildTask>* const children_;
+  CountDownLatch children_latch_;
+  CountDownLatch latch_{1};
+  Thread* thread_ = nullptr;
+};
+
+// Returns the number of stolen tasks.
+size_t RunParentTask(size_t num_children) {
+  constexpr size_t kTotalWorkers = 4;
+
+  ThreadPool pool("test", num_children, kTotalWorkers);
+  std::vector<ChildTask> children(num_children);
+  ParentTask parent(&pool, &children);
+  EXPECT_TRUE(pool.Enqueue(&parent));
+  parent.Wait();
+
+  for (const auto& child : children) {
+    EXPECT_TRUE(pool.Owns(child.thread_));
+    EXPECT_NE(parent.thread(), child.thread_);
+  }
+  return pool.TEST_num_stolen_tasks();
+}
+
+} // namespace
+
+// Tasks enqueued by a worker go to its own queue, so they could be completed while this worker is
+// blocked only when other workers steal them.
+TEST_F(ThreadPoolTest, TestWorkStealing) {
+  constexpr size_t kTotalTasks = 1000;
+
+  FLAGS_rpc_thread_pool_work_stealing = true;
+  ASSERT_EQ(kTotalTasks, RunParentTask(kTotalTasks));
+}
+
+// Without work stealing, tasks enqueued by a worker go to the shared queue.
+TEST_F(ThreadPoolTest, TestSharedQueue) {
+  constexpr size_t kTotalTasks = 1000;
+
+  FLAGS_rpc_thread_pool_work_stealing = false;
+  ASSERT_EQ(0U, RunParentTask(kTotalTasks));
+}
+
 } // namespace rpc
 } // namespace yb
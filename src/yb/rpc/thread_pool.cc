@@ -15,6 +15,7 @@
 
 #include "yb/rpc/thread_pool.h"
 
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -24,37 +25,139 @@
 #include <cds/container/basket_queue.h>
 #include <cds/gc/dhp.h>
 
+#include "yb/util/cpu_affinity.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/thread.h"
 
+DEFINE_bool(rpc_thread_pool_work_stealing, true,
+            "Whether each RPC thread pool worker has its own task queue, and idle workers steal "
+            "tasks from the queues of busy workers. Otherwise all workers share a single queue.");
+TAG_FLAG(rpc_thread_pool_work_stealing, advanced);
+
+DEFINE_bool(rpc_numa_aware_threads, false,
+            "Bind RPC workers and reactors to NUMA nodes in round robin order, and prefer passing "
+            "tasks between threads of the same node.");
+TAG_FLAG(rpc_numa_aware_threads, advanced);
+
+DEFINE_string(rpc_threads_cpu_list, "",
+              "CPUs that RPC workers and reactors are allowed to run on, in the format of Linux "
+              "cpusets, for instance 0-15,32-47. Empty means no restriction.");
+TAG_FLAG(rpc_threads_cpu_list, advanced);
+
 namespace yb {
 namespace rpc {
 
 namespace {
 
 class Worker;
+struct ThreadPoolShare;
 
 typedef cds::container::BasketQueue<cds::gc::DHP, ThreadPoolTask*> TaskQueue;
 typedef cds::container::BasketQueue<cds::gc::DHP, Worker*> WaitingWorkers;
 
+const std::string kRpcThreadCategory = "rpc_thread_pool";
+
+// NUMA node the current thread was bound to by PinRpcThread, or -1.
+thread_local int current_numa_node = -1;
+
+// Pool and index of the worker running in the current thread.
+thread_local ThreadPoolShare* current_worker_share = nullptr;
+thread_local size_t current_worker_index = 0;
+
 struct ThreadPoolShare {
   ThreadPoolOptions options;
+  const bool work_stealing;
   TaskQueue task_queue;
   WaitingWorkers waiting_workers;
 
+  // When work stealing is enabled, each worker has its own queue. Queues are kept here instead of
+  // workers, so they could be stolen from and drained regardless of the worker lifetime.
+  std::unique_ptr<TaskQueue[]> local_queues;
+  // NUMA nodes of the workers, -1 when the worker is not bound to a node or not started yet.
+  std::unique_ptr<std::atomic<int>[]> worker_nodes;
+
+  // Incremented each time a new worker could be created, so it could exceed max_workers.
+  std::atomic<size_t> created_workers = {0};
+  // Used to distribute tasks enqueued from outside of the pool between worker queues.
+  std::atomic<size_t> next_queue = {0};
+  std::atomic<size_t> num_stolen_tasks = {0};
+
   explicit ThreadPoolShare(ThreadPoolOptions o)
-      : options(std::move(o)) {}
-};
+      : options(std::move(o)),
+        work_stealing(FLAGS_rpc_thread_pool_work_stealing && options.max_workers > 1) {
+    if (work_stealing) {
+      local_queues.reset(new TaskQueue[options.max_workers]);
+      worker_nodes.reset(new std::atomic<int>[options.max_workers]);
+      for (size_t i = 0; i != options.max_workers; ++i) {
+        worker_nodes[i].store(-1, std::memory_order_relaxed);
+      }
+    }
+  }
 
-namespace {
+  // Number of worker queues that could contain tasks.
+  size_t NumQueues() const {
+    return std::min(created_workers.load(std::memory_order_acquire), options.max_workers);
+  }
 
-const std::string kRpcThreadCategory = "rpc_thread_pool";
+  // Workers push tasks to their own queues. Other threads push tasks to the queues of workers in
+  // round robin order, preferring workers on the NUMA node of the current thread.
+  TaskQueue& QueueForNewTask() {
+    if (!work_stealing) {
+      return task_queue;
+    }
+    if (current_worker_share == this) {
+      return local_queues[current_worker_index];
+    }
+    auto num_queues = NumQueues();
+    if (num_queues == 0) {
+      return task_queue;
+    }
+    auto start = next_queue.fetch_add(1, std::memory_order_relaxed);
+    if (current_numa_node >= 0) {
+      for (size_t i = 0; i != num_queues; ++i) {
+        auto index = (start + i) % num_queues;
+        if (worker_nodes[index].load(std::memory_order_relaxed) == current_numa_node) {
+          return local_queues[index];
+        }
+      }
+    }
+    return local_queues[start % num_queues];
+  }
 
-} // namespace
+  bool QueuesEmpty() const {
+    if (!task_queue.empty()) {
+      return false;
+    }
+    if (work_stealing) {
+      for (size_t i = 0; i != options.max_workers; ++i) {
+        if (!local_queues[i].empty()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  template <class F>
+  void DrainQueues(const F& f) {
+    ThreadPoolTask* task = nullptr;
+    while (task_queue.pop(task)) {
+      f(task);
+    }
+    if (work_stealing) {
+      for (size_t i = 0; i != options.max_workers; ++i) {
+        while (local_queues[i].pop(task)) {
+          f(task);
+        }
+      }
+    }
+  }
+};
 
 class Worker {
  public:
   explicit Worker(ThreadPoolShare* share, size_t index)
-      : share_(share) {
+      : share_(share), index_(index) {
     auto name = strings::Substitute("rpc_tp_$0_$1", share_->options.name, index);
     CHECK_OK(yb::Thread::Create(kRpcThreadCategory, name, &Worker::Execute, this, &thread_));
   }
@@ -94,6 +197,12 @@ class Worker {
   // does not have free hands (worker queue empty)
   void Execute() {
     Thread::current_thread()->SetUserData(share_);
+    current_worker_share = share_;
+    current_worker_index = index_;
+    numa_node_ = PinRpcThread(index_);
+    if (share_->work_stealing) {
+      share_->worker_nodes[index_].store(numa_node_, std::memory_order_relaxed);
+    }
     while (!stop_requested_) {
       ThreadPoolTask* task = nullptr;
       if (PopTask(&task)) {
@@ -106,7 +215,7 @@ class Worker {
   bool PopTask(ThreadPoolTask** task) {
     // First of all we try to get already queued task, w/o locking.
     // If there is no task, so we could go to waiting state.
-    if (share_->task_queue.pop(*task)) {
+    if (TryPopTask(task)) {
       return true;
     }
     std::unique_lock<std::mutex> lock(mutex_);
@@ -122,7 +231,7 @@ class Worker {
       // the worker queue. So worker queue could be empty in this case, and nobody was notified
       // about new task. So we check there for this case. This technique is similar to
       // double check.
-      if (share_->task_queue.pop(*task)) {
+      if (TryPopTask(task)) {
         return true;
       }
 
@@ -130,13 +239,46 @@ class Worker {
 
       // Sometimes another worker could steal task before we wake up. In this case we will
       // just enqueue ourselves back.
-      if (share_->task_queue.pop(*task)) {
+      if (TryPopTask(task)) {
         return true;
       }
     }
     return false;
   }
 
+  bool TryPopTask(ThreadPoolTask** task) {
+    if (share_->work_stealing && share_->local_queues[index_].pop(*task)) {
+      return true;
+    }
+    if (share_->task_queue.pop(*task)) {
+      return true;
+    }
+    return share_->work_stealing && StealTask(task);
+  }
+
+  // Workers of the same NUMA node are tried first, since their tasks are more likely to have data
+  // in the caches shared with us.
+  bool StealTask(ThreadPoolTask** task) {
+    auto num_queues = share_->NumQueues();
+    for (bool same_node : {true, false}) {
+      if (same_node && numa_node_ < 0) {
+        continue;
+      }
+      for (size_t i = 1; i < num_queues; ++i) {
+        auto victim = (index_ + i) % num_queues;
+        if (same_node &&
+            share_->worker_nodes[victim].load(std::memory_order_relaxed) != numa_node_) {
+          continue;
+        }
+        if (share_->local_queues[victim].pop(*task)) {
+          share_->num_stolen_tasks.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
   void AddToWaitingWorkers() {
     if (!added_to_waiting_workers_) {
       auto pushed = share_->waiting_workers.push(this);
@@ -146,6 +288,8 @@ class Worker {
   }
 
   ThreadPoolShare* share_;
+  const size_t index_;
+  int numa_node_ = -1;
   scoped_refptr<yb::Thread> thread_;
   std::mutex mutex_;
   std::condition_variable cond_;
@@ -180,7 +324,7 @@ class ThreadPool::Impl {
       task->Done(shutdown_status_);
       return false;
     }
-    bool added = share_.task_queue.push(task);
+    bool added = share_.QueueForNewTask().push(task);
     DCHECK(added); // BasketQueue always succeed.
     --adding_;
     Worker* worker = nullptr;
@@ -193,25 +337,25 @@ class ThreadPool::Impl {
     // We increment created_workers_ every time, the first max_worker increments would produce
     // a new worker. And after that, we will just increment it doing nothing after that.
     // So we could be lock free here.
-    auto index = created_workers_++;
+    auto index = share_.created_workers++;
     if (index < share_.options.max_workers) {
       std::lock_guard<std::mutex> lock(mutex_);
       if (!closing_) {
         workers_[index].reset(new Worker(&share_, index));
       }
     } else {
-      --created_workers_;
+      --share_.created_workers;
     }
     return true;
   }
 
   void Shutdown() {
     // Block creating new workers.
-    created_workers_ += workers_.size();
+    share_.created_workers += workers_.size();
     {
       std::lock_guard<std::mutex> lock(mutex_);
       if (closing_) {
-        CHECK(share_.task_queue.empty());
+        CHECK(share_.QueuesEmpty());
         CHECK(workers_.empty());
         return;
       }
@@ -229,20 +373,22 @@ class ThreadPool::Impl {
     while(adding_ != 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-    ThreadPoolTask* task = nullptr;
-    while (share_.task_queue.pop(task)) {
+    share_.DrainQueues([this](ThreadPoolTask* task) {
       task->Done(shutdown_status_);
-    }
+    });
   }
 
   bool Owns(Thread* thread) {
     return thread && thread->user_data() == &share_;
   }
 
+  size_t TEST_num_stolen_tasks() const {
+    return share_.num_stolen_tasks.load(std::memory_order_relaxed);
+  }
+
  private:
   ThreadPoolShare share_;
   std::vector<std::unique_ptr<Worker>> workers_;
-  std::atomic<size_t> created_workers_ = {0};
   std::mutex mutex_;
   std::atomic<bool> closing_ = {false};
   std::atomic<size_t> adding_ = {0};
@@ -274,6 +420,57 @@ bool ThreadPool::IsCurrentThreadRpcWorker() {
   return thread != nullptr && thread->category() == kRpcThreadCategory;
 }
 
+int PinRpcThread(size_t index) {
+  std::vector<int> allowed_cpus;
+  if (!FLAGS_rpc_threads_cpu_list.empty()) {
+    auto cpus = ParseCpuList(FLAGS_rpc_threads_cpu_list);
+    if (!cpus.ok()) {
+      LOG(WARNING) << "Invalid rpc_threads_cpu_list: " << cpus.status();
+      return -1;
+    }
+    allowed_cpus = std::move(*cpus);
+  }
+
+  int numa_node = -1;
+  std::vector<int> cpus;
+  if (FLAGS_rpc_numa_aware_threads) {
+    // Nodes are assigned in round robin order among the nodes that have allowed CPUs.
+    std::vector<std::pair<int, std::vector<int>>> candidates;
+    const auto& nodes = NumaNodes();
+    for (size_t node = 0; node != nodes.size(); ++node) {
+      std::vector<int> node_cpus;
+      if (allowed_cpus.empty()) {
+        node_cpus = nodes[node];
+      } else {
+        std::set_intersection(nodes[node].begin(), nodes[node].end(),
+                              allowed_cpus.begin(), allowed_cpus.end(),
+                              std::back_inserter(node_cpus));
+      }
+      if (!node_cpus.empty()) {
+        candidates.emplace_back(node, std::move(node_cpus));
+      }
+    }
+    if (!candidates.empty()) {
+      auto& candidate = candidates[index % candidates.size()];
+      numa_node = candidate.first;
+      cpus = std::move(candidate.second);
+    }
+  } else {
+    cpus = std::move(allowed_cpus);
+  }
+
+  if (cpus.empty()) {
+    return -1;
+  }
+  auto status = SetCurrentThreadCpuAffinity(cpus);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to pin RPC thread: " << status;
+    return -1;
+  }
+  current_numa_node = numa_node;
+  return numa_node;
+}
+
 bool ThreadPool::Enqueue(ThreadPoolTask* task) {
   return impl_->Enqueue(task);
 }
@@ -294,5 +491,9 @@ bool ThreadPool::OwnsThisThread() {
   return Owns(Thread::current_thread());
 }
 
+size_t ThreadPool::TEST_num_stolen_tasks() const {
+  return impl_->TEST_num_stolen_tasks();
+}
+
 } // namespace rpc
 } // namespace yb
@@ -71,12 +71,20 @@ class ThreadPool {
   bool Owns(Thread* thread);
   bool OwnsThisThread();
 
+  // Number of tasks that workers took from the queues of other workers.
+  size_t TEST_num_stolen_tasks() const;
+
  private:
   class Impl;
 
   std::unique_ptr<Impl> impl_;
 };
 
+// Binds the current RPC worker or reactor thread with the specified index to CPUs according to
+// rpc_threads_cpu_list and rpc_numa_aware_threads.
+// Returns NUMA node of the thread, or -1 if the thread was not bound to a node.
+int PinRpcThread(size_t index);
+
 } // namespace rpc
 } // namespace yb
 
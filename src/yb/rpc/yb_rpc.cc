@@ -254,7 +254,7 @@ Status YBInboundCall::ParseFrom(const MemTrackerPtr& mem_tracker, CallData* call
   return Status::OK();
 }
 
-Status YBInboundCall::AddRpcSidecar(RefCntBuffer car, int* idx) {
+Status YBInboundCall::AddRpcSidecar(RefCntSlice car, int* idx) {
   // Check that the number of sidecars does not exceed the number of payload
   // slices that are free.
   if(sidecars_.size() >= CallResponse::kMaxSidecarSlices) {
@@ -273,7 +273,7 @@ int YBInboundCall::RpcSidecarsSize() const {
   return sidecars_.size();
 }
 
-const RefCntBuffer& YBInboundCall::RpcSidecar(int idx) {
+const RefCntSlice& YBInboundCall::RpcSidecar(int idx) {
   return sidecars_[idx];
 }
 
@@ -376,7 +376,7 @@ void YBInboundCall::LogTrace() const {
   }
 }
 
-void YBInboundCall::Serialize(boost::container::small_vector_base<RefCntBuffer>* output) {
+void YBInboundCall::Serialize(boost::container::small_vector_base<RefCntSlice>* output) {
   TRACE_EVENT0("rpc", "YBInboundCall::Serialize");
   CHECK_GT(response_buf_.size(), 0);
   output->push_back(std::move(response_buf_));
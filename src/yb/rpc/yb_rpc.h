@@ -116,11 +116,11 @@ class YBInboundCall : public InboundCall {
   }
 
   // See RpcContext::AddRpcSidecar()
-  CHECKED_STATUS AddRpcSidecar(RefCntBuffer car, int* idx);
+  CHECKED_STATUS AddRpcSidecar(RefCntSlice car, int* idx);
 
   int RpcSidecarsSize() const;
 
-  const RefCntBuffer& RpcSidecar(int idx);
+  const RefCntSlice& RpcSidecar(int idx);
 
   // See RpcContext::ResetRpcSidecars()
   void ResetRpcSidecars();
@@ -153,7 +153,7 @@ class YBInboundCall : public InboundCall {
 
   // Serialize the response packet for the finished call.
   // The resulting slices refer to memory in this object.
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override;
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override;
 
   void LogTrace() const override;
   std::string ToString() const override;
@@ -161,6 +161,10 @@ class YBInboundCall : public InboundCall {
 
   CoarseTimePoint GetClientDeadline() const override;
 
+  RequestPriority priority() const override {
+    return header_.priority();
+  }
+
   const std::string& method_name() const override {
     return remote_method_.method_name();
   }
@@ -176,7 +180,7 @@ class YBInboundCall : public InboundCall {
  protected:
   // Vector of additional sidecars that are tacked on to the call's response
   // after serialization of the protobuf. See rpc/rpc_sidecar.h for more info.
-  std::vector<RefCntBuffer> sidecars_;
+  std::vector<RefCntSlice> sidecars_;
 
   // Serialize and queue the response.
   virtual void Respond(const google::protobuf::MessageLite& response, bool is_success);
@@ -225,6 +225,7 @@ Status RpcServerBase::SetupMessengerBuilder(rpc::MessengerBuilder* builder) {
 
   builder->set_num_reactors(FLAGS_num_reactor_threads);
   builder->set_metric_entity(metric_entity());
+  builder->set_metric_registry(metric_registry());
   builder->set_connection_keepalive_time(options_.rpc_opts.connection_keepalive_time_ms * 1ms);
 
   return Status::OK();
@@ -39,7 +39,10 @@
 #include "yb/common/common.pb.h"
 #include "yb/common/schema.h"
 
+#include "yb/server/clock.h"
+
 #include "yb/tablet/tablet-harness.h"
+#include "yb/tablet/transaction_participant.h"
 
 #include "yb/util/test_util.h"
 
@@ -105,6 +108,37 @@ class YBTabletTest : public YBTest {
   std::unique_ptr<TabletHarness> harness_;
 };
 
+// Participant context without peer, leadership and thread pool, see tablet_bootstrap-test and
+// transaction_participant-test.
+class TestTransactionParticipantContext : public TransactionParticipantContext {
+ public:
+  TestTransactionParticipantContext(server::ClockPtr clock, TabletId tablet_id)
+      : clock_(std::move(clock)), tablet_id_(std::move(tablet_id)) {}
+
+  const std::string& permanent_uuid() const override { return permanent_uuid_; }
+  const std::string& tablet_id() const override { return tablet_id_; }
+
+  const std::shared_future<client::YBClient*>& client_future() const override {
+    return client_future_;
+  }
+
+  const server::ClockPtr& clock_ptr() const override { return clock_; }
+  void GetLastReplicatedData(RemoveIntentsData* data) override {}
+  bool Enqueue(rpc::ThreadPoolTask* task) override { return false; }
+  HybridTime Now() override { return clock_->Now(); }
+  void UpdateClock(HybridTime hybrid_time) override { clock_->Update(hybrid_time); }
+  bool IsLeader() override { return false; }
+
+  void SubmitUpdateTransaction(
+      std::unique_ptr<UpdateTxnOperationState> state, int64_t term) override {}
+
+ private:
+  server::ClockPtr clock_;
+  std::string permanent_uuid_ = "test-peer";
+  TabletId tablet_id_;
+  std::shared_future<client::YBClient*> client_future_;
+};
+
 CHECKED_STATUS IterateToStringList(
     common::YQLRowwiseIteratorIf* iter, std::vector<std::string>* out, int limit = INT_MAX);
 
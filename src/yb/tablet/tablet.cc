@@ -703,6 +703,11 @@ void Tablet::StartOperation(WriteOperationState* operation_state) {
 }
 
 void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
+  // Witness does not have DocDB data. Its log is retained by TabletPeer until full replicas have
+  // it, so last_committed_write_index_ is not updated either.
+  if (is_witness_) {
+    return;
+  }
   last_committed_write_index_.store(operation_state->op_id().index(), std::memory_order_release);
   const KeyValueWriteBatchPB& put_batch =
       operation_state->consensus_round() && operation_state->consensus_round()->replicate_msg()
@@ -717,6 +722,32 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
   ApplyKeyValueRowOperations(put_batch, &frontiers, operation_state->hybrid_time());
 }
 
+void Tablet::ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states) {
+  if (operation_states.empty() || is_witness_) {
+    return;
+  }
+
+  docdb::ConsensusFrontiers frontiers;
+  rocksdb::WriteBatch write_batch;
+  for (auto* operation_state : operation_states) {
+    const auto& put_batch = operation_state->request()->write_batch();
+    DCHECK(!put_batch.has_transaction());
+    if (!put_batch.write_pairs().empty()) {
+      PrepareNonTransactionWriteBatch(put_batch, operation_state->hybrid_time(), &write_batch);
+    }
+  }
+
+  const auto& first = *operation_states.front();
+  const auto& last = *operation_states.back();
+  frontiers.Smallest().set_op_id(first.op_id());
+  frontiers.Smallest().set_hybrid_time(first.hybrid_time());
+  frontiers.Largest().set_op_id(last.op_id());
+  frontiers.Largest().set_hybrid_time(last.hybrid_time());
+
+  last_committed_write_index_.store(last.op_id().index(), std::memory_order_release);
+  WriteBatch(&frontiers, &write_batch, regular_db_.get());
+}
+
 Status Tablet::CreateCheckpoint(const std::string& dir) {
   ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
   RETURN_NOT_OK(scoped_read_operation);
@@ -1220,7 +1251,12 @@ CHECKED_STATUS Tablet::CreatePagingStateForRead(const PgsqlReadRequestPB& pgsql_
       (!pgsql_read_request.has_limit() || row_count < pgsql_read_request.limit() ||
        pgsql_read_request.return_paging_state())) {
     const string& next_partition_key = metadata_->partition().partition_key_end();
-    if (!next_partition_key.empty()) {
+    // Do not move past the max partition key of the request (if set). Scans split by partition
+    // ranges rely on this to stay within their range.
+    if (!next_partition_key.empty() &&
+        (!pgsql_read_request.has_max_hash_code() ||
+         PartitionSchema::DecodeMultiColumnHashValue(next_partition_key) <=
+             pgsql_read_request.max_hash_code())) {
       response->mutable_paging_state()->set_next_partition_key(next_partition_key);
     }
   }
@@ -254,6 +254,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Apply all of the row operations associated with this transaction.
   void ApplyRowOperations(WriteOperationState* operation_state);
 
+  // Apply row operations of several non-transactional write operations with a single RocksDB
+  // write batch. Used to speed up log replay during bootstrap.
+  void ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states);
+
   // Apply a set of RocksDB row operations.
   // If rocksdb_write_batch is specified it could contain preencoded RocksDB operations.
   void ApplyKeyValueRowOperations(
@@ -472,6 +476,17 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
     return last_committed_write_index_.load(std::memory_order_acquire);
   }
 
+  // A witness tablet belongs to a WITNESS (or PRE_WITNESS) replica. It keeps the log, but does not
+  // apply write operations to DocDB and does not serve reads. Should be set before the tablet is
+  // bootstrapped.
+  void set_is_witness(bool is_witness) {
+    is_witness_ = is_witness;
+  }
+
+  bool is_witness() const {
+    return is_witness_;
+  }
+
   uint64_t GetTotalSSTFileSizes() const;
   uint64_t GetUncompressedSSTFileSizes() const;
 
@@ -701,6 +716,8 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   std::atomic<int64_t> last_committed_write_index_{0};
 
+  bool is_witness_ = false;
+
   HybridTimeLeaseProvider ht_lease_provider_;
 
  private:
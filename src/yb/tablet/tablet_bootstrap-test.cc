@@ -30,19 +30,25 @@
 // under the License.
 //
 
+#include <thread>
 #include <vector>
 
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_index.h"
 #include "yb/consensus/log-test-base.h"
 #include "yb/consensus/log_util.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/consensus-test-util.h"
+#include "yb/consensus/retryable_requests.h"
+#include "yb/docdb/consensus_frontier.h"
 #include "yb/server/logical_clock.h"
 #include "yb/server/metadata.h"
+#include "yb/tablet/tablet_bootstrap.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet-test-util.h"
 #include "yb/tablet/tablet_metadata.h"
+#include "yb/tablet/transaction_participant.h"
 #include "yb/util/tostring.h"
 #include "yb/tablet/tablet_options.h"
 
@@ -50,6 +56,10 @@ using std::shared_ptr;
 using std::string;
 using std::vector;
 
+DECLARE_int32(retryable_request_timeout_secs);
+DECLARE_int32(tablet_bootstrap_read_ahead_segments);
+DECLARE_int32(tablet_bootstrap_write_batch_ops);
+
 namespace yb {
 
 namespace log {
@@ -70,6 +80,7 @@ using consensus::ReplicateMsg;
 using consensus::ReplicateMsgPtr;
 using log::Log;
 using log::LogAnchorRegistry;
+using log::LogIndex;
 using log::LogTestBase;
 using log::ReadableLogSegment;
 using server::Clock;
@@ -87,6 +98,7 @@ class BootstrapTest : public LogTestBase {
 
   Status LoadTestRaftGroupMetadata(RaftGroupMetadataPtr* meta) {
     Schema schema = SchemaBuilder(schema_).Build();
+    schema.SetTransactional(transactional_);
     std::pair<PartitionSchema, Partition> partition = CreateDefaultPartition(schema);
 
     RETURN_NOT_OK(RaftGroupMetadata::LoadOrCreate(
@@ -125,7 +137,7 @@ class BootstrapTest : public LogTestBase {
         scoped_refptr<Clock>(LogicalClock::CreateStartingAt(HybridTime::kInitial)),
         shared_ptr<MemTracker>() /* mem_tracker */,
         shared_ptr<MemTracker>() /* block_based_table_mem_tracker */,
-        nullptr /* metric_registry */,
+        bootstrap_metric_registry_,
         listener.get(),
         log_anchor_registry,
         tablet_options,
@@ -134,6 +146,11 @@ class BootstrapTest : public LogTestBase {
         client::LocalTabletFilter(),
         nullptr, // transaction_coordinator_context
         append_pool_.get()};
+    data.log_read_pool = append_pool_.get();
+    data.retryable_requests = bootstrap_retryable_requests_;
+    if (transactional_) {
+      data.transaction_participant_context = &participant_context_;
+    }
     RETURN_NOT_OK(BootstrapTablet(data, tablet, &log_, boot_info));
     return Status::OK();
   }
@@ -161,6 +178,104 @@ class BootstrapTest : public LogTestBase {
     return Status::OK();
   }
 
+  // Bootstraps the test tablet again, after the previous bootstrap created its metadata.
+  Status RebootstrapTestTablet(shared_ptr<TabletClass>* tablet,
+                               ConsensusBootstrapInfo* boot_info) {
+    RaftGroupMetadataPtr meta;
+    RETURN_NOT_OK(LoadTestRaftGroupMetadata(&meta));
+    return RunBootstrapOnTestTablet(meta, tablet, boot_info);
+  }
+
+  void CheckReadAheadReplay(int64_t read_ahead_limit, bool expect_read_ahead) {
+    FLAGS_tablet_bootstrap_read_ahead_segments = 2;
+    constexpr int kNumSegments = 5;
+    BuildLog();
+    for (int i = 0; i != kNumSegments; ++i) {
+      AppendReplicateBatchToLog(kEntriesPerSegment);
+      ASSERT_OK(RollLog());
+    }
+
+    // Bootstrap uses the existing tracker while it is alive.
+    auto tracker = MemTracker::FindOrCreateTracker(read_ahead_limit, "TabletBootstrapReadAhead");
+    shared_ptr<TabletClass> tablet;
+    ConsensusBootstrapInfo boot_info;
+    ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+    ASSERT_EQ(current_index_ - 1, boot_info.last_committed_id.index());
+
+    vector<string> results;
+    IterateTabletRows(tablet.get(), &results);
+    ASSERT_EQ(kNumSegments * kEntriesPerSegment, results.size());
+    ASSERT_EQ(0, tracker->consumption());
+    if (expect_read_ahead) {
+      ASSERT_GT(tracker->peak_consumption(), 0);
+    } else {
+      ASSERT_EQ(0, tracker->peak_consumption());
+    }
+  }
+
+  // Appends num_segments segments of kEntriesPerSegment no-ops each, with increasing monotonic
+  // counters, and rolls the log after each of them.
+  static constexpr int kEntriesPerSegment = 3;
+
+  void AppendSegments(int num_segments) {
+    BuildLog();
+    for (int i = 0; i != num_segments; ++i) {
+      for (int j = 0; j != kEntriesPerSegment; ++j) {
+        auto replicate = std::make_shared<ReplicateMsg>();
+        *replicate->mutable_id() = MakeOpId(1, current_index_);
+        replicate->set_op_type(consensus::NO_OP);
+        replicate->set_hybrid_time(clock_->Now().ToUint64());
+        replicate->set_monotonic_counter(current_index_ * 10);
+        ASSERT_NO_FATALS(AppendReplicateBatch(replicate));
+        ++current_index_;
+      }
+      ASSERT_OK(RollLog());
+    }
+  }
+
+  // Appends a committed write of the request with the specified id of the client.
+  void AppendRetryableWrite(uint64_t client_id, int64_t request_id) {
+    auto replicate = std::make_shared<ReplicateMsg>();
+    replicate->set_op_type(consensus::WRITE_OP);
+    *replicate->mutable_id() = MakeOpId(1, current_index_);
+    *replicate->mutable_committed_op_id() = replicate->id();
+    replicate->set_hybrid_time(clock_->Now().ToUint64());
+    auto* write_request = replicate->mutable_write_request();
+    write_request->set_tablet_id(log::kTestTablet);
+    FillRetryableRequest(client_id, request_id, write_request);
+    AddKVToPB(current_index_, 0, "retryable write", write_request->mutable_write_batch());
+    ASSERT_NO_FATALS(AppendReplicateBatch(replicate));
+    ++current_index_;
+  }
+
+  static void FillRetryableRequest(
+      uint64_t client_id, int64_t request_id, WriteRequestPB* write_request) {
+    write_request->set_client_id1(client_id);
+    write_request->set_client_id2(client_id);
+    write_request->set_request_id(request_id);
+    write_request->set_min_running_request_id(1);
+  }
+
+  log::SegmentSequence GetSegments() {
+    log::SegmentSequence segments;
+    EXPECT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+    return segments;
+  }
+
+  // Metric registry of bootstrapped tablets, tests that check tablet metrics set it.
+  MetricRegistry* bootstrap_metric_registry_ = nullptr;
+
+  // Retryable requests filled by bootstrap, tests that check them set it.
+  consensus::RetryableRequests* bootstrap_retryable_requests_ = nullptr;
+
+  // Whether the test tablet belongs to a transactional table, i.e. has an intents DB.
+  bool transactional_ = false;
+  // Lets tablets of transactional tables open their intents DB, bootstrap does not use it
+  // otherwise.
+  TestTransactionParticipantContext participant_context_{
+      scoped_refptr<Clock>(LogicalClock::CreateStartingAt(HybridTime::kInitial)),
+      log::kTestTablet};
+
   void IterateTabletRows(const Tablet* tablet,
                          vector<string>* results) {
     auto iter = tablet->NewRowIterator(schema_, boost::none);
@@ -338,6 +453,201 @@ TEST_F(BootstrapTest, TestConsensusOnlyOperationOutOfOrderHybridTime) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests replay of several log segments, with writes applied to RocksDB in batches.
+TEST_F(BootstrapTest, TestBatchedWritesReplay) {
+  constexpr int kBatchOps = 4;
+  constexpr int kNumSegments = 3;
+  constexpr int kWritesPerSegment = 5;
+  constexpr int kNumWrites = kNumSegments * kWritesPerSegment;
+  FLAGS_tablet_bootstrap_write_batch_ops = kBatchOps;
+  BuildLog();
+  for (int i = 0; i != kNumSegments; ++i) {
+    AppendReplicateBatchToLog(kWritesPerSegment);
+    ASSERT_OK(RollLog());
+  }
+
+  // The tablet collects RocksDB statistics only when it has a metric registry.
+  bootstrap_metric_registry_ = metric_registry_.get();
+  shared_ptr<TabletClass> tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+  ASSERT_EQ(current_index_ - 1, boot_info.last_committed_id.index());
+  ASSERT_TRUE(boot_info.orphaned_replicates.empty());
+
+  // Each entry inserts a row with its own index as the key.
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(kNumWrites, results.size());
+
+  // Every batch of replayed writes is a single write to RocksDB.
+  const auto rocksdb_writes =
+      tablet->rocksdb_statistics()->getTickerCount(rocksdb::WRITE_DONE_BY_SELF);
+  ASSERT_GT(rocksdb_writes, 0U);
+  ASSERT_LE(rocksdb_writes, static_cast<uint64_t>((kNumWrites + kBatchOps - 1) / kBatchOps));
+}
+
+// Tests replay of several log segments with read ahead, while its memory limit allows it.
+TEST_F(BootstrapTest, TestReadAheadReplay) {
+  ASSERT_NO_FATALS(CheckReadAheadReplay(1024 * 1024 * 1024, true));
+}
+
+// A limit of 1 byte allows no read ahead, so every segment is read when it is replayed.
+TEST_F(BootstrapTest, TestReadAheadMemoryLimit) {
+  ASSERT_NO_FATALS(CheckReadAheadReplay(1, false));
+}
+
+// Tests which leading segments are found to be flushed, depending on the flushed op id.
+TEST_F(BootstrapTest, TestFindFlushedSegments) {
+  constexpr int kNumSegments = 4;
+  ASSERT_NO_FATALS(AppendSegments(kNumSegments));
+  auto segments = GetSegments();
+  // Rolling after the last batch leaves an empty active segment.
+  ASSERT_EQ(kNumSegments + 1, segments.size());
+  scoped_refptr<LogIndex> log_index(new LogIndex(tablet_wal_path_));
+
+  // Even when everything is flushed, the last segment is still read.
+  auto flushed = FindFlushedSegments(segments, MakeOpId(1, current_index_ + 10), log_index.get());
+  ASSERT_EQ(kNumSegments, flushed.num_segments);
+  const auto& last_footer = segments[kNumSegments - 1]->footer();
+  ASSERT_EQ(last_footer.max_replicate_hybrid_time(), flushed.max_hybrid_time);
+  ASSERT_EQ((current_index_ - 1) * 10, flushed.max_monotonic_counter);
+  ASSERT_EQ(last_footer.max_monotonic_counter(), flushed.max_monotonic_counter);
+
+  // The same holds when the last segment is a closed one.
+  log::SegmentSequence closed_segments(segments.begin(), segments.begin() + kNumSegments);
+  flushed = FindFlushedSegments(
+      closed_segments, MakeOpId(1, current_index_ + 10), log_index.get());
+  ASSERT_EQ(kNumSegments - 1, flushed.num_segments);
+
+  // Segments 1 and 2 contain indexes from 1 to 6, the entry with flushed index is still read.
+  flushed = FindFlushedSegments(segments, MakeOpId(1, 2 * kEntriesPerSegment + 1), log_index.get());
+  ASSERT_EQ(2, flushed.num_segments);
+  ASSERT_EQ(segments[1]->footer().max_replicate_hybrid_time(), flushed.max_hybrid_time);
+  ASSERT_EQ(2 * kEntriesPerSegment * 10, flushed.max_monotonic_counter);
+  flushed = FindFlushedSegments(segments, MakeOpId(1, 2 * kEntriesPerSegment), log_index.get());
+  ASSERT_EQ(1, flushed.num_segments);
+
+  // Operations of a later term than the flushed one could have overwritten flushed ones.
+  flushed = FindFlushedSegments(segments, MakeOpId(0, current_index_ + 10), log_index.get());
+  ASSERT_EQ(0, flushed.num_segments);
+  ASSERT_EQ(0U, flushed.max_hybrid_time);
+  ASSERT_EQ(0, flushed.max_monotonic_counter);
+
+  // Tablets without intents DB report an empty intents op id.
+  flushed = FindFlushedSegments(segments, consensus::MinimumOpId(), log_index.get());
+  ASSERT_EQ(0, flushed.num_segments);
+
+  // Segments with entries written since the retained time are read, to bootstrap retryable
+  // requests.
+  flushed = FindFlushedSegments(
+      segments, MakeOpId(1, current_index_ + 10), log_index.get(),
+      RestartSafeCoarseTimePoint::FromUInt64(segments[0]->footer().max_entry_mono_time()));
+  ASSERT_EQ(0, flushed.num_segments);
+  auto last_entry_time = RestartSafeCoarseTimePoint::FromUInt64(
+      segments[kNumSegments - 1]->footer().max_entry_mono_time());
+  flushed = FindFlushedSegments(
+      segments, MakeOpId(1, current_index_ + 10), log_index.get(),
+      last_entry_time + std::chrono::milliseconds(1));
+  ASSERT_EQ(kNumSegments, flushed.num_segments);
+}
+
+// Segments are not skipped when the log index does not cover them, e.g. after the index was lost.
+TEST_F(BootstrapTest, TestFindFlushedSegmentsWithoutIndex) {
+  ASSERT_NO_FATALS(AppendSegments(3));
+  auto segments = GetSegments();
+  auto other_dir = GetTestPath("other_wal_dir");
+  ASSERT_OK(env_->CreateDir(other_dir));
+  scoped_refptr<LogIndex> log_index(new LogIndex(other_dir));
+  auto flushed = FindFlushedSegments(segments, MakeOpId(1, current_index_ + 10), log_index.get());
+  ASSERT_EQ(0, flushed.num_segments);
+  // Validation opens existing chunks only, so nothing is created in the other directory.
+  vector<string> children;
+  ASSERT_OK(env_->GetChildren(other_dir, &children));
+  for (const auto& child : children) {
+    ASSERT_TRUE(child == "." || child == "..") << child;
+  }
+}
+
+// A tablet of a non-transactional table has no intents DB, so its flushed intents op id stays
+// empty and bootstrap never skips its segments.
+TEST_F(BootstrapTest, TestNonTransactionalTabletSkipsNothing) {
+  constexpr int kNumSegments = 3;
+  BuildLog();
+  for (int i = 0; i != kNumSegments; ++i) {
+    AppendReplicateBatchToLog(kEntriesPerSegment);
+    ASSERT_OK(RollLog());
+  }
+
+  shared_ptr<TabletClass> tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+  ASSERT_OK(tablet->Flush(FlushMode::kSync));
+  auto op_ids = ASSERT_RESULT(tablet->MaxPersistentOpId());
+  ASSERT_EQ(current_index_ - 1, op_ids.regular.index);
+  ASSERT_EQ(0, op_ids.intents.index);
+
+  scoped_refptr<LogIndex> log_index(new LogIndex(tablet_wal_path_));
+  auto flushed = FindFlushedSegments(GetSegments(), consensus::MinimumOpId(), log_index.get());
+  ASSERT_EQ(0, flushed.num_segments);
+}
+
+// Flushed segments are skipped only when their write requests could not be retried anymore, so
+// retries of later requests are still rejected after bootstrap.
+TEST_F(BootstrapTest, TestSkipFlushedSegmentsKeepsRetryableRequests) {
+  constexpr uint64_t kOldClient = 1;
+  constexpr uint64_t kNewClient = 2;
+  constexpr int kRequestsPerClient = 2;
+  FLAGS_retryable_request_timeout_secs = 1;
+  transactional_ = true;
+  bootstrap_metric_registry_ = metric_registry_.get();
+
+  BuildLog();
+  for (int i = 1; i <= kRequestsPerClient; ++i) {
+    ASSERT_NO_FATALS(AppendRetryableWrite(kOldClient, i));
+    ASSERT_OK(RollLog());
+  }
+  // Requests of the old client expire before the ones of the new client are written.
+  std::this_thread::sleep_for(std::chrono::seconds(FLAGS_retryable_request_timeout_secs) * 2);
+  for (int i = 1; i <= kRequestsPerClient; ++i) {
+    ASSERT_NO_FATALS(AppendRetryableWrite(kNewClient, i));
+    ASSERT_OK(RollLog());
+  }
+
+  shared_ptr<TabletClass> tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+  // Writes are not transactional, so the flushed op id of the intents DB is set explicitly.
+  docdb::ConsensusFrontier frontier;
+  frontier.set_op_id(yb::OpId(1, current_index_ - 1));
+  frontier.set_hybrid_time(clock_->Now());
+  ASSERT_OK(tablet->ModifyFlushedFrontier(frontier, rocksdb::FrontierModificationMode::kUpdate));
+  ASSERT_OK(tablet->Flush(FlushMode::kSync));
+  tablet->Shutdown();
+  tablet.reset();
+  ASSERT_OK(log_->Close());
+
+  consensus::RetryableRequests retryable_requests;
+  bootstrap_retryable_requests_ = &retryable_requests;
+  ASSERT_OK(RebootstrapTestTablet(&tablet, &boot_info));
+  ASSERT_EQ(current_index_ - 1, boot_info.last_committed_id.index());
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(2 * kRequestsPerClient, results.size());
+
+  auto register_retry = [&retryable_requests](uint64_t client_id, int64_t request_id) {
+    auto replicate = std::make_shared<ReplicateMsg>();
+    replicate->set_op_type(consensus::WRITE_OP);
+    FillRetryableRequest(client_id, request_id, replicate->mutable_write_request());
+    return retryable_requests.Register(
+        make_scoped_refptr<consensus::ConsensusRound>(nullptr, replicate));
+  };
+  // Segments of the old client were skipped, so its expired requests are not known.
+  ASSERT_TRUE(register_retry(kOldClient, 1));
+  for (int i = 1; i <= kRequestsPerClient; ++i) {
+    ASSERT_FALSE(register_retry(kNewClient, i)) << "Retry of request " << i << " was accepted";
+  }
+}
+
 // Test that we don't overflow opids. Regression test for KUDU-1933.
 TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   // Start appending with a log index 3 under the int32 max value.
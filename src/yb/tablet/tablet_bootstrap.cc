@@ -31,9 +31,13 @@
 //
 #include "yb/tablet/tablet_bootstrap.h"
 
+#include <deque>
+#include <future>
+
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/quorum_util.h"
 #include "yb/consensus/retryable_requests.h"
 
 #include "yb/server/hybrid_clock.h"
@@ -46,6 +50,7 @@
 #include "yb/tablet/operations/snapshot_operation.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
 #include "yb/util/stopwatch.h"
@@ -68,6 +73,7 @@ DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "after processing a log entry during log replay.");
 
 DECLARE_uint64(max_clock_sync_error_usec);
+DECLARE_int32(retryable_request_timeout_secs);
 
 DEFINE_bool(force_recover_flushed_frontier, false,
             "Could be used to ignore the flushed frontier metadata from RocksDB manifest and "
@@ -75,6 +81,28 @@ DEFINE_bool(force_recover_flushed_frontier, false,
 TAG_FLAG(force_recover_flushed_frontier, hidden);
 TAG_FLAG(force_recover_flushed_frontier, advanced);
 
+DEFINE_int32(tablet_bootstrap_read_ahead_segments, 2,
+             "Number of log segments following the one being replayed that are read and decoded "
+             "in parallel during tablet bootstrap. 0 disables read ahead.");
+TAG_FLAG(tablet_bootstrap_read_ahead_segments, advanced);
+
+DEFINE_int64(tablet_bootstrap_read_ahead_max_bytes, 256 * 1024 * 1024,
+             "Limit on the total size of log segments read ahead by all tablets that are "
+             "bootstrapped concurrently. Segments over the limit are read when they are replayed.");
+TAG_FLAG(tablet_bootstrap_read_ahead_max_bytes, advanced);
+
+DEFINE_int32(tablet_bootstrap_write_batch_ops, 1,
+             "Max number of consecutive non-transactional write operations applied to RocksDB "
+             "with a single write batch during tablet bootstrap. 1 applies each operation "
+             "separately.");
+TAG_FLAG(tablet_bootstrap_write_batch_ops, advanced);
+
+DEFINE_bool(tablet_bootstrap_skip_flushed_segments, true,
+            "Do not read log segments whose footers show that all of their operations were "
+            "already flushed to RocksDB during tablet bootstrap. Segments with write requests "
+            "that could still be retried are read anyway.");
+TAG_FLAG(tablet_bootstrap_skip_flushed_segments, advanced);
+
 namespace yb {
 namespace tablet {
 
@@ -292,9 +320,146 @@ bool ReplayState::CanApply(LogEntryPB* entry) {
   return consensus::OpIdCompare(entry->replicate().id(), committed_op_id) <= 0;
 }
 
+// ============================================================================
+//  Class SegmentReader.
+// ============================================================================
+namespace {
+
+// Reads log segments in order. When a thread pool is provided, segments following the one being
+// replayed are read and decoded on it, so decoding overlaps with applying entries.
+//
+// Memory of segments read ahead is accounted in mem_tracker, shared by all bootstrapping tablets,
+// so read ahead stops when its limit is reached.
+class SegmentReader {
+ public:
+  SegmentReader(const log::SegmentSequence& segments, ThreadPool* pool, size_t read_ahead,
+                std::shared_ptr<MemTracker> mem_tracker)
+      : segments_(segments), read_ahead_(read_ahead), mem_tracker_(std::move(mem_tracker)) {
+    if (pool && read_ahead_ > 0) {
+      token_ = pool->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+    }
+  }
+
+  ~SegmentReader() {
+    if (token_) {
+      token_->Shutdown();
+    }
+    for (const auto& pending : pending_) {
+      mem_tracker_->Release(pending.reserved_bytes);
+    }
+  }
+
+  // Should be called with consecutive segment indexes, starting from 0.
+  log::ReadEntriesResult Read(size_t idx) {
+    if (!token_) {
+      return segments_[idx]->ReadEntries();
+    }
+    if (next_to_submit_ == idx) {
+      // Not read ahead because of the memory limit.
+      ++next_to_submit_;
+      ReadAhead(idx);
+      return segments_[idx]->ReadEntries();
+    }
+    ReadAhead(idx);
+    auto pending = std::move(pending_.front());
+    pending_.pop_front();
+    auto result = pending.future.get();
+    mem_tracker_->Release(pending.reserved_bytes);
+    return result;
+  }
+
+ private:
+  struct PendingRead {
+    std::future<log::ReadEntriesResult> future;
+    int64_t reserved_bytes;
+  };
+
+  // Submits reads of segments following idx.
+  void ReadAhead(size_t idx) {
+    while (next_to_submit_ < segments_.size() && next_to_submit_ <= idx + read_ahead_) {
+      const auto& segment = segments_[next_to_submit_];
+      // Decoded entries are kept until the segment is replayed, estimate them by the segment size.
+      const int64_t bytes = segment->file_size();
+      if (!mem_tracker_->TryConsume(bytes)) {
+        VLOG(1) << "Not reading ahead " << segment->path() << ", memory limit reached: "
+                << mem_tracker_->ToString();
+        return;
+      }
+      Submit(segment, bytes);
+      ++next_to_submit_;
+    }
+  }
+
+  void Submit(const scoped_refptr<ReadableLogSegment>& segment, int64_t reserved_bytes) {
+    auto promise = std::make_shared<std::promise<log::ReadEntriesResult>>();
+    pending_.push_back(PendingRead{promise->get_future(), reserved_bytes});
+    auto status = token_->SubmitFunc([promise, segment] {
+      promise->set_value(segment->ReadEntries());
+    });
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to submit read of " << segment->path() << ": " << status;
+      promise->set_value(segment->ReadEntries());
+    }
+  }
+
+  const log::SegmentSequence& segments_;
+  const size_t read_ahead_;
+  const std::shared_ptr<MemTracker> mem_tracker_;
+  std::unique_ptr<ThreadPoolToken> token_;
+  size_t next_to_submit_ = 0;
+  std::deque<PendingRead> pending_;
+};
+
+} // namespace
+
+FlushedSegments FindFlushedSegments(
+    const log::SegmentSequence& segments, const consensus::OpId& flushed_op_id,
+    log::LogIndex* log_index, boost::optional<RestartSafeCoarseTimePoint> retained_entry_time) {
+  // Entries with index equal to the flushed one are still read, since they bump committed op id.
+  auto indexed_in_segment = [log_index, &flushed_op_id](
+      int64_t index, const ReadableLogSegment& segment) {
+    log::LogIndexEntry entry;
+    return log_index->OpenExistingChunks(index, index).ok() &&
+           log_index->GetEntry(index, &entry).ok() &&
+           entry.segment_sequence_number == segment.header().sequence_number() &&
+           entry.op_id.term() <= flushed_op_id.term();
+  };
+  FlushedSegments result;
+  // The last segment is always read, since the last op id is required by consensus.
+  while (result.num_segments + 1 < segments.size()) {
+    const auto& segment = segments[result.num_segments];
+    if (!segment->HasFooter()) {
+      break;
+    }
+    const auto& footer = segment->footer();
+    if (!footer.has_min_replicate_index() || !footer.has_max_replicate_hybrid_time() ||
+        footer.max_replicate_index() >= flushed_op_id.index() ||
+        !indexed_in_segment(footer.min_replicate_index(), *segment) ||
+        !indexed_in_segment(footer.max_replicate_index(), *segment)) {
+      break;
+    }
+    if (retained_entry_time &&
+        (!footer.has_max_entry_mono_time() ||
+         RestartSafeCoarseTimePoint::FromUInt64(footer.max_entry_mono_time()) >=
+             *retained_entry_time)) {
+      break;
+    }
+    result.max_hybrid_time = std::max(result.max_hybrid_time, footer.max_replicate_hybrid_time());
+    result.max_monotonic_counter =
+        std::max(result.max_monotonic_counter, footer.max_monotonic_counter());
+    ++result.num_segments;
+  }
+  return result;
+}
+
 // ============================================================================
 //  Class TabletBootstrap.
 // ============================================================================
+struct TabletBootstrap::ReplayedWrite {
+  std::unique_ptr<LogEntryPB> entry;
+  std::unique_ptr<WriteOperationState> operation_state;
+};
+
 TabletBootstrap::TabletBootstrap(const BootstrapTabletData& data)
     : data_(data),
       meta_(data.meta),
@@ -420,6 +585,11 @@ Result<bool> TabletBootstrap::OpenTablet() {
   // operation like RestoreSnapshot or Truncate. However, those operations can't really be happening
   // concurrently as we haven't opened the tablet yet.
   RETURN_NOT_OK(has_ss_tables);
+  for (const auto& peer : cmeta_->committed_config().peers()) {
+    if (peer.permanent_uuid() == meta_->fs_manager()->uuid()) {
+      tablet->set_is_witness(consensus::IsWitnessMemberType(peer.member_type()));
+    }
+  }
   tablet_ = std::move(tablet);
   return has_ss_tables.get();
 }
@@ -551,6 +721,7 @@ Status TabletBootstrap::RemoveRecoveryDir() {
 Status TabletBootstrap::OpenNewLog() {
   auto log_options = LogOptions();
   log_options.env = GetEnv();
+  log_options.sync_group = data_.log_sync_group;
   RETURN_NOT_OK(Log::Open(log_options,
                           tablet_->tablet_id(),
                           tablet_->metadata()->wal_dir(),
@@ -747,6 +918,14 @@ Status TabletBootstrap::HandleEntryPair(
   ReplicateMsg* replicate = replicate_entry->mutable_replicate();
   const auto op_type = replicate_entry->replicate().op_type();
 
+  const bool batchable_write = FLAGS_tablet_bootstrap_write_batch_ops > 1 &&
+                               op_type == consensus::WRITE_OP &&
+                               !replicate->write_request().write_batch().has_transaction();
+  if (!batchable_write) {
+    // Operations should be applied in order, so writes collected so far go first.
+    ApplyReplayedWrites();
+  }
+
   int64_t flushed_index;
   if (op_type == consensus::UPDATE_TRANSACTION_OP) {
     if (replicate->transaction_state().status() == TransactionStatus::APPLYING) {
@@ -771,6 +950,11 @@ Status TabletBootstrap::HandleEntryPair(
   }
 
   if (replicate->id().index() > flushed_index) {
+    if (batchable_write) {
+      state->max_committed_hybrid_time.MakeAtLeast(HybridTime(replicate->hybrid_time()));
+      AddReplayedWrite(replicate_entry);
+      return Status::OK();
+    }
     const auto status = HandleOperation(op_type, replicate);
     if (!status.ok()) {
       return status.CloneAndAppend(Format(
@@ -844,11 +1028,17 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   // old log.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
+  RETURN_NOT_OK(SkipFlushedSegments(state, &segments));
+
   int segment_count = 0;
   yb::OpId last_committed_op_id;
   RestartSafeCoarseTimePoint last_entry_time;
+  SegmentReader segment_reader(
+      segments, data_.log_read_pool, std::max(FLAGS_tablet_bootstrap_read_ahead_segments, 0),
+      MemTracker::FindOrCreateTracker(
+          FLAGS_tablet_bootstrap_read_ahead_max_bytes, "TabletBootstrapReadAhead"));
   for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    auto read_result = segment->ReadEntries();
+    auto read_result = segment_reader.Read(segment_count);
     last_committed_op_id = std::max(last_committed_op_id, read_result.committed_op_id);
     for (int entry_idx = 0; entry_idx < read_result.entries.size(); ++entry_idx) {
       Status s = HandleEntry(
@@ -885,7 +1075,7 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
     // number of MB processed, but this is better than nothing.
     listener_->StatusMessage(Substitute("Bootstrap replayed $0/$1 log segments. "
                                         "Stats: $2. Pending: $3 replicates",
-                                        segment_count + 1, log_reader_->num_segments(),
+                                        segment_count + 1, segments.size(),
                                         stats_.ToString(),
                                         state.pending_replicates.size()));
     segment_count++;
@@ -917,6 +1107,8 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
     }
   }
 
+  ApplyReplayedWrites();
+
   LOG_WITH_PREFIX(INFO) << "Dumping replay state to log at the end of " << __FUNCTION__;
   DumpReplayStateToLog(state);
 
@@ -947,6 +1139,97 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   return Status::OK();
 }
 
+void TabletBootstrap::AddReplayedWrite(LogEntryPB* replicate_entry) {
+  // The entry is destroyed after it is handled, so take over its content.
+  ReplayedWrite write;
+  write.entry = std::make_unique<LogEntryPB>();
+  write.entry->Swap(replicate_entry);
+
+  ReplicateMsg* replicate_msg = write.entry->mutable_replicate();
+  DCHECK(replicate_msg->has_hybrid_time());
+  write.operation_state = std::make_unique<WriteOperationState>(
+      nullptr, replicate_msg->mutable_write_request(), nullptr);
+  write.operation_state->mutable_op_id()->CopyFrom(replicate_msg->id());
+  write.operation_state->set_hybrid_time(HybridTime(replicate_msg->hybrid_time()));
+  tablet_->StartOperation(write.operation_state.get());
+
+  replayed_writes_.push_back(std::move(write));
+  if (replayed_writes_.size() >= static_cast<size_t>(FLAGS_tablet_bootstrap_write_batch_ops)) {
+    ApplyReplayedWrites();
+  }
+}
+
+void TabletBootstrap::ApplyReplayedWrites() {
+  if (replayed_writes_.empty()) {
+    return;
+  }
+
+  std::vector<WriteOperationState*> operation_states;
+  operation_states.reserve(replayed_writes_.size());
+  for (const auto& write : replayed_writes_) {
+    operation_states.push_back(write.operation_state.get());
+  }
+  tablet_->ApplyRowOperations(operation_states);
+
+  for (const auto& write : replayed_writes_) {
+    tablet_->mvcc_manager()->Replicated(write.operation_state->hybrid_time());
+  }
+  replayed_writes_.clear();
+}
+
+Status TabletBootstrap::SkipFlushedSegments(
+    const ReplayState& state, log::SegmentSequence* segments) {
+  // Rewriting the WAL requires every entry to be read.
+  if (!FLAGS_tablet_bootstrap_skip_flushed_segments || !skip_wal_rewrite_) {
+    return Status::OK();
+  }
+
+  // Segments should be flushed to both RocksDB instances. Tablets without intents DB never skip
+  // segments, since their intents op id is empty.
+  const auto& flushed_op_id =
+      state.regular_stored_op_id.index() <= state.intents_stored_op_id.index()
+          ? state.regular_stored_op_id : state.intents_stored_op_id;
+  // Replayed write requests are registered in retryable requests, that keep them for
+  // retryable_request_timeout_secs after the last entry. So segments with requests that could
+  // still be retried are read. The last entry time is at least the latest time in footers.
+  boost::optional<RestartSafeCoarseTimePoint> retained_entry_time;
+  if (data_.retryable_requests) {
+    RestartSafeCoarseTimePoint last_entry_time;
+    for (const auto& segment : *segments) {
+      if (segment->HasFooter() && segment->footer().has_max_entry_mono_time()) {
+        last_entry_time = std::max(
+            last_entry_time,
+            RestartSafeCoarseTimePoint::FromUInt64(segment->footer().max_entry_mono_time()));
+      }
+    }
+    retained_entry_time = last_entry_time -
+        std::chrono::seconds(GetAtomicFlag(&FLAGS_retryable_request_timeout_secs));
+  }
+
+  scoped_refptr<LogIndex> log_index(new LogIndex(tablet_->metadata()->wal_dir()));
+  auto flushed = FindFlushedSegments(
+      *segments, flushed_op_id, log_index.get(), retained_entry_time);
+  if (flushed.num_segments == 0) {
+    return Status::OK();
+  }
+
+  // Skipped segments are not added to the index of the new log during replay.
+  RETURN_NOT_OK(log_->OpenExistingIndexChunks(
+      segments->front()->footer().min_replicate_index(),
+      (*segments)[flushed.num_segments - 1]->footer().max_replicate_index()));
+
+  // Entries of skipped segments would have moved clock and monotonic counter forward.
+  UpdateClock(flushed.max_hybrid_time);
+  tablet_->UpdateMonotonicCounter(flushed.max_monotonic_counter);
+
+  LOG_WITH_PREFIX(INFO) << "Skipping " << flushed.num_segments << " log segments flushed up to "
+                        << "index "
+                        << (*segments)[flushed.num_segments - 1]->footer().max_replicate_index()
+                        << ", flushed op id: " << flushed_op_id.ShortDebugString();
+  segments->erase(segments->begin(), segments->begin() + flushed.num_segments);
+  return Status::OK();
+}
+
 void TabletBootstrap::PlayWriteRequest(ReplicateMsg* replicate_msg) {
   DCHECK(replicate_msg->has_hybrid_time());
 
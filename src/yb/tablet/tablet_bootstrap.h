@@ -32,10 +32,13 @@
 #ifndef YB_TABLET_TABLET_BOOTSTRAP_H
 #define YB_TABLET_TABLET_BOOTSTRAP_H
 
+#include <boost/optional.hpp>
+
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/util/restart_safe_clock.h"
 #include "yb/util/threadpool.h"
 
 namespace yb {
@@ -46,6 +49,27 @@ class WriteOperationState;
 
 YB_STRONGLY_TYPED_BOOL(AlreadyApplied);
 
+// Leading log segments whose operations were all flushed to RocksDB.
+struct FlushedSegments {
+  size_t num_segments = 0;
+  // Max hybrid time and monotonic counter of operations in these segments, that replay would have
+  // moved the clock and the tablet's monotonic counter to.
+  uint64_t max_hybrid_time = 0;
+  int64_t max_monotonic_counter = 0;
+};
+
+// Finds leading segments whose operations precede flushed_op_id, according to their footers.
+// Operations should have index less than flushed_op_id's one and term not greater than its term.
+// The last segment is never included, since consensus needs the last op id from it.
+// A segment is only included when log_index, opened over the same directory, points to its first
+// and last operations, i.e. the index was not lost, for instance by remote bootstrap.
+// When retained_entry_time is specified, segments with entries written at or after it are not
+// included, so retryable requests of these entries are still bootstrapped.
+FlushedSegments FindFlushedSegments(
+    const log::SegmentSequence& segments, const consensus::OpId& flushed_op_id,
+    log::LogIndex* log_index,
+    boost::optional<RestartSafeCoarseTimePoint> retained_entry_time = boost::none);
+
 // Bootstraps an existing tablet by opening the metadata from disk, and rebuilding soft state by
 // playing log segments. A bootstrapped tablet can then be added to an existing consensus
 // configuration as a LEARNER, which will bring its state up to date with the rest of the consensus
@@ -111,8 +135,19 @@ class TabletBootstrap {
   // accepting writes from clients.
   CHECKED_STATUS PlaySegments(consensus::ConsensusBootstrapInfo* results);
 
+  // Removes leading segments whose operations were all flushed to RocksDB, according to their
+  // footers, so they are not read during replay. Should be called after the new log is opened.
+  CHECKED_STATUS SkipFlushedSegments(const ReplayState& state, log::SegmentSequence* segments);
+
   void PlayWriteRequest(consensus::ReplicateMsg* replicate_msg);
 
+  // Collects a non-transactional write, that is applied to RocksDB together with following writes
+  // by ApplyReplayedWrites.
+  void AddReplayedWrite(log::LogEntryPB* replicate_entry);
+
+  // Applies writes collected by AddReplayedWrite with a single RocksDB write batch.
+  void ApplyReplayedWrites();
+
   CHECKED_STATUS PlayUpdateTransactionRequest(
       consensus::ReplicateMsg* replicate_msg, AlreadyApplied already_applied);
 
@@ -198,6 +233,11 @@ class TabletBootstrap {
 
   bool skip_wal_rewrite_;
 
+  struct ReplayedWrite;
+
+  // Writes that are replayed but not yet applied to RocksDB, see AddReplayedWrite.
+  std::vector<ReplayedWrite> replayed_writes_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(TabletBootstrap);
 };
@@ -62,6 +62,7 @@ class PartitionSchema;
 namespace log {
 class Log;
 class LogAnchorRegistry;
+class LogSyncGroup;
 }
 
 namespace consensus {
@@ -129,6 +130,10 @@ struct BootstrapTabletData {
   TransactionCoordinatorContext* transaction_coordinator_context;
   ThreadPool* append_pool;
   consensus::RetryableRequests* retryable_requests;
+  // Group that coalesces syncs of logs under the same WAL root, or nullptr.
+  log::LogSyncGroup* log_sync_group = nullptr;
+  // Pool used to read and decode log segments ahead of replay, or nullptr.
+  ThreadPool* log_read_pool = nullptr;
 };
 
 // Bootstraps a tablet, initializing it with the provided metadata. If the tablet
@@ -170,7 +170,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
                                   const scoped_refptr<MetricEntity> &metric_entity,
                                   ThreadPool* raft_pool,
                                   ThreadPool* tablet_prepare_pool,
-                                  consensus::RetryableRequests* retryable_requests) {
+                                  consensus::RetryableRequests* retryable_requests,
+                                  consensus::MultiRaftManager* multi_raft_manager) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -248,7 +249,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
         mark_dirty_clbk_,
         tablet_->table_type(),
         raft_pool,
-        retryable_requests);
+        retryable_requests,
+        multi_raft_manager);
     has_consensus_.store(true, std::memory_order_release);
     auto ht_lease_provider = [this](MicrosTime min_allowed, CoarseTimePoint deadline) {
       MicrosTime lease_micros {
@@ -713,6 +715,11 @@ Status TabletPeer::GetEarliestNeededLogIndex(int64_t* min_index) const {
   // during bootstrap.
   *min_index = std::min(*min_index, consensus()->GetLastCommittedOpId().index);
 
+  // Witness does not flush data, so it keeps the log until every full replica has it.
+  if (tablet_->is_witness()) {
+    *min_index = std::min(*min_index, consensus_->GetFullReplicasReplicatedIndex());
+  }
+
   return Status::OK();
 }
 
@@ -246,16 +246,14 @@ class TransactionState {
     NotifyAbortWaiters(status);
   }
 
-  CHECKED_STATUS GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
+  TransactionStatusResult GetStatus() const {
     if (status_ == TransactionStatus::COMMITTED ||
         status_ == TransactionStatus::APPLIED_IN_ALL_INVOLVED_TABLETS) {
-      response->set_status(TransactionStatus::COMMITTED);
-      response->set_status_hybrid_time(commit_time_.ToUint64());
+      return TransactionStatusResult(TransactionStatus::COMMITTED, commit_time_);
     } else if (status_ == TransactionStatus::ABORTED) {
-      response->set_status(TransactionStatus::ABORTED);
+      return TransactionStatusResult::Aborted();
     } else {
       CHECK_EQ(TransactionStatus::PENDING, status_);
-      response->set_status(TransactionStatus::PENDING);
       HybridTime status_ht = context_.coordinator_context().clock().Now();
       if (replicating_) {
         auto replicating_status = replicating_->request()->status();
@@ -268,9 +266,8 @@ class TransactionState {
         }
       }
       status_ht = std::min(status_ht, context_.coordinator_context().HtLeaseExpiration());
-      response->set_status_hybrid_time(status_ht.Decremented().ToUint64());
+      return TransactionStatusResult(TransactionStatus::PENDING, status_ht.Decremented());
     }
-    return Status::OK();
   }
 
   TransactionStatusResult Abort(TransactionAbortCallback* callback) {
@@ -656,20 +653,37 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     rpcs_.Shutdown();
   }
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response) {
-    auto id = FullyDecodeTransactionId(transaction_id);
-    if (!id.ok()) {
-      return std::move(id.status());
+    auto id = VERIFY_RESULT(FullyDecodeTransactionId(request.transaction_id()));
+    std::vector<TransactionId> batch_ids;
+    batch_ids.reserve(request.batch_transaction_id().size());
+    for (const auto& transaction_id : request.batch_transaction_id()) {
+      batch_ids.push_back(VERIFY_RESULT(FullyDecodeTransactionId(transaction_id)));
     }
 
     std::lock_guard<std::mutex> lock(managed_mutex_);
-    auto it = managed_transactions_.find(*id);
+    auto result = GetStatusUnlocked(id);
+    response->set_status(result.status);
+    if (result.status != TransactionStatus::ABORTED) {
+      response->set_status_hybrid_time(result.status_time.ToUint64());
+    }
+    for (const auto& batch_id : batch_ids) {
+      result = GetStatusUnlocked(batch_id);
+      response->add_batch_status(result.status);
+      response->add_batch_status_hybrid_time(
+          result.status == TransactionStatus::ABORTED ? HybridTime::kMax.ToUint64()
+                                                      : result.status_time.ToUint64());
+    }
+    return Status::OK();
+  }
+
+  TransactionStatusResult GetStatusUnlocked(const TransactionId& id) {
+    auto it = managed_transactions_.find(id);
     if (it == managed_transactions_.end()) {
-      response->set_status(TransactionStatus::ABORTED);
-      return Status::OK();
+      return TransactionStatusResult::Aborted();
     }
-    return it->GetStatus(response);
+    return it->GetStatus();
   }
 
   void Abort(const std::string& transaction_id, int64_t term, TransactionAbortCallback callback) {
@@ -1060,9 +1074,9 @@ void TransactionCoordinator::Shutdown() {
   impl_->Shutdown();
 }
 
-Status TransactionCoordinator::GetStatus(const std::string& transaction_id,
+Status TransactionCoordinator::GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                                          tserver::GetTransactionStatusResponsePB* response) {
-  return impl_->GetStatus(transaction_id, response);
+  return impl_->GetStatus(request, response);
 }
 
 void TransactionCoordinator::Abort(const std::string& transaction_id,
@@ -47,6 +47,7 @@ class Clock;
 namespace tserver {
 
 class AbortTransactionResponsePB;
+class GetTransactionStatusRequestPB;
 class GetTransactionStatusResponsePB;
 class TransactionStatePB;
 
@@ -130,7 +131,8 @@ class TransactionCoordinator {
   // And like most of other Shutdowns in our codebase it wait until shutdown completes.
   void Shutdown();
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  // Fills response with status of transaction_id and of each of batch_transaction_id of request.
+  CHECKED_STATUS GetStatus(const tserver::GetTransactionStatusRequestPB& request,
                            tserver::GetTransactionStatusResponsePB* response);
 
   void Abort(const std::string& transaction_id, int64_t term, TransactionAbortCallback callback);
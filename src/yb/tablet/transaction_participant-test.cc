@@ -0,0 +1,312 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/client/transaction_rpc.h"
+
+#include "yb/rocksdb/write_batch.h"
+
+#include "yb/rpc/thread_pool.h"
+
+#include "yb/server/logical_clock.h"
+
+#include "yb/tablet/tablet-test-util.h"
+#include "yb/tablet/transaction_participant.h"
+
+#include "yb/tserver/tserver_service.pb.h"
+
+#include "yb/util/metrics.h"
+#include "yb/util/test_util.h"
+
+DECLARE_int32(transaction_status_cache_ttl_ms);
+
+METRIC_DECLARE_entity(tablet);
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+const TabletId kStatusTablet = "status-tablet";
+const TabletId kOtherStatusTablet = "other-status-tablet";
+const std::string kReason = "test";
+
+class TestTransactionIntentApplier : public TransactionIntentApplier {
+ public:
+  CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) override {
+    return Status::OK();
+  }
+
+  CHECKED_STATUS RemoveIntents(
+      const RemoveIntentsData& data, const TransactionId& transaction_id) override {
+    return Status::OK();
+  }
+
+  CHECKED_STATUS RemoveIntents(
+      const RemoveIntentsData& data, const TransactionIdSet& transactions) override {
+    return Status::OK();
+  }
+
+  HybridTime ApplierSafeTime(HybridTime min_allowed, CoarseTimePoint deadline) override {
+    return min_allowed;
+  }
+};
+
+// Runs tasks in place, so intents of removed transactions are removed before Enqueue returns.
+class LeaderParticipantContext : public TestTransactionParticipantContext {
+ public:
+  LeaderParticipantContext()
+      : TestTransactionParticipantContext(
+            scoped_refptr<server::Clock>(
+                server::LogicalClock::CreateStartingAt(HybridTime::kInitial)),
+            "test-tablet") {}
+
+  bool Enqueue(rpc::ThreadPoolTask* task) override {
+    task->Run();
+    task->Done(Status::OK());
+    return true;
+  }
+
+  bool IsLeader() override { return true; }
+};
+
+} // namespace
+
+class TransactionParticipantTest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+    participant_ = std::make_unique<TransactionParticipant>(&context_, &applier_, metric_entity_);
+    participant_->TEST_SetStatusRequestSender(
+        [this](const tserver::GetTransactionStatusRequestPB& req,
+               client::GetTransactionStatusCallback callback) {
+          requests_.push_back(req);
+          callbacks_.push_back(std::move(callback));
+        });
+  }
+
+  void TearDown() override {
+    callbacks_.clear();
+    participant_.reset();
+    YBTest::TearDown();
+  }
+
+  TransactionId AddTransaction(const TabletId& status_tablet) {
+    TransactionMetadata metadata;
+    metadata.transaction_id = GenerateTransactionId();
+    metadata.isolation = IsolationLevel::SNAPSHOT_ISOLATION;
+    metadata.status_tablet = status_tablet;
+    TransactionMetadataPB metadata_pb;
+    metadata.ToPB(&metadata_pb);
+    rocksdb::WriteBatch write_batch;
+    EXPECT_TRUE(participant_->Add(metadata_pb, false /* may_have_metadata */, &write_batch));
+    return metadata.transaction_id;
+  }
+
+  // Requests status of transaction at the current time, result is appended to results_.
+  void RequestStatus(const TransactionId& id) {
+    auto now = context_.Now();
+    StatusRequest request = {
+      &id,
+      now /* read_ht */,
+      now /* global_limit_ht */,
+      0 /* serial_no */,
+      &kReason,
+      TransactionLoadFlags{},
+      [this](Result<TransactionStatusResult> result) {
+        results_.push_back(std::move(result));
+      }
+    };
+    participant_->RequestStatusAt(request);
+  }
+
+  // Responds to the status request with the specified index, first status is for transaction_id
+  // of request, the rest are for batch_transaction_id. Empty batch_statuses means that status
+  // tablet does not support batching.
+  void Respond(size_t index, TransactionStatus status,
+               const std::vector<TransactionStatus>& batch_statuses = {}) {
+    tserver::GetTransactionStatusResponsePB response;
+    auto now = context_.Now().ToUint64();
+    response.set_status(status);
+    if (status != TransactionStatus::ABORTED) {
+      response.set_status_hybrid_time(now);
+    }
+    for (auto batch_status : batch_statuses) {
+      response.add_batch_status(batch_status);
+      response.add_batch_status_hybrid_time(
+          batch_status == TransactionStatus::ABORTED ? HybridTime::kMax.ToUint64() : now);
+    }
+    // Callback could send the next request, that would be added to callbacks_.
+    auto callback = std::move(callbacks_[index]);
+    callback(Status::OK(), response);
+  }
+
+  void RespondWithError(size_t index) {
+    auto callback = std::move(callbacks_[index]);
+    callback(STATUS(TimedOut, "Status tablet leader is not available"),
+             tserver::GetTransactionStatusResponsePB());
+  }
+
+  static std::vector<TransactionId> RequestedIds(
+      const tserver::GetTransactionStatusRequestPB& req) {
+    std::vector<TransactionId> result;
+    result.push_back(CHECK_RESULT(FullyDecodeTransactionId(req.transaction_id())));
+    for (const auto& id : req.batch_transaction_id()) {
+      result.push_back(CHECK_RESULT(FullyDecodeTransactionId(id)));
+    }
+    return result;
+  }
+
+  MetricRegistry metric_registry_;
+  scoped_refptr<MetricEntity> metric_entity_ =
+      METRIC_ENTITY_tablet.Instantiate(&metric_registry_, "test-tablet");
+  LeaderParticipantContext context_;
+  TestTransactionIntentApplier applier_;
+  std::unique_ptr<TransactionParticipant> participant_;
+
+  std::vector<tserver::GetTransactionStatusRequestPB> requests_;
+  std::vector<client::GetTransactionStatusCallback> callbacks_;
+  std::vector<Result<TransactionStatusResult>> results_;
+};
+
+TEST_F(TransactionParticipantTest, CoalesceStatusRequests) {
+  std::vector<TransactionId> ids;
+  for (int i = 0; i != 3; ++i) {
+    ids.push_back(AddTransaction(kStatusTablet));
+  }
+  auto other_id = AddTransaction(kOtherStatusTablet);
+
+  RequestStatus(ids[0]);
+  ASSERT_EQ(requests_.size(), 1U);
+  ASSERT_EQ(RequestedIds(requests_[0]), std::vector<TransactionId>{ids[0]});
+
+  // Request to the same status tablet is in flight, so these ones are queued.
+  RequestStatus(ids[1]);
+  RequestStatus(ids[2]);
+  ASSERT_EQ(requests_.size(), 1U);
+
+  // Other status tablet has its own queue.
+  RequestStatus(other_id);
+  ASSERT_EQ(requests_.size(), 2U);
+  ASSERT_EQ(requests_[1].tablet_id(), kOtherStatusTablet);
+
+  Respond(0, TransactionStatus::PENDING);
+  ASSERT_EQ(results_.size(), 1U);
+  ASSERT_EQ(requests_.size(), 3U);
+  ASSERT_EQ(requests_[2].tablet_id(), kStatusTablet);
+  ASSERT_EQ(RequestedIds(requests_[2]), (std::vector<TransactionId>{ids[1], ids[2]}));
+
+  Respond(2, TransactionStatus::PENDING, {TransactionStatus::COMMITTED});
+  ASSERT_EQ(results_.size(), 3U);
+  for (const auto& result : results_) {
+    ASSERT_OK(result);
+  }
+  // Queue is empty, so nothing is sent.
+  ASSERT_EQ(requests_.size(), 3U);
+
+  Respond(1, TransactionStatus::PENDING);
+  ASSERT_EQ(results_.size(), 4U);
+  ASSERT_EQ(requests_.size(), 3U);
+}
+
+TEST_F(TransactionParticipantTest, StatusTabletWithoutBatching) {
+  std::vector<TransactionId> ids;
+  for (int i = 0; i != 7; ++i) {
+    ids.push_back(AddTransaction(kStatusTablet));
+  }
+
+  RequestStatus(ids[0]);
+  RequestStatus(ids[1]);
+  RequestStatus(ids[2]);
+  Respond(0, TransactionStatus::PENDING);
+  ASSERT_EQ(requests_.size(), 2U);
+  ASSERT_EQ(RequestedIds(requests_[1]), (std::vector<TransactionId>{ids[1], ids[2]}));
+
+  // Response from leader that does not support batching contains only status of the first
+  // transaction, so the rest of batch is sent again.
+  Respond(1, TransactionStatus::PENDING);
+  ASSERT_EQ(results_.size(), 2U);
+  ASSERT_EQ(requests_.size(), 3U);
+  ASSERT_EQ(RequestedIds(requests_[2]), std::vector<TransactionId>{ids[2]});
+
+  // Further requests to this status tablet are not batched.
+  RequestStatus(ids[3]);
+  RequestStatus(ids[4]);
+  Respond(2, TransactionStatus::PENDING);
+  ASSERT_EQ(requests_.size(), 4U);
+  ASSERT_EQ(RequestedIds(requests_[3]), std::vector<TransactionId>{ids[3]});
+
+  // Failure could mean that leader has changed, so batching is tried again.
+  RespondWithError(3);
+  ASSERT_EQ(results_.size(), 4U);
+  ASSERT_NOK(results_.back());
+  ASSERT_EQ(requests_.size(), 5U);
+  ASSERT_EQ(RequestedIds(requests_[4]), std::vector<TransactionId>{ids[4]});
+
+  RequestStatus(ids[5]);
+  RequestStatus(ids[6]);
+  Respond(4, TransactionStatus::PENDING);
+  ASSERT_EQ(requests_.size(), 6U);
+  ASSERT_EQ(RequestedIds(requests_[5]), (std::vector<TransactionId>{ids[5], ids[6]}));
+  Respond(5, TransactionStatus::PENDING, {TransactionStatus::PENDING});
+  ASSERT_EQ(results_.size(), 7U);
+}
+
+TEST_F(TransactionParticipantTest, FinalStatusCache) {
+  FLAGS_transaction_status_cache_ttl_ms = 500;
+
+  auto id = AddTransaction(kStatusTablet);
+  RequestStatus(id);
+  ASSERT_EQ(requests_.size(), 1U);
+
+  // Aborted transaction is removed by leader, but its status is still known.
+  Respond(0, TransactionStatus::ABORTED);
+  ASSERT_EQ(participant_->TEST_GetNumRunningTransactions(), 0U);
+  ASSERT_EQ(results_.size(), 1U);
+  ASSERT_OK(results_[0]);
+  ASSERT_EQ(results_[0]->status, TransactionStatus::ABORTED);
+
+  RequestStatus(id);
+  ASSERT_EQ(results_.size(), 2U);
+  ASSERT_OK(results_[1]);
+  ASSERT_EQ(results_[1]->status, TransactionStatus::ABORTED);
+  ASSERT_EQ(requests_.size(), 1U);
+
+  // After expiration status of removed transaction is unknown.
+  SleepFor(MonoDelta::FromMilliseconds(FLAGS_transaction_status_cache_ttl_ms * 2));
+  RequestStatus(id);
+  ASSERT_EQ(results_.size(), 3U);
+  ASSERT_NOK(results_[2]);
+  ASSERT_TRUE(results_[2].status().IsNotFound()) << results_[2].status();
+  ASSERT_EQ(requests_.size(), 1U);
+}
+
+TEST_F(TransactionParticipantTest, FinalStatusCacheDisabled) {
+  FLAGS_transaction_status_cache_ttl_ms = 0;
+
+  auto id = AddTransaction(kStatusTablet);
+  RequestStatus(id);
+  Respond(0, TransactionStatus::ABORTED);
+  ASSERT_EQ(participant_->TEST_GetNumRunningTransactions(), 0U);
+
+  RequestStatus(id);
+  ASSERT_EQ(results_.size(), 2U);
+  ASSERT_NOK(results_[1]);
+  ASSERT_TRUE(results_[1].status().IsNotFound()) << results_[1].status();
+}
+
+} // namespace tablet
+} // namespace yb
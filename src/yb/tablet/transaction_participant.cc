@@ -17,6 +17,7 @@
 
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -56,6 +57,13 @@ DEFINE_uint64(transaction_delay_status_reply_usec_in_tests, 0,
               "For tests only. Delay handling status reply by specified amount of usec.");
 DEFINE_double(transaction_ignore_applying_probability_in_tests, 0,
               "Probability to ignore APPLYING update in tests.");
+DEFINE_int32(transaction_status_cache_ttl_ms, 5000,
+             "For how long transaction participant remembers commit time or abort of a "
+             "transaction, so status requests for it could be answered without loading it or "
+             "asking status tablet. 0 to disable.");
+DEFINE_int32(transaction_max_status_request_batch_size, 128,
+             "Max number of transactions which status is requested in a single RPC to the status "
+             "tablet.");
 
 METRIC_DEFINE_simple_counter(
     tablet, transaction_load_attempts,
@@ -145,6 +153,27 @@ class RunningTransaction;
 
 typedef std::shared_ptr<RunningTransaction> RunningTransactionPtr;
 
+boost::optional<TransactionStatus> GetStatusAt(
+    HybridTime time,
+    HybridTime last_known_status_hybrid_time,
+    TransactionStatus last_known_status) {
+  switch (last_known_status) {
+    case TransactionStatus::ABORTED:
+      return TransactionStatus::ABORTED;
+    case TransactionStatus::COMMITTED:
+      return last_known_status_hybrid_time > time
+          ? TransactionStatus::PENDING
+          : TransactionStatus::COMMITTED;
+    case TransactionStatus::PENDING:
+      if (last_known_status_hybrid_time >= time) {
+        return TransactionStatus::PENDING;
+      }
+      return boost::none;
+    default:
+      FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
+  }
+}
+
 class RunningTransactionContext {
  public:
   RunningTransactionContext(TransactionParticipantContext* participant_context,
@@ -156,6 +185,14 @@ class RunningTransactionContext {
 
   virtual bool RemoveUnlocked(const TransactionId& id, const std::string& reason) = 0;
 
+  // Requests status of the transaction from its status tablet, RunningTransaction::StatusReceived
+  // is invoked with the result.
+  virtual void SendStatusRequest(int64_t serial_no, const RunningTransactionPtr& transaction) = 0;
+
+  // Remembers that transaction was committed at the specified time or aborted.
+  virtual void CacheFinalStatusUnlocked(
+      const TransactionId& id, TransactionStatus status, HybridTime time) = 0;
+
   int64_t NextRequestIdUnlocked() {
     return ++request_serial_;
   }
@@ -407,12 +444,11 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
         context_(*context),
         remove_intents_task_(&context->applier_, &context->participant_context_,
                              metadata_.transaction_id),
-        get_status_handle_(context->rpcs_.InvalidHandle()),
         abort_handle_(context->rpcs_.InvalidHandle()) {
   }
 
   ~RunningTransaction() {
-    context_.rpcs_.Abort({&get_status_handle_, &abort_handle_});
+    context_.rpcs_.Abort({&abort_handle_});
   }
 
   const TransactionId& id() const {
@@ -439,9 +475,7 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
     local_commit_time_ = time;
   }
 
-  void RequestStatusAt(client::YBClient* client,
-                       const StatusRequest& request,
-                       std::unique_lock<std::mutex>* lock) {
+  void RequestStatusAt(const StatusRequest& request, std::unique_lock<std::mutex>* lock) {
     DCHECK_LT(request.global_limit_ht, HybridTime::kMax);
     DCHECK_LE(request.read_ht, request.global_limit_ht);
 
@@ -470,7 +504,7 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
         last_known_status_, last_known_status_hybrid_time_, request, request_id);
 
     lock->unlock();
-    SendStatusRequest(client, request_id, shared_self);
+    context_.SendStatusRequest(request_id, shared_self);
   }
 
   void Abort(client::YBClient* client,
@@ -507,71 +541,30 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
     }
   }
 
- private:
-  static boost::optional<TransactionStatus> GetStatusAt(
-      HybridTime time,
-      HybridTime last_known_status_hybrid_time,
-      TransactionStatus last_known_status) {
-    switch (last_known_status) {
-      case TransactionStatus::ABORTED:
-        return TransactionStatus::ABORTED;
-      case TransactionStatus::COMMITTED:
-        return last_known_status_hybrid_time > time
-            ? TransactionStatus::PENDING
-            : TransactionStatus::COMMITTED;
-      case TransactionStatus::PENDING:
-        if (last_known_status_hybrid_time >= time) {
-          return TransactionStatus::PENDING;
-        }
-        return boost::none;
-      default:
-        FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
-    }
-  }
-
-  void SendStatusRequest(
-      client::YBClient* client, int64_t serial_no, const RunningTransactionPtr& shared_self) {
-    tserver::GetTransactionStatusRequestPB req;
-    req.set_tablet_id(metadata_.status_tablet);
-    req.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    req.set_propagated_hybrid_time(context_.participant_context_.Now().ToUint64());
-    context_.rpcs_.RegisterAndStart(
-        client::GetTransactionStatus(
-            TransactionRpcDeadline(),
-            nullptr /* tablet */,
-            client,
-            &req,
-            std::bind(&RunningTransaction::StatusReceived, this, client, _1, _2, serial_no,
-                      shared_self)),
-        &get_status_handle_);
-  }
-
-  void StatusReceived(client::YBClient* client,
-                      const Status& status,
-                      const tserver::GetTransactionStatusResponsePB& response,
+  // Invoked by the context when the status request sent with the specified serial_no completes.
+  // response_status and response_time are meaningful only when status is OK.
+  void StatusReceived(const Status& status,
+                      TransactionStatus response_status,
+                      HybridTime response_time,
                       int64_t serial_no,
                       const RunningTransactionPtr& shared_self) {
     auto delay_usec = FLAGS_transaction_delay_status_reply_usec_in_tests;
     if (delay_usec > 0) {
       context_.delayer().Delay(
           MonoTime::Now() + MonoDelta::FromMicroseconds(delay_usec),
-          std::bind(&RunningTransaction::DoStatusReceived, this, client, status, response,
-                    serial_no, shared_self));
+          std::bind(&RunningTransaction::DoStatusReceived, this, status, response_status,
+                    response_time, serial_no, shared_self));
     } else {
-      DoStatusReceived(client, status, response, serial_no, shared_self);
+      DoStatusReceived(status, response_status, response_time, serial_no, shared_self);
     }
   }
 
-  void DoStatusReceived(client::YBClient* client,
-                        const Status& status,
-                        const tserver::GetTransactionStatusResponsePB& response,
+ private:
+  void DoStatusReceived(const Status& status,
+                        TransactionStatus response_status,
+                        HybridTime response_time,
                         int64_t serial_no,
                         const RunningTransactionPtr& shared_self) {
-    if (response.has_propagated_hybrid_time()) {
-      context_.participant_context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
-    }
-
-    context_.rpcs_.Unregister(&get_status_handle_);
     decltype(status_waiters_) status_waiters;
     HybridTime time_of_status;
     TransactionStatus transaction_status;
@@ -588,15 +581,15 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
         return;
       }
 
-      DCHECK(response.has_status_hybrid_time() ||
-             response.status() == TransactionStatus::ABORTED);
-      time_of_status = response.has_status_hybrid_time()
-          ? HybridTime(response.status_hybrid_time())
-          : HybridTime::kMax;
+      time_of_status = response_time;
+      if (response_status == TransactionStatus::ABORTED ||
+          response_status == TransactionStatus::COMMITTED) {
+        context_.CacheFinalStatusUnlocked(id(), response_status, response_time);
+      }
       if (last_known_status_hybrid_time_ <= time_of_status) {
         last_known_status_hybrid_time_ = time_of_status;
-        last_known_status_ = response.status();
-        if (response.status() == TransactionStatus::ABORTED &&
+        last_known_status_ = response_status;
+        if (response_status == TransactionStatus::ABORTED &&
             ThreadRestrictions::IsWaitAllowed() && // Required by IsLeader
             context_.participant_context_.IsLeader()) {
           context_.RemoveUnlocked(id(), "aborted"s);
@@ -613,7 +606,7 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
       }
     }
     if (new_request_id >= 0) {
-      SendStatusRequest(client, new_request_id, shared_self);
+      context_.SendStatusRequest(new_request_id, shared_self);
     }
     NotifyWaiters(serial_no, time_of_status, transaction_status, status_waiters);
   }
@@ -721,7 +714,6 @@ class RunningTransaction : public std::enable_shared_from_this<RunningTransactio
   TransactionStatus last_known_status_ = TransactionStatus::CREATED;
   HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   std::vector<StatusRequest> status_waiters_;
-  rpc::Rpcs::Handle get_status_handle_;
   rpc::Rpcs::Handle abort_handle_;
   std::vector<TransactionStatusCallback> abort_waiters_;
 };
@@ -808,7 +800,10 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = transactions_.find(id);
     if (it == transactions_.end()) {
-      return HybridTime::kInvalid;
+      // Transaction could be already applied and removed.
+      auto final_status = FindFinalStatusUnlocked(id);
+      return final_status && final_status->status == TransactionStatus::COMMITTED
+          ? final_status->time : HybridTime::kInvalid;
     }
     return (**it).local_commit_time();
   }
@@ -863,13 +858,53 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
   }
 
   void RequestStatusAt(const StatusRequest& request) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto final_status = FindFinalStatusUnlocked(*request.id);
+      if (final_status) {
+        auto status_time = final_status->time;
+        auto status = GetStatusAt(request.global_limit_ht, status_time, final_status->status);
+        lock.unlock();
+        request.callback(TransactionStatusResult{*status, status_time});
+        return;
+      }
+    }
+
     auto lock_and_iterator = LockAndFindOrLoad(*request.id, *request.reason, request.flags);
     if (!lock_and_iterator.found()) {
       request.callback(
           STATUS_FORMAT(NotFound, "Request status of unknown transaction: $0", *request.id));
       return;
     }
-    lock_and_iterator.transaction().RequestStatusAt(client(), request, &lock_and_iterator.lock);
+    lock_and_iterator.transaction().RequestStatusAt(request, &lock_and_iterator.lock);
+  }
+
+  void SendStatusRequest(int64_t serial_no, const RunningTransactionPtr& transaction) override {
+    const auto& status_tablet = transaction->metadata().status_tablet;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& queue = status_request_queues_[status_tablet];
+      queue.pending.emplace_back(transaction, serial_no);
+      if (queue.in_flight) {
+        // Will be sent with the next batch, when the current request completes.
+        return;
+      }
+      queue.in_flight = true;
+    }
+    SendStatusRequestBatch(status_tablet);
+  }
+
+  void CacheFinalStatusUnlocked(
+      const TransactionId& id, TransactionStatus status, HybridTime time) override {
+    auto ttl_ms = FLAGS_transaction_status_cache_ttl_ms;
+    if (ttl_ms <= 0) {
+      return;
+    }
+    auto now = CoarseMonoClock::now();
+    CleanupFinalStatusesUnlocked(now);
+    if (final_statuses_.emplace(id, FinalStatus{status, time}).second) {
+      final_statuses_expiration_queue_.push_back({id, now + ttl_ms * 1ms});
+    }
   }
 
   // Registers request, giving him newly allocated id and returning this id.
@@ -1012,6 +1047,7 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
       }
 
       lock_and_iterator.transaction().SetLocalCommitTime(data.commit_ht);
+      CacheFinalStatusUnlocked(data.transaction_id, TransactionStatus::COMMITTED, data.commit_ht);
     }
 
     CHECK_OK(applier_.ApplyIntents(data));
@@ -1097,6 +1133,10 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
     return transactions_.size();
   }
 
+  void TEST_SetStatusRequestSender(StatusRequestSender sender) {
+    test_status_request_sender_ = std::move(sender);
+  }
+
  private:
   typedef boost::multi_index_container<RunningTransactionPtr,
       boost::multi_index::indexed_by <
@@ -1296,6 +1336,148 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
     return recently_removed_transactions_.count(id) != 0;
   }
 
+  struct FinalStatus {
+    TransactionStatus status;
+    // Commit time for committed transaction, HybridTime::kMax for aborted one.
+    HybridTime time;
+  };
+
+  boost::optional<FinalStatus> FindFinalStatusUnlocked(const TransactionId& id) {
+    if (final_statuses_.empty()) {
+      return boost::none;
+    }
+    CleanupFinalStatusesUnlocked(CoarseMonoClock::now());
+    auto it = final_statuses_.find(id);
+    if (it == final_statuses_.end()) {
+      return boost::none;
+    }
+    return it->second;
+  }
+
+  void CleanupFinalStatusesUnlocked(CoarseTimePoint now) {
+    while (!final_statuses_expiration_queue_.empty() &&
+           final_statuses_expiration_queue_.front().time <= now) {
+      final_statuses_.erase(final_statuses_expiration_queue_.front().id);
+      final_statuses_expiration_queue_.pop_front();
+    }
+  }
+
+  typedef std::vector<std::pair<RunningTransactionPtr, int64_t>> StatusRequestBatch;
+
+  // Sends status request for transactions queued for the specified status tablet, or marks queue
+  // as idle if there is nothing to send.
+  void SendStatusRequestBatch(const TabletId& status_tablet) {
+    StatusRequestBatch batch;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = status_request_queues_.find(status_tablet);
+      auto& pending = it->second.pending;
+      if (pending.empty()) {
+        status_request_queues_.erase(it);
+        return;
+      }
+      const size_t max_batch_size = status_tablets_without_batching_.count(status_tablet)
+          ? 1 : std::max(FLAGS_transaction_max_status_request_batch_size, 1);
+      auto batch_end = pending.begin() + std::min(pending.size(), max_batch_size);
+      batch.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(batch_end));
+      pending.erase(pending.begin(), batch_end);
+    }
+
+    tserver::GetTransactionStatusRequestPB req;
+    req.set_tablet_id(status_tablet);
+    const auto& first_id = batch.front().first->id();
+    req.set_transaction_id(first_id.begin(), first_id.size());
+    for (auto it = batch.begin() + 1; it != batch.end(); ++it) {
+      const auto& id = it->first->id();
+      req.add_batch_transaction_id(id.begin(), id.size());
+    }
+    req.set_propagated_hybrid_time(participant_context_.Now().ToUint64());
+
+    if (test_status_request_sender_) {
+      test_status_request_sender_(
+          req, [this, status_tablet, batch = std::move(batch)](
+              const Status& status, const tserver::GetTransactionStatusResponsePB& response) {
+            StatusBatchReceived(status_tablet, batch, status, response);
+          });
+      return;
+    }
+
+    auto handle = rpcs_.Prepare();
+    if (handle == rpcs_.InvalidHandle()) {
+      StatusBatchReceived(
+          status_tablet, batch, STATUS(Aborted, "Transaction participant is shutting down"),
+          tserver::GetTransactionStatusResponsePB());
+      return;
+    }
+    *handle = client::GetTransactionStatus(
+        TransactionRpcDeadline(),
+        nullptr /* tablet */,
+        client(),
+        &req,
+        [this, handle, status_tablet, batch = std::move(batch)](
+            const Status& status, const tserver::GetTransactionStatusResponsePB& response) {
+          rpcs_.Unregister(handle);
+          StatusBatchReceived(status_tablet, batch, status, response);
+        });
+    (**handle).SendRpc();
+  }
+
+  void StatusBatchReceived(const TabletId& status_tablet,
+                           const StatusRequestBatch& batch,
+                           Status status,
+                           const tserver::GetTransactionStatusResponsePB& response) {
+    if (response.has_propagated_hybrid_time()) {
+      participant_context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+
+    size_t num_received = batch.size();
+    if (status.ok()) {
+      const auto num_statuses = static_cast<size_t>(response.batch_status().size());
+      const auto num_times = static_cast<size_t>(response.batch_status_hybrid_time().size());
+      if (batch.size() > 1 && num_statuses == 0) {
+        // Status tablet leader does not support batching yet, i.e. runs an older version, so it
+        // returned only status of the first transaction. Send the rest one by one.
+        num_received = 1;
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_tablets_without_batching_.insert(status_tablet);
+        auto& pending = status_request_queues_[status_tablet].pending;
+        pending.insert(pending.begin(), batch.begin() + 1, batch.end());
+      } else if (num_statuses != batch.size() - 1 || num_times != num_statuses) {
+        status = STATUS_FORMAT(
+            IllegalState, "Wrong number of statuses in response: $0, expected: $1",
+            response.ShortDebugString(), batch.size());
+      }
+    } else {
+      // Leader of the status tablet could have changed, so check whether the new one supports
+      // batching.
+      std::lock_guard<std::mutex> lock(mutex_);
+      status_tablets_without_batching_.erase(status_tablet);
+    }
+    for (size_t i = 0; i != num_received; ++i) {
+      const auto& transaction = batch[i].first;
+      if (!status.ok()) {
+        transaction->StatusReceived(
+            status, TransactionStatus::PENDING, HybridTime::kInvalid, batch[i].second,
+            transaction);
+      } else if (i == 0) {
+        DCHECK(response.has_status_hybrid_time() ||
+               response.status() == TransactionStatus::ABORTED);
+        auto time_of_status = response.has_status_hybrid_time()
+            ? HybridTime(response.status_hybrid_time())
+            : HybridTime::kMax;
+        transaction->StatusReceived(
+            status, response.status(), time_of_status, batch[i].second, transaction);
+      } else {
+        transaction->StatusReceived(
+            status, response.batch_status(i - 1),
+            HybridTime(response.batch_status_hybrid_time(i - 1)), batch[i].second, transaction);
+      }
+    }
+
+    // Send requests that were queued while this one was in flight.
+    SendStatusRequestBatch(status_tablet);
+  }
+
   struct CleanupQueueEntry {
     int64_t request_id;
     TransactionId transaction_id;
@@ -1324,6 +1506,27 @@ class TransactionParticipant::Impl : public RunningTransactionContext {
   };
   std::deque<RecentlyRemovedTransaction> recently_removed_transactions_cleanup_queue_;
 
+  // Final statuses of recently committed or aborted transactions, expired after
+  // FLAGS_transaction_status_cache_ttl_ms.
+  std::unordered_map<TransactionId, FinalStatus, TransactionIdHash> final_statuses_;
+  struct FinalStatusExpiration {
+    TransactionId id;
+    CoarseTimePoint time;
+  };
+  std::deque<FinalStatusExpiration> final_statuses_expiration_queue_;
+
+  // Status requests to the same status tablet are coalesced. While request is in flight,
+  // transactions that need status are queued and then sent together in the next request.
+  struct StatusRequestQueue {
+    bool in_flight = false;
+    StatusRequestBatch pending;
+  };
+  std::unordered_map<TabletId, StatusRequestQueue> status_request_queues_;
+  // Status tablets whose leader returned only the first status of a batch.
+  std::unordered_set<TabletId> status_tablets_without_batching_;
+
+  StatusRequestSender test_status_request_sender_;
+
   scoped_refptr<AtomicGauge<uint64_t>> metric_transactions_running_;
   scoped_refptr<Counter> metric_transaction_load_attempts_;
   scoped_refptr<Counter> metric_transaction_not_found_;
@@ -1411,5 +1614,9 @@ size_t TransactionParticipant::TEST_GetNumRunningTransactions() const {
   return impl_->TEST_GetNumRunningTransactions();
 }
 
+void TransactionParticipant::TEST_SetStatusRequestSender(StatusRequestSender sender) {
+  impl_->TEST_SetStatusRequestSender(std::move(sender));
+}
+
 } // namespace tablet
 } // namespace yb
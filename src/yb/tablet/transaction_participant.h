@@ -16,6 +16,7 @@
 #ifndef YB_TABLET_TRANSACTION_PARTICIPANT_H
 #define YB_TABLET_TRANSACTION_PARTICIPANT_H
 
+#include <functional>
 #include <future>
 #include <memory>
 
@@ -54,6 +55,8 @@ class TransactionMetadataPB;
 
 namespace tserver {
 
+class GetTransactionStatusRequestPB;
+class GetTransactionStatusResponsePB;
 class TransactionStatePB;
 
 }
@@ -166,6 +169,14 @@ class TransactionParticipant : public TransactionStatusManager {
 
   size_t TEST_CountIntents() const;
 
+  typedef std::function<void(
+      const tserver::GetTransactionStatusRequestPB&,
+      std::function<void(const Status&, const tserver::GetTransactionStatusResponsePB&)>)>
+      StatusRequestSender;
+
+  // Status requests are passed to sender instead of the status tablet.
+  void TEST_SetStatusRequestSender(StatusRequestSender sender);
+
  private:
   int64_t RegisterRequest() override;
   void UnregisterRequest(int64_t request) override;
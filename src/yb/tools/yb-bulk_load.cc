@@ -452,6 +452,8 @@ Status BulkLoad::FinishTabletProcessing(const TabletId &tablet_id,
 
     tserver::ImportDataResponsePB resp;
     rpc::RpcController controller;
+    // Bulk load should not delay the regular workload of the tablet server.
+    controller.set_priority(rpc::LOW_REQUEST_PRIORITY);
     LOG(INFO) << "Importing " << directory << " on " << replica_host << " for tablet_id: "
               << tablet_id;
     RETURN_NOT_OK(proxy.ImportData(req, &resp, &controller));
@@ -41,6 +41,7 @@
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/quorum_util.h"
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/strings/util.h"
@@ -524,7 +525,8 @@ Status RemoteBootstrapClient::VerifyChangeRoleSucceeded(
         continue;
       }
 
-      if (peer.member_type() == RaftPeerPB::VOTER || peer.member_type() == RaftPeerPB::OBSERVER) {
+      if (peer.member_type() == RaftPeerPB::VOTER || peer.member_type() == RaftPeerPB::OBSERVER ||
+          peer.member_type() == RaftPeerPB::WITNESS) {
         return Status::OK();
       } else {
         SleepFor(MonoDelta::FromMilliseconds(backoff_ms));
@@ -738,6 +740,15 @@ Status RemoteBootstrapClient::DownloadRocksDBFiles() {
 
   RETURN_NOT_OK(CreateTabletDirectories(rocksdb_dir, meta_->fs_manager()));
 
+  // Witness does not apply operations to DocDB, so it does not need the data files. It starts
+  // with an empty DocDB and only keeps the log.
+  if (consensus::IsWitnessMemberType(
+          consensus::GetConsensusMemberType(fs_manager_->uuid(), *remote_committed_cstate_))) {
+    LOG_WITH_PREFIX(INFO) << "Skipping " << new_sb->kv_store().rocksdb_files_size()
+                          << " data files for a witness replica";
+    new_sb->mutable_kv_store()->clear_rocksdb_files();
+  }
+
   DataIdPB data_id;
   data_id.set_type(DataIdPB::ROCKSDB_FILE);
   for (auto const& file_pb : new_sb->kv_store().rocksdb_files()) {
@@ -854,6 +865,8 @@ Status RemoteBootstrapClient::DownloadFile(const DataIdPB& data_id,
 
   rpc::RpcController controller;
   controller.set_timeout(MonoDelta::FromMilliseconds(session_idle_timeout_millis_));
+  // Data is fetched in the background, so it should not delay the regular workload of the source.
+  controller.set_priority(rpc::LOW_REQUEST_PRIORITY);
   FetchDataRequestPB req;
 
   bool done = false;
@@ -870,29 +883,39 @@ Status RemoteBootstrapClient::DownloadFile(const DataIdPB& data_id,
       max_length = std::min(max_length, decltype(max_length)(max_size));
     }
     req.set_max_length(max_length);
+    req.set_data_sidecar_supported(true);
 
     FetchDataResponsePB resp;
-    auto status = rate_limiter->SendOrReceiveData([this, &req, &resp, &controller]() {
-      return proxy_->FetchData(req, &resp, &controller);
-    }, [&resp]() { return resp.ByteSize(); });
+    Slice data;
+    auto status = rate_limiter->SendOrReceiveData([this, &req, &resp, &controller, &data]() {
+      RETURN_NOT_OK(proxy_->FetchData(req, &resp, &controller));
+      // Servers that do not support sidecars ignore the request flag and send data inline.
+      if (resp.chunk().has_data_sidecar()) {
+        return controller.GetSidecar(resp.chunk().data_sidecar(), &data);
+      }
+      data = resp.chunk().data();
+      return Status::OK();
+    }, [&resp, &data]() {
+      return resp.ByteSize() + (resp.chunk().has_data_sidecar() ? data.size() : 0);
+    });
     RETURN_NOT_OK_UNWIND_PREPEND(status, controller, "Unable to fetch data from remote");
-    DCHECK_LE(resp.chunk().data().size(), max_length);
+    DCHECK_LE(data.size(), max_length);
 
     // Sanity-check for corruption.
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk(), data),
                           Substitute("Error validating data item $0", data_id.ShortDebugString()));
 
     // Write the data.
-    RETURN_NOT_OK(appendable->Append(resp.chunk().data()));
+    RETURN_NOT_OK(appendable->Append(data));
     VLOG_WITH_PREFIX(3)
-        << "resp size: " << resp.ByteSize() << ", chunk size: " << resp.chunk().data().size();
+        << "resp size: " << resp.ByteSize() << ", chunk size: " << data.size();
 
-    if (offset + resp.chunk().data().size() == resp.chunk().total_data_length()) {
+    if (offset + data.size() == resp.chunk().total_data_length()) {
       done = true;
     }
-    offset += resp.chunk().data().size();
+    offset += data.size();
     if (FLAGS_bytes_remote_bootstrap_durable_write_mb != 0) {
-      periodic_sync_unsynced_bytes += resp.chunk().data().size();
+      periodic_sync_unsynced_bytes += data.size();
       if (periodic_sync_unsynced_bytes > FLAGS_bytes_remote_bootstrap_durable_write_mb * 1_MB) {
         RETURN_NOT_OK(appendable->Sync());
         periodic_sync_unsynced_bytes = 0;
@@ -905,7 +928,8 @@ Status RemoteBootstrapClient::DownloadFile(const DataIdPB& data_id,
   return Status::OK();
 }
 
-Status RemoteBootstrapClient::VerifyData(uint64_t offset, const DataChunkPB& chunk) {
+Status RemoteBootstrapClient::VerifyData(
+    uint64_t offset, const DataChunkPB& chunk, const Slice& data) {
   // Verify the offset is what we expected.
   if (offset != chunk.offset()) {
     return STATUS(InvalidArgument, "Offset did not match what was asked for",
@@ -913,11 +937,11 @@ Status RemoteBootstrapClient::VerifyData(uint64_t offset, const DataChunkPB& chu
   }
 
   // Verify the checksum.
-  uint32_t crc32 = crc::Crc32c(chunk.data().data(), chunk.data().length());
+  uint32_t crc32 = crc::Crc32c(data.data(), data.size());
   if (PREDICT_FALSE(crc32 != chunk.crc32())) {
     return STATUS(Corruption,
         Substitute("CRC32 does not match at offset $0 size $1: $2 vs $3",
-          offset, chunk.data().size(), crc32, chunk.crc32()));
+          offset, data.size(), crc32, chunk.crc32()));
   }
   return Status::OK();
 }
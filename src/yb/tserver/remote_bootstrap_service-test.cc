@@ -132,11 +132,13 @@ class RemoteBootstrapServiceTest : public RemoteBootstrapTest {
   Status DoFetchData(const string& session_id, const DataIdPB& data_id,
                      uint64_t* offset, int64_t* max_length,
                      FetchDataResponsePB* resp,
-                     RpcController* controller) {
+                     RpcController* controller,
+                     bool data_sidecar_supported = false) {
     controller->set_timeout(MonoDelta::FromSeconds(1.0));
     FetchDataRequestPB req;
     req.set_session_id(session_id);
     req.mutable_data_id()->CopyFrom(data_id);
+    req.set_data_sidecar_supported(data_sidecar_supported);
     if (offset) {
       req.set_offset(*offset);
     }
@@ -344,14 +346,6 @@ TEST_F(RemoteBootstrapServiceTest, TestFetchLog) {
 
   ASSERT_EQ(1, segment_seqno);
 
-  // Fetch the remote data.
-  FetchDataResponsePB resp;
-  RpcController controller;
-  DataIdPB data_id;
-  data_id.set_type(DataIdPB::LOG_SEGMENT);
-  data_id.set_wal_segment_seqno(segment_seqno);
-  ASSERT_OK(DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller));
-
   // Fetch the local data.
   log::SegmentSequence local_segments;
   ASSERT_OK(tablet_peer_->log()->GetLogReader()->GetSegmentsSnapshot(&local_segments));
@@ -369,7 +363,25 @@ TEST_F(RemoteBootstrapServiceTest, TestFetchLog) {
   Slice slice;
   ASSERT_OK(ReadFully(segment->readable_file_checkpoint().get(), 0, size, &slice, scratch.data()));
 
-  AssertDataEqual(slice.data(), slice.size(), resp.chunk());
+  // Fetch the remote data, inline and in a sidecar.
+  DataIdPB data_id;
+  data_id.set_type(DataIdPB::LOG_SEGMENT);
+  data_id.set_wal_segment_seqno(segment_seqno);
+  for (bool data_sidecar_supported : {false, true}) {
+    FetchDataResponsePB resp;
+    RpcController controller;
+    ASSERT_OK(DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller,
+                          data_sidecar_supported));
+    ASSERT_EQ(data_sidecar_supported, resp.chunk().has_data_sidecar());
+    DataChunkPB chunk = resp.chunk();
+    if (data_sidecar_supported) {
+      ASSERT_TRUE(chunk.data().empty());
+      Slice sidecar;
+      ASSERT_OK(controller.GetSidecar(chunk.data_sidecar(), &sidecar));
+      chunk.set_data(sidecar.ToBuffer());
+    }
+    AssertDataEqual(slice.data(), slice.size(), chunk);
+  }
 }
 
 // Test that the remote bootstrap session timeout works properly.
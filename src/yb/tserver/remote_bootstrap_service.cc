@@ -32,6 +32,7 @@
 #include "yb/tserver/remote_bootstrap_service.h"
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,7 @@
 #include "yb/util/crc.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/ref_cnt_buffer.h"
 
 using namespace std::literals;
 
@@ -297,7 +299,8 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
                     error_code, "Invalid DataId");
 
   DataChunkPB* data_chunk = resp->mutable_chunk();
-  string* data = data_chunk->mutable_data();
+  string sidecar_data;
+  string* data = req->data_sidecar_supported() ? &sidecar_data : data_chunk->mutable_data();
   int64_t total_data_length = 0;
   RPC_RETURN_NOT_OK(GetDataFilePiece(data_id, session, offset, client_maxlen, data,
                                      &total_data_length, &error_code),
@@ -310,6 +313,16 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   // Calculate checksum.
   uint32_t crc32 = Crc32c(data->data(), data->length());
   data_chunk->set_crc32(crc32);
+
+  if (data == &sidecar_data) {
+    // Moving the string keeps its heap buffer, so the data read from the file is sent as is.
+    auto holder = std::make_shared<string>(std::move(sidecar_data));
+    int sidecar_idx = 0;
+    RPC_RETURN_NOT_OK(context.AddRpcSidecar(RefCntSlice(Slice(*holder), holder), &sidecar_idx),
+                      RemoteBootstrapErrorPB::UNKNOWN_ERROR, "Unable to add data sidecar");
+    data_chunk->set_data(string());
+    data_chunk->set_data_sidecar(sidecar_idx);
+  }
   context.RespondSuccess();
 }
 
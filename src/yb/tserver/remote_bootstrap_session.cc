@@ -122,6 +122,7 @@ Status RemoteBootstrapSession::ChangeRole() {
 
     switch(peer_pb.member_type()) {
       case RaftPeerPB::OBSERVER: FALLTHROUGH_INTENDED;
+      case RaftPeerPB::WITNESS: FALLTHROUGH_INTENDED;
       case RaftPeerPB::VOTER:
         LOG(ERROR) << "Peer " << peer_pb.permanent_uuid() << " is a "
                    << RaftPeerPB::MemberType_Name(peer_pb.member_type())
@@ -132,6 +133,7 @@ Status RemoteBootstrapSession::ChangeRole() {
         return Status::OK();
 
       case RaftPeerPB::PRE_OBSERVER: FALLTHROUGH_INTENDED;
+      case RaftPeerPB::PRE_WITNESS: FALLTHROUGH_INTENDED;
       case RaftPeerPB::PRE_VOTER: {
         consensus::ChangeConfigRequestPB req;
         consensus::ChangeConfigResponsePB resp;
@@ -30,7 +30,9 @@
 // under the License.
 //
 
+#include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/log-test-base.h"
+#include "yb/consensus/opid_util.h"
 
 #include "yb/gutil/strings/escaping.h"
 #include "yb/gutil/strings/substitute.h"
@@ -565,6 +567,39 @@ TEST_F(TabletServerTest, TestCreateTablet_TabletExists) {
   }
 }
 
+TEST_F(TabletServerTest, TestMultiRaftUpdateConsensus) {
+  const auto uuid = mini_server_->server()->fs_manager()->uuid();
+  consensus::MultiRaftConsensusRequestPB req;
+  consensus::MultiRaftConsensusResponsePB resp;
+  RpcController rpc;
+
+  auto add_request = [&req](const std::string& dest_uuid, const TabletId& tablet_id) {
+    auto* request = req.add_consensus_request();
+    request->set_dest_uuid(dest_uuid);
+    request->set_tablet_id(tablet_id);
+    request->set_caller_uuid("fake-leader");
+    // Term of the local leader is at least 1, so it rejects this request as stale.
+    request->set_caller_term(0);
+    *request->mutable_committed_index() = consensus::MinimumOpId();
+  };
+  add_request("wrong-uuid", kTabletId);
+  add_request(uuid, "unknown-tablet");
+  add_request(uuid, kTabletId);
+
+  ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &rpc));
+  SCOPED_TRACE(resp.DebugString());
+  // Each tablet gets its own response, in the order of the requests.
+  ASSERT_EQ(3, resp.consensus_response_size());
+  ASSERT_EQ(TabletServerErrorPB::WRONG_SERVER_UUID, resp.consensus_response(0).error().code());
+  ASSERT_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.consensus_response(1).error().code());
+  const auto& tablet_response = resp.consensus_response(2);
+  ASSERT_FALSE(tablet_response.has_error());
+  ASSERT_EQ(uuid, tablet_response.responder_uuid());
+  ASSERT_GE(tablet_response.responder_term(), 1);
+  ASSERT_EQ(consensus::ConsensusErrorPB::INVALID_TERM,
+            tablet_response.status().error().code());
+}
+
 TEST_F(TabletServerTest, TestDeleteTablet) {
   std::shared_ptr<TabletPeer> tablet;
 
@@ -82,6 +82,7 @@
 #include "yb/util/status_callback.h"
 #include "yb/util/trace.h"
 #include "yb/util/string_util.h"
+#include "yb/util/threadpool.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/tserver/service_util.h"
 
@@ -286,7 +287,8 @@ class WriteOperationCompletionCallback : public OperationCompletionCallback {
       rowblock->Serialize(ql_write_req.client(), &rows_data);
       int rows_data_sidecar_idx = 0;
       RETURN_UNKNOWN_ERROR_IF_NOT_OK(
-          context_->AddRpcSidecar(RefCntBuffer(rows_data), &rows_data_sidecar_idx),
+          context_->AddRpcSidecar(
+              RefCntSlice::TakeOwnership(&rows_data), &rows_data_sidecar_idx),
           response_, context_.get());
       ql_write_resp->set_rows_data_sidecar(rows_data_sidecar_idx);
     }
@@ -302,7 +304,8 @@ class WriteOperationCompletionCallback : public OperationCompletionCallback {
             pggate::PgDocData::WriteTuples(resultset, &rows_data), response_, context_.get());
         int rows_data_sidecar_idx = 0;
         RETURN_UNKNOWN_ERROR_IF_NOT_OK(
-            context_->AddRpcSidecar(RefCntBuffer(rows_data), &rows_data_sidecar_idx),
+            context_->AddRpcSidecar(
+                RefCntSlice::TakeOwnership(&rows_data), &rows_data_sidecar_idx),
             response_, context_.get());
         pgsql_write_resp->set_rows_data_sidecar(rows_data_sidecar_idx);
       }
@@ -501,8 +504,7 @@ void TabletServiceImpl::GetTransactionStatus(const GetTransactionStatusRequestPB
     return;
   }
 
-  status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(
-      req->transaction_id(), resp);
+  status = tablet_peer->tablet()->transaction_coordinator()->GetStatus(*req, resp);
   resp->set_propagated_hybrid_time(server_->Clock()->Now().ToUint64());
   if (status.ok()) {
     context.RespondSuccess();
@@ -859,6 +861,13 @@ bool TabletServiceImpl::DoGetTabletOrRespond(
     return false;
   }
 
+  // Witness does not have data, so the client should read from another replica.
+  if (PREDICT_FALSE(tablet_peer->tablet()->is_witness())) {
+    SetupErrorAndRespond(resp->mutable_error(), STATUS(IllegalState, "Witness replica"),
+                         TabletServerErrorPB::STALE_FOLLOWER, context);
+    return false;
+  }
+
   // Check for leader only in strong consistency level.
   if (req->consistency_level() == YBConsistencyLevel::STRONG) {
     if (PREDICT_FALSE(FLAGS_assert_reads_served_by_follower) &&
@@ -1370,7 +1379,7 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(ReadContext* read_context) {
       }
       int rows_data_sidecar_idx = 0;
       RETURN_NOT_OK(read_context->context->AddRpcSidecar(
-          RefCntBuffer(result.rows_data), &rows_data_sidecar_idx));
+          RefCntSlice::TakeOwnership(&result.rows_data), &rows_data_sidecar_idx));
       result.response.set_rows_data_sidecar(rows_data_sidecar_idx);
       read_context->resp->add_ql_batch()->Swap(&result.response);
     }
@@ -1394,7 +1403,7 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(ReadContext* read_context) {
       }
       int rows_data_sidecar_idx = 0;
       RETURN_NOT_OK(read_context->context->AddRpcSidecar(
-          RefCntBuffer(result.rows_data), &rows_data_sidecar_idx));
+          RefCntSlice::TakeOwnership(&result.rows_data), &rows_data_sidecar_idx));
       result.response.set_rows_data_sidecar(rows_data_sidecar_idx);
       read_context->resp->add_pgsql_batch()->Swap(&result.response);
     }
@@ -1408,10 +1417,35 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(ReadContext* read_context) {
   return Status::OK();
 }
 
+namespace {
+
+void UpdateConsensusAndRespond(Consensus* consensus,
+                               ConsensusRequestPB* req,
+                               ConsensusResponsePB* resp,
+                               rpc::RpcContext* context) {
+  Status s = consensus->Update(req, resp, context->GetClientDeadline());
+  if (PREDICT_FALSE(!s.ok())) {
+    // Clear the response first, since a partially-filled response could
+    // result in confusing a caller, or in having missing required fields
+    // in embedded optional messages.
+    resp->Clear();
+
+    SetupErrorAndRespond(resp->mutable_error(), s,
+                         TabletServerErrorPB::UNKNOWN_ERROR,
+                         context);
+    return;
+  }
+  context->RespondSuccess();
+}
+
+} // namespace
+
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
-                                           TabletPeerLookupIf* tablet_manager)
+                                           TabletPeerLookupIf* tablet_manager,
+                                           ThreadPool* update_pool)
     : ConsensusServiceIf(metric_entity),
-      tablet_manager_(tablet_manager) {
+      tablet_manager_(tablet_manager),
+      update_pool_(update_pool) {
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
@@ -1434,20 +1468,132 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   // Unfortunately, we have to use const_cast here, because the protobuf-generated interface only
   // gives us a const request, but we need to be able to move messages out of the request for
   // efficiency.
-  Status s = consensus->Update(
-      const_cast<ConsensusRequestPB*>(req), resp, context.GetClientDeadline());
-  if (PREDICT_FALSE(!s.ok())) {
-    // Clear the response first, since a partially-filled response could
-    // result in confusing a caller, or in having missing required fields
-    // in embedded optional messages.
+  auto* mutable_req = const_cast<ConsensusRequestPB*>(req);
+  if (req->pipelined()) {
+    // A request pipelined before the preceding one is handled when the preceding one is, without
+    // blocking this thread meanwhile.
+    auto context_ptr = std::make_shared<RpcContext>(std::move(context));
+    auto resume = [consensus, mutable_req, resp, context_ptr] {
+      UpdateConsensusAndRespond(consensus.get(), mutable_req, resp, context_ptr.get());
+    };
+    if (!consensus->ParkUpdate(*req, context_ptr->GetClientDeadline(), resume)) {
+      resume();
+    }
+    return;
+  }
+  UpdateConsensusAndRespond(consensus.get(), mutable_req, resp, &context);
+}
+
+namespace {
+
+// Same as UpdateConsensus, but reports errors in the response instead of responding to the RPC, so
+// that it could be used for each tablet of a MultiRaftUpdateConsensus request.
+void UpdateConsensusForTablet(TabletPeerLookupIf* tablet_manager,
+                              ConsensusRequestPB* req,
+                              ConsensusResponsePB* resp,
+                              CoarseTimePoint deadline) {
+  auto set_error = [resp](const Status& status, TabletServerErrorPB::Code code) {
     resp->Clear();
+    StatusToPB(status, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(code);
+  };
+
+  const auto& local_uuid = tablet_manager->NodeInstance().permanent_uuid();
+  if (PREDICT_FALSE(req->dest_uuid() != local_uuid)) {
+    set_error(STATUS_FORMAT(InvalidArgument,
+                            "MultiRaftUpdateConsensus: Wrong destination UUID requested. "
+                            "Local UUID: $0. Requested UUID: $1",
+                            local_uuid, req->dest_uuid()),
+              TabletServerErrorPB::WRONG_SERVER_UUID);
+    return;
+  }
 
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::UNKNOWN_ERROR,
-                         &context);
+  TabletPeerPtr tablet_peer;
+  Status s = tablet_manager->GetTabletPeer(req->tablet_id(), &tablet_peer);
+  if (PREDICT_FALSE(!s.ok())) {
+    set_error(s, s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                          : TabletServerErrorPB::TABLET_NOT_FOUND);
     return;
   }
-  context.RespondSuccess();
+  const auto state = tablet_peer->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    set_error(STATUS(IllegalState, "Tablet not RUNNING", tablet::RaftGroupStatePB_Name(state)),
+              TabletServerErrorPB::TABLET_NOT_RUNNING);
+    return;
+  }
+  auto consensus = tablet_peer->shared_consensus();
+  if (!consensus) {
+    set_error(STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running"),
+              TabletServerErrorPB::TABLET_NOT_RUNNING);
+    return;
+  }
+
+  s = consensus->Update(req, resp, deadline);
+  if (PREDICT_FALSE(!s.ok())) {
+    set_error(s, TabletServerErrorPB::UNKNOWN_ERROR);
+  }
+}
+
+// Responds to a MultiRaftUpdateConsensus request when updates of all its tablets are done.
+class MultiRaftUpdateState {
+ public:
+  MultiRaftUpdateState(rpc::RpcContext context, size_t num_tablets)
+      : context_(std::move(context)), pending_tablets_(num_tablets) {}
+
+  void TabletDone() {
+    if (--pending_tablets_ == 0) {
+      context_.RespondSuccess();
+    }
+  }
+
+ private:
+  rpc::RpcContext context_;
+  std::atomic<size_t> pending_tablets_;
+};
+
+} // namespace
+
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(
+    const consensus::MultiRaftConsensusRequestPB* req,
+    consensus::MultiRaftConsensusResponsePB* resp,
+    rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi Raft Consensus Update RPC for " << req->consensus_request_size()
+           << " tablets";
+  // See UpdateConsensus for the reason of const_cast.
+  auto* mutable_req = const_cast<consensus::MultiRaftConsensusRequestPB*>(req);
+  const auto num_tablets = mutable_req->consensus_request_size();
+  if (num_tablets == 0) {
+    context.RespondSuccess();
+    return;
+  }
+  for (int i = 0; i != num_tablets; ++i) {
+    resp->add_consensus_response();
+  }
+
+  // A slow tablet, for instance one waiting for its log, should not delay updates of other
+  // tablets, so each tablet is updated by its own task. The last one is updated by this thread.
+  const auto deadline = context.GetClientDeadline();
+  auto state = std::make_shared<MultiRaftUpdateState>(std::move(context), num_tablets);
+  auto* tablet_manager = tablet_manager_;
+  for (int i = 0; i != num_tablets; ++i) {
+    auto* consensus_req = mutable_req->mutable_consensus_request(i);
+    auto* consensus_resp = resp->mutable_consensus_response(i);
+    auto update = [tablet_manager, consensus_req, consensus_resp, deadline, state] {
+      UpdateConsensusForTablet(tablet_manager, consensus_req, consensus_resp, deadline);
+      state->TabletDone();
+    };
+    if (i + 1 == num_tablets || !update_pool_) {
+      update();
+      continue;
+    }
+    auto status = update_pool_->SubmitFunc(update);
+    if (!status.ok()) {
+      YB_LOG_EVERY_N_SECS(WARNING, 10)
+          << "Failed to submit consensus update of " << consensus_req->tablet_id() << ": "
+          << status;
+      update();
+    }
+  }
 }
 
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
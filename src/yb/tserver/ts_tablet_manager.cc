@@ -49,7 +49,9 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
+#include "yb/consensus/log_sync_group.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 #include "yb/consensus/retryable_requests.h"
@@ -105,6 +107,11 @@ DEFINE_int32(num_tablets_to_open_simultaneously, 0,
              "may make sense to manually tune this.");
 TAG_FLAG(num_tablets_to_open_simultaneously, advanced);
 
+DEFINE_bool(enable_log_sync_group, false,
+            "Coalesce WAL syncs of all tablets whose WALs share a WAL root directory, so that a "
+            "server hosting many tablets issues fewer fsyncs.");
+TAG_FLAG(enable_log_sync_group, advanced);
+
 DEFINE_int32(tablet_start_warn_threshold_ms, 500,
              "If a tablet takes more than this number of millis to start, issue "
              "a warning with a trace.");
@@ -431,6 +438,21 @@ Status TSTabletManager::Init() {
   RETURN_NOT_OK(ThreadPoolBuilder("tablet-bootstrap")
                 .set_max_threads(max_bootstrap_threads)
                 .Build(&open_tablet_pool_));
+  RETURN_NOT_OK(ThreadPoolBuilder("log-read")
+                .set_max_threads(base::NumCPUs())
+                .set_idle_timeout(MonoDelta::FromMilliseconds(10000))
+                .Build(&log_read_pool_));
+
+  if (FLAGS_enable_log_sync_group) {
+    for (const auto& wal_root_dir : fs_manager_->GetWalRootDirs()) {
+      auto sync_group = std::make_unique<log::LogSyncGroup>(wal_root_dir);
+      RETURN_NOT_OK(sync_group->Init());
+      log_sync_groups_.emplace(wal_root_dir, std::move(sync_group));
+    }
+  }
+
+  multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(
+      server_->messenger(), &server_->proxy_cache(), server_->MakeCloudInfoPB());
 
   CleanupCheckpoints();
 
@@ -1018,7 +1040,9 @@ void TSTabletManager::OpenTablet(const RaftGroupMetadataPtr& meta,
         std::bind(&TSTabletManager::PreserveLocalLeadersOnly, this, _1),
         tablet_peer.get(),
         append_pool(),
-        &retryable_requests};
+        &retryable_requests,
+        LogSyncGroupFor(meta->wal_root_dir()),
+        log_read_pool_.get()};
     s = BootstrapTablet(data, &tablet, &log, &bootstrap_info);
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to bootstrap: "
@@ -1040,7 +1064,8 @@ void TSTabletManager::OpenTablet(const RaftGroupMetadataPtr& meta,
                                          tablet->GetMetricEntity(),
                                          raft_pool(),
                                          tablet_prepare_pool(),
-                                         &retryable_requests);
+                                         &retryable_requests,
+                                         multi_raft_manager_.get());
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -1103,6 +1128,9 @@ void TSTabletManager::StartShutdown() {
 
   // Shut down the bootstrap pool, so new tablets are registered after this point.
   open_tablet_pool_->Shutdown();
+  if (log_read_pool_) {
+    log_read_pool_->Shutdown();
+  }
 
   // Take a snapshot of the peers list -- that way we don't have to hold
   // on to the lock while shutting them down, which might cause a lock
@@ -1548,6 +1576,11 @@ void TSTabletManager::GetAndRegisterDataAndWalDir(FsManager* fs_manager,
   wal_assignment_value_iter->second.insert(tablet_id);
 }
 
+log::LogSyncGroup* TSTabletManager::LogSyncGroupFor(const std::string& wal_root_dir) const {
+  auto it = log_sync_groups_.find(wal_root_dir);
+  return it != log_sync_groups_.end() ? it->second.get() : nullptr;
+}
+
 void TSTabletManager::RegisterDataAndWalDir(FsManager* fs_manager,
                                             const string& table_id,
                                             const string& tablet_id,
@@ -76,6 +76,10 @@ namespace consensus {
 class RaftConfigPB;
 } // namespace consensus
 
+namespace log {
+class LogSyncGroup;
+} // namespace log
+
 namespace master {
 class ReportedTabletPB;
 class TabletReportPB;
@@ -284,6 +288,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
                             const TableType table_type,
                             const std::string& data_root_dir,
                             const std::string& wal_root_dir);
+  // Returns the group coalescing WAL syncs under the given WAL root dir, or nullptr if disabled.
+  log::LogSyncGroup* LogSyncGroupFor(const std::string& wal_root_dir) const;
+
   // Removes the tablet id assigned to the table and disk pair for both the data and WAL directory
   // as pointed by the data and wal directory map.
   void UnregisterDataWalDir(const std::string& table_id,
@@ -459,6 +466,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool used to open the tablets async, whether bootstrap is required or not.
   std::unique_ptr<ThreadPool> open_tablet_pool_;
 
+  // Thread pool used to read and decode log segments ahead of their replay during bootstrap.
+  std::unique_ptr<ThreadPool> log_read_pool_;
+
   // Thread pool for preparing transactions, shared between all tablets.
   std::unique_ptr<ThreadPool> tablet_prepare_pool_;
 
@@ -471,6 +481,12 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for appender threads, shared between all tablets.
   std::unique_ptr<ThreadPool> append_pool_;
 
+  // WAL sync groups per WAL root dir, populated in Init() when enable_log_sync_group is set.
+  std::unordered_map<std::string, std::unique_ptr<log::LogSyncGroup>> log_sync_groups_;
+
+  // Batches heartbeats of local tablet leaders per remote tablet server.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   // Thread pool for read ops, that are run in parallel, shared between all tablets.
   std::unique_ptr<ThreadPool> read_pool_;
 
@@ -0,0 +1,128 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/cpu_affinity.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+
+#include "yb/gutil/strings/numbers.h"
+#include "yb/util/errno.h"
+#include "yb/util/format.h"
+
+namespace yb {
+
+namespace {
+
+Result<int> ParseCpu(const std::string& input, const std::string& list) {
+  int32_t result;
+  if (!safe_strto32(input, &result) || result < 0) {
+    return STATUS_FORMAT(InvalidArgument, "Invalid CPU '$0' in CPU list '$1'", input, list);
+  }
+  return result;
+}
+
+std::vector<std::vector<int>> ReadNumaNodes() {
+  std::vector<std::vector<int>> result;
+#if defined(__linux__)
+  for (int node = 0;; ++node) {
+    std::ifstream input(Format("/sys/devices/system/node/node$0/cpulist", node));
+    if (!input) {
+      break;
+    }
+    std::string line;
+    std::getline(input, line);
+    auto cpus = ParseCpuList(line);
+    if (!cpus.ok()) {
+      LOG(WARNING) << "Failed to read CPUs of NUMA node " << node << ": " << cpus.status();
+      result.clear();
+      break;
+    }
+    // Nodes without CPUs are memory only, so they are not interesting for us.
+    if (!cpus->empty()) {
+      result.push_back(std::move(*cpus));
+    }
+  }
+#endif
+  if (result.empty()) {
+    std::vector<int> all_cpus(std::max(std::thread::hardware_concurrency(), 1U));
+    std::iota(all_cpus.begin(), all_cpus.end(), 0);
+    result.push_back(std::move(all_cpus));
+  }
+  return result;
+}
+
+} // namespace
+
+Result<std::vector<int>> ParseCpuList(const std::string& input) {
+  std::vector<int> result;
+  std::vector<std::string> ranges;
+  boost::split(ranges, input, boost::is_any_of(","));
+  for (auto& range : ranges) {
+    boost::trim(range);
+    if (range.empty()) {
+      continue;
+    }
+    auto dash = range.find('-');
+    if (dash == std::string::npos) {
+      result.push_back(VERIFY_RESULT(ParseCpu(range, input)));
+      continue;
+    }
+    auto first = VERIFY_RESULT(ParseCpu(boost::trim_copy(range.substr(0, dash)), input));
+    auto last = VERIFY_RESULT(ParseCpu(boost::trim_copy(range.substr(dash + 1)), input));
+    if (first > last) {
+      return STATUS_FORMAT(InvalidArgument, "Invalid CPU range '$0' in CPU list '$1'", range,
+                           input);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+const std::vector<std::vector<int>>& NumaNodes() {
+  static const std::vector<std::vector<int>> result = ReadNumaNodes();
+  return result;
+}
+
+Status SetCurrentThreadCpuAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      return STATUS_FORMAT(InvalidArgument, "CPU $0 is out of range", cpu);
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (err != 0) {
+    return STATUS(RuntimeError, "Failed to set thread CPU affinity", ErrnoToString(err), err);
+  }
+  return Status::OK();
+#else
+  return STATUS(NotSupported, "Setting thread CPU affinity is not supported on this platform");
+#endif
+}
+
+} // namespace yb
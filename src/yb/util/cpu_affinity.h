@@ -0,0 +1,37 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_CPU_AFFINITY_H
+#define YB_UTIL_CPU_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+#include "yb/util/result.h"
+
+namespace yb {
+
+// Parses list of CPUs in the format used by Linux cpusets, for instance "0-3,8,10-11".
+// Returned CPUs are sorted and unique.
+Result<std::vector<int>> ParseCpuList(const std::string& input);
+
+// Returns CPUs of each NUMA node of this machine. When NUMA information is not available, returns
+// a single node containing all CPUs.
+const std::vector<std::vector<int>>& NumaNodes();
+
+// Restricts the current thread to run on the specified CPUs.
+CHECKED_STATUS SetCurrentThreadCpuAffinity(const std::vector<int>& cpus);
+
+} // namespace yb
+
+#endif // YB_UTIL_CPU_AFFINITY_H
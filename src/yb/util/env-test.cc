@@ -33,6 +33,7 @@
 #include <fcntl.h>
 #include <sys/types.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -43,9 +44,11 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/strings/util.h"
 #include "yb/util/alignment.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/crc.h"
 #include "yb/util/env.h"
 #include "yb/util/env_util.h"
+#include "yb/util/io_uring.h"
 #include "yb/util/malloc.h"
 #include "yb/util/memenv/memenv.h"
 #include "yb/util/random.h"
@@ -56,6 +59,8 @@
 #include "yb/util/test_util.h"
 
 DECLARE_int32(o_direct_block_size_bytes);
+DECLARE_bool(o_direct_use_io_uring);
+DECLARE_int32(o_direct_io_uring_write_bytes);
 DECLARE_bool(TEST_simulate_fs_without_fallocate);
 
 #if !defined(__APPLE__)
@@ -549,6 +554,79 @@ TEST_F(TestEnv, TestRandomData) {
   ASSERT_NO_FATALS(TestAppendRandomData(true, opts));
 }
 
+TEST_F(TestEnv, TestRandomDataIoUring) {
+  FLAGS_o_direct_use_io_uring = true;
+  // Submit writes often, so several of them are in flight at the same time.
+  FLAGS_o_direct_io_uring_write_bytes = FLAGS_o_direct_block_size_bytes;
+  WritableFileOptions opts;
+  opts.o_direct = true;
+  const bool io_uring_supported = IoUring::IsSupported();
+  LOG(INFO) << "Testing Append() " << (io_uring_supported ? "through io_uring" : "with pwritev")
+            << " with random data and requests of random sizes";
+  const auto completions_before = IoUring::TEST_NumCompletions();
+  ASSERT_NO_FATALS(TestAppendRandomData(true, opts));
+  const auto completions = IoUring::TEST_NumCompletions() - completions_before;
+  if (io_uring_supported) {
+    ASSERT_GT(completions, 0U);
+  } else {
+    // Writes silently fall back to pwritev.
+    ASSERT_EQ(0U, completions);
+  }
+}
+
+TEST_F(TestEnv, TestSyncAsyncIoUring) {
+  FLAGS_o_direct_use_io_uring = true;
+  WritableFileOptions opts;
+  opts.o_direct = true;
+  const string kTestPath = GetTestPath("test_env_sync_async");
+  shared_ptr<WritableFile> file;
+  ASSERT_OK(env_util::OpenFileForWrite(opts, env_.get(), kTestPath, &file));
+
+  constexpr int kNumSyncs = 200;
+  Random rnd(SeedRandom());
+  const size_t kBufSize = 3 * FLAGS_o_direct_block_size_bytes;
+  char buf[kBufSize];
+  crc::Crc* crc32c = crc::GetCrc32cInstance();
+  uint64_t actual_checksum = 0;
+  size_t total_size = 0;
+  CountDownLatch latch(kNumSyncs);
+  std::atomic<int> last_synced{-1};
+  std::atomic<int> num_failed{0};
+  std::atomic<int> num_out_of_order{0};
+
+  const auto completions_before = IoUring::TEST_NumCompletions();
+  for (int i = 0; i != kNumSyncs; ++i) {
+    const size_t slice_size = rnd.Uniform(kBufSize) + 1;
+    RandomString(buf, slice_size, &rnd);
+    auto slice = Slice(buf, slice_size);
+    ASSERT_OK(file->Append(slice));
+    crc32c->Compute(slice.data(), slice.size(), &actual_checksum);
+    total_size += slice_size;
+    // Next data is appended without waiting for the sync.
+    file->SyncAsync([i, &latch, &last_synced, &num_failed, &num_out_of_order](const Status& s) {
+      if (!s.ok()) {
+        LOG(WARNING) << "Sync " << i << " failed: " << s;
+        ++num_failed;
+      }
+      if (last_synced.exchange(i) != i - 1) {
+        ++num_out_of_order;
+      }
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  ASSERT_EQ(0, num_failed.load());
+  ASSERT_EQ(0, num_out_of_order.load());
+  if (IoUring::IsSupported()) {
+    // At least one fdatasync completion per sync.
+    ASSERT_GE(IoUring::TEST_NumCompletions() - completions_before,
+              static_cast<uint64_t>(kNumSyncs));
+  }
+
+  ASSERT_OK(file->Close());
+  ASSERT_NO_FATALS(VerifyChecksumsMatch(kTestPath, total_size, actual_checksum, crc32c));
+}
+
 TEST_F(TestEnv, TestGetExecutablePath) {
   string p;
   ASSERT_OK(Env::Default()->GetExecutablePath(&p));
@@ -29,6 +29,7 @@
 
 #include <stdint.h>
 #include <cstdarg>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,7 @@
 #include "yb/util/file_system.h"
 #include "yb/util/result.h"
 #include "yb/util/status.h"
+#include "yb/util/status_callback.h"
 #include "yb/util/strongly_typed_bool.h"
 
 namespace yb {
@@ -512,6 +514,13 @@ class WritableFile {
 
   virtual CHECKED_STATUS Sync() = 0;
 
+  // Starts syncing the data appended so far and invokes callback with the result once it is
+  // durable. The callback could be invoked from another thread after SyncAsync returns, so more
+  // data could be appended while the sync is in progress. By default syncs synchronously.
+  virtual void SyncAsync(StdStatusCallback callback) {
+    callback(Sync());
+  }
+
   virtual uint64_t Size() const = 0;
 
   // Returns the filename provided when the WritableFile was constructed.
@@ -544,6 +553,9 @@ class WritableFileWrapper : public WritableFile {
   CHECKED_STATUS Close() override { return target_->Close(); }
   CHECKED_STATUS Flush(FlushMode mode) override { return target_->Flush(mode); }
   CHECKED_STATUS Sync() override { return target_->Sync(); }
+  void SyncAsync(StdStatusCallback callback) override {
+    target_->SyncAsync(std::move(callback));
+  }
   uint64_t Size() const override { return target_->Size(); }
   const std::string& filename() const override { return target_->filename(); }
 
@@ -34,6 +34,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -53,11 +57,13 @@
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/util/alignment.h"
+#include "yb/util/async_util.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/env.h"
 #include "yb/util/errno.h"
 #include "yb/util/file_system_posix.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/io_uring.h"
 #include "yb/util/locks.h"
 #include "yb/util/logging.h"
 #include "yb/util/malloc.h"
@@ -65,6 +71,7 @@
 #include "yb/util/path_util.h"
 #include "yb/util/slice.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/thread.h"
 #include "yb/util/thread_restrictions.h"
 
 // Copied from falloc.h. Useful for older kernels that lack support for
@@ -119,6 +126,18 @@ DEFINE_int32(o_direct_block_alignment_bytes, 4096,
              "Alignment (in bytes) for blocks used for O_DIRECT operations.");
 TAG_FLAG(o_direct_block_alignment_bytes, advanced);
 
+DEFINE_bool(o_direct_use_io_uring, false,
+            "Write files opened with O_DIRECT through io_uring. Full blocks are submitted as they "
+            "are buffered, and syncs are submitted as fdatasync with a completion callback, so "
+            "several of them could be in flight. Completions are handled by a thread per file. "
+            "Linux only, falls back to pwritev if io_uring is not available.");
+TAG_FLAG(o_direct_use_io_uring, advanced);
+
+DEFINE_int32(o_direct_io_uring_write_bytes, 64 * 1024,
+             "Full blocks of an O_DIRECT file are submitted through io_uring once at least this "
+             "many bytes of them are buffered.");
+TAG_FLAG(o_direct_io_uring_write_bytes, advanced);
+
 DEFINE_test_flag(bool, TEST_simulate_fs_without_fallocate, false,
     "If true, the system simulates a file system that doesn't support fallocate");
 
@@ -465,7 +484,9 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
  public:
   PosixDirectIOWritableFile(const std::string &fname, int fd, uint64_t file_size,
                             bool sync_on_close)
-      : PosixWritableFile(fname, fd, file_size, false /* sync_on_close */) {
+      : PosixWritableFile(fname, fd, file_size, false /* sync_on_close */),
+        o_sync_((fcntl(fd, F_GETFL) & O_SYNC) == O_SYNC),
+        use_io_uring_(FLAGS_o_direct_use_io_uring) {
 
     if (file_size != 0) {
       // For now, we don't support appending to an already existing file (of non-zero size).
@@ -487,6 +508,7 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
     if (fd_ >= 0) {
       WARN_NOT_OK(Close(), "Failed to close " + filename_);
     }
+    StopIoUring();
   }
 
   Status Append(const Slice &const_data_slice) override {
@@ -502,6 +524,7 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
 
       RETURN_NOT_OK(MaybeAllocateMemory(data.size()));
       RETURN_NOT_OK(WriteToBuffer(data));
+      RETURN_NOT_OK(MaybeSubmitFullBlocks());
 
       if (data_slice.size() >= max_data) {
         data_slice.remove_prefix(max_data);
@@ -525,7 +548,9 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
   Status Close() override {
     TRACE_EVENT1("io", "PosixDirectIOWritableFile::Close", "path", filename_);
     ThreadRestrictions::AssertIOAllowed();
-    RETURN_NOT_OK(Sync());
+    auto status = Sync();
+    StopIoUring();
+    RETURN_NOT_OK(status);
     LOG(INFO) << "Closing file " << filename_ << " with " << block_ptr_vec_.size() << " blocks";
     off_t fsize;
     fsize = lseek(fd_, 0, SEEK_END);
@@ -555,7 +580,33 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
 
   Status Sync() override {
     ThreadRestrictions::AssertIOAllowed();
-    return DoWrite();
+    if (!StartIoUring()) {
+      return SyncWithPwritev();
+    }
+    Synchronizer synchronizer;
+    SyncAsync(synchronizer.AsStdStatusCallback());
+    return synchronizer.Wait();
+  }
+
+  void SyncAsync(StdStatusCallback callback) override {
+    ThreadRestrictions::AssertIOAllowed();
+    if (!StartIoUring()) {
+      callback(SyncWithPwritev());
+      return;
+    }
+    auto submitted = SubmitBufferedBlocks(true /* include_partial_block */);
+    if (!submitted.ok()) {
+      callback(submitted.status());
+      return;
+    }
+    if (*submitted) {
+      auto status = SubmitFdatasync(&callback);
+      if (status.ok()) {
+        return;
+      }
+      LOG(WARNING) << filename_ << ": Failed to submit fdatasync through io_uring: " << status;
+    }
+    callback(SyncWithPwritev());
   }
 
   uint64_t Size() const override {
@@ -661,6 +712,269 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
     return Status::OK();
   }
 
+  // Returns whether data should be written through io_uring. Creates the ring and the thread
+  // handling its completions on first use.
+  bool StartIoUring() {
+    if (io_uring_) {
+      return true;
+    }
+    if (!use_io_uring_) {
+      return false;
+    }
+    auto io_uring = IoUring::Create(kIoUringQueueDepth);
+    if (!io_uring.ok()) {
+      LOG(WARNING) << filename_ << ": Failed to create io_uring, using pwritev: "
+                   << io_uring.status();
+      use_io_uring_ = false;
+      return false;
+    }
+    io_uring_ = std::move(*io_uring);
+    auto status = Thread::Create(
+        "io_uring", "completions", &PosixDirectIOWritableFile::HandleCompletions, this,
+        &completion_thread_);
+    if (!status.ok()) {
+      LOG(WARNING) << filename_ << ": Failed to start io_uring completion thread, using pwritev: "
+                   << status;
+      io_uring_.reset();
+      use_io_uring_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  // Waits for operations submitted through io_uring and stops the completion thread.
+  void StopIoUring() {
+    if (!completion_thread_) {
+      return;
+    }
+    WaitForInFlightOps(0);
+    // Nothing is in flight, so there is room for the no-op.
+    CHECK_OK(io_uring_->SubmitNop(kStopCompletionsUserData));
+    CHECK_OK(ThreadJoiner(completion_thread_.get()).Join());
+    completion_thread_.reset();
+    io_uring_.reset();
+    use_io_uring_ = false;
+  }
+
+  void HandleCompletions() {
+    for (;;) {
+      auto completion = io_uring_->WaitCompletion();
+      if (!completion.ok()) {
+        LOG(FATAL) << filename_ << ": Failed to wait for io_uring completion: "
+                   << completion.status();
+      }
+      if (completion->user_data == kStopCompletionsUserData) {
+        return;
+      }
+      HandleCompletion(*completion);
+    }
+  }
+
+  void HandleCompletion(const IoUring::Completion& completion) {
+    Status status;
+    StdStatusCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      auto it = in_flight_ops_.find(completion.user_data);
+      CHECK(it != in_flight_ops_.end())
+          << filename_ << ": Unexpected io_uring completion: " << completion.user_data;
+      auto& op = it->second;
+      if (PREDICT_FALSE(completion.result < 0)) {
+        status = STATUS_IO_ERROR(filename_, -completion.result);
+      } else if (PREDICT_FALSE(!op.callback &&
+                               static_cast<size_t>(completion.result) != op.bytes)) {
+        status = STATUS(IOError,
+                        Substitute("io_uring writev error: expected to write $0 bytes, wrote $1 "
+                                   "bytes instead", op.bytes, completion.result));
+      }
+      if (op.callback) {
+        // Data is durable only if all writes preceding the sync succeeded.
+        if (status.ok()) {
+          status = write_error_;
+        }
+        callback = std::move(op.callback);
+      } else {
+        if (!status.ok() && write_error_.ok()) {
+          write_error_ = status;
+        }
+        for (auto& block : op.blocks) {
+          free_blocks_.push_back(std::move(block));
+        }
+      }
+      in_flight_ops_.erase(it);
+    }
+    io_cond_.notify_all();
+    if (callback) {
+      callback(status);
+    }
+  }
+
+  void WaitForInFlightOps(size_t max_in_flight) {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    io_cond_.wait(lock, [this, max_in_flight] {
+      return in_flight_ops_.size() <= max_in_flight;
+    });
+  }
+
+  bool CanSubmitWithoutWaiting() {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    return in_flight_ops_.size() < io_uring_->queue_depth();
+  }
+
+  // Submits buffered full blocks through io_uring, so they are written while the following data
+  // is appended. The last block stays buffered when it is not full, since it will be rewritten.
+  Status MaybeSubmitFullBlocks() {
+    if (!has_new_data_ || !StartIoUring()) {
+      return Status::OK();
+    }
+    const size_t full_blocks =
+        last_block_used_bytes_ == block_size_ ? last_block_idx_ + 1 : last_block_idx_;
+    if (full_blocks == 0 ||
+        full_blocks * block_size_ < static_cast<size_t>(FLAGS_o_direct_io_uring_write_bytes)) {
+      return Status::OK();
+    }
+    if (!CanSubmitWithoutWaiting()) {
+      // Do not block appends, the blocks will be written by the next sync.
+      return Status::OK();
+    }
+    if (VERIFY_RESULT(SubmitBufferedBlocks(false /* include_partial_block */))) {
+      return Status::OK();
+    }
+    return WriteWithPwritev();
+  }
+
+  // Submits a write of buffered blocks through io_uring. The partial last block is copied, so
+  // appends could continue to it while the write is in flight. Returns false when the write could
+  // not be submitted, e.g. because of EAGAIN, and should be done with pwritev instead.
+  Result<bool> SubmitBufferedBlocks(bool include_partial_block) {
+    if (!has_new_data_) {
+      return true;
+    }
+    const bool last_block_full = last_block_used_bytes_ == block_size_;
+    const size_t full_blocks = last_block_full ? last_block_idx_ + 1 : last_block_idx_;
+    const bool write_partial_block = include_partial_block && !last_block_full;
+    vector<std::shared_ptr<uint8_t>> blocks(
+        block_ptr_vec_.begin(), block_ptr_vec_.begin() + full_blocks);
+    if (write_partial_block) {
+      blocks.push_back(VERIFY_RESULT(AllocateBlock()));
+      memcpy(blocks.back().get(), block_ptr_vec_[last_block_idx_].get(), block_size_);
+    }
+    if (blocks.empty()) {
+      return true;
+    }
+
+    const uint64_t offset = next_write_offset_;
+    const size_t bytes_to_write = blocks.size() * block_size_;
+    auto status = SubmitWrite(std::move(blocks), offset);
+    if (!status.ok()) {
+      LOG(WARNING) << filename_ << ": Failed to submit write through io_uring, using pwritev: "
+                   << status;
+      return false;
+    }
+
+    block_ptr_vec_.erase(block_ptr_vec_.begin(), block_ptr_vec_.begin() + full_blocks);
+    next_write_offset_ += full_blocks * block_size_;
+    filesize_ = std::max<uint64_t>(filesize_, offset + bytes_to_write);
+    if (last_block_full) {
+      last_block_idx_ = 0;
+      last_block_used_bytes_ = 0;
+      has_new_data_ = false;
+    } else {
+      // The partial block becomes the first one, and is rewritten by the next write.
+      last_block_idx_ -= full_blocks;
+      has_new_data_ = !write_partial_block;
+    }
+    return true;
+  }
+
+  Status SubmitWrite(vector<std::shared_ptr<uint8_t>> blocks, uint64_t offset) {
+    WaitForInFlightOps(io_uring_->queue_depth() - 1);
+    const uint64_t op_id = next_op_id_++;
+    InFlightOp* op;
+    {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      op = &in_flight_ops_[op_id];
+    }
+    op->blocks = std::move(blocks);
+    op->iov.resize(op->blocks.size());
+    for (size_t j = 0; j != op->blocks.size(); ++j) {
+      op->iov[j].iov_base = op->blocks[j].get();
+      op->iov[j].iov_len = block_size_;
+    }
+    op->bytes = op->blocks.size() * block_size_;
+    const uint64_t end = offset + op->bytes;
+    // A write that rewrites the last block of a previous one should not be reordered with it.
+    const bool drain = offset < submitted_end_;
+    // op could be completed and erased by the completion thread once submitted.
+    auto status = io_uring_->SubmitWritev(
+        fd_, op->iov.data(), op->iov.size(), offset, op_id, drain);
+    if (!status.ok()) {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      in_flight_ops_.erase(op_id);
+      return status;
+    }
+    submitted_end_ = end;
+    return Status::OK();
+  }
+
+  // Submits fdatasync that runs after all submitted writes. On success takes callback, that is
+  // invoked once fdatasync completes.
+  Status SubmitFdatasync(StdStatusCallback* callback) {
+    WaitForInFlightOps(io_uring_->queue_depth() - 1);
+    const uint64_t op_id = next_op_id_++;
+    {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      in_flight_ops_[op_id].callback = std::move(*callback);
+    }
+    auto status = io_uring_->SubmitFdatasync(fd_, op_id);
+    if (!status.ok()) {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      auto it = in_flight_ops_.find(op_id);
+      *callback = std::move(it->second.callback);
+      in_flight_ops_.erase(it);
+    }
+    return status;
+  }
+
+  // Writes buffered data with pwritev. Waits for writes submitted through io_uring first, so they
+  // are not reordered with writes of the same blocks.
+  Status WriteWithPwritev() {
+    WaitForInFlightOps(0);
+    {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      RETURN_NOT_OK(write_error_);
+    }
+    return DoWrite();
+  }
+
+  Status SyncWithPwritev() {
+    RETURN_NOT_OK(WriteWithPwritev());
+    // Writes are durable once completed when the file is opened with O_SYNC.
+    if (!o_sync_ && fdatasync(fd_) != 0) {
+      return STATUS_IO_ERROR(filename_, errno);
+    }
+    return Status::OK();
+  }
+
+  Result<std::shared_ptr<uint8_t>> AllocateBlock() {
+    {
+      std::lock_guard<std::mutex> lock(io_mutex_);
+      if (!free_blocks_.empty()) {
+        auto result = std::move(free_blocks_.back());
+        free_blocks_.pop_back();
+        return result;
+      }
+    }
+    void *temp_buf = nullptr;
+    auto err = posix_memalign(&temp_buf, FLAGS_o_direct_block_alignment_bytes, block_size_);
+    if (err) {
+      return STATUS(RuntimeError, "Unable to allocate memory", ErrnoToString(err), err);
+    }
+
+    uint8_t *start = static_cast<uint8_t *>(temp_buf);
+    return std::shared_ptr<uint8_t>(start, [](uint8_t *p) { free(p); });
+  }
+
   Status MaybeAllocateMemory(size_t data_size) {
     auto buffered_data_size = last_block_idx_ * block_size_ + last_block_used_bytes_;
     auto bytes_to_write = align_up(buffered_data_size + data_size, block_size_);
@@ -669,14 +983,7 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
     if (blocks_to_write > block_ptr_vec_.size()) {
       auto nblocks = blocks_to_write - block_ptr_vec_.size();
       for (auto i = 0; i < nblocks; i++) {
-        void *temp_buf = nullptr;
-        auto err = posix_memalign(&temp_buf, FLAGS_o_direct_block_alignment_bytes, block_size_);
-        if (err) {
-          return STATUS(RuntimeError, "Unable to allocate memory", ErrnoToString(err), err);
-        }
-
-        uint8_t *start = static_cast<uint8_t *>(temp_buf);
-        block_ptr_vec_.push_back(std::shared_ptr<uint8_t>(start, [](uint8_t *p) { free(p); }));
+        block_ptr_vec_.push_back(VERIFY_RESULT(AllocateBlock()));
       }
 
       CHECK_EQ(block_ptr_vec_.size() * block_size_, bytes_to_write);
@@ -691,6 +998,36 @@ class PosixDirectIOWritableFile final : public PosixWritableFile {
   int block_size_;
   bool has_new_data_;
   size_t real_size_;
+
+  struct InFlightOp {
+    // Blocks of a write, reused for appends once it completes.
+    vector<std::shared_ptr<uint8_t>> blocks;
+    vector<iovec> iov;
+    size_t bytes = 0;
+    // Set for fdatasync, invoked once it completes.
+    StdStatusCallback callback;
+  };
+
+  static constexpr uint32_t kIoUringQueueDepth = 32;
+  static constexpr uint64_t kStopCompletionsUserData = std::numeric_limits<uint64_t>::max();
+
+  const bool o_sync_;
+  bool use_io_uring_;
+  std::unique_ptr<IoUring> io_uring_;
+  scoped_refptr<Thread> completion_thread_;
+  uint64_t next_op_id_ = 0;
+  // End offset of the last write submitted through io_uring.
+  uint64_t submitted_end_ = 0;
+
+  // Protects state shared with the completion thread.
+  std::mutex io_mutex_;
+  std::condition_variable io_cond_;
+  // Operations submitted through io_uring, by user data of their submission.
+  std::map<uint64_t, InFlightOp> in_flight_ops_;
+  // Blocks of completed io_uring writes, reused instead of allocating new ones.
+  vector<std::shared_ptr<uint8_t>> free_blocks_;
+  // First error of a write submitted through io_uring. Fails all following syncs.
+  Status write_error_;
 };
 #endif
 
@@ -1406,7 +1743,7 @@ class PosixFileFactory : public FileFactory {
     int fd = -1;
     int extra_flags = 0;
     if (UseODirect(opts.o_direct)) {
-      extra_flags = kODirectFlags;
+      extra_flags = ODirectFlags();
     }
     RETURN_NOT_OK(DoOpen(fname, opts.mode, &fd, extra_flags));
     return InstantiateNewWritableFile(fname, fd, opts, result);
@@ -1422,7 +1759,7 @@ class PosixFileFactory : public FileFactory {
     ::snprintf(fname.get(), name_template.size() + 1, "%s", name_template.c_str());
     int fd = -1;
     if (UseODirect(opts.o_direct)) {
-      fd = ::mkostemp(fname.get(), kODirectFlags);
+      fd = ::mkostemp(fname.get(), ODirectFlags());
     } else {
       fd = ::mkstemp(fname.get());
     }
@@ -1453,6 +1790,14 @@ class PosixFileFactory : public FileFactory {
   }
 
  private:
+  static int ODirectFlags() {
+    // Files written through io_uring are made durable by fdatasync, so they don't need O_SYNC.
+    if (FLAGS_o_direct_use_io_uring && IoUring::IsSupported()) {
+      return kODirectFlags & ~O_SYNC;
+    }
+    return kODirectFlags;
+  }
+
   bool UseODirect(bool o_direct) {
 #if defined(__linux__)
     return o_direct;
@@ -0,0 +1,317 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/util/io_uring.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#include <glog/logging.h>
+
+#include "yb/util/errno.h"
+
+#if defined(__linux__) && defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+#define YB_HAS_IO_URING 1
+#else
+#define YB_HAS_IO_URING 0
+#endif
+
+namespace yb {
+
+namespace {
+
+std::atomic<uint64_t> num_completions{0};
+
+} // namespace
+
+uint64_t IoUring::TEST_NumCompletions() {
+  return num_completions.load(std::memory_order_acquire);
+}
+
+#if YB_HAS_IO_URING
+
+namespace {
+
+int SysIoUringSetup(uint32_t entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysIoUringEnter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+Status IoUringError(const char* what, int err) {
+  return STATUS(IOError, what, ErrnoToString(err), err);
+}
+
+class MappedRegion {
+ public:
+  MappedRegion() = default;
+
+  ~MappedRegion() {
+    if (address_ != nullptr) {
+      munmap(address_, size_);
+    }
+  }
+
+  Status Map(int fd, size_t size, off_t offset) {
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         offset);
+    if (address == MAP_FAILED) {
+      return IoUringError("Failed to map io_uring ring", errno);
+    }
+    address_ = static_cast<char*>(address);
+    size_ = size;
+    return Status::OK();
+  }
+
+  template <class T>
+  T* At(size_t offset) const {
+    return reinterpret_cast<T*>(address_ + offset);
+  }
+
+ private:
+  char* address_ = nullptr;
+  size_t size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedRegion);
+};
+
+} // namespace
+
+struct IoUring::Rings {
+  MappedRegion sq_region;
+  MappedRegion cq_region;
+  MappedRegion sqes_region;
+
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  uint32_t* sq_array;
+  io_uring_sqe* sqes;
+
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  io_uring_cqe* cqes;
+};
+
+bool IoUring::IsSupported() {
+  // Kernel could be older than the headers we were built with, or io_uring could be disabled,
+  // e.g. by seccomp.
+  static const bool supported = [] {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = SysIoUringSetup(1, &params);
+    if (fd < 0) {
+      LOG(INFO) << "io_uring is not available: " << ErrnoToString(errno);
+      return false;
+    }
+    close(fd);
+    return true;
+  }();
+  return supported;
+}
+
+Result<std::unique_ptr<IoUring>> IoUring::Create(uint32_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = SysIoUringSetup(queue_depth, &params);
+  if (fd < 0) {
+    int err = errno;
+    if (err == ENOSYS) {
+      return STATUS(NotSupported, "io_uring is not supported by the kernel");
+    }
+    return IoUringError("io_uring_setup failed", err);
+  }
+
+  auto rings = std::make_unique<Rings>();
+  auto status = [&]() -> Status {
+    RETURN_NOT_OK(rings->sq_region.Map(
+        fd, params.sq_off.array + params.sq_entries * sizeof(uint32_t), IORING_OFF_SQ_RING));
+    RETURN_NOT_OK(rings->cq_region.Map(
+        fd, params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe), IORING_OFF_CQ_RING));
+    RETURN_NOT_OK(rings->sqes_region.Map(
+        fd, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+    return Status::OK();
+  }();
+  if (!status.ok()) {
+    rings.reset();
+    close(fd);
+    return status;
+  }
+
+  const auto& sq = rings->sq_region;
+  rings->sq_head = sq.At<uint32_t>(params.sq_off.head);
+  rings->sq_tail = sq.At<uint32_t>(params.sq_off.tail);
+  rings->sq_mask = *sq.At<uint32_t>(params.sq_off.ring_mask);
+  rings->sq_entries = *sq.At<uint32_t>(params.sq_off.ring_entries);
+  rings->sq_array = sq.At<uint32_t>(params.sq_off.array);
+  rings->sqes = rings->sqes_region.At<io_uring_sqe>(0);
+
+  const auto& cq = rings->cq_region;
+  rings->cq_head = cq.At<uint32_t>(params.cq_off.head);
+  rings->cq_tail = cq.At<uint32_t>(params.cq_off.tail);
+  rings->cq_mask = *cq.At<uint32_t>(params.cq_off.ring_mask);
+  rings->cqes = cq.At<io_uring_cqe>(params.cq_off.cqes);
+
+  return std::unique_ptr<IoUring>(new IoUring(fd, params.sq_entries, std::move(rings)));
+}
+
+IoUring::IoUring(int ring_fd, uint32_t queue_depth, std::unique_ptr<Rings> rings)
+    : ring_fd_(ring_fd), queue_depth_(queue_depth), rings_(std::move(rings)) {
+}
+
+IoUring::~IoUring() {
+  rings_.reset();
+  close(ring_fd_);
+}
+
+template <class Fill>
+Status IoUring::Submit(const Fill& fill) {
+  auto& rings = *rings_;
+  // This thread is the only producer, so only the head could be changed concurrently.
+  const uint32_t tail = *rings.sq_tail;
+  const uint32_t head = __atomic_load_n(rings.sq_head, __ATOMIC_ACQUIRE);
+  if (tail - head >= rings.sq_entries) {
+    return STATUS(Busy, "io_uring submission queue is full");
+  }
+
+  const uint32_t index = tail & rings.sq_mask;
+  io_uring_sqe* sqe = &rings.sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  fill(sqe);
+  rings.sq_array[index] = index;
+  __atomic_store_n(rings.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  for (;;) {
+    int submitted = SysIoUringEnter(ring_fd_, 1, 0, 0);
+    if (submitted > 0) {
+      return Status::OK();
+    }
+    const int err = submitted < 0 ? errno : EAGAIN;
+    if (err == EINTR) {
+      continue;
+    }
+    // Without SQPOLL the kernel consumes entries only inside io_uring_enter, so if the head did not
+    // move, the entry was not submitted. Take it back, otherwise the next io_uring_enter would
+    // submit it after the caller released its buffers.
+    if (__atomic_load_n(rings.sq_head, __ATOMIC_ACQUIRE) == tail) {
+      __atomic_store_n(rings.sq_tail, tail, __ATOMIC_RELEASE);
+      return IoUringError("io_uring_enter failed to submit", err);
+    }
+    // The entry was consumed, so its completion will be returned by WaitCompletion.
+    return Status::OK();
+  }
+}
+
+Status IoUring::SubmitWritev(
+    int fd, const iovec* iov, uint32_t iovcnt, uint64_t offset, uint64_t user_data, bool drain) {
+  return Submit([=](io_uring_sqe* sqe) {
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->flags = drain ? IOSQE_IO_DRAIN : 0;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = iovcnt;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+  });
+}
+
+Status IoUring::SubmitFdatasync(int fd, uint64_t user_data) {
+  return Submit([=](io_uring_sqe* sqe) {
+    sqe->opcode = IORING_OP_FSYNC;
+    // Writes are not ordered with fsync otherwise, so it could miss the data being written.
+    sqe->flags = IOSQE_IO_DRAIN;
+    sqe->fd = fd;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe->user_data = user_data;
+  });
+}
+
+Status IoUring::SubmitNop(uint64_t user_data) {
+  return Submit([=](io_uring_sqe* sqe) {
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = user_data;
+  });
+}
+
+Result<IoUring::Completion> IoUring::WaitCompletion() {
+  auto& rings = *rings_;
+  for (;;) {
+    const uint32_t head = *rings.cq_head;
+    const uint32_t tail = __atomic_load_n(rings.cq_tail, __ATOMIC_ACQUIRE);
+    if (head != tail) {
+      const io_uring_cqe& cqe = rings.cqes[head & rings.cq_mask];
+      Completion result = { cqe.user_data, cqe.res };
+      __atomic_store_n(rings.cq_head, head + 1, __ATOMIC_RELEASE);
+      num_completions.fetch_add(1, std::memory_order_acq_rel);
+      return result;
+    }
+    if (SysIoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      return IoUringError("io_uring_enter failed to wait", errno);
+    }
+  }
+}
+
+#else // YB_HAS_IO_URING
+
+struct IoUring::Rings {};
+
+bool IoUring::IsSupported() {
+  return false;
+}
+
+Result<std::unique_ptr<IoUring>> IoUring::Create(uint32_t queue_depth) {
+  return STATUS(NotSupported, "io_uring is not supported on this platform");
+}
+
+IoUring::IoUring(int ring_fd, uint32_t queue_depth, std::unique_ptr<Rings> rings)
+    : ring_fd_(ring_fd), queue_depth_(queue_depth), rings_(std::move(rings)) {
+}
+
+IoUring::~IoUring() {
+}
+
+Status IoUring::SubmitWritev(
+    int fd, const iovec* iov, uint32_t iovcnt, uint64_t offset, uint64_t user_data, bool drain) {
+  return STATUS(NotSupported, "io_uring is not supported on this platform");
+}
+
+Status IoUring::SubmitFdatasync(int fd, uint64_t user_data) {
+  return STATUS(NotSupported, "io_uring is not supported on this platform");
+}
+
+Status IoUring::SubmitNop(uint64_t user_data) {
+  return STATUS(NotSupported, "io_uring is not supported on this platform");
+}
+
+Result<IoUring::Completion> IoUring::WaitCompletion() {
+  return STATUS(NotSupported, "io_uring is not supported on this platform");
+}
+
+#endif // YB_HAS_IO_URING
+
+} // namespace yb
@@ -0,0 +1,90 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_IO_URING_H
+#define YB_UTIL_IO_URING_H
+
+#include <sys/uio.h>
+
+#include <memory>
+
+#include "yb/gutil/macros.h"
+#include "yb/util/result.h"
+
+namespace yb {
+
+// Minimal wrapper over a Linux io_uring instance, used to submit file writes and syncs without
+// waiting for them. Talks to the kernel directly, so it does not depend on liburing.
+//
+// Not thread safe: operations should be submitted by a single thread, and completions could be
+// waited for by another single thread.
+class IoUring {
+ public:
+  struct Completion {
+    uint64_t user_data;
+    // Result of the operation: number of bytes written, or negative errno.
+    int32_t result;
+  };
+
+  // Returns NotSupported if io_uring is not available on this platform or kernel.
+  static Result<std::unique_ptr<IoUring>> Create(uint32_t queue_depth);
+
+  ~IoUring();
+
+  // Submits a vectored write. iov and the buffers it points to should stay valid until the
+  // completion with user_data is returned by WaitCompletion. When an error is returned, the write
+  // was not submitted and the kernel does not reference iov.
+  // With drain, the write is started only after all previously submitted operations complete.
+  CHECKED_STATUS SubmitWritev(
+      int fd, const iovec* iov, uint32_t iovcnt, uint64_t offset, uint64_t user_data,
+      bool drain = false);
+
+  // Submits fdatasync of fd, that is started after all previously submitted operations complete.
+  CHECKED_STATUS SubmitFdatasync(int fd, uint64_t user_data);
+
+  // Submits an operation that does nothing, e.g. to wake up the thread waiting for completions.
+  CHECKED_STATUS SubmitNop(uint64_t user_data);
+
+  // Waits until at least one submitted operation completes and returns it.
+  Result<Completion> WaitCompletion();
+
+  uint32_t queue_depth() const {
+    return queue_depth_;
+  }
+
+  // Whether io_uring could be used on this platform and kernel. The first call probes the kernel
+  // by setting up a ring.
+  static bool IsSupported();
+
+  // Number of completions returned by all rings of this process.
+  static uint64_t TEST_NumCompletions();
+
+ private:
+  struct Rings;
+
+  IoUring(int ring_fd, uint32_t queue_depth, std::unique_ptr<Rings> rings);
+
+  // Fills the next submission queue entry using fill and submits it.
+  template <class Fill>
+  CHECKED_STATUS Submit(const Fill& fill);
+
+  const int ring_fd_;
+  const uint32_t queue_depth_;
+  std::unique_ptr<Rings> rings_;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_IO_URING_H
@@ -728,6 +728,13 @@ Histogram::Histogram(const HistogramPrototype* proto)
     histogram_(new HdrHistogram(proto->max_trackable_value(), proto->num_sig_digits())) {
 }
 
+Histogram::Histogram(std::unique_ptr<HistogramPrototype> proto)
+  : Metric(std::move(proto)),
+    histogram_(new HdrHistogram(
+        down_cast<const HistogramPrototype*>(prototype())->max_trackable_value(),
+        down_cast<const HistogramPrototype*>(prototype())->num_sig_digits())) {
+}
+
 void Histogram::Increment(int64_t value) {
   histogram_->Increment(value);
 }
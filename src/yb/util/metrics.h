@@ -485,6 +485,7 @@ class MetricEntity : public RefCountedThreadSafe<MetricEntity> {
 
   scoped_refptr<Counter> FindOrCreateCounter(const CounterPrototype* proto);
   scoped_refptr<Histogram> FindOrCreateHistogram(const HistogramPrototype* proto);
+  scoped_refptr<Histogram> FindOrCreateHistogram(std::unique_ptr<HistogramPrototype> proto);
 
   template<typename T>
   scoped_refptr<AtomicGauge<T>> FindOrCreateGauge(const GaugePrototype<T>* proto,
@@ -1236,6 +1237,7 @@ class Histogram : public Metric {
   FRIEND_TEST(MetricsTest, SimpleHistogramTest);
   friend class MetricEntity;
   explicit Histogram(const HistogramPrototype* proto);
+  explicit Histogram(std::unique_ptr<HistogramPrototype> proto);
 
   const gscoped_ptr<HdrHistogram> histogram_;
   DISALLOW_COPY_AND_ASSIGN(Histogram);
@@ -1302,6 +1304,18 @@ inline scoped_refptr<Histogram> MetricEntity::FindOrCreateHistogram(
   return m;
 }
 
+inline scoped_refptr<Histogram> MetricEntity::FindOrCreateHistogram(
+    std::unique_ptr<HistogramPrototype> proto) {
+  CheckInstantiation(proto.get());
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto m = down_cast<Histogram*>(FindPtrOrNull(metric_map_, proto.get()).get());
+  if (!m) {
+    m = new Histogram(std::move(proto));
+    InsertOrDie(&metric_map_, m->prototype(), m);
+  }
+  return m;
+}
+
 template<typename T>
 inline scoped_refptr<AtomicGauge<T> > MetricEntity::FindOrCreateGauge(
     const GaugePrototype<T>* proto,
@@ -1377,6 +1391,22 @@ class OwningGaugePrototype : public OwningMetricCtorArgs, public GaugePrototype<
             flags)) {}
 };
 
+class OwningHistogramPrototype : public OwningMetricCtorArgs, public HistogramPrototype {
+ public:
+  OwningHistogramPrototype(
+      std::string entity_type, std::string name, std::string label, MetricUnit::Type unit,
+      std::string description, uint64_t max_trackable_value, int num_sig_digits)
+      : OwningMetricCtorArgs(
+            std::move(entity_type), std::move(name), std::move(label), unit,
+            std::move(description)),
+        HistogramPrototype(
+            MetricPrototype::CtorArgs(
+                OwningMetricCtorArgs::entity_type.c_str(), OwningMetricCtorArgs::name.c_str(),
+                OwningMetricCtorArgs::label.c_str(), unit,
+                OwningMetricCtorArgs::description.c_str(), flags),
+            max_trackable_value, num_sig_digits) {}
+};
+
 } // namespace yb
 
 #endif // YB_UTIL_METRICS_H
@@ -692,4 +692,19 @@ Status Socket::SetReceiveBufferSize(int32_t size) {
   return Status::OK();
 }
 
+Status Socket::SetBusyPoll(int32_t usec) {
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+  DCHECK_GE(fd_, 0);
+  if (setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec))) {
+    int err = errno;
+    return STATUS(
+        NetworkError, Format("Failed to set socket busy poll: $0", ErrnoToString(err)),
+        Slice(), err);
+  }
+  return Status::OK();
+#else
+  return STATUS(NotSupported, "SO_BUSY_POLL is not supported on this platform");
+#endif
+}
+
 } // namespace yb
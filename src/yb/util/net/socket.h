@@ -169,6 +169,10 @@ class Socket {
   Result<int32_t> GetReceiveBufferSize();
   CHECKED_STATUS SetReceiveBufferSize(int32_t size);
 
+  // Implements the SOL_SOCKET/SO_BUSY_POLL socket option, i.e. number of microseconds to busy poll
+  // the device queue on blocking receive when there is no data. Linux only.
+  CHECKED_STATUS SetBusyPoll(int32_t usec);
+
  private:
   // Called internally from SetSend/RecvTimeout().
   CHECKED_STATUS SetTimeout(int opt, std::string optname, const MonoDelta& timeout);
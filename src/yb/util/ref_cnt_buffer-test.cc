@@ -21,6 +21,7 @@
 
 #include <gtest/gtest.h>
 
+#include "yb/util/faststring.h"
 #include "yb/util/ref_cnt_buffer.h"
 
 #include "yb/util/test_util.h"
@@ -89,6 +90,35 @@ TEST_F(RefCntBufferTest, TestVector) {
   }
 }
 
+// Test slices that reference own buffer or external memory.
+TEST_F(RefCntBufferTest, TestSlice) {
+  RefCntBuffer buffer("buffer"s);
+  RefCntSlice buffer_slice(buffer);
+  ASSERT_FALSE(buffer_slice.external());
+  ASSERT_EQ(buffer.data(), buffer_slice.data());
+  ASSERT_EQ("buffer", buffer_slice.as_slice().ToBuffer());
+
+  faststring str;
+  const std::string kValue(kSizeLimit, 'x');
+  str.append(kValue);
+  const uint8_t* data = str.data();
+  auto taken = RefCntSlice::TakeOwnership(&str);
+  ASSERT_TRUE(taken.external());
+  ASSERT_TRUE(str.empty());
+  // Heap allocated data should be taken without copying.
+  ASSERT_EQ(data, taken.udata());
+  ASSERT_EQ(kValue, taken.as_slice().ToBuffer());
+
+  auto holder = std::make_shared<std::string>("external");
+  RefCntSlice external(Slice(*holder), holder);
+  ASSERT_EQ(2, holder.use_count());
+  auto copy = external;
+  ASSERT_EQ(3, holder.use_count());
+  external = RefCntSlice();
+  copy = RefCntSlice();
+  ASSERT_EQ(1, holder.use_count());
+}
+
 namespace {
 
 const size_t kInitialBuffers = 1000;
@@ -81,6 +81,12 @@ void RefCntBuffer::DoReset(char* data) {
   data_ = data;
 }
 
+RefCntSlice RefCntSlice::TakeOwnership(faststring* str) {
+  auto size = str->size();
+  std::shared_ptr<const void> holder(str->release(), std::default_delete<uint8_t[]>());
+  return RefCntSlice(Slice(static_cast<const uint8_t*>(holder.get()), size), std::move(holder));
+}
+
 std::string RefCntPrefix::ShortDebugString() const {
   return Slice(data(), size()).ToDebugHexString();
 }
@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include <atomic>
+#include <memory>
 #include <string>
 
 #include "yb/util/slice.h"
@@ -127,6 +128,54 @@ struct RefCntBufferHash {
   }
 };
 
+// Reference counted block of bytes that does not necessarily own a RefCntBuffer.
+// The bytes are kept alive either by a RefCntBuffer or by an arbitrary external holder, e.g.
+// a block cache handle or a mmapped file region, so large data can be passed down to the
+// network layer without copying it.
+class RefCntSlice {
+ public:
+  RefCntSlice() {}
+
+  RefCntSlice(RefCntBuffer buffer) // NOLINT
+      : slice_(buffer.as_slice()), buffer_(std::move(buffer)) {}
+
+  RefCntSlice(const Slice& slice, std::shared_ptr<const void> holder)
+      : slice_(slice), holder_(std::move(holder)) {}
+
+  // Takes ownership of the data accumulated in str, leaving it empty.
+  static RefCntSlice TakeOwnership(faststring* str);
+
+  size_t size() const {
+    return slice_.size();
+  }
+
+  bool empty() const {
+    return slice_.empty();
+  }
+
+  const char* data() const {
+    return slice_.cdata();
+  }
+
+  const uint8_t* udata() const {
+    return slice_.data();
+  }
+
+  const Slice& as_slice() const {
+    return slice_;
+  }
+
+  // Whether data is referenced from an external holder instead of own buffer.
+  bool external() const {
+    return holder_ != nullptr;
+  }
+
+ private:
+  Slice slice_;
+  RefCntBuffer buffer_;
+  std::shared_ptr<const void> holder_;
+};
+
 class RefCntPrefix {
  public:
   RefCntPrefix() : size_(0) {}
@@ -0,0 +1,113 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "yb/util/test_util.h"
+#include "yb/util/weighted_fair_queue.h"
+
+namespace yb {
+
+class WeightedFairQueueTest : public YBTest {
+};
+
+TEST_F(WeightedFairQueueTest, Weights) {
+  constexpr int kValuesPerClass = 100;
+  constexpr int kPops = 50;
+  WeightedFairQueue<std::string, int> queue;
+  for (int i = 0; i != kValuesPerClass; ++i) {
+    queue.Push("low", 1, i);
+    queue.Push("high", 4, kValuesPerClass + i);
+  }
+  ASSERT_EQ(2 * kValuesPerClass, queue.size());
+  ASSERT_EQ(2, queue.num_classes());
+
+  int low = 0;
+  int high = 0;
+  for (int i = 0; i != kPops; ++i) {
+    int value;
+    ASSERT_TRUE(queue.Pop(&value));
+    // Values of the same class are served in FIFO order.
+    if (value < kValuesPerClass) {
+      ASSERT_EQ(low, value);
+      ++low;
+    } else {
+      ASSERT_EQ(kValuesPerClass + high, value);
+      ++high;
+    }
+  }
+  ASSERT_EQ(kPops, low + high);
+  ASSERT_NEAR(kPops * 4 / 5, high, 1);
+
+  int value;
+  while (queue.Pop(&value)) {
+  }
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(0, queue.num_classes());
+}
+
+TEST_F(WeightedFairQueueTest, NewClassIsNotStarved) {
+  WeightedFairQueue<std::string, int> queue;
+  for (int i = 0; i != 100; ++i) {
+    queue.Push("bulk", 1, i);
+  }
+  int value;
+  for (int i = 0; i != 10; ++i) {
+    ASSERT_TRUE(queue.Pop(&value));
+  }
+
+  // A class that arrives later does not wait for the backlog of other classes.
+  queue.Push("point", 1, -1);
+  ASSERT_TRUE(queue.Pop(&value));
+  if (value != -1) {
+    ASSERT_TRUE(queue.Pop(&value));
+  }
+  ASSERT_EQ(-1, value);
+}
+
+TEST_F(WeightedFairQueueTest, Remove) {
+  WeightedFairQueue<std::string, int> queue;
+  for (int i = 0; i != 3; ++i) {
+    queue.Push("a", 1, i);
+    queue.Push("b", 1, 10 + i);
+  }
+  ASSERT_FALSE(queue.Remove("a", 10));
+  ASSERT_FALSE(queue.Remove("c", 0));
+
+  // Remove the head, a middle and the last value.
+  ASSERT_TRUE(queue.Remove("a", 0));
+  ASSERT_TRUE(queue.Remove("b", 11));
+  ASSERT_TRUE(queue.Remove("a", 2));
+  ASSERT_FALSE(queue.Remove("a", 0));
+  ASSERT_EQ(3, queue.size());
+
+  std::vector<int> values;
+  int value;
+  while (queue.Pop(&value)) {
+    values.push_back(value);
+  }
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ((std::vector<int>{1, 10, 12}), values);
+  ASSERT_EQ(0, queue.num_classes());
+
+  // Removing the only value drops the class.
+  queue.Push("a", 1, 0);
+  ASSERT_TRUE(queue.Remove("a", 0));
+  ASSERT_TRUE(queue.empty());
+  ASSERT_EQ(0, queue.num_classes());
+  ASSERT_FALSE(queue.Pop(&value));
+}
+
+} // namespace yb
@@ -0,0 +1,147 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_UTIL_WEIGHTED_FAIR_QUEUE_H
+#define YB_UTIL_WEIGHTED_FAIR_QUEUE_H
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+namespace yb {
+
+// Queue of values split into classes, where backlogged classes are served in proportion to their
+// weights, using start-time fair queuing. Values of the same class are served in FIFO order.
+//
+// Not thread safe.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class WeightedFairQueue {
+ public:
+  // Adds value to the class with the specified key. Weight of the class is taken from the last
+  // pushed value.
+  void Push(const Key& key, uint64_t weight, Value value) {
+    auto& cls = classes_.emplace(key, Class(key)).first->second;
+    const uint64_t start = std::max(virtual_time_, cls.last_finish);
+    cls.last_finish = start + kCostScale / std::max<uint64_t>(weight, 1);
+    cls.entries.push_back(Entry{start, next_serial_++, std::move(value)});
+    if (cls.entries.size() == 1) {
+      ready_.emplace(start, cls.entries.front().serial, &cls);
+    }
+    ++size_;
+  }
+
+  // Pops value with the smallest start tag. Returns false if the queue is empty.
+  bool Pop(Value* value) {
+    if (ready_.empty()) {
+      return false;
+    }
+    auto* cls = std::get<2>(*ready_.begin());
+    ready_.erase(ready_.begin());
+    auto& entry = cls->entries.front();
+    virtual_time_ = entry.start;
+    *value = std::move(entry.value);
+    cls->entries.pop_front();
+    --size_;
+    if (cls->entries.empty()) {
+      // Idle classes are dropped, so the number of classes does not grow with the number of
+      // distinct keys seen.
+      classes_.erase(cls->key);
+    } else {
+      const auto& next = cls->entries.front();
+      ready_.emplace(next.start, next.serial, cls);
+    }
+    return true;
+  }
+
+  // Removes the specified value of the class with the specified key. Returns false if it is not in
+  // the queue. The virtual finish time of the class is not rolled back, so the class is charged for
+  // the removed value, as if it was served.
+  bool Remove(const Key& key, const Value& value) {
+    auto cls_it = classes_.find(key);
+    if (cls_it == classes_.end()) {
+      return false;
+    }
+    auto& cls = cls_it->second;
+    auto it = std::find_if(cls.entries.begin(), cls.entries.end(),
+                           [&value](const Entry& entry) { return entry.value == value; });
+    if (it == cls.entries.end()) {
+      return false;
+    }
+    const bool front = it == cls.entries.begin();
+    if (front) {
+      ready_.erase(std::make_tuple(it->start, it->serial, &cls));
+    }
+    cls.entries.erase(it);
+    --size_;
+    if (cls.entries.empty()) {
+      classes_.erase(cls_it);
+    } else if (front) {
+      const auto& next = cls.entries.front();
+      ready_.emplace(next.start, next.serial, &cls);
+    }
+    return true;
+  }
+
+  void Clear() {
+    ready_.clear();
+    classes_.clear();
+    size_ = 0;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t num_classes() const {
+    return classes_.size();
+  }
+
+ private:
+  // Cost of a value in the class with weight 1, expressed in virtual time units.
+  static constexpr uint64_t kCostScale = 1ULL << 20;
+
+  struct Entry {
+    uint64_t start;
+    // Orders values with the same start tag by arrival.
+    uint64_t serial;
+    Value value;
+  };
+
+  struct Class {
+    explicit Class(const Key& k) : key(k) {}
+
+    Key key;
+    uint64_t last_finish = 0;
+    std::deque<Entry> entries;
+  };
+
+  // Classes are stored in node based map, so pointers to them stay valid.
+  std::unordered_map<Key, Class, Hash> classes_;
+  // Head entries of backlogged classes.
+  std::set<std::tuple<uint64_t, uint64_t, Class*>> ready_;
+  uint64_t virtual_time_ = 0;
+  uint64_t next_serial_ = 0;
+  size_t size_ = 0;
+};
+
+} // namespace yb
+
+#endif // YB_UTIL_WEIGHTED_FAIR_QUEUE_H
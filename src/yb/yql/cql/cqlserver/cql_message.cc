@@ -1743,7 +1743,7 @@ CQLServerEvent::CQLServerEvent(std::unique_ptr<EventResponse> event_response)
   serialized_response_ = RefCntBuffer(temp);
 }
 
-void CQLServerEvent::Serialize(boost::container::small_vector_base<RefCntBuffer>* output) const {
+void CQLServerEvent::Serialize(boost::container::small_vector_base<RefCntSlice>* output) const {
   output->push_back(serialized_response_);
 }
 
@@ -1761,7 +1761,7 @@ void CQLServerEventList::Transferred(const Status& status, rpc::Connection*) {
 }
 
 void CQLServerEventList::Serialize(
-    boost::container::small_vector_base<RefCntBuffer>* output) {
+    boost::container::small_vector_base<RefCntSlice>* output) {
   for (const auto& cql_server_event : cql_server_events_) {
     cql_server_event->Serialize(output);
   }
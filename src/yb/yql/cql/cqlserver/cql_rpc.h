@@ -94,7 +94,7 @@ class CQLInboundCall : public rpc::InboundCall {
 
   // Serialize the response packet for the finished call.
   // The resulting slices refer to memory in this object.
-  void Serialize(boost::container::small_vector_base<RefCntBuffer>* output) override;
+  void Serialize(boost::container::small_vector_base<RefCntSlice>* output) override;
 
   void LogTrace() const override;
   std::string ToString() const override;
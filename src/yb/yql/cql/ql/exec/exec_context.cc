@@ -128,6 +128,37 @@ bool ExecContext::HasPendingOperations() const {
   return false;
 }
 
+void ExecContext::SetFinalFlushIfSingleWrite() {
+  if (!transaction_ || transactional_session_->CountBufferedOperations() != 1) {
+    return;
+  }
+  const client::YBqlOp* pending_op = nullptr;
+  for (auto& tnode_context : tnode_contexts_) {
+    if (tnode_context.child_context() != nullptr) {
+      return;
+    }
+    for (const auto& op : tnode_context.ops()) {
+      if (op->response().has_status()) {
+        continue;
+      }
+      if (pending_op != nullptr || op->type() != client::YBOperation::Type::QL_WRITE) {
+        return;
+      }
+      pending_op = op.get();
+    }
+  }
+  if (pending_op == nullptr) {
+    return;
+  }
+  // Failed IF condition aborts the transaction and index updates are done in a child transaction,
+  // so both need the write to be transactional.
+  const auto& req = static_cast<const client::YBqlWriteOp*>(pending_op)->request();
+  if (req.has_if_expr() || !req.update_index_ids().empty()) {
+    return;
+  }
+  transaction_->SetNextFlushFinal();
+}
+
 class AbortTransactionTask : public rpc::ThreadPoolTask {
  public:
   explicit AbortTransactionTask(YBTransactionPtr transaction)
@@ -258,6 +258,11 @@ class ExecContext : public ProcessContextBase {
   // Does this statement have pending operations?
   bool HasPendingOperations() const;
 
+  // If the only remaining operation of the transaction is an unconditional write buffered in the
+  // transactional session, tells the transaction that the next flush is its final one, so the
+  // write could be done without intents (see YBTransaction::SetNextFlushFinal).
+  void SetFinalFlushIfSingleWrite();
+
   //------------------------------------------------------------------------------------------------
   client::Restart restart() const {
     return restart_;
@@ -1381,6 +1381,7 @@ void Executor::FlushAsync() {
   for (ExecContext& exec_context : exec_contexts_) {
     if (exec_context.HasTransaction()) {
       if (exec_context.transactional_session()->CountBufferedOperations() > 0) {
+        exec_context.SetFinalFlushIfSingleWrite();
         flush_sessions.push_back({exec_context.transactional_session(), &exec_context});
       } else if (!exec_context.HasPendingOperations()) {
         commit_contexts.push_back(&exec_context);
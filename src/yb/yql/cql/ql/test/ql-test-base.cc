@@ -74,10 +74,25 @@ TestQLProcessor* QLTestBase::GetQLProcessor(const RoleName& role_name) {
     CreateSimulatedCluster();
   }
 
-  ql_processors_.emplace_back(new TestQLProcessor(client_.get(), metadata_cache_, role_name));
+  ql_processors_.emplace_back(new TestQLProcessor(
+      client_.get(), metadata_cache_, role_name,
+      std::bind(&QLTestBase::GetTransactionPool, this)));
   CallUseKeyspace(ql_processors_.back(), kDefaultKeyspaceName);
   return ql_processors_.back().get();
 }
 
+client::TransactionPool* QLTestBase::GetTransactionPool() {
+  std::lock_guard<std::mutex> lock(transaction_pool_mutex_);
+  if (!transaction_pool_) {
+    server::ClockPtr clock(new server::HybridClock());
+    CHECK_OK(clock->Init());
+    transaction_manager_ = std::make_unique<client::TransactionManager>(
+        client_.get(), clock, client::LocalTabletFilter());
+    transaction_pool_ = std::make_unique<client::TransactionPool>(
+        transaction_manager_.get(), nullptr /* metric_entity */);
+  }
+  return transaction_pool_.get();
+}
+
 }  // namespace ql
 }  // namespace yb
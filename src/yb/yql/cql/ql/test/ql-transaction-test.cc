@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------------------------------
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//--------------------------------------------------------------------------------------------------
+
+#include "yb/yql/cql/ql/test/ql-test-base.h"
+
+#include "yb/rocksdb/db.h"
+
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+
+DECLARE_bool(enable_single_shard_transaction_fast_path);
+
+namespace yb {
+namespace ql {
+
+class TestQLTransaction : public QLTestBase {
+ public:
+  TestQLTransaction() : QLTestBase() {
+  }
+
+  // Returns sum of latest sequence numbers of intents DBs of the table tablets, it does not change
+  // when transaction writes without intents.
+  rocksdb::SequenceNumber IntentsSequenceNumber(const std::string& table_name) {
+    rocksdb::SequenceNumber result = 0;
+    auto peers = ListTabletPeers(cluster_.get(), ListPeersFilter::kAll);
+    for (const auto& peer : peers) {
+      auto tablet = peer->shared_tablet();
+      if (tablet && tablet->metadata()->table_name() == table_name) {
+        result += tablet->TEST_intents_db()->GetLatestSequenceNumber();
+      }
+    }
+    return result;
+  }
+
+  void CheckRowCount(TestQLProcessor* processor, size_t expected_rows) {
+    CHECK_VALID_STMT("SELECT * FROM t;");
+    ASSERT_EQ(processor->row_block()->row_count(), expected_rows);
+  }
+};
+
+// Transaction block that consists of a single write is done without intents.
+TEST_F(TestQLTransaction, SingleWrite) {
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+  TestQLProcessor* processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (k INT PRIMARY KEY, v INT) "
+                   "WITH transactions = { 'enabled' : true };");
+
+  auto sequence_number = IntentsSequenceNumber("t");
+  CHECK_VALID_STMT("BEGIN TRANSACTION "
+                   "  INSERT INTO t (k, v) VALUES (1, 1); "
+                   "END TRANSACTION;");
+  ASSERT_EQ(IntentsSequenceNumber("t"), sequence_number);
+  ASSERT_NO_FATALS(CheckRowCount(processor, 1));
+
+  // Conditional write needs the transaction to abort when the condition is not satisfied.
+  CHECK_VALID_STMT("BEGIN TRANSACTION "
+                   "  INSERT INTO t (k, v) VALUES (2, 2) IF NOT EXISTS ELSE ERROR; "
+                   "END TRANSACTION;");
+  auto new_sequence_number = IntentsSequenceNumber("t");
+  ASSERT_GT(new_sequence_number, sequence_number);
+  sequence_number = new_sequence_number;
+
+  CHECK_VALID_STMT("BEGIN TRANSACTION "
+                   "  INSERT INTO t (k, v) VALUES (3, 3); "
+                   "  INSERT INTO t (k, v) VALUES (4, 4); "
+                   "END TRANSACTION;");
+  new_sequence_number = IntentsSequenceNumber("t");
+  ASSERT_GT(new_sequence_number, sequence_number);
+  sequence_number = new_sequence_number;
+
+  FLAGS_enable_single_shard_transaction_fast_path = false;
+  CHECK_VALID_STMT("BEGIN TRANSACTION "
+                   "  INSERT INTO t (k, v) VALUES (5, 5); "
+                   "END TRANSACTION;");
+  ASSERT_GT(IntentsSequenceNumber("t"), sequence_number);
+
+  ASSERT_NO_FATALS(CheckRowCount(processor, 5));
+}
+
+}  // namespace ql
+}  // namespace yb
@@ -13,7 +13,12 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/yql/pggate/pg_doc_op.h"
+
+#include "yb/client/table.h"
+#include "yb/common/partition.h"
+
 #include "yb/yql/pggate/pggate_flags.h"
+#include "yb/yql/pggate/util/pg_wire.h"
 
 // TODO: include a header for PgTxnManager specifically.
 #include "yb/yql/pggate/pggate_if_cxx_decl.h"
@@ -98,8 +103,12 @@ Status PgDocOp::GetResult(string *result_set) {
   RETURN_NOT_OK(exec_status_);
 
   RETURN_NOT_OK(SendRequestIfNeededUnlocked());
+  RETURN_NOT_OK(ReadAheadUnlocked());
 
   // Wait for response from DocDB.
+  if (!has_cached_data_ && !end_of_data_) {
+    consumer_waited_ = true;
+  }
   while (!has_cached_data_ && !end_of_data_) {
     cv_.wait(lock);
   }
@@ -112,6 +121,7 @@ Status PgDocOp::GetResult(string *result_set) {
   // This will pre-fetch the next chunk of data if we've consumed all cached
   // rows.
   RETURN_NOT_OK(SendRequestIfNeededUnlocked());
+  RETURN_NOT_OK(ReadAheadUnlocked());
 
   pg_session_->pg_txn_manager()->PreventRestart();
   return Status::OK();
@@ -132,6 +142,10 @@ void PgDocOp::ReadFromCacheUnlocked(string *result) {
   }
 }
 
+Status PgDocOp::ReadAheadUnlocked() {
+  return Status::OK();
+}
+
 Status PgDocOp::SendRequestIfNeededUnlocked() {
   // Request more data if more execution is needed and cache is empty.
   if (!has_cached_data_ && !end_of_data_ && !waiting_for_response_) {
@@ -178,17 +192,66 @@ void PgDocReadOp::InitUnlocked(std::unique_lock<std::mutex>* lock) {
   PgDocOp::InitUnlocked(lock);
 
   read_op_->mutable_request()->set_return_paging_state(true);
+
+  partition_ops_.clear();
+  in_flight_ops_.clear();
+  if (CanScanPartitionsInParallel()) {
+    InitPartitionOpsUnlocked();
+  }
+}
+
+bool PgDocReadOp::CanScanPartitionsInParallel() const {
+  // Only full forward scans of hash partitioned tables are split. Rows of different tablets of
+  // such a table have no meaningful order, so the results of the tablets are returned as they
+  // arrive. Scans with a LIMIT are left alone as they often need a single page of one tablet.
+  const PgsqlReadRequestPB& req = read_op_->request();
+  return FLAGS_ysql_select_parallelism > 1 &&
+         exec_params_.limit_use_default &&
+         req.is_forward_scan() &&
+         req.partition_column_values().empty() &&
+         req.range_column_values().empty() &&
+         req.ybctid_column_value().value().binary_value().empty() &&
+         !req.has_index_request() &&
+         !req.has_paging_state() &&
+         read_op_->table()->partition_schema().IsHashPartitioning() &&
+         read_op_->table()->GetPartitions().size() > 1;
 }
 
-void PgDocReadOp::SetRequestPrefetchLimit() {
+void PgDocReadOp::InitPartitionOpsUnlocked() {
+  const std::vector<std::string>& partitions = read_op_->table()->GetPartitions();
+  for (size_t i = 0; i < partitions.size(); i++) {
+    std::shared_ptr<client::YBPgsqlReadOp> op = read_op_->DeepCopy();
+    PgsqlReadRequestPB *req = op->mutable_request();
+
+    // Bound the read to the hash range of the tablet so that it does not move on to the next one.
+    req->set_hash_code(
+        partitions[i].empty() ? 0 : PartitionSchema::DecodeMultiColumnHashValue(partitions[i]));
+    req->set_max_hash_code(
+        i + 1 < partitions.size()
+            ? PartitionSchema::DecodeMultiColumnHashValue(partitions[i + 1]) - 1
+            : std::numeric_limits<uint16_t>::max());
+    if (!partitions[i].empty()) {
+      req->mutable_paging_state()->set_next_partition_key(partitions[i]);
+    }
+    partition_ops_.push_back(std::move(op));
+  }
+  VLOG(2) << __PRETTY_FUNCTION__ << ": Scanning " << partition_ops_.size() << " tablets of "
+          << read_op_->table()->name().ToString() << " in parallel";
+}
+
+void PgDocReadOp::SetRequestPrefetchLimit(PgsqlReadRequestPB *req) {
   // Predict the maximum prefetch-limit using the associated gflags.
-  PgsqlReadRequestPB *req = read_op_->mutable_request();
   int predicted_limit = FLAGS_ysql_prefetch_limit;
   if (!req->is_forward_scan()) {
     // Backward scan is slower than forward scan, so predicted limit is a smaller number.
     predicted_limit = predicted_limit * FLAGS_ysql_backward_prefetch_scale_factor;
   }
 
+  // Once pages are being received, use the adaptive limit instead.
+  if (FLAGS_ysql_adaptive_prefetch_limit && adaptive_prefetch_limit_ > 0) {
+    predicted_limit = adaptive_prefetch_limit_;
+  }
+
   // Use statement LIMIT(count + offset) if it is smaller than the predicted limit.
   int64_t limit_count = exec_params_.limit_count + exec_params_.limit_offset;
   if (exec_params_.limit_use_default || limit_count > predicted_limit) {
@@ -200,7 +263,11 @@ void PgDocReadOp::SetRequestPrefetchLimit() {
 Status PgDocReadOp::SendRequestUnlocked() {
   CHECK(!waiting_for_response_);
 
-  SetRequestPrefetchLimit();
+  if (!partition_ops_.empty()) {
+    return SendParallelRequestsUnlocked();
+  }
+
+  SetRequestPrefetchLimit(read_op_->mutable_request());
   SCHECK_EQ(VERIFY_RESULT(pg_session_->PgApplyAsync(read_op_, read_time_)), OpBuffered::kFalse,
             IllegalState, "YSQL read operation should not be buffered");
 
@@ -234,6 +301,7 @@ void PgDocReadOp::ReceiveResponse(Status exec_status) {
 
   if (!is_canceled_) {
     // Save it to cache.
+    UpdatePrefetchLimitUnlocked(read_op_->request(), *read_op_->mutable_rows_data());
     WriteToCacheUnlocked(read_op_);
 
     // Setup request for the next batch of data.
@@ -255,6 +323,123 @@ void PgDocReadOp::ReceiveResponse(Status exec_status) {
   }
 }
 
+void PgDocReadOp::UpdatePrefetchLimitUnlocked(const PgsqlReadRequestPB& req,
+                                              const std::string& rows_data) {
+  const bool consumer_waited = consumer_waited_;
+  consumer_waited_ = false;
+  if (!FLAGS_ysql_adaptive_prefetch_limit || rows_data.empty()) {
+    return;
+  }
+
+  if (adaptive_prefetch_limit_ == 0) {
+    adaptive_prefetch_limit_ = req.limit();
+  }
+
+  // A page that PostgreSQL was waiting for was too small to hide the round trip, so ask for more
+  // rows next time.
+  if (consumer_waited) {
+    adaptive_prefetch_limit_ *= 2;
+  }
+  adaptive_prefetch_limit_ = std::min<int64_t>(adaptive_prefetch_limit_,
+                                               FLAGS_ysql_max_prefetch_limit);
+
+  // Keep the page within the byte limit based on the width of the rows received.
+  Slice cursor(rows_data);
+  int64_t row_count = 0;
+  cursor.remove_prefix(PgWire::ReadNumber(&cursor, &row_count));
+  if (row_count > 0) {
+    const int64_t row_width = std::max<int64_t>(1, cursor.size() / row_count);
+    adaptive_prefetch_limit_ = std::min<int64_t>(adaptive_prefetch_limit_,
+                                                 FLAGS_ysql_max_prefetch_page_bytes / row_width);
+  }
+  adaptive_prefetch_limit_ = std::max<int64_t>(adaptive_prefetch_limit_, 1);
+}
+
+Status PgDocReadOp::ReadAheadUnlocked() {
+  if (!is_canceled_ && !end_of_data_ && !waiting_for_response_ &&
+      result_cache_.size() < static_cast<size_t>(FLAGS_ysql_readahead_pages)) {
+    return SendRequestUnlocked();
+  }
+  return Status::OK();
+}
+
+Status PgDocReadOp::SendParallelRequestsUnlocked() {
+  // Once the size of a tablet page is known, send no more reads at a time than fit the limit.
+  size_t round_size = FLAGS_ysql_select_parallelism;
+  if (max_response_size_ > 0) {
+    round_size = std::min<size_t>(
+        round_size,
+        std::max<size_t>(1, FLAGS_ysql_select_parallel_memory_limit_bytes / max_response_size_));
+  }
+
+  in_flight_ops_.clear();
+  for (const auto& op : partition_ops_) {
+    if (in_flight_ops_.size() >= round_size) {
+      break;
+    }
+    SetRequestPrefetchLimit(op->mutable_request());
+    SCHECK_EQ(VERIFY_RESULT(pg_session_->PgApplyAsync(op, read_time_)), OpBuffered::kFalse,
+              IllegalState, "YSQL read operation should not be buffered");
+    in_flight_ops_.push_back(op);
+  }
+
+  waiting_for_response_ = true;
+  Status s = pg_session_->PgFlushAsync([this](const Status& s) {
+                                         PgDocReadOp::ReceiveParallelResponses(s);
+                                       });
+  if (!s.ok()) {
+    waiting_for_response_ = false;
+    return s;
+  }
+  return Status::OK();
+}
+
+void PgDocReadOp::ReceiveParallelResponses(Status exec_status) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  CHECK(waiting_for_response_);
+  cv_.notify_all();
+  waiting_for_response_ = false;
+  exec_status_ = exec_status;
+
+  // A restart sends the next round, which refills in_flight_ops_.
+  std::vector<std::shared_ptr<client::YBPgsqlReadOp>> ops;
+  ops.swap(in_flight_ops_);
+
+  if (exec_status.ok()) {
+    for (const auto& op : ops) {
+      // No response of this round has been used yet, so a restart resends the whole round.
+      if (CheckRestartUnlocked(op.get())) {
+        return;
+      }
+      if (!exec_status_.ok()) {
+        break;
+      }
+    }
+  }
+
+  // exec_status_ could be changed by CheckRestartUnlocked
+  if (!exec_status_.ok() || is_canceled_) {
+    end_of_data_ = true;
+    return;
+  }
+
+  for (const auto& op : ops) {
+    max_response_size_ = std::max(max_response_size_, op->mutable_rows_data()->size());
+    UpdatePrefetchLimitUnlocked(op->request(), *op->mutable_rows_data());
+    WriteToCacheUnlocked(op);
+
+    const PgsqlResponsePB& res = op->response();
+    if (res.has_paging_state()) {
+      PgsqlReadRequestPB *req = op->mutable_request();
+      *req->mutable_paging_state() = res.paging_state();
+      req->clear_ysql_catalog_version();
+    } else {
+      partition_ops_.remove(op);
+    }
+  }
+  end_of_data_ = partition_ops_.empty();
+}
+
 //--------------------------------------------------------------------------------------------------
 
 PgDocWriteOp::PgDocWriteOp(PgSession::ScopedRefPtr pg_session, client::YBPgsqlWriteOp *write_op)
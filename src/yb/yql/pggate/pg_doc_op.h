@@ -72,6 +72,10 @@ class PgDocOp {
   // all data in the cache.
   CHECKED_STATUS SendRequestIfNeededUnlocked();
 
+  // Send a request for the next page even if the cache is not empty. Called by GetResult, i.e.
+  // only from the PostgreSQL thread, so the session is never used by two threads at once.
+  virtual CHECKED_STATUS ReadAheadUnlocked();
+
   // Checks whether op causes restart. Could set exec_status_.
   // Returns true is restart was initiated;
   bool CheckRestartUnlocked(client::YBPgsqlOp* op);
@@ -90,7 +94,8 @@ class PgDocOp {
   Status exec_status_ = Status::OK();
 
   // Whether or not we are waiting for a response from DocDB after sending a request. Only one
-  // request can be sent to DocDB at a time.
+  // flush can be sent to DocDB at a time, although a read op may put the reads of several tablets
+  // in one flush.
   bool waiting_for_response_ = false;
 
   // Whether all requested data by the statement has been received or there's a run-time error.
@@ -102,6 +107,10 @@ class PgDocOp {
   // Whether or not the statement has been canceled by application / users.
   bool is_canceled_ = false;
 
+  // Whether GetResult had to wait for data since the last response, i.e. the consumer is faster
+  // than DocDB responses arrive.
+  bool consumer_waited_ = false;
+
   // Caching state variables.
   std::list<string> result_cache_;
 
@@ -137,10 +146,42 @@ class PgDocReadOp : public PgDocOp {
   virtual void ReceiveResponse(Status exec_status);
 
   // Analyze options and pick the appropriate prefetch limit.
-  void SetRequestPrefetchLimit();
+  void SetRequestPrefetchLimit(PgsqlReadRequestPB *req);
+
+  // Updates the adaptive prefetch limit from the size of a received page and from whether the
+  // consumer had to wait for it.
+  void UpdatePrefetchLimitUnlocked(const PgsqlReadRequestPB& req, const std::string& rows_data);
+
+  // Sends the request for the next page if fewer than FLAGS_ysql_readahead_pages pages are cached,
+  // so that the page is fetched while PostgreSQL processes the cached ones.
+  CHECKED_STATUS ReadAheadUnlocked() override;
+
+  // Whether the statement is a full scan that can be split into one read per tablet.
+  bool CanScanPartitionsInParallel() const;
+
+  // Creates one read op per tablet of the table, each bound to the hash range of its tablet.
+  void InitPartitionOpsUnlocked();
+
+  // Sends the next page of up to FLAGS_ysql_select_parallelism tablet reads in one flush.
+  CHECKED_STATUS SendParallelRequestsUnlocked();
+  void ReceiveParallelResponses(Status exec_status);
 
   // Operator.
   std::shared_ptr<client::YBPgsqlReadOp> read_op_;
+
+  // Read ops of the tablets that still have data to return when the scan is split by tablet.
+  // Empty when the statement is executed with read_op_ alone.
+  std::list<std::shared_ptr<client::YBPgsqlReadOp>> partition_ops_;
+
+  // Read ops of the round that is being waited for.
+  std::vector<std::shared_ptr<client::YBPgsqlReadOp>> in_flight_ops_;
+
+  // Largest response seen for a single tablet read, used to bound the size of a round.
+  size_t max_response_size_ = 0;
+
+  // Number of rows to request per page when the prefetch limit is adaptive. Zero until the first
+  // page has been received.
+  int64_t adaptive_prefetch_limit_ = 0;
 };
 
 class PgDocWriteOp : public PgDocOp {
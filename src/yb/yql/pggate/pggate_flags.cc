@@ -19,8 +19,11 @@
 
 #include "yb/util/flags.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/size_literals.h"
 #include "yb/yql/pggate/pggate_flags.h"
 
+using namespace yb::size_literals;
+
 DEFINE_int32(pgsql_rpc_keepalive_time_ms, 0,
              "If an RPC connection from a client is idle for this amount of time, the server "
              "will disconnect the client. Setting flag to 0 disables this clean up.");
@@ -55,6 +58,32 @@ DEFINE_int32(ysql_session_max_batch_size, 512,
              "Maximum batch size for buffered writes between PostgreSQL server and YugaByte DocDB "
              "services");
 
+DEFINE_int32(ysql_readahead_pages, 2,
+             "Number of pages of a YSQL scan that are fetched ahead of the page being returned to "
+             "PostgreSQL. The next page is requested whenever PostgreSQL reads a page while fewer "
+             "than this number of pages are cached. Set to 1 to request a page only once the cache "
+             "is empty.");
+
+DEFINE_bool(ysql_adaptive_prefetch_limit, true,
+            "Grow the number of rows requested per page when PostgreSQL consumes pages faster "
+            "than they arrive, bounded by ysql_max_prefetch_limit and "
+            "ysql_max_prefetch_page_bytes.");
+
+DEFINE_int32(ysql_max_prefetch_limit, 8192,
+             "Maximum number of rows to prefetch per page when the prefetch limit is adaptive.");
+
+DEFINE_int64(ysql_max_prefetch_page_bytes, 4_MB,
+             "Maximum size of a prefetched page when the prefetch limit is adaptive. The number of "
+             "rows per page is reduced based on the observed row width to stay within this size.");
+
+DEFINE_int32(ysql_select_parallelism, 8,
+             "Maximum number of tablets that a full scan of a hash partitioned table reads from "
+             "concurrently. Set to 1 to read the tablets one after another.");
+
+DEFINE_int64(ysql_select_parallel_memory_limit_bytes, 64_MB,
+             "Limit on the data fetched by one round of concurrent tablet reads of a full table "
+             "scan. The number of tablets read concurrently is reduced to stay within this limit.");
+
 // Top-level flag to enable all YSQL beta features.
 DEFINE_bool(ysql_beta_features, true,
             "Whether to enable all ysql beta features");
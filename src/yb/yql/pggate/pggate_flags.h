@@ -26,6 +26,12 @@ DECLARE_bool(pggate_ignore_tserver_shm);
 DECLARE_int32(ysql_prefetch_limit);
 DECLARE_double(ysql_backward_prefetch_scale_factor);
 DECLARE_int32(ysql_session_max_batch_size);
+DECLARE_int32(ysql_readahead_pages);
+DECLARE_bool(ysql_adaptive_prefetch_limit);
+DECLARE_int32(ysql_max_prefetch_limit);
+DECLARE_int64(ysql_max_prefetch_page_bytes);
+DECLARE_int32(ysql_select_parallelism);
+DECLARE_int64(ysql_select_parallel_memory_limit_bytes);
 
 DECLARE_bool(ysql_beta_features);
 DECLARE_bool(ysql_beta_feature_function);
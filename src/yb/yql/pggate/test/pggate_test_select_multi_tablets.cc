@@ -13,13 +13,83 @@
 //
 //--------------------------------------------------------------------------------------------------
 
+#include <set>
+
 #include "yb/yql/pggate/test/pggate_test.h"
+#include "yb/yql/pggate/pggate_flags.h"
 #include "yb/util/ybc-internal.h"
 
 namespace yb {
 namespace pggate {
 
 class PggateTestSelectMultiTablets : public PggateTest {
+ protected:
+  // Creates a table with hash_key and id columns, and inserts rows with both columns set to the
+  // row number, from 0 to row_count - 1.
+  void CreateAndFillTable(const char* tabname, YBCPgOid tab_oid, int row_count) {
+    YBCPgStatement pg_stmt;
+    CHECK_YBC_STATUS(YBCPgNewCreateTable(pg_session_, kDefaultDatabase, kDefaultSchema, tabname,
+                                         kDefaultDatabaseOid, tab_oid,
+                                         false /* is_shared_table */, true /* if_not_exist */,
+                                         false /* add_primary_key */, &pg_stmt));
+    CHECK_YBC_STATUS(YBCTestCreateTableAddColumn(pg_stmt, "hash_key", 1,
+                                               DataType::INT64, true, true));
+    CHECK_YBC_STATUS(YBCTestCreateTableAddColumn(pg_stmt, "id", 2,
+                                               DataType::INT32, false, true));
+    CHECK_YBC_STATUS(YBCPgExecCreateTable(pg_stmt));
+    CHECK_YBC_STATUS(YBCPgDeleteStatement(pg_stmt));
+
+    CHECK_YBC_STATUS(YBCPgNewInsert(pg_session_, kDefaultDatabaseOid, tab_oid,
+                                    false /* is_single_row_txn */, &pg_stmt));
+    YBCPgExpr expr_hash;
+    CHECK_YBC_STATUS(YBCTestNewConstantInt8(pg_stmt, 0, false, &expr_hash));
+    YBCPgExpr expr_id;
+    CHECK_YBC_STATUS(YBCTestNewConstantInt4(pg_stmt, 0, false, &expr_id));
+    CHECK_YBC_STATUS(YBCPgDmlBindColumn(pg_stmt, 1, expr_hash));
+    CHECK_YBC_STATUS(YBCPgDmlBindColumn(pg_stmt, 2, expr_id));
+
+    for (int i = 0; i < row_count; i++) {
+      YBCPgUpdateConstInt8(expr_hash, i, false);
+      YBCPgUpdateConstInt4(expr_id, i, false);
+      CHECK_YBC_STATUS(YBCPgExecInsert(pg_stmt));
+      CommitTransaction();
+    }
+    CHECK_YBC_STATUS(YBCPgDeleteStatement(pg_stmt));
+  }
+
+  // Scans the table created by CreateAndFillTable, checks that every row is returned exactly once
+  // and returns the keys of returned rows.
+  std::set<int64_t> CheckScanKeys(YBCPgOid tab_oid, int row_count) {
+    const int col_count = 2;
+    YBCPgStatement pg_stmt;
+    CHECK_YBC_STATUS(YBCPgNewSelect(pg_session_, kDefaultDatabaseOid, tab_oid, kInvalidOid,
+                                    &pg_stmt, nullptr /* read_time */));
+    YBCPgExpr colref;
+    YBCTestNewColumnRef(pg_stmt, 1, DataType::INT64, &colref);
+    CHECK_YBC_STATUS(YBCPgDmlAppendTarget(pg_stmt, colref));
+    YBCTestNewColumnRef(pg_stmt, 2, DataType::INT32, &colref);
+    CHECK_YBC_STATUS(YBCPgDmlAppendTarget(pg_stmt, colref));
+    CHECK_YBC_STATUS(YBCPgExecSelect(pg_stmt, nullptr /* exec_params */));
+
+    uint64_t *values = static_cast<uint64_t*>(YBCPAlloc(col_count * sizeof(uint64_t)));
+    bool *isnulls = static_cast<bool*>(YBCPAlloc(col_count * sizeof(bool)));
+    std::set<int64_t> selected;
+    bool has_data = true;
+    while (true) {
+      CHECK_YBC_STATUS(YBCPgDmlFetch(pg_stmt, col_count, values, isnulls, nullptr, &has_data));
+      if (!has_data) {
+        break;
+      }
+      CHECK_EQ(values[0], values[1]);
+      CHECK_LT(values[0], static_cast<uint64_t>(row_count));
+      CHECK(selected.insert(values[0]).second) << "Row " << values[0] << " is fetched twice";
+    }
+    CHECK_EQ(selected.size(), static_cast<size_t>(row_count))
+        << "Not all inserted rows are fetched";
+
+    CHECK_YBC_STATUS(YBCPgDeleteStatement(pg_stmt));
+    return selected;
+  }
 };
 
 TEST_F(PggateTestSelectMultiTablets, TestSelectMultiTablets) {
@@ -272,5 +342,49 @@ TEST_F(PggateTestSelectMultiTablets, TestSelectMultiTablets) {
   pg_stmt = nullptr;
 }
 
+// Scans a table in many small pages with different numbers of pages fetched ahead. The next page
+// is requested by the thread that reads the rows while earlier pages are still cached, so every row
+// should be returned exactly once.
+TEST_F(PggateTestSelectMultiTablets, TestReadAhead) {
+  CHECK_OK(Init("TestReadAhead"));
+
+  const YBCPgOid tab_oid = 3;
+  const int insert_row_count = 100;
+  CreateAndFillTable("readahead_table", tab_oid, insert_row_count);
+
+  // Keep pages small and of a fixed size, so that a scan takes many round trips.
+  FLAGS_ysql_prefetch_limit = 3;
+  FLAGS_ysql_adaptive_prefetch_limit = false;
+
+  for (int readahead_pages : {1, 2, 5}) {
+    LOG(INFO) << "Test SELECTing with " << readahead_pages << " readahead pages";
+    FLAGS_ysql_readahead_pages = readahead_pages;
+    CheckScanKeys(tab_oid, insert_row_count);
+  }
+}
+
+// Scans the tablets of a table one after another and concurrently, in many small pages. Rows of
+// concurrent scans are returned in the order tablets respond, but the same rows should be returned.
+TEST_F(PggateTestSelectMultiTablets, TestParallelScan) {
+  CHECK_OK(Init("TestParallelScan"));
+
+  const YBCPgOid tab_oid = 3;
+  const int insert_row_count = 100;
+  CreateAndFillTable("parallel_scan_table", tab_oid, insert_row_count);
+
+  FLAGS_ysql_prefetch_limit = 3;
+  FLAGS_ysql_adaptive_prefetch_limit = false;
+
+  FLAGS_ysql_select_parallelism = 1;
+  const auto sequential_keys = CheckScanKeys(tab_oid, insert_row_count);
+  // With a memory limit of 1 byte, each round after the first one reads a single tablet.
+  for (int64_t memory_limit : {1LL, 64LL * 1024 * 1024}) {
+    LOG(INFO) << "Test SELECTing in parallel with memory limit " << memory_limit;
+    FLAGS_ysql_select_parallelism = 8;
+    FLAGS_ysql_select_parallel_memory_limit_bytes = memory_limit;
+    CHECK(CheckScanKeys(tab_oid, insert_row_count) == sequential_keys);
+  }
+}
+
 } // namespace pggate
 } // namespace yb
@@ -10,6 +10,8 @@
 // or implied.  See the License for the specific language governing permissions and limitations
 // under the License.
 
+#include <set>
+
 #include <boost/scope_exit.hpp>
 
 #include "yb/util/random_util.h"
@@ -25,6 +27,7 @@ DECLARE_int32(yb_client_admin_operation_timeout_sec);
 
 METRIC_DECLARE_entity(tablet);
 METRIC_DECLARE_counter(transaction_not_found);
+METRIC_DECLARE_counter(restart_read_requests);
 
 namespace yb {
 namespace pgwrapper {
@@ -632,5 +635,96 @@ TEST_F(PgLibPqTest, TestConcurrentCounterRepeatableRead) {
   TestConcurrentCounter(IsolationLevel::SNAPSHOT_ISOLATION);
 }
 
+class PgLibPqParallelScanTest : public PgLibPqTest {
+ protected:
+  void UpdateMiniClusterOptions(ExternalMiniClusterOptions* options) override {
+    // Each tablet server hosts a tablet of the table, so full scans read 3 tablets at once.
+    options->extra_tserver_flags.push_back("--ysql_select_parallelism=8");
+  }
+};
+
+// Scans all tablets of a table concurrently while rows are inserted. Reads that hit a write inside
+// the clock skew window restart, and a restarted scan should still return every row exactly once.
+TEST_F(PgLibPqParallelScanTest, YB_DISABLE_TEST_IN_TSAN(ReadRestart)) {
+  auto conn = ASSERT_RESULT(Connect());
+  ASSERT_OK(Execute(conn.get(), "CREATE TABLE t (key INT PRIMARY KEY)"));
+
+  std::atomic<bool> stop(false);
+  std::atomic<int> last_written(0);
+
+  std::thread write_thread([this, &stop, &last_written] {
+    auto write_conn = ASSERT_RESULT(Connect());
+    int write_key = 1;
+    while (!stop.load(std::memory_order_acquire)) {
+      auto status = Execute(write_conn.get(), Format("INSERT INTO t (key) VALUES ($0)", write_key));
+      if (status.ok()) {
+        last_written.store(write_key, std::memory_order_release);
+        ++write_key;
+      } else {
+        LOG(INFO) << "Write " << write_key << " failed: " << status;
+      }
+    }
+  });
+
+  BOOST_SCOPE_EXIT(&stop, &write_thread) {
+    stop.store(true, std::memory_order_release);
+    write_thread.join();
+  } BOOST_SCOPE_EXIT_END;
+
+  int successful_reads = 0;
+  int failed_reads = 0;
+  auto deadline = CoarseMonoClock::now() + 30s;
+  while (CoarseMonoClock::now() < deadline) {
+    int min_read_key = last_written.load(std::memory_order_acquire);
+    if (min_read_key == 0) {
+      std::this_thread::sleep_for(100ms);
+      continue;
+    }
+
+    SCOPED_TRACE(Format("Reading: $0", min_read_key));
+    ASSERT_OK(Execute(conn.get(), "BEGIN ISOLATION LEVEL REPEATABLE READ"));
+    auto res = Fetch(conn.get(), "SELECT key FROM t");
+    if (!res.ok()) {
+      // A restart is possible only until the first rows were returned.
+      ASSERT_TRUE(TransactionalFailure(res.status())) << res.status();
+      ++failed_reads;
+      ASSERT_OK(Execute(conn.get(), "ROLLBACK"));
+      continue;
+    }
+
+    auto lines = PQntuples(res->get());
+    std::set<int32_t> keys;
+    for (int i = 0; i != lines; ++i) {
+      auto key = ASSERT_RESULT(GetInt32(res->get(), i, 0));
+      ASSERT_TRUE(keys.insert(key).second) << "Key " << key << " is returned twice";
+    }
+    for (int key = 1; key <= min_read_key; ++key) {
+      ASSERT_EQ(1U, keys.count(key)) << "Key " << key << " is missing";
+    }
+    ++successful_reads;
+    ASSERT_OK(Execute(conn.get(), "ROLLBACK"));
+  }
+
+  LOG(INFO) << "Successful reads: " << successful_reads << ", failed reads: " << failed_reads;
+  ASSERT_GT(successful_reads, 0);
+
+  int64_t total_restarts = 0;
+  for (auto* tserver : cluster_->tserver_daemons()) {
+    auto tablets = ASSERT_RESULT(cluster_->GetTabletIds(tserver));
+    for (const auto& tablet : tablets) {
+      int64_t value;
+      auto status = tserver->GetInt64Metric(
+          &METRIC_ENTITY_tablet, tablet.c_str(), &METRIC_restart_read_requests, "value", &value);
+      if (status.ok()) {
+        total_restarts += value;
+      } else {
+        ASSERT_TRUE(status.IsNotFound()) << status;
+      }
+    }
+  }
+  LOG(INFO) << "Total restarts: " << total_restarts;
+  ASSERT_GT(total_restarts, 0);
+}
+
 } // namespace pgwrapper
 } // namespace yb
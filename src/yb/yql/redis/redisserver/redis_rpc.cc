@@ -359,7 +359,7 @@ RefCntBuffer SerializeResponses(const Collection& responses) {
   return result;
 }
 
-void RedisInboundCall::Serialize(boost::container::small_vector_base<RefCntBuffer>* output) {
+void RedisInboundCall::Serialize(boost::container::small_vector_base<RefCntSlice>* output) {
   output->push_back(SerializeResponses(responses_));
 }
 